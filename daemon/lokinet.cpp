@@ -18,28 +18,36 @@
 #include <iostream>
 #include <future>
 
-#ifdef USE_JEMALLOC
+#if defined(USE_JEMALLOC) || defined(TRACY_ENABLE)
 #include <new>
+#ifdef USE_JEMALLOC
 #include <jemalloc/jemalloc.h>
+#endif
+#include <llarp/util/instrument.hpp>
 
 void*
 operator new(std::size_t sz)
 {
   void* ptr = malloc(sz);
   if (ptr)
+  {
+    LLARP_TRACE_ALLOC(ptr, sz);
     return ptr;
+  }
   else
     throw std::bad_alloc{};
 }
 void
 operator delete(void* ptr) noexcept
 {
+  LLARP_TRACE_FREE(ptr);
   free(ptr);
 }
 
 void
 operator delete(void* ptr, size_t) noexcept
 {
+  LLARP_TRACE_FREE(ptr);
   free(ptr);
 }
 #endif
@@ -446,8 +454,8 @@ lokinet_main(int argc, char* argv[])
 
     if (!result["colour"].as<bool>())
     {
-      llarp::LogContext::Instance().logStream =
-          std::make_unique<llarp::OStreamLogStream>(false, std::cerr);
+      llarp::LogContext::Instance().SwapLogStream(
+          std::make_unique<llarp::OStreamLogStream>(false, std::cerr));
     }
 
     if (result.count("help"))
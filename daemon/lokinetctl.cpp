@@ -56,15 +56,15 @@ main(int argc, char* argv[])
     if (result.count("verbose") > 0)
     {
       SetLogLevel(llarp::eLogDebug);
-      llarp::LogContext::Instance().logStream =
-          std::make_unique<llarp::OStreamLogStream>(true, std::cerr);
+      llarp::LogContext::Instance().SwapLogStream(
+          std::make_unique<llarp::OStreamLogStream>(true, std::cerr));
       llarp::LogDebug("debug logging activated");
     }
     else
     {
       SetLogLevel(llarp::eLogError);
-      llarp::LogContext::Instance().logStream =
-          std::make_unique<llarp::OStreamLogStream>(true, std::cerr);
+      llarp::LogContext::Instance().SwapLogStream(
+          std::make_unique<llarp::OStreamLogStream>(true, std::cerr));
     }
 
     if (result.count("help") > 0)
@@ -53,6 +53,65 @@ extern "C"
   int
   lokinet_inbound_stream(uint16_t port, struct lokinet_context* context);
 
+  /// stop a stream made by lokinet_outbound_stream or remove an inbound stream acceptor
+  void
+  lokinet_close_stream(int stream_id, struct lokinet_context* context);
+
+  /// callbacks for a stream that the application reads and writes directly, without a localhost
+  /// tcp socket in between. they are all called from lokinet's event loop thread and must not
+  /// block it. any of them may be NULL.
+  struct lokinet_stream_callbacks
+  {
+    /// the stream is set up when error is zero, otherwise error is the errno of what failed and
+    /// no other callback is called for this stream id
+    void (*on_open)(int stream_id, int error, void* user);
+    /// data arrived, only valid for the duration of the call
+    void (*on_data)(int stream_id, const void* data, size_t len, void* user);
+    /// the stream closed, error is zero for a graceful close otherwise ECONNRESET. the stream id
+    /// is no longer valid once this returns.
+    void (*on_close)(int stream_id, int error, void* user);
+    /// there is room to send again after lokinet_stream_send returned EAGAIN
+    void (*on_writable)(int stream_id, void* user);
+    /// passed to every callback
+    void* user;
+  };
+
+  /// open a stream to remoteAddr, in the form of "name:port", that is read and written through
+  /// callbacks. does not block, the outcome is passed to callbacks->on_open.
+  /// returns the id of the new stream or -1 if the arguments are invalid or the context is not up
+  int
+  lokinet_stream_connect(
+      const char* remoteAddr,
+      const struct lokinet_stream_callbacks* callbacks,
+      struct lokinet_context* context);
+
+  /// accept inbound streams that pass acceptFilter, or all of them if it is NULL, and hand them to
+  /// callbacks instead of mapping them to a localhost port. every accepted stream gets its own id
+  /// and is announced through callbacks->on_open.
+  /// returns an id to pass to lokinet_close_stream to stop accepting, or -1 on error
+  int
+  lokinet_inbound_stream_callbacks(
+      lokinet_stream_filter acceptFilter,
+      void* user,
+      const struct lokinet_stream_callbacks* callbacks,
+      struct lokinet_context* context);
+
+  /// queue len bytes of data to be sent on a stream made by lokinet_stream_connect or
+  /// lokinet_inbound_stream_callbacks. the data is copied and the call does not block.
+  /// returns 0 if the data was queued
+  /// returns EAGAIN without queuing anything while the stream has too much data queued or
+  /// unacknowledged in flight, on_writable is called once it drains
+  /// returns ENOTCONN if the stream is not open yet or no longer open
+  int
+  lokinet_stream_send(
+      int stream_id, const void* data, size_t len, struct lokinet_context* context);
+
+  /// gracefully close a stream made by lokinet_stream_connect or
+  /// lokinet_inbound_stream_callbacks after everything queued so far is sent, on_close is called
+  /// when it is done
+  void
+  lokinet_stream_close(int stream_id, struct lokinet_context* context);
+
 #ifdef __cplusplus
 }
 #endif
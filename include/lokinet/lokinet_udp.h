@@ -15,6 +15,8 @@ extern "C"
 #include <sys/uio.h>
 #endif
 
+#include <time.h>
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -38,10 +40,13 @@ extern "C"
   /// establish an outbound udp flow
   /// remoteHost is the remote .loki or .snode address conneting to
   /// remotePort is either a string integer or an srv record name to lookup, e.g. thingservice in
-  /// which we do a srv lookup for _udp.thingservice.remotehost.tld and use the "best" port provided
+  /// which we do a srv lookup for _thingservice._udp.remotehost.tld and use the "best" port
+  /// provided
   /// localAddr is the local ip:port to bind our socket to, if localAddr is NULL then
   /// lokinet_udp_sendmmsg MUST be used to send packets return 0 on success return nonzero on fail,
   /// containing an errno value
+  /// blocks until a path to the remote is ready, fails with ETIMEDOUT if that takes over 30 seconds
+  /// forwarding to a local socket is not supported yet, a non NULL localAddr fails with ENOTSUP
   int
   lokinet_udp_establish(
       char* remoteHost,
@@ -66,18 +71,26 @@ extern "C"
   ///
   /// returns 0 on success
   /// returns nonzero on error in which it is an errno value
+  /// forwarding to a local socket is not supported yet, a non NULL localAddr fails with ENOTSUP
   int
   lokinet_udp_bind(
       int exposedPort,
       char* srv,
       char* localAddr,
-      struct lokinet_udp_listen_result* result,
+      struct lokinet_udp_bind_result* result,
       struct lokinet_context* ctx);
 
+  /// close a socket made by lokinet_udp_establish or lokinet_udp_bind, removing the srv record it
+  /// added if any
+  void
+  lokinet_udp_close(int socket_id, struct lokinet_context* ctx);
+
   /// poll many udp sockets for activity
+  /// waits until one of the sockets has packets to read or timeout passes, forever if timeout is
+  /// NULL
   /// returns 0 on sucess
-  ///
-  /// returns non zero errno on error
+  /// returns ETIMEDOUT if none had packets in time
+  /// returns non zero errno on error, EBADF if one of the sockets is not open
   int
   lokinet_udp_poll(
       const int* socket_ids,
@@ -92,13 +105,31 @@ extern "C"
     struct iovec pkt;
   };
 
-  /// analog to recvmmsg
+  /// analog to recvmmsg, does not block
+  /// fills up to max_events packets into the caller's buffers, pkt.iov_len is set to how many
+  /// bytes were copied, the smaller of its original value and the size of the datagram. the part
+  /// of a datagram that does not fit is dropped.
+  /// returns how many packets were filled in, 0 if none are waiting
+  /// returns -1 if the socket is not open
   ssize_t
   lokinet_udp_recvmmsg(
       int socket_id,
       struct lokinet_udp_pkt* events,
       size_t max_events,
-      struct lokient_context* ctx);
+      struct lokinet_context* ctx);
+
+  /// analog to sendmmsg, does not block
+  /// on a flow from lokinet_udp_establish the remote of every packet is the flow's and
+  /// remote_addr / remote_port are ignored. on a socket from lokinet_udp_bind they say who to
+  /// reply to, which must be someone that sent to this socket.
+  /// returns how many packets were queued to be sent
+  /// returns -1 if the socket is not open
+  ssize_t
+  lokinet_udp_sendmmsg(
+      int socket_id,
+      const struct lokinet_udp_pkt* events,
+      size_t num_events,
+      struct lokinet_context* ctx);
 
 #ifdef __cplusplus
 }
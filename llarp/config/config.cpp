@@ -240,6 +240,33 @@ namespace llarp
             relative_to_datadir,
         });
 
+    conf.defineOption<int>(
+        "router",
+        "introset-store-size",
+        RelayOnly,
+        Default{16},
+        Comment{
+            "Megabytes of memory to use for storing intro sets published to us. When full, the",
+            "intro sets farthest from us in the dht are dropped first.",
+        },
+        [this](int arg) {
+          if (arg < 1)
+            throw std::invalid_argument("introset-store-size must be at least 1");
+
+          m_IntroSetStoreSize = size_t(arg) * 1024 * 1024;
+        });
+
+    conf.defineOption<bool>(
+        "router",
+        "persist-introsets",
+        RelayOnly,
+        Default{false},
+        AssignmentAcceptor(m_PersistIntroSets),
+        Comment{
+            "Save the intro sets we store to introsets.dat in the data dir so that they can be",
+            "served right away after a restart.",
+        });
+
     // Deprecated options:
 
     // these weren't even ever used!
@@ -659,6 +686,50 @@ namespace llarp
           m_SRVRecords.push_back(std::move(newSRV));
         });
 
+    conf.defineOption<std::string>(
+        "network",
+        "addr-map-persist-file",
+        Comment{
+            "File to persist the ip address given to each remote in so that remotes keep the",
+            "same ip across restarts.  If not specified address mappings are lost on restart.",
+        },
+        [this](std::string arg) {
+          if (arg.empty())
+            return;
+          m_AddrMapPersistFile = arg;
+        });
+
+    conf.defineOption<bool>(
+        "network",
+        "quic-coalesce",
+        ClientOnly,
+        Default{false},
+        AssignmentAcceptor(m_QUICCoalesce),
+        Comment{
+            "Pack quic packets that are written together into shared lokinet frames instead of",
+            "sending each one in its own frame.  This lowers the per-packet cost of tcp tunnels",
+            "but requires that the remote end of the tunnel also understands coalesced frames.",
+        });
+
+    conf.defineOption<std::string>(
+        "network",
+        "send-queue",
+        ClientOnly,
+        Default{"codel"},
+        Comment{
+            "How packets from the tun interface wait to be sent into the network.  'codel' keeps",
+            "them in one queue.  'fq-codel' gives every connection its own queue and serves them",
+            "in turn, so interactive traffic does not wait behind bulk transfers.",
+        },
+        [this](std::string arg) {
+          if (arg == "codel")
+            m_FlowQueueing = false;
+          else if (arg == "fq-codel")
+            m_FlowQueueing = true;
+          else
+            throw std::invalid_argument(stringify("invalid send-queue: ", arg));
+        });
+
     // Deprecated options:
     conf.defineOption<std::string>("network", "enabled", Deprecated);
   }
@@ -897,6 +968,22 @@ namespace llarp
             "Recommend localhost-only for security purposes.",
         });
 
+    conf.defineOption<std::string>(
+        "api",
+        "metrics-bind",
+        [this](std::string arg) {
+          if (arg.empty())
+            return;
+          m_metricsBindAddr = IpAddress{std::move(arg)};
+          if (not m_metricsBindAddr->getPort())
+            throw std::invalid_argument{"[api]:metrics-bind needs a port"};
+        },
+        Comment{
+            "IP address and port to serve OpenMetrics (Prometheus) text on over HTTP at /metrics.",
+            "Disabled when empty. The same text is always available from the `llarp.metrics` RPC",
+            "command. Recommend localhost-only as it is not authenticated.",
+        });
+
     conf.defineOption<std::string>("api", "authkey", Deprecated);
 
     // TODO: this was from pre-refactor:
@@ -1084,6 +1171,32 @@ namespace llarp
             "e.g. exclude-country=DE",
             "can be listed multiple times to exclude multiple countries"});
 #endif
+
+    conf.defineOption<int>(
+        "paths",
+        "hedged-builds",
+        ClientOnly,
+        Default{3},
+        [=](int arg) {
+          if (arg < 1 or arg > 8)
+            throw std::invalid_argument{"[paths]:hedged-builds must be between 1 and 8"};
+          m_HedgedBuilds = arg;
+        },
+        Comment{
+            "When we need a path and have none, build this many over different routers at once",
+            "and keep the first one to finish. 1 builds one path at a time."});
+
+    conf.defineOption<int>(
+        "paths",
+        "hedge-budget",
+        ClientOnly,
+        Default{12},
+        [=](int arg) {
+          if (arg < 0)
+            throw std::invalid_argument{"[paths]:hedge-budget cannot be negative"};
+          m_HedgeBudget = arg;
+        },
+        Comment{"Most extra path builds per minute that racing builds may use."});
   }
 
   bool
@@ -67,6 +67,11 @@ namespace llarp
 
     bool m_isRelay = false;
 
+    /// most bytes of intro sets we store for the dht
+    size_t m_IntroSetStoreSize = 0;
+    /// keep stored intro sets in the data dir across restarts
+    bool m_PersistIntroSets = false;
+
     void
     defineConfigOptions(ConfigDefinition& conf, const ConfigGenParameters& params);
   };
@@ -82,6 +87,11 @@ namespace llarp
     /// set of countrys to exclude from path building (2 char country code)
     std::unordered_set<std::string> m_ExcludeCountries;
 
+    /// how many disjoint paths we race when a path set has none, 1 disables it
+    size_t m_HedgedBuilds = 1;
+    /// extra builds per minute racing may use across all path sets
+    size_t m_HedgeBudget = 0;
+
     void
     defineConfigOptions(ConfigDefinition& conf, const ConfigGenParameters& params);
 
@@ -125,6 +135,13 @@ namespace llarp
     std::set<IPRange> m_OwnedRanges;
     std::optional<net::TrafficPolicy> m_TrafficPolicy;
 
+    bool m_QUICCoalesce = false;
+
+    /// queue outbound packets per flow with fq-codel instead of a single codel queue
+    bool m_FlowQueueing = false;
+
+    std::optional<fs::path> m_AddrMapPersistFile;
+
     // TODO:
     // on-up
     // on-down
@@ -175,6 +192,7 @@ namespace llarp
   {
     bool m_enableRPCServer = false;
     std::string m_rpcBindAddr;
+    std::optional<IpAddress> m_metricsBindAddr;
 
     void
     defineConfigOptions(ConfigDefinition& conf, const ConfigGenParameters& params);
@@ -31,6 +31,9 @@ namespace llarp
 
     /// measure latency every this interval ms
     constexpr auto latency_interval = 20s;
+    /// measure latency this often on a path that is carrying traffic, the probe goes out with
+    /// the next batch of data
+    constexpr auto busy_latency_interval = 5s;
     /// if a path is inactive for this amount of time it's dead
     constexpr auto alive_timeout = latency_interval * 1.5;
 
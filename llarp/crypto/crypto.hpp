@@ -1,6 +1,7 @@
 #pragma once
 
 #include "constants.hpp"
+#include "onion.hpp"
 #include "types.hpp"
 
 #include <llarp/util/buffer.hpp>
@@ -18,6 +19,24 @@
 
 namespace llarp
 {
+  /// one buffer of a Crypto::xchacha20_batch call, encrypted in place
+  struct XChaCha20Job
+  {
+    byte_t* buf;
+    size_t sz;
+    const SharedSecret* key;
+    TunnelNonce nonce;
+  };
+
+  /// one message of a Crypto::hmac_batch call, HMACSIZE bytes are written to result
+  struct HMACJob
+  {
+    byte_t* result;
+    const byte_t* buf;
+    size_t sz;
+    const SharedSecret* key;
+  };
+
   /// library crypto configuration
   struct Crypto
   {
@@ -36,6 +55,14 @@ namespace llarp
     xchacha20_alt(
         const llarp_buffer_t&, const llarp_buffer_t&, const SharedSecret&, const byte_t*) = 0;
 
+    /// xchacha symmetric cipher applied once per layer in a single pass over the buffer
+    virtual bool
+    xchacha20_onion(const llarp_buffer_t&, const onion::Layer*, size_t) = 0;
+
+    /// xchacha symmetric cipher over many independent buffers at once
+    virtual bool
+    xchacha20_batch(const XChaCha20Job*, size_t) = 0;
+
     /// path dh creator's side
     virtual bool
     dh_client(SharedSecret&, const PubKey&, const SecretKey&, const TunnelNonce&) = 0;
@@ -54,6 +81,9 @@ namespace llarp
     /// blake2s 256 bit "hmac" (keyed hash)
     virtual bool
     hmac(byte_t*, const llarp_buffer_t&, const SharedSecret&) = 0;
+    /// blake2b 256 bit "hmac" of many independent messages at once
+    virtual bool
+    hmac_batch(const HMACJob*, size_t) = 0;
     /// ed25519 sign
     virtual bool
     sign(Signature&, const SecretKey&, const llarp_buffer_t&) = 0;
@@ -9,10 +9,12 @@
 #include <sodium/randombytes.h>
 #include <sodium/utils.h>
 #include <llarp/util/mem.hpp>
+#include <llarp/util/metrics.hpp>
 #include <llarp/util/endian.hpp>
 #include <llarp/util/str.hpp>
 #include <cassert>
 #include <cstring>
+#include <vector>
 
 extern "C"
 {
@@ -24,6 +26,30 @@ namespace llarp
 {
   namespace sodium
   {
+    /// counters of the crypto operations done, for the metrics registry
+    struct CryptoOps
+    {
+      static metrics::Counter&
+      Op(const char* op)
+      {
+        return metrics::Registry::Global().GetCounter(
+            "lokinet_crypto_ops", "crypto operations done", {{"op", op}});
+      }
+
+      metrics::Counter& xchacha20 = Op("xchacha20");
+      metrics::Counter& hmac = Op("hmac");
+      metrics::Counter& dh = Op("dh");
+      metrics::Counter& sign = Op("sign");
+      metrics::Counter& verify = Op("verify");
+    };
+
+    static CryptoOps&
+    Ops()
+    {
+      static CryptoOps ops;
+      return ops;
+    }
+
     static bool
     dh(llarp::SharedSecret& out,
        const PubKey& client_pk,
@@ -85,10 +111,12 @@ namespace llarp
       if (avx2 && std::string(avx2) == "1")
       {
         ntru_init(1);
+        m_SimdKernel = simd::Kernel::Scalar;
       }
       else
       {
         ntru_init(0);
+        m_SimdKernel = simd::BestKernel();
       }
       int seed = 0;
       randombytes(reinterpret_cast<unsigned char*>(&seed), sizeof(seed));
@@ -132,6 +160,7 @@ namespace llarp
     CryptoLibSodium::xchacha20(
         const llarp_buffer_t& buff, const SharedSecret& k, const TunnelNonce& n)
     {
+      Ops().xchacha20.Add();
       return crypto_stream_xchacha20_xor(buff.base, buff.base, buff.sz, n.data(), k.data()) == 0;
     }
 
@@ -139,15 +168,70 @@ namespace llarp
     CryptoLibSodium::xchacha20_alt(
         const llarp_buffer_t& out, const llarp_buffer_t& in, const SharedSecret& k, const byte_t* n)
     {
+      Ops().xchacha20.Add();
       if (in.sz > out.sz)
         return false;
       return crypto_stream_xchacha20_xor(out.base, in.base, in.sz, n, k.data()) == 0;
     }
 
+    bool
+    CryptoLibSodium::xchacha20_onion(
+        const llarp_buffer_t& buff, const onion::Layer* layers, size_t numLayers)
+    {
+      Ops().xchacha20.Add(numLayers);
+      // one pass only pays off with wide kernels, the scalar one is slower than libsodium per hop
+      if (m_SimdKernel != simd::Kernel::Scalar)
+      {
+        onion::XChaCha20(buff, layers, numLayers, m_SimdKernel);
+        return true;
+      }
+      bool ok = true;
+      for (size_t idx = 0; idx < numLayers; ++idx)
+        ok = crypto_stream_xchacha20_xor(
+                 buff.base, buff.base, buff.sz, layers[idx].nonce.data(), layers[idx].key->data())
+                == 0
+            and ok;
+      return ok;
+    }
+
+    bool
+    CryptoLibSodium::xchacha20_batch(const XChaCha20Job* jobs, size_t num)
+    {
+      Ops().xchacha20.Add(num);
+      if (m_SimdKernel != simd::Kernel::Scalar and num > 1)
+      {
+        std::vector<simd::ChaChaJob> batch;
+        batch.reserve(num);
+        for (size_t idx = 0; idx < num; ++idx)
+        {
+          batch.push_back(
+              {jobs[idx].buf,
+               jobs[idx].sz,
+               simd::Prepare(jobs[idx].key->data(), jobs[idx].nonce.data())});
+        }
+        if (m_SimdKernel == simd::Kernel::AVX512
+                ? simd::ChaChaBatchAVX512(batch.data(), batch.size())
+                : simd::ChaChaBatchAVX2(batch.data(), batch.size()))
+          return true;
+      }
+      bool ok = true;
+      for (size_t idx = 0; idx < num; ++idx)
+        ok = crypto_stream_xchacha20_xor(
+                 jobs[idx].buf,
+                 jobs[idx].buf,
+                 jobs[idx].sz,
+                 jobs[idx].nonce.data(),
+                 jobs[idx].key->data())
+                == 0
+            and ok;
+      return ok;
+    }
+
     bool
     CryptoLibSodium::dh_client(
         llarp::SharedSecret& shared, const PubKey& pk, const SecretKey& sk, const TunnelNonce& n)
     {
+      Ops().dh.Add();
       return dh_client_priv(shared, pk, sk, n);
     }
     /// path dh relay side
@@ -155,6 +239,7 @@ namespace llarp
     CryptoLibSodium::dh_server(
         llarp::SharedSecret& shared, const PubKey& pk, const SecretKey& sk, const TunnelNonce& n)
     {
+      Ops().dh.Add();
       return dh_server_priv(shared, pk, sk, n);
     }
     /// transport dh client side
@@ -162,6 +247,7 @@ namespace llarp
     CryptoLibSodium::transport_dh_client(
         llarp::SharedSecret& shared, const PubKey& pk, const SecretKey& sk, const TunnelNonce& n)
     {
+      Ops().dh.Add();
       return dh_client_priv(shared, pk, sk, n);
     }
     /// transport dh server side
@@ -169,6 +255,7 @@ namespace llarp
     CryptoLibSodium::transport_dh_server(
         llarp::SharedSecret& shared, const PubKey& pk, const SecretKey& sk, const TunnelNonce& n)
     {
+      Ops().dh.Add();
       return dh_server_priv(shared, pk, sk, n);
     }
 
@@ -183,11 +270,45 @@ namespace llarp
     bool
     CryptoLibSodium::hmac(byte_t* result, const llarp_buffer_t& buff, const SharedSecret& secret)
     {
+      Ops().hmac.Add();
       return crypto_generichash_blake2b(
                  result, HMACSIZE, buff.base, buff.sz, secret.data(), HMACSECSIZE)
           != -1;
     }
 
+    bool
+    CryptoLibSodium::hmac_batch(const HMACJob* jobs, size_t num)
+    {
+      Ops().hmac.Add(num);
+      static_assert(HMACSIZE == 32 and HMACSECSIZE == 32, "simd blake2b is fixed to 32 bytes");
+      if (m_SimdKernel != simd::Kernel::Scalar and num > 1)
+      {
+        std::vector<simd::Blake2bJob> batch;
+        batch.reserve(num);
+        for (size_t idx = 0; idx < num; ++idx)
+        {
+          batch.push_back(
+              {jobs[idx].result, jobs[idx].buf, jobs[idx].sz, jobs[idx].key->data()});
+        }
+        if (m_SimdKernel == simd::Kernel::AVX512
+                ? simd::Blake2bBatchAVX512(batch.data(), batch.size())
+                : simd::Blake2bBatchAVX2(batch.data(), batch.size()))
+          return true;
+      }
+      bool ok = true;
+      for (size_t idx = 0; idx < num; ++idx)
+        ok = crypto_generichash_blake2b(
+                 jobs[idx].result,
+                 HMACSIZE,
+                 jobs[idx].buf,
+                 jobs[idx].sz,
+                 jobs[idx].key->data(),
+                 HMACSECSIZE)
+                != -1
+            and ok;
+      return ok;
+    }
+
     static bool
     hash(uint8_t* result, const llarp_buffer_t& buff)
     {
@@ -197,12 +318,14 @@ namespace llarp
     bool
     CryptoLibSodium::sign(Signature& sig, const SecretKey& secret, const llarp_buffer_t& buf)
     {
+      Ops().sign.Add();
       return crypto_sign_detached(sig.data(), nullptr, buf.base, buf.sz, secret.data()) != -1;
     }
 
     bool
     CryptoLibSodium::sign(Signature& sig, const PrivateKey& privkey, const llarp_buffer_t& buf)
     {
+      Ops().sign.Add();
       PubKey pubkey;
 
       privkey.toPublic(pubkey);
@@ -247,6 +370,7 @@ namespace llarp
     bool
     CryptoLibSodium::verify(const PubKey& pub, const llarp_buffer_t& buf, const Signature& sig)
     {
+      Ops().verify.Add();
       return crypto_sign_verify_detached(sig.data(), buf.base, buf.sz, pub.data()) != -1;
     }
 
@@ -29,6 +29,15 @@ namespace llarp
           const SharedSecret&,
           const byte_t*) override;
 
+      /// xchacha symmetric cipher applied once per layer, in a single pass over the buffer when a
+      /// simd kernel is available and once per layer with libsodium otherwise
+      bool
+      xchacha20_onion(const llarp_buffer_t&, const onion::Layer*, size_t) override;
+
+      /// xchacha symmetric cipher over many independent buffers at once
+      bool
+      xchacha20_batch(const XChaCha20Job*, size_t) override;
+
       /// path dh creator's side
       bool
       dh_client(SharedSecret&, const PubKey&, const SecretKey&, const TunnelNonce&) override;
@@ -49,6 +58,9 @@ namespace llarp
       /// blake2s 256 bit hmac
       bool
       hmac(byte_t*, const llarp_buffer_t&, const SharedSecret&) override;
+      /// blake2b 256 bit hmac of many independent messages at once
+      bool
+      hmac_batch(const HMACJob*, size_t) override;
       /// ed25519 sign
       bool
       sign(Signature&, const SecretKey&, const llarp_buffer_t&) override;
@@ -104,6 +116,9 @@ namespace llarp
 
       bool
       check_identity_privkey(const SecretKey&) override;
+
+     private:
+      simd::Kernel m_SimdKernel = simd::Kernel::Scalar;
     };
   }  // namespace sodium
 
@@ -0,0 +1,34 @@
+#include "onion.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace llarp::onion
+{
+  void
+  XChaCha20(const llarp_buffer_t& buf, const Layer* layers, size_t numLayers, simd::Kernel which)
+  {
+    if (not simd::Supported(which))
+      which = simd::Kernel::Scalar;
+
+    // the keystreams xor together, so very long onions are simply done in groups
+    constexpr size_t MaxGroup = 16;
+    std::array<simd::PreparedKey, MaxGroup> prepared;
+    while (numLayers > 0)
+    {
+      const size_t num = std::min(numLayers, MaxGroup);
+      for (size_t idx = 0; idx < num; ++idx)
+        prepared[idx] = simd::Prepare(layers[idx].key->data(), layers[idx].nonce.data());
+
+      size_t done = 0;
+      if (which == simd::Kernel::AVX512)
+        done = simd::OnionAVX512(buf.base, buf.sz, prepared.data(), num);
+      else if (which == simd::Kernel::AVX2)
+        done = simd::OnionAVX2(buf.base, buf.sz, prepared.data(), num);
+      simd::OnionScalar(buf.base + done, buf.sz - done, done / 64, prepared.data(), num);
+
+      layers += num;
+      numLayers -= num;
+    }
+  }
+}  // namespace llarp::onion
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "simd_kernel.hpp"
+#include "types.hpp"
+
+#include <llarp/util/buffer.hpp>
+
+namespace llarp::onion
+{
+  /// one layer of xchacha20 onion encryption
+  struct Layer
+  {
+    const SharedSecret* key;
+    TunnelNonce nonce;
+  };
+
+  /// apply every layer of xchacha20 to buf in a single pass over it: the keystreams of all layers
+  /// are generated together and their xor is applied to the payload once. the result is bit
+  /// identical to calling Crypto::xchacha20 once per layer. falls back to the scalar kernel if
+  /// which is not supported.
+  void
+  XChaCha20(const llarp_buffer_t& buf, const Layer* layers, size_t numLayers, simd::Kernel which);
+}  // namespace llarp::onion
@@ -0,0 +1,133 @@
+#include "simd_kernel.hpp"
+
+#include <sodium/crypto_core_hchacha20.h>
+
+#include <algorithm>
+#include <array>
+
+namespace llarp::simd
+{
+  static inline uint32_t
+  Load32(const uint8_t* ptr)
+  {
+    return uint32_t{ptr[0]} | (uint32_t{ptr[1]} << 8) | (uint32_t{ptr[2]} << 16)
+        | (uint32_t{ptr[3]} << 24);
+  }
+
+  static inline uint32_t
+  Rotl(uint32_t x, int n)
+  {
+    return (x << n) | (x >> (32 - n));
+  }
+
+  static inline void
+  QuarterRound(uint32_t* x, int a, int b, int c, int d)
+  {
+    x[a] += x[b];
+    x[d] = Rotl(x[d] ^ x[a], 16);
+    x[c] += x[d];
+    x[b] = Rotl(x[b] ^ x[c], 12);
+    x[a] += x[b];
+    x[d] = Rotl(x[d] ^ x[a], 8);
+    x[c] += x[d];
+    x[b] = Rotl(x[b] ^ x[c], 7);
+  }
+
+  /// xor one chacha20 keystream block of key into acc
+  static void
+  Accumulate(uint32_t* acc, const PreparedKey& key, uint64_t block)
+  {
+    uint32_t init[16] = {
+        0x61707865,
+        0x3320646e,
+        0x79622d32,
+        0x6b206574,
+        key.key[0],
+        key.key[1],
+        key.key[2],
+        key.key[3],
+        key.key[4],
+        key.key[5],
+        key.key[6],
+        key.key[7],
+        static_cast<uint32_t>(block),
+        static_cast<uint32_t>(block >> 32),
+        key.nonce[0],
+        key.nonce[1]};
+    uint32_t x[16];
+    std::copy_n(init, 16, x);
+    for (int round = 0; round < 10; ++round)
+    {
+      QuarterRound(x, 0, 4, 8, 12);
+      QuarterRound(x, 1, 5, 9, 13);
+      QuarterRound(x, 2, 6, 10, 14);
+      QuarterRound(x, 3, 7, 11, 15);
+      QuarterRound(x, 0, 5, 10, 15);
+      QuarterRound(x, 1, 6, 11, 12);
+      QuarterRound(x, 2, 7, 8, 13);
+      QuarterRound(x, 3, 4, 9, 14);
+    }
+    for (int i = 0; i < 16; ++i)
+      acc[i] ^= x[i] + init[i];
+  }
+
+  PreparedKey
+  Prepare(const uint8_t* key, const uint8_t* nonce)
+  {
+    // xchacha20 is chacha20 keyed with hchacha20(key, nonce[0:16]) using nonce[16:24]
+    std::array<uint8_t, 32> subkey;
+    crypto_core_hchacha20(subkey.data(), nonce, key, nullptr);
+    PreparedKey prepared;
+    for (size_t word = 0; word < 8; ++word)
+      prepared.key[word] = Load32(subkey.data() + word * 4);
+    prepared.nonce[0] = Load32(nonce + 16);
+    prepared.nonce[1] = Load32(nonce + 20);
+    return prepared;
+  }
+
+  void
+  OnionScalar(uint8_t* buf, size_t sz, uint64_t firstBlock, const PreparedKey* keys, size_t num)
+  {
+    for (uint64_t block = firstBlock; sz > 0; ++block)
+    {
+      uint32_t acc[16] = {0};
+      for (size_t idx = 0; idx < num; ++idx)
+        Accumulate(acc, keys[idx], block);
+      const size_t n = std::min<size_t>(sz, 64);
+      for (size_t idx = 0; idx < n; ++idx)
+        buf[idx] ^= static_cast<uint8_t>(acc[idx / 4] >> (8 * (idx % 4)));
+      buf += n;
+      sz -= n;
+    }
+  }
+
+  bool
+  Supported(Kernel which)
+  {
+    switch (which)
+    {
+      case Kernel::Scalar:
+        return true;
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+      case Kernel::AVX2:
+        return HaveAVX2() and __builtin_cpu_supports("avx2");
+      case Kernel::AVX512:
+        return HaveAVX512() and __builtin_cpu_supports("avx512f")
+            and __builtin_cpu_supports("avx512vl");
+#endif
+      default:
+        return false;
+    }
+  }
+
+  Kernel
+  BestKernel()
+  {
+    for (const auto which : {Kernel::AVX512, Kernel::AVX2})
+    {
+      if (Supported(which))
+        return which;
+    }
+    return Kernel::Scalar;
+  }
+}  // namespace llarp::simd
@@ -0,0 +1,117 @@
+#include "simd_kernel.hpp"
+
+#ifdef __AVX2__
+
+#include "simd_x86.hpp"
+
+namespace llarp::simd
+{
+  namespace
+  {
+    struct RotateAVX2
+    {
+      template <int N>
+      static inline __m256i
+      Left32(__m256i x)
+      {
+        // whole byte rotates are a single byte shuffle
+        if constexpr (N == 16)
+          return _mm256_shuffle_epi8(
+              x,
+              _mm256_setr_epi8(
+                  2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                  2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13));
+        else if constexpr (N == 8)
+          return _mm256_shuffle_epi8(
+              x,
+              _mm256_setr_epi8(
+                  3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                  3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14));
+        else
+          return _mm256_or_si256(_mm256_slli_epi32(x, N), _mm256_srli_epi32(x, 32 - N));
+      }
+
+      template <int N>
+      static inline __m256i
+      Right64(__m256i x)
+      {
+        if constexpr (N == 32)
+          return _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+        else if constexpr (N == 24)
+          return _mm256_shuffle_epi8(
+              x,
+              _mm256_setr_epi8(
+                  3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+                  3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10));
+        else if constexpr (N == 16)
+          return _mm256_shuffle_epi8(
+              x,
+              _mm256_setr_epi8(
+                  2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+                  2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9));
+        else if constexpr (N == 63)
+          return _mm256_or_si256(_mm256_add_epi64(x, x), _mm256_srli_epi64(x, 63));
+        else
+          return _mm256_or_si256(_mm256_srli_epi64(x, N), _mm256_slli_epi64(x, 64 - N));
+      }
+    };
+  }  // namespace
+
+  size_t
+  OnionAVX2(uint8_t* buf, size_t sz, const PreparedKey* keys, size_t num)
+  {
+    return ChaCha8<RotateAVX2>::Onion(buf, sz, keys, num);
+  }
+
+  bool
+  ChaChaBatchAVX2(ChaChaJob* jobs, size_t num)
+  {
+    ChaCha8<RotateAVX2>::Batch(jobs, num);
+    return true;
+  }
+
+  bool
+  Blake2bBatchAVX2(Blake2bJob* jobs, size_t num)
+  {
+    Blake2b4<RotateAVX2>::Batch(jobs, num);
+    return true;
+  }
+
+  bool
+  HaveAVX2()
+  {
+    return true;
+  }
+}  // namespace llarp::simd
+
+#else
+
+// stubs for compilers/builds without avx2 support
+namespace llarp::simd
+{
+  size_t
+  OnionAVX2(uint8_t*, size_t, const PreparedKey*, size_t)
+  {
+    return 0;
+  }
+
+  bool
+  ChaChaBatchAVX2(ChaChaJob*, size_t)
+  {
+    return false;
+  }
+
+  bool
+  Blake2bBatchAVX2(Blake2bJob*, size_t)
+  {
+    return false;
+  }
+
+  bool
+  HaveAVX2()
+  {
+    return false;
+  }
+}  // namespace llarp::simd
+
+#endif
@@ -0,0 +1,87 @@
+#include "simd_kernel.hpp"
+
+#if defined(__AVX512F__) && defined(__AVX512VL__)
+
+#include "simd_x86.hpp"
+
+namespace llarp::simd
+{
+  namespace
+  {
+    /// avx512vl has single instruction rotates for 256 bit registers
+    struct RotateAVX512
+    {
+      template <int N>
+      static inline __m256i
+      Left32(__m256i x)
+      {
+        return _mm256_rol_epi32(x, N);
+      }
+
+      template <int N>
+      static inline __m256i
+      Right64(__m256i x)
+      {
+        return _mm256_ror_epi64(x, N);
+      }
+    };
+  }  // namespace
+
+  size_t
+  OnionAVX512(uint8_t* buf, size_t sz, const PreparedKey* keys, size_t num)
+  {
+    return ChaCha8<RotateAVX512>::Onion(buf, sz, keys, num);
+  }
+
+  bool
+  ChaChaBatchAVX512(ChaChaJob* jobs, size_t num)
+  {
+    ChaCha8<RotateAVX512>::Batch(jobs, num);
+    return true;
+  }
+
+  bool
+  Blake2bBatchAVX512(Blake2bJob* jobs, size_t num)
+  {
+    Blake2b4<RotateAVX512>::Batch(jobs, num);
+    return true;
+  }
+
+  bool
+  HaveAVX512()
+  {
+    return true;
+  }
+}  // namespace llarp::simd
+
+#else
+
+// stubs for compilers/builds without avx512 support
+namespace llarp::simd
+{
+  size_t
+  OnionAVX512(uint8_t*, size_t, const PreparedKey*, size_t)
+  {
+    return 0;
+  }
+
+  bool
+  ChaChaBatchAVX512(ChaChaJob*, size_t)
+  {
+    return false;
+  }
+
+  bool
+  Blake2bBatchAVX512(Blake2bJob*, size_t)
+  {
+    return false;
+  }
+
+  bool
+  HaveAVX512()
+  {
+    return false;
+  }
+}  // namespace llarp::simd
+
+#endif
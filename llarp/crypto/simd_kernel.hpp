@@ -0,0 +1,99 @@
+#pragma once
+
+// this header is included by translation units compiled with -mavx2 / -mavx512*, keep it free of
+// anything but plain declarations so no inline code built for those instruction sets ends up
+// being picked by the linker for callers running on older cpus.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace llarp::simd
+{
+  /// implementations of the simd crypto kernels
+  enum class Kernel
+  {
+    Scalar,
+    AVX2,
+    AVX512,
+  };
+
+  /// true if which was compiled in and this cpu can run it
+  bool
+  Supported(Kernel which);
+
+  /// the fastest kernel this cpu supports
+  Kernel
+  BestKernel();
+
+  /// an xchacha20 key and nonce reduced to the chacha20 state it needs: the hchacha20 subkey and
+  /// the last 8 bytes of the 24 byte nonce, both as little endian words
+  struct PreparedKey
+  {
+    uint32_t key[8];
+    uint32_t nonce[2];
+  };
+
+  /// reduce a 32 byte key and 24 byte xchacha20 nonce for the kernels
+  PreparedKey
+  Prepare(const uint8_t* key, const uint8_t* nonce);
+
+  /// one buffer of a batched chacha20 call
+  struct ChaChaJob
+  {
+    uint8_t* buf;
+    size_t sz;
+    PreparedKey key;
+  };
+
+  /// one message of a batched keyed blake2b call with a 32 byte key and a 32 byte result
+  struct Blake2bJob
+  {
+    uint8_t* out;
+    const uint8_t* msg;
+    size_t sz;
+    const uint8_t* key;
+  };
+
+  /// number of 64 byte chacha blocks or independent buffers the simd kernels do per step
+  constexpr size_t ChaChaLanes = 8;
+
+  /// number of independent messages the simd blake2b kernels do per step
+  constexpr size_t Blake2bLanes = 4;
+
+  /// xor the combined keystream of all keys into buf, starting at keystream block firstBlock
+  void
+  OnionScalar(uint8_t* buf, size_t sz, uint64_t firstBlock, const PreparedKey* keys, size_t num);
+
+  /// xor the combined keystream of all keys into the leading whole ChaChaLanes * 64 byte chunks
+  /// of buf, starting at block 0. returns the number of bytes done, which is always 0 if the
+  /// kernel was not compiled in.
+  size_t
+  OnionAVX2(uint8_t* buf, size_t sz, const PreparedKey* keys, size_t num);
+
+  size_t
+  OnionAVX512(uint8_t* buf, size_t sz, const PreparedKey* keys, size_t num);
+
+  /// xor each job's keystream into its buffer, ChaChaLanes jobs at a time. returns false without
+  /// doing anything if the kernel was not compiled in.
+  bool
+  ChaChaBatchAVX2(ChaChaJob* jobs, size_t num);
+
+  bool
+  ChaChaBatchAVX512(ChaChaJob* jobs, size_t num);
+
+  /// keyed blake2b of each job, Blake2bLanes jobs at a time. returns false without doing anything
+  /// if the kernel was not compiled in.
+  bool
+  Blake2bBatchAVX2(Blake2bJob* jobs, size_t num);
+
+  bool
+  Blake2bBatchAVX512(Blake2bJob* jobs, size_t num);
+
+  /// true if the avx2 kernels were compiled in
+  bool
+  HaveAVX2();
+
+  /// true if the avx512 kernels were compiled in
+  bool
+  HaveAVX512();
+}  // namespace llarp::simd
@@ -0,0 +1,394 @@
+#pragma once
+
+// chacha20 and blake2b cores shared by the avx2 and avx512 kernels, only include this from a
+// translation unit compiled for at least avx2. Rotate supplies the lane rotates, which is all
+// that differs between the two.
+
+#include "simd_kernel.hpp"
+
+#include <immintrin.h>
+
+#include <cstring>
+
+namespace llarp::simd
+{
+  namespace
+  {
+    // no std algorithms in here: their out of line instantiations are shared between translation
+    // units and could end up built with avx instructions
+    inline size_t
+    Min(size_t a, size_t b)
+    {
+      return a < b ? a : b;
+    }
+
+    inline size_t
+    Max(size_t a, size_t b)
+    {
+      return a < b ? b : a;
+    }
+
+    /// 8 lane chacha20, lane i of word w is word w of the state of block / buffer i
+    template <typename Rotate>
+    struct ChaCha8
+    {
+      static inline void
+      QuarterRound(__m256i& a, __m256i& b, __m256i& c, __m256i& d)
+      {
+        a = _mm256_add_epi32(a, b);
+        d = Rotate::template Left32<16>(_mm256_xor_si256(d, a));
+        c = _mm256_add_epi32(c, d);
+        b = Rotate::template Left32<12>(_mm256_xor_si256(b, c));
+        a = _mm256_add_epi32(a, b);
+        d = Rotate::template Left32<8>(_mm256_xor_si256(d, a));
+        c = _mm256_add_epi32(c, d);
+        b = Rotate::template Left32<7>(_mm256_xor_si256(b, c));
+      }
+
+      /// the 20 chacha rounds without the final addition of the input
+      static inline void
+      Rounds(__m256i* x)
+      {
+        for (int round = 0; round < 10; ++round)
+        {
+          QuarterRound(x[0], x[4], x[8], x[12]);
+          QuarterRound(x[1], x[5], x[9], x[13]);
+          QuarterRound(x[2], x[6], x[10], x[14]);
+          QuarterRound(x[3], x[7], x[11], x[15]);
+          QuarterRound(x[0], x[5], x[10], x[15]);
+          QuarterRound(x[1], x[6], x[11], x[12]);
+          QuarterRound(x[2], x[7], x[8], x[13]);
+          QuarterRound(x[3], x[4], x[9], x[14]);
+        }
+      }
+
+      static inline __m256i
+      Constant(int word)
+      {
+        constexpr uint32_t sigma[4] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+        return _mm256_set1_epi32(sigma[word]);
+      }
+
+      /// xor 8 consecutive keystream blocks of key into acc, lane i of acc[w] is word w of
+      /// block firstBlock + i
+      static inline void
+      Accumulate(__m256i* acc, const PreparedKey& key, uint64_t firstBlock)
+      {
+        alignas(32) uint32_t lo[8], hi[8];
+        for (int i = 0; i < 8; ++i)
+        {
+          lo[i] = static_cast<uint32_t>(firstBlock + i);
+          hi[i] = static_cast<uint32_t>((firstBlock + i) >> 32);
+        }
+        const __m256i counterLo = _mm256_load_si256(reinterpret_cast<const __m256i*>(lo));
+        const __m256i counterHi = _mm256_load_si256(reinterpret_cast<const __m256i*>(hi));
+
+        // the initial state is rebuilt from broadcasts at the end rather than kept around, there
+        // are not enough registers for both
+        __m256i x[16];
+        for (int i = 0; i < 4; ++i)
+          x[i] = Constant(i);
+        for (int i = 0; i < 8; ++i)
+          x[4 + i] = _mm256_set1_epi32(key.key[i]);
+        x[12] = counterLo;
+        x[13] = counterHi;
+        x[14] = _mm256_set1_epi32(key.nonce[0]);
+        x[15] = _mm256_set1_epi32(key.nonce[1]);
+        Rounds(x);
+        for (int i = 0; i < 4; ++i)
+          x[i] = _mm256_add_epi32(x[i], Constant(i));
+        for (int i = 0; i < 8; ++i)
+          x[4 + i] = _mm256_add_epi32(x[4 + i], _mm256_set1_epi32(key.key[i]));
+        x[12] = _mm256_add_epi32(x[12], counterLo);
+        x[13] = _mm256_add_epi32(x[13], counterHi);
+        x[14] = _mm256_add_epi32(x[14], _mm256_set1_epi32(key.nonce[0]));
+        x[15] = _mm256_add_epi32(x[15], _mm256_set1_epi32(key.nonce[1]));
+        for (int i = 0; i < 16; ++i)
+          acc[i] = _mm256_xor_si256(acc[i], x[i]);
+      }
+
+      /// transpose 8 registers of 8 words so register i holds words 0-7 of lane i
+      static inline void
+      Transpose(__m256i* r)
+      {
+        const __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+        const __m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+        const __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+        const __m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+        const __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+        const __m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+        const __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+        const __m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+
+        const __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+        const __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+        const __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+        const __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+        const __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+        const __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+        const __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+        const __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+        r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+        r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+        r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+        r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+        r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+        r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+        r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+        r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+      }
+
+      /// xor the 64 byte block in lo/hi into sz bytes at ptr
+      static inline void
+      XorBlock(uint8_t* ptr, size_t sz, __m256i lo, __m256i hi)
+      {
+        if (sz >= 64)
+        {
+          auto* first = reinterpret_cast<__m256i*>(ptr);
+          auto* second = reinterpret_cast<__m256i*>(ptr + 32);
+          _mm256_storeu_si256(first, _mm256_xor_si256(_mm256_loadu_si256(first), lo));
+          _mm256_storeu_si256(second, _mm256_xor_si256(_mm256_loadu_si256(second), hi));
+          return;
+        }
+        alignas(32) uint8_t block[64];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(block), lo);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(block + 32), hi);
+        for (size_t idx = 0; idx < sz; ++idx)
+          ptr[idx] ^= block[idx];
+      }
+
+      static size_t
+      Onion(uint8_t* buf, size_t sz, const PreparedKey* keys, size_t num)
+      {
+        constexpr size_t chunk = ChaChaLanes * 64;
+        size_t done = 0;
+        for (; done + chunk <= sz; done += chunk)
+        {
+          // the combined keystream of every layer stays in registers, the payload is only
+          // touched once
+          __m256i acc[16];
+          for (auto& word : acc)
+            word = _mm256_setzero_si256();
+          for (size_t layer = 0; layer < num; ++layer)
+            Accumulate(acc, keys[layer], done / 64);
+          Transpose(acc);
+          Transpose(acc + 8);
+          for (size_t block = 0; block < ChaChaLanes; ++block)
+            XorBlock(buf + done + block * 64, 64, acc[block], acc[8 + block]);
+        }
+        return done;
+      }
+
+      /// up to 8 jobs at once, each lane has its own key and nonce and walks its own buffer
+      static void
+      BatchGroup(ChaChaJob* jobs, size_t num)
+      {
+        // key material transposed so that lane i of each word belongs to job i
+        alignas(32) uint32_t keys[10][8] = {};
+        size_t blocks = 0;
+        for (size_t lane = 0; lane < num; ++lane)
+        {
+          for (int word = 0; word < 8; ++word)
+            keys[word][lane] = jobs[lane].key.key[word];
+          keys[8][lane] = jobs[lane].key.nonce[0];
+          keys[9][lane] = jobs[lane].key.nonce[1];
+          blocks = Max(blocks, (jobs[lane].sz + 63) / 64);
+        }
+        const auto Load = [&keys](int word) {
+          return _mm256_load_si256(reinterpret_cast<const __m256i*>(keys[word]));
+        };
+
+        for (size_t block = 0; block < blocks; ++block)
+        {
+          const __m256i counterLo = _mm256_set1_epi32(static_cast<uint32_t>(block));
+          const __m256i counterHi =
+              _mm256_set1_epi32(static_cast<uint32_t>(uint64_t{block} >> 32));
+          __m256i x[16];
+          for (int i = 0; i < 4; ++i)
+            x[i] = Constant(i);
+          for (int i = 0; i < 8; ++i)
+            x[4 + i] = Load(i);
+          x[12] = counterLo;
+          x[13] = counterHi;
+          x[14] = Load(8);
+          x[15] = Load(9);
+          Rounds(x);
+          for (int i = 0; i < 4; ++i)
+            x[i] = _mm256_add_epi32(x[i], Constant(i));
+          for (int i = 0; i < 8; ++i)
+            x[4 + i] = _mm256_add_epi32(x[4 + i], Load(i));
+          x[12] = _mm256_add_epi32(x[12], counterLo);
+          x[13] = _mm256_add_epi32(x[13], counterHi);
+          x[14] = _mm256_add_epi32(x[14], Load(8));
+          x[15] = _mm256_add_epi32(x[15], Load(9));
+          Transpose(x);
+          Transpose(x + 8);
+          const size_t offset = block * 64;
+          for (size_t lane = 0; lane < num; ++lane)
+          {
+            if (offset < jobs[lane].sz)
+              XorBlock(jobs[lane].buf + offset, jobs[lane].sz - offset, x[lane], x[8 + lane]);
+          }
+        }
+      }
+
+      static void
+      Batch(ChaChaJob* jobs, size_t num)
+      {
+        for (size_t idx = 0; idx < num; idx += ChaChaLanes)
+          BatchGroup(jobs + idx, Min(ChaChaLanes, num - idx));
+      }
+    };
+
+    /// 4 lane keyed blake2b with 32 byte keys and results, lane i hashes job i
+    template <typename Rotate>
+    struct Blake2b4
+    {
+      static constexpr uint64_t IV[8] = {
+          0x6a09e667f3bcc908ULL,
+          0xbb67ae8584caa73bULL,
+          0x3c6ef372fe94f82bULL,
+          0xa54ff53a5f1d36f1ULL,
+          0x510e527fade682d1ULL,
+          0x9b05688c2b3e6c1fULL,
+          0x1f83d9abfb41bd6bULL,
+          0x5be0cd19137e2179ULL};
+
+      static constexpr uint8_t Sigma[12][16] = {
+          {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+          {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+          {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4},
+          {7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+          {9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13},
+          {2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+          {12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11},
+          {13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+          {6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5},
+          {10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0},
+          {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+          {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3}};
+
+      static inline void
+      G(__m256i& a, __m256i& b, __m256i& c, __m256i& d, __m256i x, __m256i y)
+      {
+        a = _mm256_add_epi64(_mm256_add_epi64(a, b), x);
+        d = Rotate::template Right64<32>(_mm256_xor_si256(d, a));
+        c = _mm256_add_epi64(c, d);
+        b = Rotate::template Right64<24>(_mm256_xor_si256(b, c));
+        a = _mm256_add_epi64(_mm256_add_epi64(a, b), y);
+        d = Rotate::template Right64<16>(_mm256_xor_si256(d, a));
+        c = _mm256_add_epi64(c, d);
+        b = Rotate::template Right64<63>(_mm256_xor_si256(b, c));
+      }
+
+      static inline void
+      Compress(__m256i* h, const __m256i* m, __m256i counter, __m256i final)
+      {
+        __m256i v[16];
+        for (int i = 0; i < 8; ++i)
+        {
+          v[i] = h[i];
+          v[8 + i] = _mm256_set1_epi64x(IV[i]);
+        }
+        // the counter never reaches 2^64 bytes so its high word stays zero
+        v[12] = _mm256_xor_si256(v[12], counter);
+        v[14] = _mm256_xor_si256(v[14], final);
+        for (const auto& s : Sigma)
+        {
+          G(v[0], v[4], v[8], v[12], m[s[0]], m[s[1]]);
+          G(v[1], v[5], v[9], v[13], m[s[2]], m[s[3]]);
+          G(v[2], v[6], v[10], v[14], m[s[4]], m[s[5]]);
+          G(v[3], v[7], v[11], v[15], m[s[6]], m[s[7]]);
+          G(v[0], v[5], v[10], v[15], m[s[8]], m[s[9]]);
+          G(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);
+          G(v[2], v[7], v[8], v[13], m[s[12]], m[s[13]]);
+          G(v[3], v[4], v[9], v[14], m[s[14]], m[s[15]]);
+        }
+        for (int i = 0; i < 8; ++i)
+          h[i] = _mm256_xor_si256(h[i], _mm256_xor_si256(v[i], v[8 + i]));
+      }
+
+      static void
+      BatchGroup(Blake2bJob* jobs, size_t num)
+      {
+        // the key padded to a full block is hashed first, then the message
+        size_t steps[Blake2bLanes] = {};
+        size_t maxSteps = 0;
+        for (size_t lane = 0; lane < num; ++lane)
+        {
+          steps[lane] = 1 + (jobs[lane].sz + 127) / 128;
+          maxSteps = Max(maxSteps, steps[lane]);
+        }
+
+        __m256i h[8];
+        for (int i = 0; i < 8; ++i)
+          h[i] = _mm256_set1_epi64x(IV[i]);
+        // parameter block: 32 byte digest, 32 byte key, fanout and depth 1
+        h[0] = _mm256_xor_si256(h[0], _mm256_set1_epi64x(0x01012020));
+
+        for (size_t step = 0; step < maxSteps; ++step)
+        {
+          alignas(32) uint64_t words[16][Blake2bLanes] = {};
+          alignas(32) uint64_t counter[Blake2bLanes] = {};
+          alignas(32) uint64_t final[Blake2bLanes] = {};
+          alignas(32) uint64_t active[Blake2bLanes] = {};
+          for (size_t lane = 0; lane < num; ++lane)
+          {
+            if (step >= steps[lane])
+              continue;
+            active[lane] = ~uint64_t{0};
+            uint8_t block[128] = {};
+            if (step == 0)
+              std::memcpy(block, jobs[lane].key, 32);
+            else
+            {
+              const size_t offset = (step - 1) * 128;
+              std::memcpy(block, jobs[lane].msg + offset, Min(128, jobs[lane].sz - offset));
+            }
+            for (int word = 0; word < 16; ++word)
+              std::memcpy(&words[word][lane], block + word * 8, 8);
+            if (step + 1 == steps[lane])
+            {
+              counter[lane] = 128 + jobs[lane].sz;
+              final[lane] = ~uint64_t{0};
+            }
+            else
+              counter[lane] = 128 * (step + 1);
+          }
+          __m256i m[16];
+          for (int word = 0; word < 16; ++word)
+            m[word] = _mm256_load_si256(reinterpret_cast<const __m256i*>(words[word]));
+          __m256i next[8];
+          for (int i = 0; i < 8; ++i)
+            next[i] = h[i];
+          Compress(
+              next,
+              m,
+              _mm256_load_si256(reinterpret_cast<const __m256i*>(counter)),
+              _mm256_load_si256(reinterpret_cast<const __m256i*>(final)));
+          // lanes that already finished keep their state
+          const __m256i mask = _mm256_load_si256(reinterpret_cast<const __m256i*>(active));
+          for (int i = 0; i < 8; ++i)
+            h[i] = _mm256_blendv_epi8(h[i], next[i], mask);
+        }
+
+        alignas(32) uint64_t out[4][Blake2bLanes];
+        for (int i = 0; i < 4; ++i)
+          _mm256_store_si256(reinterpret_cast<__m256i*>(out[i]), h[i]);
+        for (size_t lane = 0; lane < num; ++lane)
+        {
+          for (int i = 0; i < 4; ++i)
+            std::memcpy(jobs[lane].out + i * 8, &out[i][lane], 8);
+        }
+      }
+
+      static void
+      Batch(Blake2bJob* jobs, size_t num)
+      {
+        for (size_t idx = 0; idx < num; idx += Blake2bLanes)
+          BatchGroup(jobs + idx, Min(Blake2bLanes, num - idx));
+      }
+    };
+  }  // namespace
+}  // namespace llarp::simd
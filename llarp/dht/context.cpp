@@ -21,12 +21,30 @@
 #include <llarp/profiling.hpp>
 #include <llarp/router/i_rc_lookup_handler.hpp>
 #include <llarp/util/decaying_hashset.hpp>
+#include <llarp/util/metrics.hpp>
 #include <vector>
 
 namespace llarp
 {
   namespace dht
   {
+    /// dht lookups this router started or relayed, by what they look for
+    static metrics::Counter&
+    RouterLookups()
+    {
+      static auto& lookups = metrics::Registry::Global().GetCounter(
+          "lokinet_dht_lookups", "dht lookups started or relayed", {{"kind", "router"}});
+      return lookups;
+    }
+
+    static metrics::Counter&
+    IntroSetLookups()
+    {
+      static auto& lookups = metrics::Registry::Global().GetCounter(
+          "lokinet_dht_lookups", "dht lookups started or relayed", {{"kind", "introset"}});
+      return lookups;
+    }
+
     AbstractContext::~AbstractContext() = default;
 
     struct Context final : public AbstractContext
@@ -171,14 +189,21 @@ namespace llarp
       std::unique_ptr<Bucket<RCNode>> _nodes;
 
       // for introduction sets
-      std::unique_ptr<Bucket<ISNode>> _services;
+      std::unique_ptr<IntroSetStore> _services;
 
-      Bucket<ISNode>*
+      /// where we persist intro sets, if we do
+      std::optional<fs::path> _servicesFile;
+      llarp_time_t _nextServicesSave = 0s;
+
+      IntroSetStore*
       services() override
       {
         return _services.get();
       }
 
+      void
+      SaveIntroSets() override;
+
       bool allowTransit{false};
 
       bool&
@@ -299,6 +324,15 @@ namespace llarp
     Context::Context()
     {
       randombytes((byte_t*)&ids, sizeof(uint64_t));
+      auto& registry = metrics::Registry::Global();
+      static constexpr auto help = "time from starting a dht lookup to finding what it looked for";
+      _pendingRouterLookups.latency =
+          &registry.GetLatency("lokinet_dht_lookup_seconds", help, {{"kind", "router"}});
+      _pendingIntrosetLookups.latency =
+          &registry.GetLatency("lokinet_dht_lookup_seconds", help, {{"kind", "introset"}});
+      _pendingRouterLookups.now = [this] { return Now(); };
+      _pendingIntrosetLookups.now = [this] { return Now(); };
+      _pendingExploreLookups.now = [this] { return Now(); };
     }
 
     void
@@ -353,21 +387,25 @@ namespace llarp
 
       if (_services)
       {
-        // expire intro sets
-        auto& nodes = _services->nodes;
-        auto itr = nodes.begin();
-        while (itr != nodes.end())
+        _services->Expire(now);
+        if (_servicesFile and now >= _nextServicesSave)
         {
-          if (itr->second.introset.IsExpired(now))
-          {
-            itr = nodes.erase(itr);
-          }
-          else
-            ++itr;
+          _nextServicesSave = now + IntroSetSaveInterval;
+          router->QueueDiskIO([introsets = _services->All(), fpath = *_servicesFile]() {
+            if (not IntroSetStore::Save(fpath, introsets))
+              LogWarn("failed to save intro sets to ", fpath);
+          });
         }
       }
     }
 
+    void
+    Context::SaveIntroSets()
+    {
+      if (_services and _servicesFile and not IntroSetStore::Save(*_servicesFile, _services->All()))
+        LogWarn("failed to save intro sets to ", *_servicesFile);
+    }
+
     void
     Context::LookupRouterRelayed(
         const Key_t& requester,
@@ -431,10 +469,7 @@ namespace llarp
     std::optional<llarp::service::EncryptedIntroSet>
     Context::GetIntroSetByLocation(const Key_t& key) const
     {
-      auto itr = _services->nodes.find(key);
-      if (itr == _services->nodes.end())
-        return {};
-      return itr->second.introset;
+      return _services->Get(key);
     }
 
     void
@@ -467,7 +502,21 @@ namespace llarp
       router = r;
       ourKey = us;
       _nodes = std::make_unique<Bucket<RCNode>>(ourKey, llarp::randint);
-      _services = std::make_unique<Bucket<ISNode>>(ourKey, llarp::randint);
+      size_t maxBytes = IntroSetStore::DefaultMaxBytes;
+      if (auto conf = router->GetConfig())
+      {
+        if (conf->router.m_IntroSetStoreSize > 0)
+          maxBytes = conf->router.m_IntroSetStoreSize;
+        if (conf->router.m_PersistIntroSets)
+          _servicesFile = conf->router.m_dataDir / "introsets.dat";
+      }
+      _services = std::make_unique<IntroSetStore>(ourKey, maxBytes);
+      if (_servicesFile and fs::exists(*_servicesFile))
+      {
+        const auto loaded = _services->Load(*_servicesFile, Now());
+        LogInfo("loaded ", loaded, " intro sets from ", *_servicesFile);
+      }
+      _nextServicesSave = Now() + IntroSetSaveInterval;
       llarp::LogDebug("initialize dht with key ", ourKey);
       // start cleanup timer
       _timer_keepalive = std::make_shared<int>(0);
@@ -510,6 +559,7 @@ namespace llarp
         const Key_t& askpeer,
         uint64_t relayOrder)
     {
+      IntroSetLookups().Add();
       const TXOwner asker(OurKey(), txid);
       const TXOwner peer(askpeer, ++ids);
       _pendingIntrosetLookups.NewTX(
@@ -559,6 +609,7 @@ namespace llarp
         uint64_t relayOrder,
         service::EncryptedIntroSetLookupHandler handler)
     {
+      IntroSetLookups().Add();
       const TXOwner asker(whoasked, txid);
       const TXOwner peer(askpeer, ++ids);
       _pendingIntrosetLookups.NewTX(
@@ -573,6 +624,7 @@ namespace llarp
         const Key_t& askpeer,
         service::EncryptedIntroSetLookupHandler handler)
     {
+      IntroSetLookups().Add();
       const TXOwner asker(whoasked, txid);
       const TXOwner peer(askpeer, ++ids);
       _pendingIntrosetLookups.NewTX(
@@ -630,6 +682,7 @@ namespace llarp
         const RouterID& target, uint64_t txid, const llarp::PathID_t& path, const Key_t& askpeer)
 
     {
+      RouterLookups().Add();
       const TXOwner peer(askpeer, ++ids);
       const TXOwner whoasked(OurKey(), txid);
       _pendingRouterLookups.NewTX(
@@ -644,6 +697,7 @@ namespace llarp
         const Key_t& askpeer,
         RouterLookupHandler handler)
     {
+      RouterLookups().Add();
       const TXOwner asker(whoasked, txid);
       const TXOwner peer(askpeer, ++ids);
       _pendingRouterLookups.NewTX(
@@ -3,6 +3,7 @@
 
 #include "bucket.hpp"
 #include "dht.h"
+#include "introset_store.hpp"
 #include "key.hpp"
 #include "message.hpp"
 #include <llarp/dht/messages/findintro.hpp>
@@ -32,6 +33,9 @@ namespace llarp
     static constexpr size_t IntroSetStorageRedundancy =
         (IntroSetRelayRedundancy * IntroSetRequestsPerRelay);
 
+    /// how often stored intro sets are written to disk when persisting them
+    static constexpr auto IntroSetSaveInterval = 5min;
+
     struct AbstractContext
     {
       using PendingIntrosetLookups = TXHolder<TXOwner, service::EncryptedIntroSet>;
@@ -168,9 +172,13 @@ namespace llarp
       virtual const PendingExploreLookups&
       pendingExploreLookups() const = 0;
 
-      virtual Bucket<ISNode>*
+      virtual IntroSetStore*
       services() = 0;
 
+      /// write the intro sets we store to disk if persisting them is enabled
+      virtual void
+      SaveIntroSets() = 0;
+
       virtual bool&
       AllowTransit() = 0;
       virtual const bool&
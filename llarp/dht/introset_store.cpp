@@ -0,0 +1,255 @@
+#include "introset_store.hpp"
+
+#include <llarp/constants/path.hpp>
+#include <llarp/util/bencode.hpp>
+#include <llarp/util/logging/logger.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+namespace llarp
+{
+  namespace dht
+  {
+    IntroSetStore::IntroSetStore(const Key_t& us, size_t maxBytes)
+        : m_MaxBytes(maxBytes), m_Entries(XorMetric{us})
+    {}
+
+    bool
+    IntroSetStore::Put(
+        const service::EncryptedIntroSet& introset, const Key_t& source, llarp_time_t now)
+    {
+      const Key_t location{introset.derivedSigningKey.as_array()};
+      auto itr = m_Entries.find(location);
+      // an older or same copy is not worth a token, we already have what they sent
+      if (itr != m_Entries.end() and not itr->second.introset.OtherIsNewer(introset))
+        return true;
+      if (not Admit(source, now))
+      {
+        ++m_RateLimited;
+        return false;
+      }
+      return Store(introset);
+    }
+
+    std::optional<service::EncryptedIntroSet>
+    IntroSetStore::Get(const Key_t& location) const
+    {
+      auto itr = m_Entries.find(location);
+      if (itr == m_Entries.end())
+        return std::nullopt;
+      return itr->second.introset;
+    }
+
+    size_t
+    IntroSetStore::Expire(llarp_time_t now)
+    {
+      size_t expired = 0;
+      while (not m_Expiry.empty() and m_Expiry.top().first <= now)
+      {
+        const auto [expiresAt, location] = m_Expiry.top();
+        m_Expiry.pop();
+        auto itr = m_Entries.find(location);
+        // skip what was left behind by an entry that got replaced or evicted since
+        if (itr == m_Entries.end() or itr->second.expiresAt != expiresAt)
+          continue;
+        Erase(itr);
+        ++expired;
+      }
+      m_Expired += expired;
+
+      if (now >= m_NextPrune)
+      {
+        // a source whose bucket has filled back up is no different from one we never saw
+        const auto full = SourceRefill * SourceBurst;
+        for (auto itr = m_Sources.begin(); itr != m_Sources.end();)
+        {
+          if (now - itr->second.updated >= full)
+            itr = m_Sources.erase(itr);
+          else
+            ++itr;
+        }
+        m_NextPrune = now + SourcePruneInterval;
+      }
+      return expired;
+    }
+
+    std::vector<service::EncryptedIntroSet>
+    IntroSetStore::All() const
+    {
+      std::vector<service::EncryptedIntroSet> all;
+      all.reserve(m_Entries.size());
+      for (const auto& [location, entry] : m_Entries)
+        all.push_back(entry.introset);
+      return all;
+    }
+
+    bool
+    IntroSetStore::Save(
+        const fs::path& fpath, const std::vector<service::EncryptedIntroSet>& introsets)
+    {
+      // write beside the old file and swap it in, so a crash mid write leaves the old one whole
+      auto tmpPath = fpath;
+      tmpPath += ".tmp";
+      std::error_code ec;
+      {
+        auto optional_f = util::OpenFileStream<std::ofstream>(tmpPath, std::ios::binary);
+        if (not optional_f or not optional_f->is_open())
+          return false;
+        auto& f = *optional_f;
+        // the same list BEncodeWriteList makes, encoded one entry at a time
+        std::vector<byte_t> tmp(service::MAX_INTROSET_SIZE + 256);
+        f.put('l');
+        for (const auto& introset : introsets)
+        {
+          llarp_buffer_t buf(tmp);
+          if (not introset.BEncode(&buf))
+          {
+            f.close();
+            fs::remove(tmpPath, ec);
+            return false;
+          }
+          f.write(reinterpret_cast<const char*>(buf.base), buf.cur - buf.base);
+        }
+        f.put('e');
+        f.flush();
+        if (not f.good())
+        {
+          f.close();
+          fs::remove(tmpPath, ec);
+          return false;
+        }
+      }
+      fs::rename(tmpPath, fpath, ec);
+      return not ec;
+    }
+
+    size_t
+    IntroSetStore::Load(const fs::path& fpath, llarp_time_t now)
+    {
+      std::vector<byte_t> data;
+      {
+        std::ifstream f{fpath.string(), std::ios::binary};
+        if (not f.is_open())
+          return 0;
+        data.assign(std::istreambuf_iterator<char>{f}, std::istreambuf_iterator<char>{});
+      }
+      llarp_buffer_t buf(data);
+      std::vector<service::EncryptedIntroSet> introsets;
+      if (not BEncodeReadList(introsets, &buf))
+      {
+        LogWarn("failed to load intro sets from ", fpath);
+        return 0;
+      }
+      size_t loaded = 0;
+      for (const auto& introset : introsets)
+      {
+        if (introset.IsExpired(now) or not introset.Verify(now))
+          continue;
+        if (Store(introset))
+          ++loaded;
+      }
+      return loaded;
+    }
+
+    util::StatusObject
+    IntroSetStore::ExtractStatus() const
+    {
+      util::StatusObject obj{
+          {"size", m_Entries.size()},
+          {"bytes", m_Bytes},
+          {"maxBytes", m_MaxBytes},
+          {"sources", m_Sources.size()},
+          {"stored", m_Stored},
+          {"expired", m_Expired},
+          {"evicted", m_Evicted},
+          {"rateLimited", m_RateLimited},
+          {"refused", m_Refused}};
+      std::vector<util::StatusObject> entries;
+      for (const auto& [location, entry] : m_Entries)
+        entries.push_back(entry.introset.ExtractStatus());
+      obj["entries"] = entries;
+      return obj;
+    }
+
+    bool
+    IntroSetStore::Admit(const Key_t& source, llarp_time_t now)
+    {
+      auto [itr, inserted] = m_Sources.try_emplace(source, Bucket{double(SourceBurst), now});
+      auto& bucket = itr->second;
+      if (not inserted and now > bucket.updated)
+      {
+        const double earned = double((now - bucket.updated).count()) / SourceRefill.count();
+        bucket.tokens = std::min(double(SourceBurst), bucket.tokens + earned);
+        bucket.updated = now;
+      }
+      if (bucket.tokens < 1)
+        return false;
+      bucket.tokens -= 1;
+      return true;
+    }
+
+    bool
+    IntroSetStore::Store(const service::EncryptedIntroSet& introset)
+    {
+      const Key_t location{introset.derivedSigningKey.as_array()};
+      const size_t bytes = introset.introsetPayload.size() + EntryOverhead;
+      auto itr = m_Entries.find(location);
+      const size_t replacing = itr == m_Entries.end() ? 0 : itr->second.bytes;
+      if (bytes > replacing and not MakeRoom(location, bytes - replacing))
+      {
+        ++m_Refused;
+        return false;
+      }
+      // evicting may not touch location itself, it only drops entries farther than it
+      itr = m_Entries.find(location);
+      const auto expiresAt = introset.signedAt + path::default_lifetime;
+      if (itr == m_Entries.end())
+      {
+        m_Entries.emplace(location, Entry{introset, expiresAt, bytes});
+      }
+      else
+      {
+        m_Bytes -= itr->second.bytes;
+        itr->second = Entry{introset, expiresAt, bytes};
+      }
+      m_Bytes += bytes;
+      ++m_Stored;
+      m_Expiry.emplace(expiresAt, location);
+      // replaced entries leave their old expiry behind, rebuild before those pile up
+      if (m_Expiry.size() > m_Entries.size() * 2 + 64)
+      {
+        std::vector<Expiry_t> expiry;
+        expiry.reserve(m_Entries.size());
+        for (const auto& [key, entry] : m_Entries)
+          expiry.emplace_back(entry.expiresAt, key);
+        m_Expiry = decltype(m_Expiry){std::greater<Expiry_t>{}, std::move(expiry)};
+      }
+      return true;
+    }
+
+    bool
+    IntroSetStore::MakeRoom(const Key_t& location, size_t extra)
+    {
+      if (extra > m_MaxBytes)
+        return false;
+      while (m_Bytes + extra > m_MaxBytes)
+      {
+        auto farthest = std::prev(m_Entries.end());
+        // we would rather keep what we have than store something farther from us
+        if (not m_Entries.key_comp()(location, farthest->first))
+          return false;
+        Erase(farthest);
+        ++m_Evicted;
+      }
+      return true;
+    }
+
+    void
+    IntroSetStore::Erase(std::map<Key_t, Entry, XorMetric>::iterator itr)
+    {
+      m_Bytes -= itr->second.bytes;
+      m_Entries.erase(itr);
+    }
+  }  // namespace dht
+}  // namespace llarp
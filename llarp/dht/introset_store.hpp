@@ -0,0 +1,132 @@
+#pragma once
+
+#include "key.hpp"
+#include "kademlia.hpp"
+#include <llarp/service/intro_set.hpp>
+#include <llarp/util/fs.hpp>
+#include <llarp/util/status.hpp>
+#include <llarp/util/time.hpp>
+
+#include <map>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace dht
+  {
+    /// the intro sets a relay stores for the dht. entries are kept ordered by xor distance from
+    /// our key so that when the memory cap is reached the ones we are least responsible for go
+    /// first, expiry is tracked in a min heap so the periodic expiry pass only looks at what
+    /// actually expired, and every source that publishes to us gets a token bucket so one peer or
+    /// path cannot flood the store.
+    struct IntroSetStore
+    {
+      static constexpr size_t DefaultMaxBytes = 16 * 1024 * 1024;
+      /// publishes a source may make in a burst
+      static constexpr size_t SourceBurst = 32;
+      /// a source earns one more publish this often
+      static constexpr llarp_time_t SourceRefill = 2s;
+      /// how often we forget sources that have not published in a while
+      static constexpr llarp_time_t SourcePruneInterval = 30s;
+      /// what an entry costs on top of its encrypted payload
+      static constexpr size_t EntryOverhead = sizeof(service::EncryptedIntroSet) + 128;
+
+      explicit IntroSetStore(const Key_t& us, size_t maxBytes = DefaultMaxBytes);
+
+      /// store a verified intro set that source published to us. returns false if it was
+      /// rejected because source is over its rate or the store is full of closer entries.
+      bool
+      Put(const service::EncryptedIntroSet& introset, const Key_t& source, llarp_time_t now);
+
+      std::optional<service::EncryptedIntroSet>
+      Get(const Key_t& location) const;
+
+      /// drop every expired entry, returns how many were dropped
+      size_t
+      Expire(llarp_time_t now);
+
+      size_t
+      Size() const
+      {
+        return m_Entries.size();
+      }
+
+      size_t
+      Bytes() const
+      {
+        return m_Bytes;
+      }
+
+      size_t
+      MaxBytes() const
+      {
+        return m_MaxBytes;
+      }
+
+      /// a copy of every stored intro set, for persisting
+      std::vector<service::EncryptedIntroSet>
+      All() const;
+
+      /// write intro sets to fpath, the old file is only replaced once all of them are written
+      static bool
+      Save(const fs::path& fpath, const std::vector<service::EncryptedIntroSet>& introsets);
+
+      /// load intro sets saved by Save, keeping the ones that still verify and have not expired.
+      /// returns how many were stored.
+      size_t
+      Load(const fs::path& fpath, llarp_time_t now);
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      struct Entry
+      {
+        service::EncryptedIntroSet introset;
+        llarp_time_t expiresAt;
+        size_t bytes;
+      };
+
+      struct Bucket
+      {
+        double tokens;
+        llarp_time_t updated;
+      };
+
+      /// take a token from source's bucket, false if it has none left
+      bool
+      Admit(const Key_t& source, llarp_time_t now);
+
+      bool
+      Store(const service::EncryptedIntroSet& introset);
+
+      /// evict the farthest entries until extra more bytes fit, false if the farthest entry is
+      /// closer than location so nothing was evicted
+      bool
+      MakeRoom(const Key_t& location, size_t extra);
+
+      void
+      Erase(std::map<Key_t, Entry, XorMetric>::iterator itr);
+
+      using Expiry_t = std::pair<llarp_time_t, Key_t>;
+
+      const size_t m_MaxBytes;
+      size_t m_Bytes = 0;
+      std::map<Key_t, Entry, XorMetric> m_Entries;
+      /// every time we stored an entry and when it expires. an entry that is replaced or evicted
+      /// leaves its old element behind, those are skipped when they reach the top.
+      std::priority_queue<Expiry_t, std::vector<Expiry_t>, std::greater<Expiry_t>> m_Expiry;
+      std::unordered_map<Key_t, Bucket, std::hash<AlignedBuffer<Key_t::SIZE>>> m_Sources;
+      llarp_time_t m_NextPrune = 0s;
+      uint64_t m_Stored = 0;
+      uint64_t m_Expired = 0;
+      uint64_t m_Evicted = 0;
+      uint64_t m_RateLimited = 0;
+      uint64_t m_Refused = 0;
+    };
+  }  // namespace dht
+}  // namespace llarp
@@ -9,6 +9,7 @@
 #include <llarp/dht/messages/pubintro.hpp>
 #include <llarp/dht/messages/findname.hpp>
 #include <llarp/dht/messages/gotname.hpp>
+#include <llarp/dht/messages/rcsync.hpp>
 
 namespace llarp
 {
@@ -77,6 +78,19 @@ namespace llarp
                 msg = std::make_unique<GotIntroMessage>(From);
                 break;
               }
+            // rc sync is only between directly connected routers
+            case 'D':
+              if (not relayed)
+                msg = std::make_unique<RCSyncDigestMessage>(From);
+              break;
+            case 'Y':
+              if (not relayed)
+                msg = std::make_unique<RCSyncSummaryMessage>(From);
+              break;
+            case 'U':
+              if (not relayed)
+                msg = std::make_unique<RCSyncBatchMessage>(From);
+              break;
             default:
               llarp::LogWarn("unknown dht message type: ", (char)*strbuf.base);
               // bad msg type
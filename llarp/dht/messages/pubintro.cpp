@@ -97,6 +97,25 @@ namespace llarp
 
       const auto& us = dht.OurKey();
 
+      // relayed publishes come from a client path at our end, the rest from the relay that
+      // propagated it
+      Key_t source{From};
+      if (relayed)
+      {
+        source.Zero();
+        std::copy(pathID.begin(), pathID.end(), source.begin());
+      }
+
+      auto store = [&]() {
+        if (dht.services()->Put(introset, source, now))
+          replies.emplace_back(new GotIntroMessage({introset}, txID));
+        else
+        {
+          LogDebug("not storing intro set for ", keyStr, " from ", source, ", txid=", txID);
+          replies.emplace_back(new GotIntroMessage({}, txID));
+        }
+      };
+
       // function to identify the closest 4 routers we know of for this introset
       auto propagateIfNotUs = [&](size_t index) {
         assert(index < IntroSetStorageRedundancy);
@@ -108,8 +127,7 @@ namespace llarp
         {
           llarp::LogInfo("we are peer ", index, " so storing instead of propagating");
 
-          dht.services()->PutNode(introset);
-          replies.emplace_back(new GotIntroMessage({introset}, txID));
+          store();
         }
         else
         {
@@ -161,8 +179,7 @@ namespace llarp
               txID,
               " and we are candidate ",
               candidateNumber);
-          dht.services()->PutNode(introset);
-          replies.emplace_back(new GotIntroMessage({introset}, txID));
+          store();
         }
         else
         {
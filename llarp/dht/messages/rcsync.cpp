@@ -0,0 +1,154 @@
+#include "rcsync.hpp"
+
+#include <llarp/dht/context.hpp>
+#include <llarp/router/abstractrouter.hpp>
+
+namespace llarp::dht
+{
+  static std::string_view
+  ReadString(llarp_buffer_t* val, bool& ok)
+  {
+    llarp_buffer_t strbuf;
+    ok = bencode_read_string(val, &strbuf);
+    if (not ok)
+      return {};
+    return {reinterpret_cast<const char*>(strbuf.base), strbuf.sz};
+  }
+
+  bool
+  RCSyncDigestMessage::BEncode(llarp_buffer_t* buf) const
+  {
+    const auto packed = RCSketch::EncodeDigest(digest);
+    if (not bencode_start_dict(buf))
+      return false;
+    if (not BEncodeWriteDictMsgType(buf, "A", "D"))
+      return false;
+    if (not BEncodeWriteDictString("H", packed, buf))
+      return false;
+    if (not BEncodeWriteDictInt("T", txid, buf))
+      return false;
+    if (not BEncodeWriteDictInt("V", version, buf))
+      return false;
+    return bencode_end(buf);
+  }
+
+  bool
+  RCSyncDigestMessage::DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val)
+  {
+    if (key == "H")
+    {
+      bool ok;
+      const auto maybe = RCSketch::DecodeDigest(ReadString(val, ok));
+      if (not(ok and maybe))
+        return false;
+      digest = *maybe;
+      return true;
+    }
+    if (key == "T")
+      return bencode_read_integer(val, &txid);
+    bool read = false;
+    if (not BEncodeMaybeVerifyVersion("V", version, LLARP_PROTO_VERSION, read, key, val))
+      return false;
+    return read;
+  }
+
+  bool
+  RCSyncDigestMessage::HandleMessage(llarp_dht_context* ctx, std::vector<Ptr_t>&) const
+  {
+    ctx->impl->GetRouter()->rcSyncer().HandleDigest(From.as_array(), txid, digest);
+    return true;
+  }
+
+  bool
+  RCSyncSummaryMessage::BEncode(llarp_buffer_t* buf) const
+  {
+    const auto packed = RCSyncEntry::Pack(entries);
+    if (not bencode_start_dict(buf))
+      return false;
+    if (not BEncodeWriteDictMsgType(buf, "A", "Y"))
+      return false;
+    if (not BEncodeWriteDictString("B", complete, buf))
+      return false;
+    if (not BEncodeWriteDictString("E", packed, buf))
+      return false;
+    if (not BEncodeWriteDictInt("T", txid, buf))
+      return false;
+    if (not BEncodeWriteDictInt("V", version, buf))
+      return false;
+    return bencode_end(buf);
+  }
+
+  bool
+  RCSyncSummaryMessage::DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val)
+  {
+    if (key == "B")
+    {
+      bool ok;
+      const auto str = ReadString(val, ok);
+      complete.assign(str.begin(), str.end());
+      return ok;
+    }
+    if (key == "E")
+    {
+      bool ok;
+      auto maybe = RCSyncEntry::Unpack(ReadString(val, ok));
+      if (not(ok and maybe))
+        return false;
+      entries = std::move(*maybe);
+      return true;
+    }
+    if (key == "T")
+      return bencode_read_integer(val, &txid);
+    bool read = false;
+    if (not BEncodeMaybeVerifyVersion("V", version, LLARP_PROTO_VERSION, read, key, val))
+      return false;
+    return read;
+  }
+
+  bool
+  RCSyncSummaryMessage::HandleMessage(llarp_dht_context* ctx, std::vector<Ptr_t>&) const
+  {
+    ctx->impl->GetRouter()->rcSyncer().HandleSummary(From.as_array(), txid, complete, entries);
+    return true;
+  }
+
+  bool
+  RCSyncBatchMessage::BEncode(llarp_buffer_t* buf) const
+  {
+    if (not bencode_start_dict(buf))
+      return false;
+    if (not BEncodeWriteDictMsgType(buf, "A", "U"))
+      return false;
+    if (not BEncodeWriteDictList("R", rcs, buf))
+      return false;
+    if (not BEncodeWriteDictInt("T", txid, buf))
+      return false;
+    if (not BEncodeWriteDictInt("V", version, buf))
+      return false;
+    if (not BEncodeWriteDictList("W", wanted, buf))
+      return false;
+    return bencode_end(buf);
+  }
+
+  bool
+  RCSyncBatchMessage::DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val)
+  {
+    if (key == "R")
+      return BEncodeReadList(rcs, val);
+    if (key == "T")
+      return bencode_read_integer(val, &txid);
+    if (key == "W")
+      return BEncodeReadList(wanted, val);
+    bool read = false;
+    if (not BEncodeMaybeVerifyVersion("V", version, LLARP_PROTO_VERSION, read, key, val))
+      return false;
+    return read;
+  }
+
+  bool
+  RCSyncBatchMessage::HandleMessage(llarp_dht_context* ctx, std::vector<Ptr_t>&) const
+  {
+    ctx->impl->GetRouter()->rcSyncer().HandleBatch(From.as_array(), txid, rcs, wanted);
+    return true;
+  }
+}  // namespace llarp::dht
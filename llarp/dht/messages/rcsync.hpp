@@ -0,0 +1,83 @@
+#pragma once
+
+#include <llarp/dht/message.hpp>
+#include <llarp/router/rc_sync.hpp>
+
+#include <vector>
+
+namespace llarp::dht
+{
+  /// starts an rc sync, carries the sender's digest
+  struct RCSyncDigestMessage final : public IMessage
+  {
+    explicit RCSyncDigestMessage(const Key_t& from) : IMessage(from)
+    {}
+
+    RCSyncDigestMessage(uint64_t id, const RCSketch::Digest_t& _digest)
+        : IMessage({}), txid(id), digest(_digest)
+    {}
+
+    bool
+    BEncode(llarp_buffer_t* buf) const override;
+
+    bool
+    DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val) override;
+
+    bool
+    HandleMessage(struct llarp_dht_context* dht, std::vector<Ptr_t>& replies) const override;
+
+    uint64_t txid = 0;
+    RCSketch::Digest_t digest{};
+  };
+
+  /// answers a digest with the entries of the buckets that differ
+  struct RCSyncSummaryMessage final : public IMessage
+  {
+    explicit RCSyncSummaryMessage(const Key_t& from) : IMessage(from)
+    {}
+
+    RCSyncSummaryMessage(
+        uint64_t id, std::vector<uint8_t> _complete, std::vector<RCSyncEntry> _entries)
+        : IMessage({}), txid(id), complete(std::move(_complete)), entries(std::move(_entries))
+    {}
+
+    bool
+    BEncode(llarp_buffer_t* buf) const override;
+
+    bool
+    DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val) override;
+
+    bool
+    HandleMessage(struct llarp_dht_context* dht, std::vector<Ptr_t>& replies) const override;
+
+    uint64_t txid = 0;
+    /// buckets whose entries are all in this message
+    std::vector<uint8_t> complete;
+    std::vector<RCSyncEntry> entries;
+  };
+
+  /// rcs the other side was missing, and the ones we want from them
+  struct RCSyncBatchMessage final : public IMessage
+  {
+    explicit RCSyncBatchMessage(const Key_t& from) : IMessage(from)
+    {}
+
+    RCSyncBatchMessage(
+        uint64_t id, std::vector<RouterContact> _rcs, std::vector<RouterID> _wanted)
+        : IMessage({}), txid(id), rcs(std::move(_rcs)), wanted(std::move(_wanted))
+    {}
+
+    bool
+    BEncode(llarp_buffer_t* buf) const override;
+
+    bool
+    DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val) override;
+
+    bool
+    HandleMessage(struct llarp_dht_context* dht, std::vector<Ptr_t>& replies) const override;
+
+    uint64_t txid = 0;
+    std::vector<RouterContact> rcs;
+    std::vector<RouterID> wanted;
+  };
+}  // namespace llarp::dht
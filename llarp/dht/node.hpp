@@ -2,7 +2,6 @@
 
 #include "key.hpp"
 #include <llarp/router_contact.hpp>
-#include <llarp/service/intro_set.hpp>
 #include <utility>
 
 namespace llarp
@@ -34,34 +33,5 @@ namespace llarp
         return rc.last_updated < other.rc.last_updated;
       }
     };
-
-    struct ISNode
-    {
-      service::EncryptedIntroSet introset;
-
-      Key_t ID;
-
-      ISNode()
-      {
-        ID.Zero();
-      }
-
-      ISNode(service::EncryptedIntroSet other) : introset(std::move(other))
-      {
-        ID = Key_t(introset.derivedSigningKey.as_array());
-      }
-
-      util::StatusObject
-      ExtractStatus() const
-      {
-        return introset.ExtractStatus();
-      }
-
-      bool
-      operator<(const ISNode& other) const
-      {
-        return introset.signedAt < other.introset.signedAt;
-      }
-    };
   }  // namespace dht
 }  // namespace llarp
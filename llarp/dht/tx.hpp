@@ -5,6 +5,7 @@
 #include "txowner.hpp"
 #include <llarp/util/logging/logger.hpp>
 #include <llarp/util/status.hpp>
+#include <llarp/util/time.hpp>
 
 #include <set>
 #include <vector>
@@ -23,6 +24,8 @@ namespace llarp
       std::set<Key_t> peersAsked;
       std::vector<V> valuesFound;
       TXOwner whoasked;
+      /// when the lookup was put in its TXHolder, on the holder's clock
+      llarp_time_t started = 0s;
 
       TX(const TXOwner& asker, const K& k, AbstractContext* p)
           : target(k), parent(p), whoasked(asker)
@@ -3,9 +3,11 @@
 
 #include "tx.hpp"
 #include "txowner.hpp"
+#include <llarp/util/metrics.hpp>
 #include <llarp/util/time.hpp>
 #include <llarp/util/status.hpp>
 
+#include <functional>
 #include <memory>
 #include <unordered_map>
 
@@ -23,6 +25,10 @@ namespace llarp
       std::unordered_map<K, llarp_time_t> timeouts;
       // maps remote peer with tx to handle reply from them
       std::unordered_map<TXOwner, TXPtr> tx;
+      // how long lookups that found something took, not recorded when null
+      metrics::LatencyHistogram* latency = nullptr;
+      // the clock lookups are timed on, the dht sets it to its router's so it follows the loop
+      std::function<llarp_time_t()> now = [] { return time_now_ms(); };
 
       const TX<K, V>*
       GetPendingLookupFrom(const TXOwner& owner) const;
@@ -129,6 +135,8 @@ namespace llarp
         llarp_time_t requestTimeoutMS)
     {
       (void)whoasked;
+      const auto started = now();
+      t->started = started;
       tx.emplace(askpeer, std::unique_ptr<TX<K, V>>(t));
       auto count = waiting.count(k);
       waiting.emplace(k, askpeer);
@@ -136,7 +144,7 @@ namespace llarp
       auto itr = timeouts.find(k);
       if (itr == timeouts.end())
       {
-        timeouts.emplace(k, time_now_ms() + requestTimeoutMS);
+        timeouts.emplace(k, started + requestTimeoutMS);
       }
       if (count == 0)
       {
@@ -174,6 +182,8 @@ namespace llarp
           }
           if (sendreply)
           {
+            if (latency and not txitr->second->valuesFound.empty())
+              latency->Record(now() - txitr->second->started);
             txitr->second->SendReply();
             tx.erase(txitr);
           }
@@ -4,9 +4,19 @@
 #include <array>
 #include <utility>
 #include <llarp/ev/udp_handle.hpp>
+#include <llarp/util/instrument.hpp>
 
 namespace llarp::dns
 {
+  metrics::LatencyHistogram&
+  ResolveTime(std::string_view answeredBy)
+  {
+    return metrics::Registry::Global().GetLatency(
+        "lokinet_dns_resolve_seconds",
+        "time from getting a dns query to sending its answer",
+        {{"answered_by", std::string{answeredBy}}});
+  }
+
   PacketHandler::PacketHandler(EventLoop_ptr loop, IQueryHandler* h)
       : m_QueryHandler{h}, m_Loop{std::move(loop)}
   {}
@@ -121,6 +131,7 @@ namespace llarp::dns
   void
   PacketHandler::HandlePacket(const SockAddr& resolver, const SockAddr& from, llarp_buffer_t buf)
   {
+    LLARP_ZONE();
     MessageHeader hdr;
     if (not hdr.Decode(&buf))
     {
@@ -155,7 +166,12 @@ namespace llarp::dns
 
     if (m_QueryHandler && m_QueryHandler->ShouldHookDNSMessage(msg))
     {
-      auto reply = [self = shared_from_this(), to = from, resolver](dns::Message msg) {
+      auto reply = [self = shared_from_this(),
+                    to = from,
+                    resolver,
+                    started = std::chrono::steady_clock::now()](dns::Message msg) {
+        static auto& resolveTime = ResolveTime("lokinet");
+        resolveTime.Record(std::chrono::steady_clock::now() - started);
         self->SendServerMessageBufferTo(resolver, to, msg.ToBuffer());
       };
       if (!m_QueryHandler->HandleHookedDNSMessage(std::move(msg), reply))
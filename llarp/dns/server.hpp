@@ -3,6 +3,7 @@
 #include "message.hpp"
 #include <llarp/ev/ev.hpp>
 #include <llarp/net/net.hpp>
+#include <llarp/util/metrics.hpp>
 #include "unbound_resolver.hpp"
 
 #include <unordered_map>
@@ -11,6 +12,10 @@ namespace llarp
 {
   namespace dns
   {
+    /// how long answering queries took by who answered them, lokinet or upstream
+    metrics::LatencyHistogram&
+    ResolveTime(std::string_view answeredBy);
+
     /// handler of dns query hooking
     class IQueryHandler
     {
@@ -11,6 +11,7 @@ namespace llarp::dns
     Message msg;
     SockAddr resolverAddr;
     SockAddr askerAddr;
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
   };
 
   void
@@ -71,6 +72,9 @@ namespace llarp::dns
     buf.cur = buf.base;
     hdr.Encode(&buf);
 
+    // this runs on the unbound thread, recording is thread safe
+    static auto& resolveTime = ResolveTime("upstream");
+    resolveTime.Record(std::chrono::steady_clock::now() - lookup->started);
     this_ptr->replyFunc(lookup->resolverAddr, lookup->askerAddr, std::move(pkt));
 
     ub_resolve_free(result);
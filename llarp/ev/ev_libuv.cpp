@@ -3,6 +3,8 @@
 #include <memory>
 #include <thread>
 #include <type_traits>
+#include <llarp/util/instrument.hpp>
+#include <llarp/util/metrics.hpp>
 #include <llarp/util/thread/queue.hpp>
 
 #include <cstring>
@@ -97,7 +99,12 @@ namespace llarp::uv
   void
   Loop::FlushLogic()
   {
+    LLARP_ZONE();
     llarp::LogTrace("Loop::FlushLogic() start");
+    LLARP_PLOT("logic queue", m_LogicCalls.size());
+    static auto& queued = metrics::Registry::Global().GetGauge(
+        "lokinet_queue_depth", "items waiting in a queue", {{"queue", "logic"}});
+    queued.Set(m_LogicCalls.size());
     while (not m_LogicCalls.empty())
     {
       auto f = m_LogicCalls.popFront();
@@ -109,12 +116,13 @@ namespace llarp::uv
   void
   Loop::tick_event_loop()
   {
-    llarp::LogTrace("ticking event loop.");
-    FlushLogic();
-    PumpLL();
-    auto& log = llarp::LogContext::Instance();
-    if (log.logStream)
-      log.logStream->Tick(time_now());
+    {
+      LLARP_ZONE();
+      llarp::LogTrace("ticking event loop.");
+      FlushLogic();
+      PumpLL();
+    }
+    LLARP_FRAME();
   }
 
   Loop::Loop(size_t queue_size) : llarp::EventLoop{}, PumpLL{[] {}}, m_LogicCalls{queue_size}
@@ -0,0 +1,587 @@
+#include "ev_sim.hpp"
+
+#include <llarp/util/instrument.hpp>
+#include <llarp/util/logging/logger.hpp>
+
+#include <algorithm>
+
+namespace llarp::sim
+{
+  struct LoopState
+  {
+    std::weak_ptr<Loop> loop;
+    std::atomic<bool> stopped{false};
+    /// guarded by Network::m_Access
+    bool running = false;
+    /// guarded by Network::m_Access
+    bool cyclePending = false;
+  };
+
+  /// true for 0.0.0.0 and ::, which bind every address on their port
+  static bool
+  IsUnspecified(const SockAddr& addr)
+  {
+    static const auto any4 = SockAddr{0, 0, 0, 0}.asIPv6();
+    const auto ip = addr.asIPv6();
+    return addr.isEmpty() or ip == any4 or ip == huint128_t{0};
+  }
+
+  class SimWakeup final : public EventLoopWakeup, public std::enable_shared_from_this<SimWakeup>
+  {
+    std::weak_ptr<Loop> m_Loop;
+    std::function<void()> m_Callback;
+    std::atomic<bool> m_Pending{false};
+
+   public:
+    SimWakeup(std::weak_ptr<Loop> loop, std::function<void()> callback)
+        : m_Loop{std::move(loop)}, m_Callback{std::move(callback)}
+    {}
+
+    void
+    Trigger() override
+    {
+      if (m_Pending.exchange(true))
+        return;
+      if (auto loop = m_Loop.lock())
+      {
+        loop->call_soon([self = weak_from_this()] {
+          if (auto ptr = self.lock())
+          {
+            ptr->m_Pending = false;
+            ptr->m_Callback();
+          }
+        });
+      }
+    }
+  };
+
+  class SimRepeater final : public EventLoopRepeater,
+                            public std::enable_shared_from_this<SimRepeater>
+  {
+    std::weak_ptr<Loop> m_Loop;
+    llarp_time_t m_Every = 0s;
+    std::function<void()> m_Task;
+
+    void
+    Arm()
+    {
+      if (auto loop = m_Loop.lock())
+      {
+        loop->call_later(m_Every, [self = weak_from_this()] {
+          // re-arm first so the task may drop the last reference to us to stop repeating
+          if (auto ptr = self.lock())
+          {
+            ptr->Arm();
+            ptr->m_Task();
+          }
+        });
+      }
+    }
+
+   public:
+    explicit SimRepeater(std::weak_ptr<Loop> loop) : m_Loop{std::move(loop)}
+    {}
+
+    void
+    start(llarp_time_t every, std::function<void()> task) override
+    {
+      m_Every = every;
+      m_Task = std::move(task);
+      Arm();
+    }
+  };
+
+  Network::Network(uint64_t seed, llarp_time_t start)
+      : m_Now{std::chrono::duration_cast<Clock_t>(start)}, m_Rand{seed}
+  {}
+
+  std::shared_ptr<EventLoop>
+  Network::MakeLoop()
+  {
+    auto loop = std::make_shared<Loop>(shared_from_this());
+    loop->m_State->loop = loop;
+    return loop;
+  }
+
+  void
+  Network::SetDefaultLink(LinkModel model)
+  {
+    std::unique_lock lock{m_Access};
+    m_DefaultLink = model;
+  }
+
+  void
+  Network::SetLink(const SockAddr& from, const SockAddr& to, LinkModel model)
+  {
+    std::unique_lock lock{m_Access};
+    m_Links[{from.asIPv6(), to.asIPv6()}] = model;
+  }
+
+  void
+  Network::SetLinks(const SockAddr& a, const SockAddr& b, LinkModel model)
+  {
+    SetLink(a, b, model);
+    SetLink(b, a, model);
+  }
+
+  llarp_time_t
+  Network::Now() const
+  {
+    std::unique_lock lock{m_Access};
+    return std::chrono::duration_cast<llarp_time_t>(m_Now);
+  }
+
+  NetworkStats
+  Network::Stats() const
+  {
+    std::unique_lock lock{m_Access};
+    return m_Stats;
+  }
+
+  bool
+  Network::IsDriver() const
+  {
+    return m_Driver.load() == std::this_thread::get_id();
+  }
+
+  void
+  Network::Push(Event ev)
+  {
+    ev.seq = m_NextSeq++;
+    m_Events.emplace_back(std::move(ev));
+    std::push_heap(m_Events.begin(), m_Events.end(), std::greater<>{});
+    m_Wake.notify_all();
+  }
+
+  void
+  Network::Schedule(std::shared_ptr<LoopState> owner, Clock_t delay, std::function<void()> func)
+  {
+    std::unique_lock lock{m_Access};
+    Push({m_Now + std::max(delay, Clock_t{0}), 0, std::move(owner), std::move(func)});
+  }
+
+  void
+  Network::WakeLocked(const std::shared_ptr<LoopState>& state)
+  {
+    if (state->cyclePending or state->stopped)
+      return;
+    state->cyclePending = true;
+    Push({m_Now,
+          0,
+          state,
+          [loop = state->loop] {
+            if (auto ptr = loop.lock())
+              ptr->Cycle();
+          },
+          true});
+  }
+
+  void
+  Network::Wake(const std::shared_ptr<LoopState>& state)
+  {
+    std::unique_lock lock{m_Access};
+    WakeLocked(state);
+  }
+
+  bool
+  Network::RunNext(std::unique_lock<std::mutex>& lock, Clock_t until)
+  {
+    if (m_Events.empty() or m_Events.front().when > until)
+      return false;
+    std::pop_heap(m_Events.begin(), m_Events.end(), std::greater<>{});
+    Event ev = std::move(m_Events.back());
+    m_Events.pop_back();
+    m_Now = std::max(m_Now, ev.when);
+    if (ev.owner and ev.owner->stopped)
+      return true;
+    if (ev.cycle)
+      ev.owner->cyclePending = false;
+
+    lock.unlock();
+    ev.func();
+    lock.lock();
+
+    if (ev.owner and not ev.cycle)
+      WakeLocked(ev.owner);
+    return true;
+  }
+
+  void
+  Network::Run(const std::shared_ptr<LoopState>& state)
+  {
+    std::unique_lock lock{m_Access};
+    if (state->stopped or state->running)
+      return;
+    state->running = true;
+    ++m_Running;
+
+    if (m_Driver.load() != std::thread::id{})
+    {
+      m_Wake.wait(lock, [&] { return state->stopped.load(); });
+      return;
+    }
+
+    m_Driver = std::this_thread::get_id();
+    while (m_Running > 0)
+    {
+      if (m_Events.empty())
+        m_Wake.wait(lock, [&] { return m_Running == 0 or not m_Events.empty(); });
+      else
+        RunNext(lock, Clock_t::max());
+    }
+    m_Driver = std::thread::id{};
+  }
+
+  void
+  Network::Stopped(const std::shared_ptr<LoopState>& state)
+  {
+    std::unique_lock lock{m_Access};
+    if (state->stopped.exchange(true))
+      return;
+    if (state->running)
+      --m_Running;
+    m_Wake.notify_all();
+  }
+
+  size_t
+  Network::RunFor(llarp_time_t duration)
+  {
+    std::unique_lock lock{m_Access};
+    if (m_Driver.load() != std::thread::id{})
+      throw std::runtime_error{"simulated network is already being run"};
+    m_Driver = std::this_thread::get_id();
+    const auto until = m_Now + std::chrono::duration_cast<Clock_t>(duration);
+    size_t num = 0;
+    while (RunNext(lock, until))
+      ++num;
+    m_Now = std::max(m_Now, until);
+    m_Driver = std::thread::id{};
+    return num;
+  }
+
+  size_t
+  Network::RunPending()
+  {
+    return RunFor(0s);
+  }
+
+  std::optional<SockAddr>
+  Network::Bind(SockAddr addr, const std::shared_ptr<UDPHandle>& handle)
+  {
+    std::unique_lock lock{m_Access};
+    const auto taken = [&](const SockAddr& a) {
+      if (IsUnspecified(a))
+      {
+        auto itr = m_Wildcard.find(a.getPort());
+        return itr != m_Wildcard.end() and not itr->second.expired();
+      }
+      auto itr = m_Bound.find(a);
+      return itr != m_Bound.end() and not itr->second.expired();
+    };
+    if (addr.getPort() == 0)
+    {
+      // scan every ephemeral port at most once
+      for (size_t tries = 0; tries < 16384; ++tries)
+      {
+        addr.setPort(m_NextEphemeral);
+        m_NextEphemeral = m_NextEphemeral == 65535 ? 49152 : m_NextEphemeral + 1;
+        if (not taken(addr))
+          break;
+      }
+    }
+    if (taken(addr))
+      return std::nullopt;
+    if (IsUnspecified(addr))
+      m_Wildcard[addr.getPort()] = handle;
+    else
+      m_Bound[addr] = handle;
+    return addr;
+  }
+
+  void
+  Network::Unbind(const SockAddr& addr, const UDPHandle* handle)
+  {
+    std::unique_lock lock{m_Access};
+    const auto unbind = [handle](auto& map, const auto& key) {
+      auto itr = map.find(key);
+      if (itr == map.end())
+        return;
+      auto current = itr->second.lock();
+      if (current == nullptr or current.get() == handle)
+        map.erase(itr);
+    };
+    if (IsUnspecified(addr))
+      unbind(m_Wildcard, addr.getPort());
+    else
+      unbind(m_Bound, addr);
+  }
+
+  std::shared_ptr<UDPHandle>
+  Network::Lookup(const SockAddr& addr) const
+  {
+    if (auto itr = m_Bound.find(addr); itr != m_Bound.end())
+    {
+      if (auto handle = itr->second.lock())
+        return handle;
+    }
+    if (auto itr = m_Wildcard.find(addr.getPort()); itr != m_Wildcard.end())
+      return itr->second.lock();
+    return nullptr;
+  }
+
+  void
+  Network::Transmit(const SockAddr& from, const SockAddr& to, const llarp_buffer_t& buf)
+  {
+    std::unique_lock lock{m_Access};
+    m_Stats.sent++;
+    const HostPair_t hosts{from.asIPv6(), to.asIPv6()};
+    const auto itr = m_Links.find(hosts);
+    const LinkModel& model = itr == m_Links.end() ? m_DefaultLink : itr->second;
+
+    if (model.loss > 0 and std::uniform_real_distribution<double>{0, 1}(m_Rand) < model.loss)
+    {
+      m_Stats.lost++;
+      return;
+    }
+    auto departs = m_Now;
+    if (model.bandwidth > 0)
+    {
+      auto& busyUntil = m_LinkBusyUntil[hosts];
+      const auto starts = std::max(m_Now, busyUntil);
+      if (starts - m_Now > model.maxQueue)
+      {
+        m_Stats.queueDropped++;
+        return;
+      }
+      departs = starts + Clock_t{buf.sz * 1'000'000 / model.bandwidth};
+      busyUntil = departs;
+    }
+    auto arrives = departs + std::chrono::duration_cast<Clock_t>(model.latency);
+    if (model.jitter > 0s)
+    {
+      const auto jitter = std::chrono::duration_cast<Clock_t>(model.jitter).count();
+      arrives += Clock_t{std::uniform_int_distribution<Clock_t::rep>{0, jitter}(m_Rand)};
+    }
+    Push(
+        {arrives,
+         0,
+         nullptr,
+         [this, from, to, data = std::make_shared<OwnedBuffer>(OwnedBuffer::copy_from(buf))] {
+           Deliver(from, to, std::move(data));
+         }});
+  }
+
+  void
+  Network::Deliver(const SockAddr& from, const SockAddr& to, std::shared_ptr<OwnedBuffer> data)
+  {
+    std::shared_ptr<UDPHandle> handle;
+    std::shared_ptr<Loop> loop;
+    {
+      std::unique_lock lock{m_Access};
+      handle = Lookup(to);
+      if (handle)
+        loop = handle->m_Loop.lock();
+      if (loop == nullptr or loop->m_State->stopped)
+      {
+        m_Stats.unreachable++;
+        return;
+      }
+      m_Stats.delivered++;
+      m_Stats.bytesDelivered += data->sz;
+    }
+    handle->on_recv(*handle, from, std::move(*data));
+    Wake(loop->m_State);
+  }
+
+  Loop::Loop(std::shared_ptr<Network> net)
+      : m_Net{std::move(net)}, m_State{std::make_shared<LoopState>()}
+  {}
+
+  void
+  Loop::run()
+  {
+    m_Net->Run(m_State);
+  }
+
+  bool
+  Loop::running() const
+  {
+    return not m_State->stopped;
+  }
+
+  llarp_time_t
+  Loop::time_now() const
+  {
+    return m_Net->Now();
+  }
+
+  void
+  Loop::wakeup()
+  {
+    m_Net->Wake(m_State);
+  }
+
+  void
+  Loop::call_soon(std::function<void(void)> f)
+  {
+    m_Net->Schedule(m_State, Network::Clock_t{0}, std::move(f));
+  }
+
+  void
+  Loop::call_later(llarp_time_t delay_ms, std::function<void(void)> callback)
+  {
+    m_Net->Schedule(
+        m_State, std::chrono::duration_cast<Network::Clock_t>(delay_ms), std::move(callback));
+  }
+
+  bool
+  Loop::add_network_interface(
+      std::shared_ptr<vpn::NetworkInterface> netif, std::function<void(net::IPPacket)> handler)
+  {
+    if (not netif)
+      return false;
+    m_NetIfs.emplace_back(std::move(netif), std::move(handler));
+    return true;
+  }
+
+  bool
+  Loop::add_ticker(std::function<void(void)> ticker)
+  {
+    m_Tickers.emplace_back(std::move(ticker));
+    return true;
+  }
+
+  void
+  Loop::stop()
+  {
+    m_Net->Stopped(m_State);
+  }
+
+  void
+  Loop::Cycle()
+  {
+    LLARP_ZONE();
+    for (const auto& [netif, handler] : m_NetIfs)
+    {
+      for (auto pkt = netif->ReadNextPacket(); pkt.sz > 0; pkt = netif->ReadNextPacket())
+      {
+        if (handler)
+          handler(std::move(pkt));
+      }
+    }
+    for (const auto& ticker : m_Tickers)
+      ticker();
+    if (m_Pump)
+      m_Pump();
+  }
+
+  std::shared_ptr<llarp::UDPHandle>
+  Loop::make_udp(UDPReceiveFunc on_recv)
+  {
+    return std::make_shared<UDPHandle>(shared_from_this(), std::move(on_recv));
+  }
+
+  void
+  Loop::set_pump_function(std::function<void(void)> pumpll)
+  {
+    m_Pump = std::move(pumpll);
+  }
+
+  std::shared_ptr<EventLoopWakeup>
+  Loop::make_waker(std::function<void()> callback)
+  {
+    return std::make_shared<SimWakeup>(weak_from_this(), std::move(callback));
+  }
+
+  std::shared_ptr<EventLoopRepeater>
+  Loop::make_repeater()
+  {
+    return std::make_shared<SimRepeater>(weak_from_this());
+  }
+
+  bool
+  Loop::inEventLoop() const
+  {
+    return m_Net->IsDriver();
+  }
+
+  UDPHandle::UDPHandle(std::shared_ptr<Loop> loop, ReceiveFunc rf)
+      : llarp::UDPHandle{std::move(rf)}, m_Loop{loop}, m_Net{loop->network()}
+  {}
+
+  UDPHandle::~UDPHandle()
+  {
+    close();
+  }
+
+  bool
+  UDPHandle::listen(const SockAddr& addr)
+  {
+    close();
+    m_Addr = m_Net->Bind(addr, shared_from_this());
+    if (not m_Addr)
+      llarp::LogError("failed to bind ", addr, ": address already in use");
+    return m_Addr.has_value();
+  }
+
+  bool
+  UDPHandle::send(const SockAddr& dest, const llarp_buffer_t& buf)
+  {
+    if (not m_Addr and not listen(SockAddr{0, 0, 0, 0}))
+      return false;
+    m_Net->Transmit(*m_Addr, dest, buf);
+    return true;
+  }
+
+  void
+  UDPHandle::close()
+  {
+    if (m_Addr)
+      m_Net->Unbind(*m_Addr, this);
+    m_Addr.reset();
+  }
+
+  MemoryInterface::MemoryInterface(std::string ifname, std::weak_ptr<EventLoop> loop)
+      : m_IfName{std::move(ifname)}, m_Loop{std::move(loop)}
+  {}
+
+  void
+  MemoryInterface::Inject(net::IPPacket pkt)
+  {
+    {
+      std::lock_guard lock{m_Access};
+      m_Inbound.emplace_back(std::move(pkt));
+    }
+    if (auto loop = m_Loop.lock())
+      loop->wakeup();
+  }
+
+  net::IPPacket
+  MemoryInterface::ReadNextPacket()
+  {
+    std::lock_guard lock{m_Access};
+    net::IPPacket pkt;
+    pkt.sz = 0;
+    if (m_Inbound.empty())
+      return pkt;
+    pkt = std::move(m_Inbound.front());
+    m_Inbound.pop_front();
+    return pkt;
+  }
+
+  bool
+  MemoryInterface::WritePacket(net::IPPacket pkt)
+  {
+    if (onWrite)
+      onWrite(std::move(pkt));
+    return true;
+  }
+
+  std::shared_ptr<vpn::NetworkInterface>
+  MemoryPlatform::ObtainInterface(vpn::InterfaceInfo info)
+  {
+    auto netif = std::make_shared<MemoryInterface>(info.ifname, m_Loop);
+    interfaces.push_back(netif);
+    return netif;
+  }
+}  // namespace llarp::sim
@@ -0,0 +1,346 @@
+#pragma once
+#include "ev.hpp"
+#include "udp_handle.hpp"
+#include "vpn.hpp"
+
+#include <llarp/net/sock_addr.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp::sim
+{
+  /// the characteristics of the simulated path from one virtual host to another
+  struct LinkModel
+  {
+    /// one way propagation delay
+    llarp_time_t latency = 10ms;
+    /// extra delay drawn uniformly from [0, jitter] per datagram, may reorder datagrams
+    llarp_time_t jitter = 0ms;
+    /// probability in [0, 1] that a datagram is silently dropped
+    double loss = 0.0;
+    /// bytes per second the link can carry, 0 for unlimited
+    uint64_t bandwidth = 0;
+    /// datagrams that would wait longer than this behind the ones already on the link are dropped
+    llarp_time_t maxQueue = 1s;
+  };
+
+  /// counters over every datagram sent on a network
+  struct NetworkStats
+  {
+    uint64_t sent = 0;
+    uint64_t delivered = 0;
+    uint64_t lost = 0;
+    uint64_t queueDropped = 0;
+    uint64_t unreachable = 0;
+    uint64_t bytesDelivered = 0;
+  };
+
+  class Loop;
+  class UDPHandle;
+  struct LoopState;
+
+  /// an in memory network of virtual hosts sharing one virtual clock. every Loop made by a network
+  /// runs on whichever single thread drives it, so thousands of routers can share one process and
+  /// a run with the same seed and the same inputs is reproducible. time only moves forward when
+  /// there is nothing left to do at the current instant, so idle periods cost nothing.
+  class Network : public std::enable_shared_from_this<Network>
+  {
+   public:
+    using Clock_t = std::chrono::microseconds;
+
+    /// seed drives every random draw for loss and jitter. the clock starts at start, which defaults
+    /// to the wall clock so router contacts and introsets made inside the simulation look fresh.
+    explicit Network(uint64_t seed = 0, llarp_time_t start = time_now_ms());
+
+    /// make a new event loop on this network, loops must be made through here
+    std::shared_ptr<EventLoop>
+    MakeLoop();
+
+    /// the model used between hosts that have no model of their own
+    void
+    SetDefaultLink(LinkModel model);
+
+    /// set the model for datagrams sent from the host from to the host to, ports are ignored
+    void
+    SetLink(const SockAddr& from, const SockAddr& to, LinkModel model);
+
+    /// set the model in both directions between two hosts
+    void
+    SetLinks(const SockAddr& a, const SockAddr& b, LinkModel model);
+
+    /// the current virtual time
+    llarp_time_t
+    Now() const;
+
+    /// run every event due up to Now() + duration on the calling thread, then move the clock to
+    /// the end of that window. returns the number of events run.
+    size_t
+    RunFor(llarp_time_t duration);
+
+    /// run everything due at the current instant without moving the clock
+    size_t
+    RunPending();
+
+    NetworkStats
+    Stats() const;
+
+   private:
+    friend class Loop;
+    friend class UDPHandle;
+
+    struct Event
+    {
+      Clock_t when;
+      uint64_t seq;
+      std::shared_ptr<LoopState> owner;
+      std::function<void()> func;
+      /// true for the per iteration cycle of owner, which must not wake owner again
+      bool cycle = false;
+
+      bool
+      operator>(const Event& other) const
+      {
+        return std::tie(when, seq) > std::tie(other.when, other.seq);
+      }
+    };
+
+    /// queue func to run on owner's behalf after delay, thread safe
+    void
+    Schedule(std::shared_ptr<LoopState> owner, Clock_t delay, std::function<void()> func);
+
+    /// queue one cycle of the loop owning state unless one is already queued, requires m_Access
+    void
+    WakeLocked(const std::shared_ptr<LoopState>& state);
+
+    void
+    Wake(const std::shared_ptr<LoopState>& state);
+
+    void
+    Push(Event ev);
+
+    /// pop and run the next event if it is due no later than until. requires m_Access held, which
+    /// is released while the event runs.
+    bool
+    RunNext(std::unique_lock<std::mutex>& lock, Clock_t until);
+
+    /// blocking run used by Loop::run()
+    void
+    Run(const std::shared_ptr<LoopState>& state);
+
+    void
+    Stopped(const std::shared_ptr<LoopState>& state);
+
+    /// bind addr to handle, a zero port picks a free ephemeral one. returns the bound address.
+    std::optional<SockAddr>
+    Bind(SockAddr addr, const std::shared_ptr<UDPHandle>& handle);
+
+    void
+    Unbind(const SockAddr& addr, const UDPHandle* handle);
+
+    std::shared_ptr<UDPHandle>
+    Lookup(const SockAddr& addr) const;
+
+    void
+    Transmit(const SockAddr& from, const SockAddr& to, const llarp_buffer_t& buf);
+
+    void
+    Deliver(const SockAddr& from, const SockAddr& to, std::shared_ptr<OwnedBuffer> data);
+
+    bool
+    IsDriver() const;
+
+    mutable std::mutex m_Access;
+    std::condition_variable m_Wake;
+    /// min heap on (when, seq) so events due at the same instant run in the order queued
+    std::vector<Event> m_Events;
+    uint64_t m_NextSeq = 0;
+    Clock_t m_Now;
+    std::atomic<std::thread::id> m_Driver{std::thread::id{}};
+    size_t m_Running = 0;
+
+    std::mt19937_64 m_Rand;
+    LinkModel m_DefaultLink;
+    using HostPair_t = std::pair<huint128_t, huint128_t>;
+    std::map<HostPair_t, LinkModel> m_Links;
+    /// when the link between each pair of hosts is done sending what it has queued
+    std::map<HostPair_t, Clock_t> m_LinkBusyUntil;
+
+    std::unordered_map<SockAddr, std::weak_ptr<UDPHandle>> m_Bound;
+    /// handles bound to an unspecified address, by port
+    std::unordered_map<uint16_t, std::weak_ptr<UDPHandle>> m_Wildcard;
+    uint16_t m_NextEphemeral = 49152;
+
+    NetworkStats m_Stats;
+  };
+
+  /// an EventLoop whose timers and sockets live on a simulated Network
+  class Loop final : public llarp::EventLoop, public std::enable_shared_from_this<Loop>
+  {
+   public:
+    explicit Loop(std::shared_ptr<Network> net);
+
+    /// the first loop of a network to run drives every loop on it until all of them stopped,
+    /// later callers block until their own loop is stopped.
+    void
+    run() override;
+
+    bool
+    running() const override;
+
+    llarp_time_t
+    time_now() const override;
+
+    void
+    wakeup() override;
+
+    void
+    call_soon(std::function<void(void)> f) override;
+
+    void
+    call_later(llarp_time_t delay_ms, std::function<void(void)> callback) override;
+
+    /// simulated routers have no tun device, netif is an in memory interface that is read from
+    /// once per loop cycle. whoever puts packets into it has to wake the loop.
+    bool
+    add_network_interface(
+        std::shared_ptr<vpn::NetworkInterface> netif,
+        std::function<void(net::IPPacket)> packetHandler) override;
+
+    bool
+    add_ticker(std::function<void(void)> ticker) override;
+
+    void
+    stop() override;
+
+    std::shared_ptr<llarp::UDPHandle>
+    make_udp(UDPReceiveFunc on_recv) override;
+
+    void
+    set_pump_function(std::function<void(void)> pumpll) override;
+
+    std::shared_ptr<EventLoopWakeup>
+    make_waker(std::function<void()> callback) override;
+
+    std::shared_ptr<EventLoopRepeater>
+    make_repeater() override;
+
+    bool
+    inEventLoop() const override;
+
+    const std::shared_ptr<Network>&
+    network() const
+    {
+      return m_Net;
+    }
+
+   private:
+    friend class Network;
+    friend class UDPHandle;
+
+    /// read the network interfaces, then run the tickers and pump function once after a batch of
+    /// events, the way libuv runs check handles once per iteration
+    void
+    Cycle();
+
+    std::shared_ptr<Network> m_Net;
+    std::shared_ptr<LoopState> m_State;
+    std::vector<std::function<void(void)>> m_Tickers;
+    std::function<void(void)> m_Pump;
+    using PacketHandler_t = std::function<void(net::IPPacket)>;
+    std::vector<std::pair<std::shared_ptr<vpn::NetworkInterface>, PacketHandler_t>> m_NetIfs;
+  };
+
+  class UDPHandle final : public llarp::UDPHandle,
+                          public std::enable_shared_from_this<UDPHandle>
+  {
+   public:
+    UDPHandle(std::shared_ptr<Loop> loop, ReceiveFunc rf);
+
+    ~UDPHandle() override;
+
+    /// binds addr on the simulated network; an unspecified address receives every datagram sent
+    /// to its port that no specific binding takes
+    bool
+    listen(const SockAddr& addr) override;
+
+    bool
+    send(const SockAddr& dest, const llarp_buffer_t& buf) override;
+
+    void
+    close() override;
+
+   private:
+    friend class Network;
+
+    std::weak_ptr<Loop> m_Loop;
+    std::shared_ptr<Network> m_Net;
+    std::optional<SockAddr> m_Addr;
+  };
+
+  /// an in memory tun device for a simulated loop. packets injected into it are read by the loop
+  /// on its next cycle, packets the loop writes to it go to onWrite.
+  class MemoryInterface final : public vpn::NetworkInterface
+  {
+   public:
+    MemoryInterface(std::string ifname, std::weak_ptr<EventLoop> loop);
+
+    /// called on the loop with every packet written to the interface
+    std::function<void(net::IPPacket)> onWrite;
+
+    /// queue a packet for the loop to read and wake it, thread safe
+    void
+    Inject(net::IPPacket pkt);
+
+    int
+    PollFD() const override
+    {
+      return -1;
+    }
+
+    std::string
+    IfName() const override
+    {
+      return m_IfName;
+    }
+
+    net::IPPacket
+    ReadNextPacket() override;
+
+    bool
+    WritePacket(net::IPPacket pkt) override;
+
+   private:
+    const std::string m_IfName;
+    std::weak_ptr<EventLoop> m_Loop;
+    std::mutex m_Access;
+    std::deque<net::IPPacket> m_Inbound;
+  };
+
+  /// hands out a MemoryInterface for every interface a router on loop asks for
+  class MemoryPlatform final : public vpn::Platform
+  {
+   public:
+    explicit MemoryPlatform(std::weak_ptr<EventLoop> loop) : m_Loop{std::move(loop)}
+    {}
+
+    std::shared_ptr<vpn::NetworkInterface>
+    ObtainInterface(vpn::InterfaceInfo info) override;
+
+    /// every interface handed out so far, oldest first
+    std::vector<std::shared_ptr<MemoryInterface>> interfaces;
+
+   private:
+    std::weak_ptr<EventLoop> m_Loop;
+  };
+}  // namespace llarp::sim
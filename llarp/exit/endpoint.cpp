@@ -27,10 +27,21 @@ namespace llarp
 
     Endpoint::~Endpoint()
     {
+      if (m_FlushPending)
+        m_Parent->CancelExitFlush(this);
       if (m_CurrentPath)
         m_Parent->DelEndpointInfo(m_CurrentPath->RXID());
     }
 
+    void
+    Endpoint::MarkFlushPending()
+    {
+      if (m_FlushPending)
+        return;
+      m_FlushPending = true;
+      m_Parent->QueueExitFlush(this);
+    }
+
     void
     Endpoint::Close()
     {
@@ -124,10 +135,13 @@ namespace llarp
         return true;
       }
       // queue overflow
-      if (m_UpstreamQueue.size() > MaxUpstreamQueueSize)
+      if (m_UpstreamUsed > MaxUpstreamQueueSize)
         return false;
 
-      llarp::net::IPPacket pkt;
+      if (m_UpstreamUsed == m_UpstreamPackets.size())
+        m_UpstreamPackets.emplace_back();
+      // load straight into the pooled slot
+      auto& pkt = m_UpstreamPackets[m_UpstreamUsed];
       if (!pkt.Load(buf.underlying))
         return false;
       if (pkt.IsV6() && m_Parent->SupportsV6())
@@ -152,7 +166,8 @@ namespace llarp
       {
         return false;
       }
-      m_UpstreamQueue.emplace(pkt, counter);
+      m_UpstreamUsed++;
+      MarkFlushPending();
       m_TxRate += buf.underlying.sz;
       m_LastActive = m_Parent->Now();
       return true;
@@ -185,59 +200,53 @@ namespace llarp
       const auto _pktbuf = pkt.ConstBuffer();
       auto& pktbuf = _pktbuf.underlying;
 
-      const uint8_t queue_idx = pktbuf.sz / llarp::routing::ExitPadSize;
-      if (m_DownstreamQueues.find(queue_idx) == m_DownstreamQueues.end())
-        m_DownstreamQueues.emplace(queue_idx, InboundTrafficQueue_t{});
-      auto& queue = m_DownstreamQueues.at(queue_idx);
-      if (queue.size() == 0)
-      {
-        queue.emplace_back();
-        queue.back().protocol = type;
-        return queue.back().PutBuffer(pktbuf, m_Counter++);
-      }
-      auto& msg = queue.back();
-      if (msg.Size() + pktbuf.sz > llarp::routing::ExitPadSize)
+      // append to the newest batch if it has room and carries the same protocol, otherwise start
+      // a new batch, reusing a previously flushed message when we have one
+      if (m_DownstreamUsed == 0
+          or m_DownstreamBatches[m_DownstreamUsed - 1].protocol != type
+          or m_DownstreamBatches[m_DownstreamUsed - 1].Size() + pktbuf.sz
+              > llarp::routing::ExitPadSize)
       {
-        queue.emplace_back();
-        queue.back().protocol = type;
-        return queue.back().PutBuffer(pktbuf, m_Counter++);
+        if (m_DownstreamUsed == m_DownstreamBatches.size())
+          m_DownstreamBatches.emplace_back();
+        auto& batch = m_DownstreamBatches[m_DownstreamUsed];
+        batch.version = LLARP_PROTO_VERSION;
+        batch.protocol = type;
+        m_DownstreamUsed++;
       }
-      msg.protocol = type;
-      return msg.PutBuffer(pktbuf, m_Counter++);
+      if (not m_DownstreamBatches[m_DownstreamUsed - 1].PutBuffer(pktbuf, m_Counter++))
+        return false;
+      MarkFlushPending();
+      return true;
     }
 
     bool
     Endpoint::Flush()
     {
+      m_FlushPending = false;
       // flush upstream queue
-      while (m_UpstreamQueue.size())
-      {
-        m_Parent->QueueOutboundTraffic(m_UpstreamQueue.top().pkt);
-        m_UpstreamQueue.pop();
-      }
+      for (size_t idx = 0; idx < m_UpstreamUsed; ++idx)
+        m_Parent->QueueOutboundTraffic(m_UpstreamPackets[idx]);
+      m_UpstreamUsed = 0;
       // flush downstream queue
       auto path = GetCurrentPath();
       bool sent = path != nullptr;
-      if (path)
+      for (size_t idx = 0; idx < m_DownstreamUsed; ++idx)
       {
-        for (auto& item : m_DownstreamQueues)
+        auto& msg = m_DownstreamBatches[idx];
+        if (path)
         {
-          auto& queue = item.second;
-          while (queue.size())
+          msg.S = path->NextSeqNo();
+          if (path->SendRoutingMessage(msg, m_Parent->GetRouter()))
           {
-            auto& msg = queue.front();
-            msg.S = path->NextSeqNo();
-            if (path->SendRoutingMessage(msg, m_Parent->GetRouter()))
-            {
-              m_RxRate += msg.Size();
-              sent = true;
-            }
-            queue.pop_front();
+            m_RxRate += msg.Size();
+            sent = true;
           }
         }
+        // keeps the storage of msg.X for the next batch
+        msg.Clear();
       }
-      for (auto& item : m_DownstreamQueues)
-        item.second.clear();
+      m_DownstreamUsed = 0;
       return sent;
     }
   }  // namespace exit
@@ -7,7 +7,7 @@
 #include <llarp/service/protocol_type.hpp>
 #include <llarp/util/time.hpp>
 
-#include <queue>
+#include <vector>
 
 namespace llarp
 {
@@ -64,6 +64,13 @@ namespace llarp
       bool
       Flush();
 
+      /// return true if we have queued traffic waiting for a flush
+      bool
+      HasPendingTraffic() const
+      {
+        return m_UpstreamUsed > 0 or m_DownstreamUsed > 0;
+      }
+
       /// queue outbound traffic
       /// does ip rewrite here
       bool
@@ -115,28 +122,22 @@ namespace llarp
       uint64_t m_TxRate, m_RxRate;
       llarp_time_t m_LastActive;
       bool m_RewriteSource;
-      using InboundTrafficQueue_t = std::deque<llarp::routing::TransferTrafficMessage>;
-      using TieredQueue = std::map<uint8_t, InboundTrafficQueue_t>;
-      // maps number of fragments the message will fit in to the queue for it
-      TieredQueue m_DownstreamQueues;
+      /// true while we are on our parent's list of exits to flush
+      bool m_FlushPending = false;
 
-      struct UpstreamBuffer
-      {
-        UpstreamBuffer(const llarp::net::IPPacket& p, uint64_t c) : pkt(p), counter(c)
-        {}
+      /// schedule ourself for the parent's next flush
+      void
+      MarkFlushPending();
 
-        llarp::net::IPPacket pkt;
-        uint64_t counter;
+      // downstream packets batched into transfer messages; the first m_DownstreamUsed entries are
+      // pending, the rest are cleared messages kept around so their storage gets reused
+      std::vector<llarp::routing::TransferTrafficMessage> m_DownstreamBatches;
+      size_t m_DownstreamUsed = 0;
 
-        bool
-        operator<(const UpstreamBuffer& other) const
-        {
-          return counter < other.counter;
-        }
-      };
+      // upstream packets in arrival order, pooled the same way as the downstream batches
+      std::vector<llarp::net::IPPacket> m_UpstreamPackets;
+      size_t m_UpstreamUsed = 0;
 
-      using UpstreamQueue_t = std::priority_queue<UpstreamBuffer>;
-      UpstreamQueue_t m_UpstreamQueue;
       uint64_t m_Counter;
     };
   }  // namespace exit
@@ -10,6 +10,7 @@
 #include <llarp/quic/tunnel.hpp>
 #include <llarp/router/i_rc_lookup_handler.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include "service/protocol_type.hpp"
 
@@ -28,6 +29,11 @@ namespace llarp
     {
       m_ShouldInitTun = true;
       m_QUIC = std::make_shared<quic::TunnelManager>(*this);
+      // the allocator hands the address over to the new ident itself, we only need to drop the
+      // old ident's exit sessions
+      m_AddrAlloc.onEvict = [this](const net::AddressAllocator::Entry& entry) {
+        KickIdentOffExit(PubKey{entry.key});
+      };
     }
 
     ExitEndpoint::~ExitEndpoint() = default;
@@ -234,10 +240,10 @@ namespace llarp
         }
         else
         {
-          auto itr = m_IPToKey.find(ip);
-          if (itr != m_IPToKey.end() && m_SNodeKeys.find(itr->second) != m_SNodeKeys.end())
+          const auto* entry = m_AddrAlloc.FindEntry(ip);
+          if (entry and m_SNodeKeys.find(PubKey{entry->key}) != m_SNodeKeys.end())
           {
-            RouterID them = itr->second;
+            RouterID them{entry->key.as_array()};
             msg.AddAReply(them.ToString());
           }
           else
@@ -305,7 +311,7 @@ namespace llarp
                     std::shared_ptr<exit::BaseSession> session) {
                   if (session && session->IsReady())
                   {
-                    msg->AddINReply(m_KeyToIP[pubKey], isV6);
+                    msg->AddINReply(m_AddrAlloc.FindIP(pubKey).value_or(huint128_t{0}), isV6);
                   }
                   else
                   {
@@ -318,10 +324,9 @@ namespace llarp
           else
           {
             // we have it mapped already as a service node
-            auto itr = m_KeyToIP.find(pubKey);
-            if (itr != m_KeyToIP.end())
+            if (auto maybe = m_AddrAlloc.FindIP(pubKey))
             {
-              ip = itr->second;
+              ip = *maybe;
               msg.AddINReply(ip, isV6);
             }
             else  // fallback case that should never happen (probably)
@@ -375,14 +380,14 @@ namespace llarp
       m_InetToNetwork.Process([&](Pkt_t& pkt) {
         PubKey pk;
         {
-          auto itr = m_IPToKey.find(pkt.dstv6());
-          if (itr == m_IPToKey.end())
+          const auto* entry = m_AddrAlloc.FindEntry(pkt.dstv6());
+          if (entry == nullptr)
           {
             // drop
             LogWarn(Name(), " dropping packet, has no session at ", pkt.dstv6());
             return;
           }
-          pk = itr->second;
+          pk = PubKey{entry->key};
         }
         // check if this key is a service node
         if (m_SNodeKeys.count(pk))
@@ -423,15 +428,20 @@ namespace llarp
         }
       });
       {
-        auto itr = m_ActiveExits.begin();
-        while (itr != m_ActiveExits.end())
+        // only visit exits that queued something; an exit re-queues itself if it gets more
+        // traffic while we are flushing
+        std::vector<exit::Endpoint*> pending;
+        std::swap(pending, m_PendingFlush);
+        for (auto* ep : pending)
         {
-          if (!itr->second->Flush())
+          if (!ep->Flush())
           {
-            LogWarn("exit session with ", itr->first, " dropped packets");
+            LogWarn("exit session with ", ep->PubKey(), " dropped packets");
           }
-          ++itr;
         }
+        pending.clear();
+        if (m_PendingFlush.empty())
+          std::swap(pending, m_PendingFlush);
       }
       {
         auto itr = m_SNodeSessions.begin();
@@ -451,10 +461,13 @@ namespace llarp
       // map our address
       const PubKey us(m_Router->pubkey());
       const huint128_t ip = GetIfAddr();
-      m_KeyToIP[us] = ip;
-      m_IPToKey[ip] = us;
-      m_IPActivity[ip] = std::numeric_limits<llarp_time_t>::max();
+      m_AddrAlloc.Map(ip, us, 0, true, llarp_time_t::max());
       m_SNodeKeys.insert(us);
+      if (m_PersistAddrMapFile)
+      {
+        const auto loaded = m_AddrAlloc.Load(*m_PersistAddrMapFile, Now());
+        LogInfo(Name(), " loaded ", loaded, " address mappings from ", *m_PersistAddrMapFile);
+      }
       if (m_ShouldInitTun)
       {
         vpn::InterfaceInfo info;
@@ -499,6 +512,8 @@ namespace llarp
     {
       for (auto& item : m_SNodeSessions)
         item.second->Stop();
+      if (m_PersistAddrMapFile)
+        m_AddrAlloc.Save(*m_PersistAddrMapFile);
       return true;
     }
 
@@ -514,66 +529,24 @@ namespace llarp
     bool
     ExitEndpoint::HasLocalMappedAddrFor(const PubKey& pk) const
     {
-      return m_KeyToIP.find(pk) != m_KeyToIP.end();
+      return m_AddrAlloc.FindIP(pk).has_value();
     }
 
     huint128_t
     ExitEndpoint::GetIPForIdent(const PubKey pk)
     {
-      huint128_t found{};
-      if (!HasLocalMappedAddrFor(pk))
-      {
-        // allocate and map
-        found = AllocateNewAddress();
-        if (!m_KeyToIP.emplace(pk, found).second)
-        {
-          LogError(Name(), "failed to map ", pk, " to ", found);
-          return found;
-        }
-        if (!m_IPToKey.emplace(found, pk).second)
-        {
-          LogError(Name(), "failed to map ", found, " to ", pk);
-          return found;
-        }
-        if (HasLocalMappedAddrFor(pk))
-          LogInfo(Name(), " mapping ", pk, " to ", found);
-        else
-          LogError(Name(), "failed to map ", pk, " to ", found);
-      }
-      else
-        found = m_KeyToIP[pk];
-
-      MarkIPActive(found);
-      m_KeyToIP.rehash(0);
-      assert(HasLocalMappedAddrFor(pk));
-      return found;
-    }
-
-    huint128_t
-    ExitEndpoint::AllocateNewAddress()
-    {
-      if (m_NextAddr < m_HigestAddr)
-        return ++m_NextAddr;
-
-      // find oldest activity ip address
-      huint128_t found = {0};
-      llarp_time_t min = std::numeric_limits<llarp_time_t>::max();
-      auto itr = m_IPActivity.begin();
-      while (itr != m_IPActivity.end())
+      const bool existing = HasLocalMappedAddrFor(pk);
+      // allocates a new address, or kicks the least recently active ident off if we are full
+      // TODO: DoS
+      const auto maybe = m_AddrAlloc.Obtain(pk, 0, Now());
+      if (not maybe)
       {
-        if (itr->second < min)
-        {
-          found.h = itr->first.h;
-          min = itr->second;
-        }
-        ++itr;
+        LogError(Name(), " failed to map ", pk, ": no addresses left");
+        return huint128_t{0};
       }
-      // kick old ident off exit
-      // TODO: DoS
-      PubKey pk = m_IPToKey[found];
-      KickIdentOffExit(pk);
-
-      return found;
+      if (not existing)
+        LogInfo(Name(), " mapping ", pk, " to ", *maybe);
+      return *maybe;
     }
 
     EndpointBase::AddressVariant_t
@@ -637,9 +610,6 @@ namespace llarp
     ExitEndpoint::KickIdentOffExit(const PubKey& pk)
     {
       LogInfo(Name(), " kicking ", pk, " off exit");
-      huint128_t ip = m_KeyToIP[pk];
-      m_KeyToIP.erase(pk);
-      m_IPToKey.erase(ip);
       auto range = m_ActiveExits.equal_range(pk);
       auto exit_itr = range.first;
       while (exit_itr != range.second)
@@ -649,7 +619,7 @@ namespace llarp
     void
     ExitEndpoint::MarkIPActive(huint128_t ip)
     {
-      m_IPActivity[ip] = GetRouter()->Now();
+      m_AddrAlloc.MarkActive(ip, GetRouter()->Now());
     }
 
     void
@@ -743,8 +713,8 @@ namespace llarp
       const auto host_str = m_OurRange.BaseAddressString();
       // string, or just a plain char array?
       m_IfAddr = m_OurRange.addr;
-      m_NextAddr = m_IfAddr;
-      m_HigestAddr = m_OurRange.HighestAddr();
+      m_AddrAlloc.Init(m_IfAddr + huint128_t{1}, m_OurRange.HighestAddr());
+      m_PersistAddrMapFile = networkConfig.m_AddrMapPersistFile;
       m_UseV6 = not m_OurRange.IsV4();
 
       m_ifname = networkConfig.m_ifname;
@@ -852,6 +822,19 @@ namespace llarp
       }
     }
 
+    void
+    ExitEndpoint::QueueExitFlush(exit::Endpoint* ep)
+    {
+      m_PendingFlush.push_back(ep);
+    }
+
+    void
+    ExitEndpoint::CancelExitFlush(const exit::Endpoint* ep)
+    {
+      m_PendingFlush.erase(
+          std::remove(m_PendingFlush.begin(), m_PendingFlush.end(), ep), m_PendingFlush.end());
+    }
+
     void
     ExitEndpoint::Tick(llarp_time_t now)
     {
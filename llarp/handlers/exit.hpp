@@ -1,6 +1,7 @@
 #pragma once
 
 #include <llarp/exit/endpoint.hpp>
+#include <llarp/net/address_allocator.hpp>
 #include "tun.hpp"
 #include <llarp/dns/server.hpp>
 #include <unordered_map>
@@ -118,6 +119,14 @@ namespace llarp
       void
       RemoveExit(const exit::Endpoint* ep);
 
+      /// called by an exit::Endpoint when it has traffic queued so that the next Flush() visits it
+      void
+      QueueExitFlush(exit::Endpoint* ep);
+
+      /// called by an exit::Endpoint with queued traffic that is going away
+      void
+      CancelExitFlush(const exit::Endpoint* ep);
+
       bool
       QueueOutboundTraffic(net::IPPacket pkt);
 
@@ -156,9 +165,6 @@ namespace llarp
       ObtainSNodeSession(const RouterID& router, exit::SessionReadyFunc obtainCb);
 
      private:
-      huint128_t
-      AllocateNewAddress();
-
       /// obtain ip for service node session, creates a new session if one does
       /// not existing already
       huint128_t
@@ -184,9 +190,13 @@ namespace llarp
 
       std::unordered_multimap<PubKey, std::unique_ptr<exit::Endpoint>> m_ActiveExits;
 
-      using KeyMap_t = std::unordered_map<PubKey, huint128_t>;
+      /// exits with traffic queued since the last Flush(); only these get flushed
+      std::vector<exit::Endpoint*> m_PendingFlush;
 
-      KeyMap_t m_KeyToIP;
+      /// maps ident to ip and back, hands out and reclaims addresses in our range
+      net::AddressAllocator m_AddrAlloc;
+      /// file we persist address mappings to, if any
+      std::optional<fs::path> m_PersistAddrMapFile;
 
       using SNodes_t = std::set<PubKey>;
       /// set of pubkeys we treat as snodes
@@ -196,17 +206,10 @@ namespace llarp
       /// snode sessions we are talking to directly
       SNodeSessions_t m_SNodeSessions;
 
-      std::unordered_map<huint128_t, PubKey> m_IPToKey;
-
       huint128_t m_IfAddr;
-      huint128_t m_HigestAddr;
-
-      huint128_t m_NextAddr;
       IPRange m_OurRange;
       std::string m_ifname;
 
-      std::unordered_map<huint128_t, llarp_time_t> m_IPActivity;
-
       std::shared_ptr<vpn::NetworkInterface> m_NetIf;
 
       IpAddress m_LocalResolverAddr;
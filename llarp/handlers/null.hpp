@@ -19,6 +19,10 @@ namespace llarp
         r->loop()->add_ticker([this] { Pump(Now()); });
       }
 
+      /// takes inbound TrafficV4 packets, set by liblokinet for its udp sockets. without one they
+      /// are dropped.
+      std::function<bool(service::ConvoTag, const llarp_buffer_t&)> m_TrafficHandler;
+
       virtual bool
       HandleInboundPacket(
           const service::ConvoTag tag,
@@ -31,6 +35,8 @@ namespace llarp
         {
           return true;
         }
+        if (t == service::ProtocolType::TrafficV4 and m_TrafficHandler)
+          return m_TrafficHandler(tag, buf);
         if (t != service::ProtocolType::QUIC)
           return false;
 
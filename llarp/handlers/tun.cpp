@@ -19,7 +19,9 @@
 #include <llarp/service/outbound_context.hpp>
 #include <llarp/service/name.hpp>
 #include <llarp/service/protocol_type.hpp>
+#include <llarp/util/instrument.hpp>
 #include <llarp/util/meta/memfn.hpp>
+#include <llarp/util/metrics.hpp>
 #include <llarp/nodedb.hpp>
 #include <llarp/quic/tunnel.hpp>
 #include <llarp/rpc/endpoint_rpc.hpp>
@@ -64,7 +66,6 @@ namespace llarp
 
     TunEndpoint::TunEndpoint(AbstractRouter* r, service::Context* parent)
         : service::Endpoint(r, parent)
-        , m_UserToNetworkPktQueue("endpoint_sendq", r->loop(), r->loop())
     {
       m_PacketRouter = std::make_unique<vpn::PacketRouter>(
           [this](net::IPPacket pkt) { HandleGotUserPacket(std::move(pkt)); });
@@ -103,23 +104,23 @@ namespace llarp
       obj["ustreamResolvers"] = resolvers;
       obj["localResolver"] = m_LocalResolverAddr.toString();
       util::StatusObject ips{};
-      for (const auto& item : m_IPActivity)
-      {
-        util::StatusObject ipObj{{"lastActive", to_json(item.second)}};
+      m_AddrAlloc.ForEach([&ips](const net::AddressAllocator::Entry& entry) {
+        util::StatusObject ipObj{{"lastActive", to_json(entry.lastActive)}};
         std::string remoteStr;
-        AlignedBuffer<32> addr = m_IPToAddr.at(item.first);
-        if (m_SNodes.at(addr))
-          remoteStr = RouterID(addr.as_array()).ToString();
+        if (entry.kind == eAddrKindSNode)
+          remoteStr = RouterID(entry.key.as_array()).ToString();
         else
-          remoteStr = service::Address(addr.as_array()).ToString();
+          remoteStr = service::Address(entry.key.as_array()).ToString();
         ipObj["remote"] = remoteStr;
-        std::string ipaddr = item.first.ToString();
+        std::string ipaddr = entry.ip.ToString();
         ips[ipaddr] = ipObj;
-      }
+      });
       obj["addrs"] = ips;
       obj["ourIP"] = m_OurIP.ToString();
-      obj["nextIP"] = m_NextIP.ToString();
-      obj["maxIP"] = m_MaxIP.ToString();
+      obj["nextIP"] = m_AddrAlloc.NextFresh().ToString();
+      obj["maxIP"] = m_AddrAlloc.Last().ToString();
+      if (m_UserToNetworkFlowQueue)
+        obj["sendQueue"] = m_UserToNetworkFlowQueue->ExtractStatus();
       return obj;
     }
 
@@ -158,7 +159,16 @@ namespace llarp
         m_AuthPolicy = std::move(auth);
       }
 
+      if (conf.m_FlowQueueing)
+        m_UserToNetworkFlowQueue =
+            std::make_unique<FlowQueue_t>("endpoint_sendq", Router()->loop(), Router()->loop());
+      else
+        m_UserToNetworkPktQueue =
+            std::make_unique<PacketQueue_t>("endpoint_sendq", Router()->loop(), Router()->loop());
+
       m_TrafficPolicy = conf.m_TrafficPolicy;
+      if (m_TrafficPolicy)
+        m_CompiledTrafficPolicy.emplace(*m_TrafficPolicy);
       m_OwnedRanges = conf.m_OwnedRanges;
 
       m_LocalResolverAddr = dnsConf.m_bind;
@@ -195,6 +205,8 @@ namespace llarp
       m_OurIP = m_OurRange.addr;
       m_UseV6 = false;
 
+      m_PersistAddrMapFile = conf.m_AddrMapPersistFile;
+
       if (auto* quic = GetQUICTunnel())
       {
         quic->listen([this](std::string_view, uint16_t port) {
@@ -208,7 +220,7 @@ namespace llarp
     bool
     TunEndpoint::HasLocalIP(const huint128_t& ip) const
     {
-      return m_IPToAddr.find(ip) != m_IPToAddr.end();
+      return m_AddrAlloc.HasIP(ip);
     }
 
     void
@@ -216,6 +228,7 @@ namespace llarp
     {
       FlushSend();
       Pump(Now());
+      LLARP_PLOT("tun write queue", m_NetworkToUserPktQueue.size());
       // flush network to user
       while (not m_NetworkToUserPktQueue.empty())
       {
@@ -249,18 +262,19 @@ namespace llarp
     std::optional<std::variant<service::Address, RouterID>>
     TunEndpoint::ObtainAddrForIP(huint128_t ip) const
     {
-      auto itr = m_IPToAddr.find(ip);
-      if (itr == m_IPToAddr.end())
+      const auto* entry = m_AddrAlloc.FindEntry(ip);
+      if (entry == nullptr)
         return std::nullopt;
-      if (m_SNodes.at(itr->second))
-        return RouterID{itr->second.as_array()};
+      if (entry->kind == eAddrKindSNode)
+        return RouterID{entry->key.as_array()};
       else
-        return service::Address{itr->second.as_array()};
+        return service::Address{entry->key.as_array()};
     }
 
     bool
     TunEndpoint::HandleHookedDNSMessage(dns::Message msg, std::function<void(dns::Message)> reply)
     {
+      LLARP_ZONE();
       auto ReplyToSNodeDNSWhenReady = [self = this, reply = reply](
                                           RouterID snode, auto msg, bool isV6) -> bool {
         return self->EnsurePathToSNode(
@@ -676,20 +690,20 @@ namespace llarp
     bool
     TunEndpoint::MapAddress(const service::Address& addr, huint128_t ip, bool SNode)
     {
-      auto itr = m_IPToAddr.find(ip);
-      if (itr != m_IPToAddr.end())
+      if (const auto* entry = m_AddrAlloc.FindEntry(ip))
       {
         llarp::LogWarn(
-            ip, " already mapped to ", service::Address(itr->second.as_array()).ToString());
+            ip, " already mapped to ", service::Address(entry->key.as_array()).ToString());
         return false;
       }
+      // drop any address the remote was given dynamically (e.g. one loaded from the persisted
+      // mappings) in favour of the explicit mapping
+      if (auto maybe = m_AddrAlloc.FindIP(addr))
+        m_AddrAlloc.Release(*maybe);
       llarp::LogInfo(Name() + " map ", addr.ToString(), " to ", ip);
 
-      m_IPToAddr[ip] = addr;
-      m_AddrToIP[addr] = ip;
-      m_SNodes[addr] = SNode;
-      MarkIPActiveForever(ip);
-      return true;
+      return m_AddrAlloc.Map(
+          ip, addr, SNode ? eAddrKindSNode : eAddrKindService, true, llarp_time_t::max());
     }
 
     std::string
@@ -723,10 +737,16 @@ namespace llarp
     bool
     TunEndpoint::SetupTun()
     {
-      m_NextIP = m_OurIP;
-      m_MaxIP = m_OurRange.HighestAddr();
+      // hand out everything after our address, up to but excluding the broadcast address
+      m_AddrAlloc.Init(m_OurIP + huint128_t{1}, m_OurRange.HighestAddr() - huint128_t{1});
       llarp::LogInfo(Name(), " set ", m_IfName, " to have address ", m_OurIP);
-      llarp::LogInfo(Name(), " allocated up to ", m_MaxIP, " on range ", m_OurRange);
+      llarp::LogInfo(Name(), " allocated up to ", m_AddrAlloc.Last(), " on range ", m_OurRange);
+      if (m_PersistAddrMapFile)
+      {
+        const auto loaded = m_AddrAlloc.Load(*m_PersistAddrMapFile, Now());
+        llarp::LogInfo(
+            Name(), " loaded ", loaded, " address mappings from ", *m_PersistAddrMapFile);
+      }
 
       const service::Address ourAddr = m_Identity.pub.Addr();
 
@@ -833,13 +853,23 @@ namespace llarp
     {
       if (m_Resolver)
         m_Resolver->Stop();
+      if (m_PersistAddrMapFile)
+        m_AddrAlloc.Save(*m_PersistAddrMapFile);
       return llarp::service::Endpoint::Stop();
     }
 
     void
     TunEndpoint::FlushSend()
     {
-      m_UserToNetworkPktQueue.Process([&](net::IPPacket& pkt) {
+      LLARP_ZONE();
+      const size_t queueSize = m_UserToNetworkFlowQueue ? m_UserToNetworkFlowQueue->Size()
+          : m_UserToNetworkPktQueue                    ? m_UserToNetworkPktQueue->Size()
+                                                       : 0;
+      LLARP_PLOT("tun send queue", queueSize);
+      static auto& queued = metrics::Registry::Global().GetGauge(
+          "lokinet_queue_depth", "items waiting in a queue", {{"queue", "tun_send"}});
+      queued.Set(queueSize);
+      const auto sendPacket = [&](net::IPPacket& pkt) {
         huint128_t dst, src;
         if (pkt.IsV4())
         {
@@ -874,23 +904,15 @@ namespace llarp
         {
           dst = net::ExpandV4(net::TruncateV6(dst));
         }
-        auto itr = m_IPToAddr.find(dst);
-        if (itr == m_IPToAddr.end())
+        const auto* entry = m_AddrAlloc.FindEntry(dst);
+        if (entry == nullptr)
         {
-          // find all ranges that match the destination ip
-          const auto exitEntries = m_ExitMap.FindAllEntries(dst);
-          if (exitEntries.empty())
-          {
-            // send icmp unreachable as we dont have any exits for this ip
-            if (const auto icmp = pkt.MakeICMPUnreachable())
-            {
-              HandleWriteIPPacket(icmp->ConstBuffer(), dst, src, 0);
-            }
-            return;
-          }
+          // visit all ranges that match the destination ip, the most specific range is visited
+          // last so it wins
+          bool anyExit = false;
           service::Address addr{};
-          for (const auto& [range, exitAddr] : exitEntries)
-          {
+          m_ExitMap.ForEachMatch(dst, [&](const auto& range, const auto& exitAddr) {
+            anyExit = true;
             if (range.BogonRange() and range.Contains(dst))
             {
               // we permit this because it matches our rules and we allow bogons
@@ -902,6 +924,15 @@ namespace llarp
               addr = exitAddr;
             }
             // we do not permit bogons when they don't explicitly match a permitted bogon range
+          });
+          if (not anyExit)
+          {
+            // send icmp unreachable as we dont have any exits for this ip
+            if (const auto icmp = pkt.MakeICMPUnreachable())
+            {
+              HandleWriteIPPacket(icmp->ConstBuffer(), dst, src, 0);
+            }
+            return;
           }
           if (addr.IsZero())  // drop becase no exit was found that matches our rules
             return;
@@ -922,14 +953,14 @@ namespace llarp
         bool rewriteAddrs = true;
         std::variant<service::Address, RouterID> to;
         service::ProtocolType type;
-        if (m_SNodes.at(itr->second))
+        if (entry->kind == eAddrKindSNode)
         {
-          to = RouterID{itr->second.as_array()};
+          to = RouterID{entry->key.as_array()};
           type = service::ProtocolType::TrafficV4;
         }
         else
         {
-          to = service::Address{itr->second.as_array()};
+          to = service::Address{entry->key.as_array()};
           type = m_state->m_ExitEnabled and src != m_OurIP ? service::ProtocolType::Exit
                                                            : pkt.ServiceProtocol();
         }
@@ -949,17 +980,18 @@ namespace llarp
           return;
         }
         llarp::LogWarn(Name(), " did not flush packets");
-      });
+      };
+      if (m_UserToNetworkFlowQueue)
+        m_UserToNetworkFlowQueue->Process(sendPacket);
+      else if (m_UserToNetworkPktQueue)
+        m_UserToNetworkPktQueue->Process(sendPacket);
     }
 
     bool
     TunEndpoint::ShouldAllowTraffic(const net::IPPacket& pkt) const
     {
-      if (const auto exitPolicy = GetExitPolicy())
-      {
-        if (not exitPolicy->AllowsTraffic(pkt))
-          return false;
-      }
+      if (m_CompiledTrafficPolicy)
+        return m_CompiledTrafficPolicy->AllowsTraffic(pkt);
 
       return true;
     }
@@ -1045,10 +1077,8 @@ namespace llarp
           src = pkt.srcv6();
         }
         // find what exit we think this should be for
-        const auto mapped = m_ExitMap.FindAllEntries(src);
         bool allow = false;
-        for (const auto& [range, exitAddr] : mapped)
-        {
+        m_ExitMap.ForEachMatch(src, [&](const auto& range, const auto& exitAddr) {
           if ((range.BogonRange() and range.Contains(src)) or not IsBogon(src))
           {
             // this range is either not a bogon or is a bogon we are explicitly allowing
@@ -1058,7 +1088,7 @@ namespace llarp
               allow = exitAddr == *ptr;
             }
           }
-        }
+        });
         if (not allow)
           return false;
       }
@@ -1106,100 +1136,55 @@ namespace llarp
     huint128_t
     TunEndpoint::ObtainIPForAddr(std::variant<service::Address, RouterID> addr)
     {
-      llarp_time_t now = Now();
-      huint128_t nextIP = {0};
       AlignedBuffer<32> ident{};
-      bool snode = false;
+      uint8_t kind = eAddrKindService;
 
       var::visit([&ident](auto&& val) { ident = val.data(); }, addr);
 
       if (std::get_if<RouterID>(&addr))
       {
-        snode = true;
+        kind = eAddrKindSNode;
       }
 
-      {
-        // previously allocated address
-        auto itr = m_AddrToIP.find(ident);
-        if (itr != m_AddrToIP.end())
-        {
-          // mark ip active
-          MarkIPActive(itr->second);
-          return itr->second;
-        }
-      }
-      // allocate new address
-      if (m_NextIP < m_MaxIP)
-      {
-        do
-        {
-          nextIP = ++m_NextIP;
-        } while (m_IPToAddr.find(nextIP) != m_IPToAddr.end() && m_NextIP < m_MaxIP);
-        if (nextIP < m_MaxIP)
-        {
-          m_AddrToIP[ident] = nextIP;
-          m_IPToAddr[nextIP] = ident;
-          m_SNodes[ident] = snode;
-          llarp::LogInfo(Name(), " mapped ", ident, " to ", nextIP);
-          MarkIPActive(nextIP);
-          return nextIP;
-        }
-      }
-
-      // we are full
-      // expire least active ip
+      const bool existing = m_AddrAlloc.FindIP(ident).has_value();
+      // allocates a new address, or reclaims the least recently active one if we are full
       // TODO: prevent DoS
-      std::pair<huint128_t, llarp_time_t> oldest = {huint128_t{0}, 0s};
-
-      // find oldest entry
-      auto itr = m_IPActivity.begin();
-      while (itr != m_IPActivity.end())
+      if (auto maybe = m_AddrAlloc.Obtain(ident, kind, Now()))
       {
-        if (itr->second <= now)
-        {
-          if ((now - itr->second) > oldest.second)
-          {
-            oldest.first = itr->first;
-            oldest.second = itr->second;
-          }
-        }
-        ++itr;
+        if (not existing)
+          llarp::LogInfo(Name(), " mapped ", ident, " to ", *maybe);
+        return *maybe;
       }
-      // remap address
-      m_IPToAddr[oldest.first] = ident;
-      m_AddrToIP[ident] = oldest.first;
-      m_SNodes[ident] = snode;
-      nextIP = oldest.first;
-
-      // mark ip active
-      m_IPActivity[nextIP] = std::max(m_IPActivity[nextIP], now);
-
-      return nextIP;
+      llarp::LogWarn(Name(), " cannot map ", ident, ": every address in our range is pinned");
+      return huint128_t{0};
     }
 
     bool
     TunEndpoint::HasRemoteForIP(huint128_t ip) const
     {
-      return m_IPToAddr.find(ip) != m_IPToAddr.end();
+      return m_AddrAlloc.HasIP(ip);
     }
 
     void
     TunEndpoint::MarkIPActive(huint128_t ip)
     {
       llarp::LogDebug(Name(), " address ", ip, " is active");
-      m_IPActivity[ip] = std::max(Now(), m_IPActivity[ip]);
+      m_AddrAlloc.MarkActive(ip, Now());
     }
 
     void
     TunEndpoint::MarkIPActiveForever(huint128_t ip)
     {
-      m_IPActivity[ip] = std::numeric_limits<llarp_time_t>::max();
+      m_AddrAlloc.Pin(ip);
     }
 
     void
     TunEndpoint::HandleGotUserPacket(net::IPPacket pkt)
     {
-      m_UserToNetworkPktQueue.Emplace(std::move(pkt));
+      if (m_UserToNetworkFlowQueue)
+        m_UserToNetworkFlowQueue->Emplace(std::move(pkt));
+      else if (m_UserToNetworkPktQueue)
+        m_UserToNetworkPktQueue->Emplace(std::move(pkt));
     }
 
     TunEndpoint::~TunEndpoint() = default;
@@ -3,11 +3,13 @@
 #include <llarp/dns/server.hpp>
 #include <llarp/ev/ev.hpp>
 #include <llarp/ev/vpn.hpp>
+#include <llarp/net/address_allocator.hpp>
 #include <llarp/net/ip.hpp>
 #include <llarp/net/ip_packet.hpp>
 #include <llarp/net/net.hpp>
 #include <llarp/service/endpoint.hpp>
 #include <llarp/util/codel.hpp>
+#include <llarp/util/fq_codel.hpp>
 #include <llarp/util/thread/threading.hpp>
 #include <llarp/vpn/packet_router.hpp>
 
@@ -148,7 +150,7 @@ namespace llarp
       bool
       HasAddress(const AlignedBuffer<32>& addr) const
       {
-        return m_AddrToIP.find(addr) != m_AddrToIP.end();
+        return m_AddrAlloc.FindIP(addr).has_value();
       }
 
       /// get ip address for key unconditionally
@@ -170,8 +172,18 @@ namespace llarp
           net::IPPacket::CompareOrder,
           net::IPPacket::GetNow>;
 
-      /// queue for sending packets over the network from us
-      PacketQueue_t m_UserToNetworkPktQueue;
+      using FlowQueue_t = llarp::util::FQCoDelQueue<
+          net::IPPacket,
+          net::IPPacket::GetTime,
+          net::IPPacket::PutTime,
+          net::IPPacket::GetSize,
+          net::IPPacket::FlowHash,
+          net::IPPacket::GetNow>;
+
+      /// queue for sending packets over the network from us, Configure sets one of these two
+      /// depending on whether we queue per flow
+      std::unique_ptr<PacketQueue_t> m_UserToNetworkPktQueue;
+      std::unique_ptr<FlowQueue_t> m_UserToNetworkFlowQueue;
 
       struct WritePacket
       {
@@ -203,14 +215,13 @@ namespace llarp
       virtual void
       FlushSend();
 
-      /// maps ip to key (host byte order)
-      std::unordered_map<huint128_t, AlignedBuffer<32>> m_IPToAddr;
-      /// maps key to ip (host byte order)
-      std::unordered_map<AlignedBuffer<32>, huint128_t> m_AddrToIP;
+      /// kinds of key we keep in m_AddrAlloc
+      static constexpr uint8_t eAddrKindService = 0;
+      static constexpr uint8_t eAddrKindSNode = 1;
 
-      /// maps key to true if key is a service node, maps key to false if key is
-      /// a hidden service
-      std::unordered_map<AlignedBuffer<32>, bool> m_SNodes;
+      /// maps ip to key and key to ip (host byte order), tracks address activity and hands out
+      /// and reclaims addresses in our range
+      net::AddressAllocator m_AddrAlloc;
 
      private:
       template <typename Addr_t, typename Endpoint_t>
@@ -235,17 +246,13 @@ namespace llarp
       /// our dns resolver
       std::shared_ptr<dns::PacketHandler> m_Resolver;
 
-      /// maps ip address to timestamp last active
-      std::unordered_map<huint128_t, llarp_time_t> m_IPActivity;
       /// our ip address (host byte order)
       huint128_t m_OurIP;
       /// our network interface's ipv6 address
       huint128_t m_OurIPv6;
 
-      /// next ip address to allocate (host byte order)
-      huint128_t m_NextIP;
-      /// highest ip address to allocate (host byte order)
-      huint128_t m_MaxIP;
+      /// file we persist address mappings to, if any
+      std::optional<fs::path> m_PersistAddrMapFile;
       /// our ip range we are using
       llarp::IPRange m_OurRange;
       /// upstream dns resolver list
@@ -265,6 +272,8 @@ namespace llarp
       std::unique_ptr<vpn::PacketRouter> m_PacketRouter;
 
       std::optional<net::TrafficPolicy> m_TrafficPolicy;
+      /// m_TrafficPolicy flattened for per packet checks
+      std::optional<net::CompiledTrafficPolicy> m_CompiledTrafficPolicy;
       /// ranges we advetise as reachable
       std::set<IPRange> m_OwnedRanges;
     };
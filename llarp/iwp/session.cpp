@@ -3,6 +3,10 @@
 #include <llarp/messages/link_intro.hpp>
 #include <llarp/messages/discard.hpp>
 #include <llarp/util/meta/memfn.hpp>
+#include <llarp/util/metrics.hpp>
+#include <llarp/util/instrument.hpp>
+
+#include <algorithm>
 
 namespace llarp
 {
@@ -145,20 +149,28 @@ namespace llarp
     void
     Session::EncryptWorker(CryptoQueue_t msgs)
     {
+      LLARP_ZONE();
       LogTrace("encrypt worker ", msgs.size(), " messages");
+      // encrypt then mac every packet of the batch at once so the crypto can be done many
+      // packets wide
+      std::vector<XChaCha20Job> ciphers;
+      std::vector<HMACJob> macs;
+      ciphers.reserve(msgs.size());
+      macs.reserve(msgs.size());
       for (auto& pkt : msgs)
       {
-        llarp_buffer_t pktbuf{pkt};
-        const TunnelNonce nonce_ptr{pkt.data() + HMACSIZE};
-        pktbuf.base += PacketOverhead;
-        pktbuf.cur = pktbuf.base;
-        pktbuf.sz -= PacketOverhead;
-        CryptoManager::instance()->xchacha20(pktbuf, m_SessionKey, nonce_ptr);
-        pktbuf.base = pkt.data() + HMACSIZE;
-        pktbuf.sz = pkt.size() - HMACSIZE;
-        CryptoManager::instance()->hmac(pkt.data(), pktbuf, m_SessionKey);
-        Send_LL(pkt.data(), pkt.size());
+        ciphers.push_back(
+            {pkt.data() + PacketOverhead,
+             pkt.size() - PacketOverhead,
+             &m_SessionKey,
+             TunnelNonce{pkt.data() + HMACSIZE}});
+        macs.push_back(
+            {pkt.data(), pkt.data() + HMACSIZE, pkt.size() - HMACSIZE, &m_SessionKey});
       }
+      CryptoManager::instance()->xchacha20_batch(ciphers.data(), ciphers.size());
+      CryptoManager::instance()->hmac_batch(macs.data(), macs.size());
+      for (auto& pkt : msgs)
+        Send_LL(pkt.data(), pkt.size());
     }
 
     void
@@ -180,6 +192,8 @@ namespace llarp
     {
       if (m_TXMsgs.size() >= MaxSendQueueSize)
       {
+        static auto& dropped = metrics::Drops("iwp_send_queue_full");
+        dropped.Add();
         if (completed)
           completed(ILinkSession::DeliveryStatus::eDeliveryDropped);
         return false;
@@ -227,6 +241,7 @@ namespace llarp
     void
     Session::Pump()
     {
+      LLARP_ZONE();
       const auto now = m_Parent->Now();
       if (m_State == State::Ready || m_State == State::LinkIntro)
       {
@@ -312,6 +327,7 @@ namespace llarp
           {"txPktsAcked", m_Stats.totalAckedTX},
           {"txPktsDropped", m_Stats.totalDroppedTX},
           {"txPktsInFlight", m_Stats.totalInFlightTX},
+          {"rtt", to_json(m_Stats.smoothedRTT)},
 
           {"state", StateToString(m_State)},
           {"inbound", m_Inbound},
@@ -610,26 +626,76 @@ namespace llarp
     void
     Session::DecryptWorker(CryptoQueue_t msgs)
     {
-      auto itr = msgs.begin();
-      while (itr != msgs.end())
+      LLARP_ZONE();
+      msgs.erase(
+          std::remove_if(
+              msgs.begin(),
+              msgs.end(),
+              [&](const auto& pkt) {
+                if (pkt.size() > PacketOverhead)
+                  return false;
+                static auto& dropped = metrics::Drops("iwp_short_packet");
+                dropped.Add();
+                LogError("packet too small from ", m_RemoteAddr);
+                return true;
+              }),
+          msgs.end());
+      // verify the keyed hash of the whole batch at once, then decrypt the survivors together
+      std::vector<ShortHash> hashes(msgs.size());
+      std::vector<HMACJob> macs;
+      macs.reserve(msgs.size());
+      for (size_t idx = 0; idx < msgs.size(); ++idx)
       {
-        auto& pkt = *itr;
-        if (not DecryptMessageInPlace(pkt))
+        auto& pkt = msgs[idx];
+        macs.push_back(
+            {hashes[idx].data(), pkt.data() + HMACSIZE, pkt.size() - HMACSIZE, &m_SessionKey});
+      }
+      if (not CryptoManager::instance()->hmac_batch(macs.data(), macs.size()))
+      {
+        LogError("failed to caclulate keyed hash for ", m_RemoteAddr);
+        return;
+      }
+      CryptoQueue_t verified;
+      verified.reserve(msgs.size());
+      for (size_t idx = 0; idx < msgs.size(); ++idx)
+      {
+        if (hashes[idx] != ShortHash{msgs[idx].data()})
         {
-          itr = msgs.erase(itr);
+          static auto& dropped = metrics::Drops("iwp_bad_hmac");
+          dropped.Add();
           LogError("failed to decrypt session data from ", m_RemoteAddr);
           continue;
         }
+        verified.emplace_back(std::move(msgs[idx]));
+      }
+      std::vector<XChaCha20Job> ciphers;
+      ciphers.reserve(verified.size());
+      for (auto& pkt : verified)
+      {
+        ciphers.push_back(
+            {pkt.data() + PacketOverhead,
+             pkt.size() - PacketOverhead,
+             &m_SessionKey,
+             TunnelNonce{pkt.data() + HMACSIZE}});
+      }
+      CryptoManager::instance()->xchacha20_batch(ciphers.data(), ciphers.size());
+
+      auto itr = verified.begin();
+      while (itr != verified.end())
+      {
+        auto& pkt = *itr;
         if (pkt[PacketOverhead] != LLARP_PROTO_VERSION)
         {
+          static auto& dropped = metrics::Drops("iwp_bad_version");
+          dropped.Add();
           LogError(
               "protocol version mismatch ", int(pkt[PacketOverhead]), " != ", LLARP_PROTO_VERSION);
-          itr = msgs.erase(itr);
+          itr = verified.erase(itr);
           continue;
         }
         ++itr;
       }
-      m_PlaintextRecv.tryPushBack(std::move(msgs));
+      m_PlaintextRecv.tryPushBack(std::move(verified));
       m_Parent->WakeupPlaintext();
     }
 
@@ -699,6 +765,7 @@ namespace llarp
         {
           m_Stats.totalAckedTX++;
           m_Stats.totalInFlightTX--;
+          RecordAckTime(itr->second.m_StartedAt);
           itr->second.Completed();
           m_TXMsgs.erase(itr);
         }
@@ -711,6 +778,23 @@ namespace llarp
       }
     }
 
+    void
+    Session::RecordAckTime(llarp_time_t sentAt)
+    {
+      static auto& ackTime = metrics::Registry::Global().GetLatency(
+          "lokinet_iwp_ack_seconds", "time from sending a link message to it being fully acked");
+      const auto now = m_Parent->Now();
+      if (now < sentAt)
+        return;
+      const auto rtt = now - sentAt;
+      ackTime.Record(rtt);
+      // same gain as tcp's srtt
+      if (m_Stats.smoothedRTT == 0s)
+        m_Stats.smoothedRTT = rtt;
+      else
+        m_Stats.smoothedRTT = (m_Stats.smoothedRTT * 7 + rtt) / 8;
+    }
+
     void
     Session::HandleNACK(Packet_t data)
     {
@@ -871,6 +955,7 @@ namespace llarp
       if (itr->second.IsTransmitted())
       {
         LogDebug("sent message ", itr->first, " to ", m_RemoteAddr);
+        RecordAckTime(itr->second.m_StartedAt);
         itr->second.Completed();
         itr = m_TXMsgs.erase(itr);
       }
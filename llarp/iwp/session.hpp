@@ -265,6 +265,10 @@ namespace llarp
 
       void
       HandleMACK(Packet_t msg);
+
+      /// account for how long an outbound message took to be fully acked
+      void
+      RecordAckTime(llarp_time_t sentAt);
     };
   }  // namespace iwp
 }  // namespace llarp
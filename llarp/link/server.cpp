@@ -129,8 +129,17 @@ namespace llarp
   ILinkLayer::Configure(EventLoop_ptr loop, const std::string& ifname, int af, uint16_t port)
   {
     m_Loop = std::move(loop);
+    auto& registry = metrics::Registry::Global();
+    const metrics::Labels tx{{"link", Name()}, {"direction", "tx"}};
+    const metrics::Labels rx{{"link", Name()}, {"direction", "rx"}};
+    m_TXPackets = &registry.GetCounter("lokinet_link_packets", "link layer packets", tx);
+    m_TXBytes = &registry.GetCounter("lokinet_link_bytes", "link layer bytes", tx);
+    m_RXPackets = &registry.GetCounter("lokinet_link_packets", "link layer packets", rx);
+    m_RXBytes = &registry.GetCounter("lokinet_link_bytes", "link layer bytes", rx);
     m_udp = m_Loop->make_udp(
         [this]([[maybe_unused]] UDPHandle& udp, const SockAddr& from, llarp_buffer_t buf) {
+          m_RXPackets->Add();
+          m_RXBytes->Add(buf.sz);
           ILinkSession::Packet_t pkt;
           pkt.resize(buf.sz);
           std::copy_n(buf.base, buf.sz, pkt.data());
@@ -429,6 +438,12 @@ namespace llarp
   void
   ILinkLayer::SendTo_LL(const SockAddr& to, const llarp_buffer_t& pkt)
   {
+    // the counters are only picked once we are configured
+    if (m_TXPackets)
+    {
+      m_TXPackets->Add();
+      m_TXBytes->Add(pkt.sz);
+    }
     m_udp->send(to, pkt);
   }
 
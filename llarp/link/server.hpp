@@ -5,6 +5,7 @@
 #include "session.hpp"
 #include <llarp/net/sock_addr.hpp>
 #include <llarp/router_contact.hpp>
+#include <llarp/util/metrics.hpp>
 #include <llarp/util/status.hpp>
 #include <llarp/util/thread/threading.hpp>
 #include <llarp/config/key_manager.hpp>
@@ -255,6 +256,12 @@ namespace llarp
 
    private:
     std::shared_ptr<int> m_repeater_keepalive;
+
+    /// packets and bytes on the wire for links of our kind, set up in Configure
+    metrics::Counter* m_TXPackets = nullptr;
+    metrics::Counter* m_TXBytes = nullptr;
+    metrics::Counter* m_RXPackets = nullptr;
+    metrics::Counter* m_RXBytes = nullptr;
   };
 
   using LinkLayer_ptr = std::shared_ptr<ILinkLayer>;
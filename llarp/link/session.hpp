@@ -25,6 +25,9 @@ namespace llarp
     uint64_t totalAckedTX = 0;
     uint64_t totalDroppedTX = 0;
     uint64_t totalInFlightTX = 0;
+
+    /// smoothed time from sending a message to it being fully acked, 0s until one is
+    llarp_time_t smoothedRTT = 0s;
   };
 
   struct ILinkSession
@@ -8,8 +8,14 @@
 #include <llarp/router/abstractrouter.hpp>
 #include <llarp/service/context.hpp>
 #include <llarp/quic/tunnel.hpp>
+#include <llarp/handlers/null.hpp>
+#include <llarp/net/ip_packet.hpp>
 #include <llarp/nodedb.hpp>
 
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
 
 #ifdef _WIN32
@@ -74,6 +80,125 @@ struct lokinet_context
   {
     streams[id] = false;
   }
+
+  /// a stream the application reads and writes through callbacks
+  struct native_stream
+  {
+    int id;
+    lokinet_stream_callbacks callbacks;
+    std::weak_ptr<llarp::quic::Stream> stream;
+    /// set while the stream has too much data queued or in flight to take more
+    std::atomic<bool> congested{false};
+    /// bytes lokinet_stream_send took that the event loop has not appended to the stream yet
+    std::atomic<size_t> queued{0};
+  };
+
+  /// guards native_streams, apart from m_access as it is taken from the event loop
+  std::mutex m_native_access;
+  std::unordered_map<int, std::shared_ptr<native_stream>> native_streams;
+  int next_native_stream_id = 1;
+
+  std::shared_ptr<native_stream>
+  new_native_stream(const lokinet_stream_callbacks& callbacks)
+  {
+    std::unique_lock lock{m_native_access};
+    auto st = std::make_shared<native_stream>();
+    st->id = next_native_stream_id++;
+    st->callbacks = callbacks;
+    native_streams.emplace(st->id, st);
+    return st;
+  }
+
+  std::shared_ptr<native_stream>
+  find_native_stream(int id)
+  {
+    std::unique_lock lock{m_native_access};
+    if (auto itr = native_streams.find(id); itr != native_streams.end())
+      return itr->second;
+    return nullptr;
+  }
+
+  void
+  forget_native_stream(int id)
+  {
+    std::unique_lock lock{m_native_access};
+    native_streams.erase(id);
+  }
+
+  /// a udp socket made by lokinet_udp_establish or lokinet_udp_bind
+  struct udp_socket
+  {
+    int id;
+    /// the port we take packets on, the exposed port of a bound socket or the local port of a
+    /// flow
+    uint16_t port;
+    /// set for a flow, the only remote it talks to, on the convo tag we got for it
+    std::optional<llarp::EndpointBase::AddressVariant_t> remote;
+    uint16_t remote_port = 0;
+    llarp::service::ConvoTag tag;
+    /// convo tags of the remotes that sent to a bound socket, to send replies on
+    std::unordered_map<std::string, llarp::service::ConvoTag> peers;
+    /// the srv record a bound socket added
+    std::optional<llarp::dns::SRVData> srv;
+
+    struct datagram
+    {
+      std::string remote;
+      int port;
+      std::vector<byte_t> data;
+    };
+    std::deque<datagram> recvq;
+  };
+
+  /// datagrams we hold per socket until they are read, more are dropped
+  static constexpr size_t udp_max_queued = 1024;
+
+  /// guards the udp sockets and their queues, taken from the event loop
+  std::mutex m_udp_access;
+  /// signalled when a datagram is queued or a socket closed
+  std::condition_variable m_udp_cond;
+  std::unordered_map<int, std::shared_ptr<udp_socket>> udp_sockets;
+  int next_udp_socket_id = 1;
+  uint16_t next_udp_port = 49152;
+
+  /// must hold m_udp_access
+  std::shared_ptr<udp_socket>
+  find_udp_socket(int id) const
+  {
+    if (auto itr = udp_sockets.find(id); itr != udp_sockets.end())
+      return itr->second;
+    return nullptr;
+  }
+
+  /// the socket that takes datagrams sent to port by remote, must hold m_udp_access
+  std::shared_ptr<udp_socket>
+  udp_socket_for(uint16_t port, const llarp::EndpointBase::AddressVariant_t& remote) const
+  {
+    for (const auto& [id, sock] : udp_sockets)
+    {
+      if (sock->port == port and (not sock->remote or *sock->remote == remote))
+        return sock;
+    }
+    return nullptr;
+  }
+
+  /// give sock an id and keep it, picking an unused ephemeral port for it if it has none. must
+  /// hold m_udp_access
+  void
+  add_udp_socket(const std::shared_ptr<udp_socket>& sock)
+  {
+    while (sock->port == 0)
+    {
+      const auto port = next_udp_port;
+      next_udp_port = next_udp_port == 65535 ? 49152 : next_udp_port + 1;
+      if (std::none_of(udp_sockets.begin(), udp_sockets.end(), [port](const auto& item) {
+            return item.second->port == port;
+          }))
+        sock->port = port;
+    }
+    sock->id = next_udp_socket_id++;
+    udp_sockets.emplace(sock->id, sock);
+  }
 };
 
 namespace
@@ -119,6 +244,124 @@ namespace
       return {host, std::stoi(portStr)};
   }
 
+  /// report the outcome of opening a native stream, forgetting it if it failed
+  void
+  native_stream_opened(
+      lokinet_context* ctx, const std::shared_ptr<lokinet_context::native_stream>& st, int err)
+  {
+    if (err)
+      ctx->forget_native_stream(st->id);
+    if (st->callbacks.on_open)
+      st->callbacks.on_open(st->id, err, st->callbacks.user);
+  }
+
+  /// hand the data and close events of a quic stream to the application's callbacks
+  void
+  attach_native_stream(
+      lokinet_context* ctx,
+      const std::shared_ptr<lokinet_context::native_stream>& st,
+      llarp::quic::Stream& stream)
+  {
+    st->stream = stream.weak_from_this();
+    stream.data_callback = [st](auto&, llarp::quic::bstring_view data) {
+      if (st->callbacks.on_data)
+        st->callbacks.on_data(st->id, data.data(), data.size(), st->callbacks.user);
+    };
+    stream.close_callback = [ctx, st](auto&, std::optional<uint64_t> error_code) {
+      ctx->forget_native_stream(st->id);
+      if (st->callbacks.on_close)
+        st->callbacks.on_close(st->id, error_code ? ECONNRESET : 0, st->callbacks.user);
+    };
+  }
+
+  /// called from the event loop once a native stream is congested, calls on_writable as soon as
+  /// the stream has room to take more
+  void
+  native_stream_wait_writable(
+      const std::shared_ptr<lokinet_context::native_stream>& st, llarp::quic::Stream& stream)
+  {
+    const auto writable = [st](llarp::quic::Stream& s) {
+      if (s.used() >= llarp::quic::tunnel::PAUSE_SIZE)
+        return false;
+      st->congested = false;
+      if (st->callbacks.on_writable)
+        st->callbacks.on_writable(st->id, st->callbacks.user);
+      return true;
+    };
+    if (not writable(stream))
+      stream.when_available(writable);
+  }
+
+  /// queue an inbound udp datagram on the socket it was sent to, called from the event loop
+  bool
+  udp_deliver(
+      lokinet_context* ctx,
+      const llarp::service::Endpoint& ep,
+      llarp::service::ConvoTag tag,
+      const llarp_buffer_t& buf)
+  {
+    llarp::net::IPPacket pkt;
+    if (not pkt.Load(buf) or not pkt.IsV4()
+        or llarp::net::IPProtocol{pkt.Header()->protocol} != llarp::net::IPProtocol::UDP)
+      return false;
+    const size_t offset = pkt.Header()->ihl * 4 + 8;
+    auto remote = ep.GetEndpointWithConvoTag(tag);
+    if (pkt.sz < offset or not remote)
+      return false;
+    const auto srcport = ToHost(*pkt.SrcPort()).h;
+    const auto dstport = ToHost(*pkt.DstPort()).h;
+
+    std::unique_lock lock{ctx->m_udp_access};
+    auto sock = ctx->udp_socket_for(dstport, *remote);
+    if (not sock)
+      return false;
+    auto remoteStr = var::visit([](auto&& addr) { return addr.ToString(); }, *remote);
+    if (not sock->remote)
+      sock->peers[remoteStr] = tag;
+    if (sock->recvq.size() >= lokinet_context::udp_max_queued)
+    {
+      llarp::LogDebug("udp socket ", sock->id, " is full, dropping datagram");
+      return true;
+    }
+    sock->recvq.push_back(
+        {std::move(remoteStr), srcport, std::vector<byte_t>{pkt.buf + offset, pkt.buf + pkt.sz}});
+    ctx->m_udp_cond.notify_all();
+    return true;
+  }
+
+  /// route the inbound traffic of our endpoint to the udp sockets, called from the event loop.
+  /// returns false if the endpoint cannot do udp.
+  bool
+  udp_attach(lokinet_context* ctx, const std::shared_ptr<llarp::service::Endpoint>& ep)
+  {
+    auto* null = dynamic_cast<llarp::handlers::NullEndpoint*>(ep.get());
+    if (null == nullptr)
+      return false;
+    if (not null->m_TrafficHandler)
+      null->m_TrafficHandler = [ctx, null](auto tag, const auto& buf) {
+        return udp_deliver(ctx, *null, tag, buf);
+      };
+    return true;
+  }
+
+  /// the srv record to use out of the ones a remote published, the lowest priority with the
+  /// highest weight
+  std::optional<llarp::dns::SRVData>
+  pick_srv(const std::vector<llarp::dns::SRVData>& records)
+  {
+    std::optional<llarp::dns::SRVData> best;
+    for (const auto& record : records)
+    {
+      // a lone dot says there is no such service
+      if (record.target == ".")
+        continue;
+      if (not best or record.priority < best->priority
+          or (record.priority == best->priority and record.weight > best->weight))
+        best = record;
+    }
+    return best;
+  }
+
   int
   accept_port(const char* remote, uint16_t port, void* ptr)
   {
@@ -133,10 +376,17 @@ namespace
   std::optional<lokinet_srv_record>
   SRVFromData(const llarp::dns::SRVData& data, std::string name)
   {
-    // TODO: implement me
-    (void)data;
-    (void)name;
-    return std::nullopt;
+    // a lone dot says there is no such service
+    if (data.target == ".")
+      return std::nullopt;
+    // an empty target refers to the name we looked up
+    const auto& target = data.target.empty() ? name : data.target;
+    lokinet_srv_record record{};
+    record.priority = data.priority;
+    record.weight = data.weight;
+    record.port = data.port;
+    std::copy_n(target.c_str(), std::min(target.size(), sizeof(record.target) - 1), record.target);
+    return record;
   }
 
 }  // namespace
@@ -564,6 +814,522 @@ extern "C"
     {}
   }
 
+  int
+  lokinet_stream_connect(
+      const char* remote,
+      const struct lokinet_stream_callbacks* callbacks,
+      struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr or remote == nullptr or callbacks == nullptr)
+      return -1;
+    std::string remotehost;
+    int remoteport;
+    try
+    {
+      auto [h, p] = split_host_port(remote);
+      remotehost = h;
+      remoteport = p;
+    }
+    catch (...)
+    {
+      return -1;
+    }
+
+    auto lock = ctx->acquire();
+    if (not ctx->impl->IsUp())
+      return -1;
+    auto st = ctx->new_native_stream(*callbacks);
+    ctx->impl->CallSafe([ctx, st, remotehost, remoteport]() {
+      auto ep = ctx->endpoint();
+      auto* quic = ep ? ep->GetQUICTunnel() : nullptr;
+      if (quic == nullptr)
+      {
+        native_stream_opened(ctx, st, ENOTSUP);
+        return;
+      }
+      try
+      {
+        quic->open_stream(remotehost, remoteport, [ctx, st](auto stream) {
+          if (not stream)
+          {
+            native_stream_opened(ctx, st, ECONNREFUSED);
+            return;
+          }
+          attach_native_stream(ctx, st, *stream);
+          native_stream_opened(ctx, st, 0);
+        });
+      }
+      catch (std::exception& ex)
+      {
+        llarp::LogWarn("cannot open stream to ", remotehost, ": ", ex.what());
+        native_stream_opened(ctx, st, EINVAL);
+      }
+    });
+    return st->id;
+  }
+
+  int
+  lokinet_inbound_stream_callbacks(
+      lokinet_stream_filter acceptFilter,
+      void* user,
+      const struct lokinet_stream_callbacks* callbacks,
+      struct lokinet_context* ctx)
+  {
+    if (acceptFilter == nullptr)
+    {
+      acceptFilter = [](auto, auto, auto) { return 0; };
+    }
+    if (not ctx or not callbacks)
+      return -1;
+    std::promise<int> promise;
+    {
+      auto lock = ctx->acquire();
+      if (not ctx->impl->IsUp())
+      {
+        return -1;
+      }
+
+      ctx->impl->CallSafe([ctx, acceptFilter, user, callbacks = *callbacks, &promise]() {
+        auto ep = ctx->endpoint();
+        auto* quic = ep ? ep->GetQUICTunnel() : nullptr;
+        if (quic == nullptr)
+        {
+          promise.set_value(-1);
+          return;
+        }
+        auto id = quic->listen_streams(
+            [ctx, acceptFilter, user, callbacks](auto remoteAddr, auto port, auto& stream) {
+              std::string remote{remoteAddr};
+              const auto result = acceptFilter(remote.c_str(), port, user);
+              if (result == -1)
+                throw std::invalid_argument{"rejected"};
+              if (result)
+                return false;
+              auto st = ctx->new_native_stream(callbacks);
+              attach_native_stream(ctx, st, stream);
+              native_stream_opened(ctx, st, 0);
+              return true;
+            });
+        promise.set_value(id);
+      });
+    }
+    auto id = promise.get_future().get();
+    if (id > 0)
+    {
+      auto lock = ctx->acquire();
+      ctx->inbound_stream(id);
+    }
+    return id;
+  }
+
+  int
+  lokinet_stream_send(int stream_id, const void* data, size_t len, struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr or (data == nullptr and len > 0))
+      return EINVAL;
+    // no context lock here, this is meant to be called from the stream callbacks too
+    auto st = ctx->find_native_stream(stream_id);
+    if (st == nullptr or st->stream.expired())
+      return ENOTCONN;
+    if (st->congested)
+      return EAGAIN;
+    if (len == 0)
+      return 0;
+    // counted here as the event loop may not get to the appends before the caller sends again
+    if (st->queued >= llarp::quic::tunnel::PAUSE_SIZE)
+    {
+      // runs after the queued appends so on_writable waits on them reaching the stream
+      if (not st->congested.exchange(true))
+      {
+        ctx->impl->CallSafe([st]() {
+          if (auto stream = st->stream.lock(); stream and not stream->closing())
+            native_stream_wait_writable(st, *stream);
+        });
+      }
+      return EAGAIN;
+    }
+    st->queued += len;
+    // the stream takes ownership of the buffer and frees it once the remote acked it
+    auto buf = std::make_shared<std::unique_ptr<std::byte[]>>(new std::byte[len]);
+    std::memcpy(buf->get(), data, len);
+    ctx->impl->CallSafe([st, buf, len]() {
+      st->queued -= len;
+      auto stream = st->stream.lock();
+      if (not stream or stream->closing())
+        return;
+      stream->append_buffer(buf->release(), len);
+      if (stream->used() < llarp::quic::tunnel::PAUSE_SIZE or st->congested.exchange(true))
+        return;
+      native_stream_wait_writable(st, *stream);
+    });
+    return 0;
+  }
+
+  void
+  lokinet_stream_close(int stream_id, struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr)
+      return;
+    if (auto st = ctx->find_native_stream(stream_id))
+    {
+      ctx->impl->CallSafe([st]() {
+        if (auto stream = st->stream.lock())
+          stream->close();
+      });
+    }
+  }
+
+  int
+  lokinet_udp_establish(
+      char* remoteHost,
+      char* remotePort,
+      char* localAddr,
+      struct lokinet_udp_flow* flow,
+      struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr or remoteHost == nullptr or remotePort == nullptr or flow == nullptr)
+      return EINVAL;
+    if (localAddr)
+      return ENOTSUP;
+    const std::string_view portStr{remotePort};
+    std::optional<uint16_t> port;
+    if (uint16_t val; std::from_chars(portStr.data(), portStr.data() + portStr.size(), val).ptr
+                      == portStr.data() + portStr.size()
+                      and val > 0)
+      port = val;
+    else if (portStr.empty())
+      return EINVAL;
+
+    auto sock = std::make_shared<lokinet_context::udp_socket>();
+    auto promise = std::make_shared<std::promise<int>>();
+    auto future = promise->get_future();
+    // the lookups may call back more than once, or not at all and tell us so, only take the first
+    // outcome
+    auto finish = [promise, done = std::make_shared<bool>(false)](int err) {
+      if (std::exchange(*done, true))
+        return;
+      promise->set_value(err);
+    };
+    {
+      auto lock = ctx->acquire();
+      if (not ctx->impl->IsUp())
+        return EHOSTDOWN;
+      ctx->impl->CallSafe([ctx,
+                           sock,
+                           host = std::string{remoteHost},
+                           service = "_" + std::string{portStr} + "._udp",
+                           port,
+                           finish]() {
+        auto ep = ctx->endpoint();
+        if (ep == nullptr or not udp_attach(ctx, ep))
+        {
+          finish(ENOTSUP);
+          return;
+        }
+        auto withAddr = [ep, sock, finish](auto maybe) {
+          if (not maybe)
+          {
+            finish(EHOSTUNREACH);
+            return;
+          }
+          sock->remote = *maybe;
+          const bool pending = ep->EnsurePathTo(
+              *maybe,
+              [sock, finish](auto maybe_tag) {
+                if (maybe_tag)
+                  sock->tag = *maybe_tag;
+                finish(maybe_tag ? 0 : EHOSTUNREACH);
+              },
+              5s);
+          if (not pending)
+            finish(EHOSTUNREACH);
+        };
+        auto withPort = [ep, sock, withAddr](const std::string& host, uint16_t port) {
+          sock->remote_port = port;
+          if (auto maybe = llarp::service::ParseAddress(host))
+            withAddr(maybe);
+          else
+            ep->LookupNameAsync(host, withAddr);
+        };
+        if (port)
+        {
+          withPort(host, *port);
+          return;
+        }
+        ep->LookupServiceAsync(host, service, [host, withPort, finish](auto records) {
+          auto srv = pick_srv(records);
+          if (not srv)
+          {
+            finish(ENOENT);
+            return;
+          }
+          // an empty target refers to the name we looked up
+          withPort(srv->target.empty() ? host : srv->target, srv->port);
+        });
+      });
+    }
+    // name lookups and the path build time out on their own, this is in case the loop never gets
+    // to them
+    int err = ETIMEDOUT;
+    try
+    {
+      if (future.wait_for(std::chrono::seconds{30}) == std::future_status::ready)
+        err = future.get();
+    }
+    catch (std::exception& ex)
+    {
+      err = EHOSTDOWN;
+    }
+    if (err)
+      return err;
+
+    std::unique_lock lock{ctx->m_udp_access};
+    ctx->add_udp_socket(sock);
+    std::memset(flow, 0, sizeof(lokinet_udp_flow));
+    flow->socket_id = sock->id;
+    const auto remote = var::visit([](auto&& addr) { return addr.ToString(); }, *sock->remote);
+    std::copy_n(
+        remote.c_str(), std::min(remote.size(), sizeof(flow->remote_addr) - 1), flow->remote_addr);
+    flow->remote_port = sock->remote_port;
+    flow->local_port = sock->port;
+    return 0;
+  }
+
+  int
+  lokinet_udp_bind(
+      int exposedPort,
+      char* srv,
+      char* localAddr,
+      struct lokinet_udp_bind_result* result,
+      struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr or result == nullptr or exposedPort <= 0 or exposedPort > 65535)
+      return EINVAL;
+    if (localAddr)
+      return ENOTSUP;
+    auto sock = std::make_shared<lokinet_context::udp_socket>();
+    sock->port = exposedPort;
+    if (srv)
+      sock->srv = llarp::dns::SRVData{"_" + std::string{srv} + "._udp", 0, 1, sock->port, ""};
+    {
+      std::unique_lock lock{ctx->m_udp_access};
+      for (const auto& [id, other] : ctx->udp_sockets)
+      {
+        if (other->port == sock->port)
+          return EADDRINUSE;
+      }
+      ctx->add_udp_socket(sock);
+    }
+
+    // shared as the loop may still get to it after we gave up waiting
+    auto promise = std::make_shared<std::promise<int>>();
+    auto future = promise->get_future();
+    {
+      auto lock = ctx->acquire();
+      if (not ctx->impl->IsUp())
+        promise->set_value(EHOSTDOWN);
+      else
+        ctx->impl->CallSafe([ctx, sock, promise]() {
+          auto ep = ctx->endpoint();
+          if (ep == nullptr or not udp_attach(ctx, ep))
+          {
+            promise->set_value(ENOTSUP);
+            return;
+          }
+          if (sock->srv)
+          {
+            // we may have timed out and closed it already
+            std::unique_lock lock{ctx->m_udp_access};
+            if (not ctx->find_udp_socket(sock->id))
+            {
+              promise->set_value(EBADF);
+              return;
+            }
+            ep->PutSRVRecord(*sock->srv);
+          }
+          promise->set_value(0);
+        });
+    }
+    int err = ETIMEDOUT;
+    try
+    {
+      if (future.wait_for(std::chrono::seconds{10}) == std::future_status::ready)
+        err = future.get();
+    }
+    catch (std::exception& ex)
+    {
+      err = EHOSTDOWN;
+    }
+    if (err)
+    {
+      std::unique_lock lock{ctx->m_udp_access};
+      ctx->udp_sockets.erase(sock->id);
+      return err;
+    }
+    result->socket_id = sock->id;
+    return 0;
+  }
+
+  void
+  lokinet_udp_close(int socket_id, struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr)
+      return;
+    std::shared_ptr<lokinet_context::udp_socket> sock;
+    {
+      std::unique_lock lock{ctx->m_udp_access};
+      sock = ctx->find_udp_socket(socket_id);
+      if (not sock)
+        return;
+      ctx->udp_sockets.erase(socket_id);
+      ctx->m_udp_cond.notify_all();
+    }
+    if (sock->srv and ctx->impl->IsUp())
+    {
+      ctx->impl->CallSafe([ctx, srv = *sock->srv]() {
+        if (auto ep = ctx->endpoint())
+          ep->DelSRVRecordIf([&srv](const auto& other) { return other == srv; });
+      });
+    }
+  }
+
+  int
+  lokinet_udp_poll(
+      const int* socket_ids,
+      size_t numsockets,
+      const struct timespec* timeout,
+      struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr or (socket_ids == nullptr and numsockets > 0))
+      return EINVAL;
+    int result = ETIMEDOUT;
+    const auto ready = [&]() {
+      for (size_t idx = 0; idx < numsockets; ++idx)
+      {
+        auto sock = ctx->find_udp_socket(socket_ids[idx]);
+        if (not sock)
+          result = EBADF;
+        else if (not sock->recvq.empty())
+          result = 0;
+        else
+          continue;
+        return true;
+      }
+      return false;
+    };
+    std::unique_lock lock{ctx->m_udp_access};
+    if (timeout == nullptr)
+      ctx->m_udp_cond.wait(lock, ready);
+    else
+      ctx->m_udp_cond.wait_for(
+          lock,
+          std::chrono::seconds{timeout->tv_sec} + std::chrono::nanoseconds{timeout->tv_nsec},
+          ready);
+    return result;
+  }
+
+  ssize_t
+  lokinet_udp_recvmmsg(
+      int socket_id,
+      struct lokinet_udp_pkt* events,
+      size_t max_events,
+      struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr or (events == nullptr and max_events > 0))
+      return -1;
+    std::unique_lock lock{ctx->m_udp_access};
+    auto sock = ctx->find_udp_socket(socket_id);
+    if (not sock)
+      return -1;
+    size_t num = 0;
+    for (; num < max_events and not sock->recvq.empty(); ++num)
+    {
+      const auto& datagram = sock->recvq.front();
+      auto& event = events[num];
+      std::memset(event.remote_addr, 0, sizeof(event.remote_addr));
+      std::copy_n(
+          datagram.remote.c_str(),
+          std::min(datagram.remote.size(), sizeof(event.remote_addr) - 1),
+          event.remote_addr);
+      event.remote_port = datagram.port;
+      event.pkt.iov_len = std::min(event.pkt.iov_len, datagram.data.size());
+      std::copy_n(
+          datagram.data.data(), event.pkt.iov_len, static_cast<byte_t*>(event.pkt.iov_base));
+      sock->recvq.pop_front();
+    }
+    return num;
+  }
+
+  ssize_t
+  lokinet_udp_sendmmsg(
+      int socket_id,
+      const struct lokinet_udp_pkt* events,
+      size_t num_events,
+      struct lokinet_context* ctx)
+  {
+    if (ctx == nullptr or (events == nullptr and num_events > 0))
+      return -1;
+    std::shared_ptr<lokinet_context::udp_socket> sock;
+    {
+      std::unique_lock lock{ctx->m_udp_access};
+      sock = ctx->find_udp_socket(socket_id);
+    }
+    if (not sock)
+      return -1;
+    // build the packets here so the event loop only has to send them, the whole batch at once
+    auto batch = std::make_shared<std::vector<std::pair<std::string, llarp::net::IPPacket>>>();
+    batch->reserve(num_events);
+    for (size_t idx = 0; idx < num_events; ++idx)
+    {
+      const auto& event = events[idx];
+      const uint16_t dstport = sock->remote ? sock->remote_port : event.remote_port;
+      auto pkt = llarp::net::IPPacket::UDP(
+          llarp::nuint32_t{0},
+          llarp::ToNet(llarp::huint16_t{sock->port}),
+          llarp::nuint32_t{0},
+          llarp::ToNet(llarp::huint16_t{dstport}),
+          llarp_buffer_t{static_cast<const byte_t*>(event.pkt.iov_base), event.pkt.iov_len});
+      // too big to fit in one packet
+      if (pkt.sz == 0)
+        continue;
+      batch->emplace_back(sock->remote ? std::string{} : std::string{event.remote_addr}, pkt);
+    }
+    if (not ctx->impl->IsUp())
+      return 0;
+    ctx->impl->CallSafe([ctx, sock, batch]() {
+      auto ep = ctx->endpoint();
+      if (ep == nullptr)
+        return;
+      // a flow follows the remote to whichever convo tag is best now
+      if (sock->remote)
+      {
+        if (auto maybe = ep->GetBestConvoTagFor(*sock->remote))
+          sock->tag = *maybe;
+      }
+      std::vector<std::optional<llarp::service::ConvoTag>> tags;
+      {
+        std::unique_lock lock{ctx->m_udp_access};
+        for (const auto& [remote, pkt] : *batch)
+        {
+          if (sock->remote)
+            tags.emplace_back(sock->tag);
+          else if (auto itr = sock->peers.find(remote); itr != sock->peers.end())
+            tags.emplace_back(itr->second);
+          else
+            tags.emplace_back();
+        }
+      }
+      // sending to ourselves delivers inline, so not under the udp lock
+      for (size_t idx = 0; idx < batch->size(); ++idx)
+      {
+        const auto& pkt = (*batch)[idx].second;
+        if (tags[idx])
+          ep->SendToOrQueue(*tags[idx], pkt.ConstBuffer(), llarp::service::ProtocolType::TrafficV4);
+      }
+    });
+    return batch->size();
+  }
+
   int
   lokinet_srv_lookup(
       char* host,
@@ -186,6 +186,9 @@ namespace llarp
 
     const std::optional<IpAddress> fromAddr;
 
+    /// admitted while too many path builds were waiting, only answer with a congestion status
+    bool congested = false;
+
     LRCMFrameDecrypt(Context* ctx, Decrypter_ptr dec, const LR_CommitMessage* commit)
         : decrypter(std::move(dec))
         , frames(commit->frames)
@@ -396,6 +399,20 @@ namespace llarp
         self->decrypter = nullptr;
         return;
       }
+      if (self->congested)
+      {
+        // we have the path key now so we can tell them to back off rather than leave them to
+        // time out
+        llarp::LogDebug("LRCM refused, too many path builds pending ", info);
+        OnForwardLRCMResult(
+            self->context->Router(),
+            info.rxID,
+            info.downstream,
+            self->hop->pathKey,
+            SendStatus::Congestion);
+        self->decrypter = nullptr;
+        return;
+      }
       // generate hash of hop key for nonce mutation
       crypto->shorthash(self->hop->nonceXOR, llarp_buffer_t(self->hop->pathKey));
       if (self->record.work && self->record.work->IsValid(now))
@@ -456,15 +473,24 @@ namespace llarp
   bool
   LR_CommitMessage::AsyncDecrypt(llarp::path::PathContext* context) const
   {
+    using Admission = llarp::path::PathContext::BuildAdmission;
+    const auto admission = context->AdmitPathBuild();
+    if (admission == Admission::Drop)
+    {
+      llarp::LogDebug("dropping LRCM, too many path builds pending");
+      return true;
+    }
     auto decrypter = std::make_unique<LRCMFrameDecrypt::Decrypter>(
         context->EncryptionSecretKey(), &LRCMFrameDecrypt::HandleDecrypted);
     // copy frames so we own them
     auto frameDecrypt = std::make_shared<LRCMFrameDecrypt>(context, std::move(decrypter), this);
 
+    frameDecrypt->congested = admission == Admission::Congested;
+
     // decrypt frames async
     frameDecrypt->decrypter->AsyncDecrypt(
-        frameDecrypt->frames[0], frameDecrypt, [r = context->Router()](auto func) {
-          r->QueueWork(std::move(func));
+        frameDecrypt->frames[0], frameDecrypt, [context](auto func) {
+          context->QueuePathBuildWork(std::move(func));
         });
     return true;
   }
@@ -0,0 +1,215 @@
+#include "address_allocator.hpp"
+
+#include <llarp/util/logging/logger.hpp>
+
+#include <oxenmq/bt_serialize.h>
+
+#include <fstream>
+#include <tuple>
+
+namespace llarp::net
+{
+  void
+  AddressAllocator::Init(huint128_t first, huint128_t last)
+  {
+    m_First = first;
+    m_Last = last;
+    m_NextFresh = first;
+    m_FreshExhausted = last < first;
+    m_Released.clear();
+    m_LRU.clear();
+    m_ByIP.clear();
+    m_ByKey.clear();
+    // pinned mappings are configured ahead of the range (e.g. [network]:mapaddr) so they stay
+    for (auto itr = m_Pinned.begin(); itr != m_Pinned.end(); ++itr)
+    {
+      m_ByIP.emplace(itr->ip, itr);
+      m_ByKey.emplace(itr->key, itr);
+    }
+  }
+
+  std::optional<huint128_t>
+  AddressAllocator::FindIP(const Key_t& key) const
+  {
+    if (auto itr = m_ByKey.find(key); itr != m_ByKey.end())
+      return itr->second->ip;
+    return std::nullopt;
+  }
+
+  const AddressAllocator::Entry*
+  AddressAllocator::FindEntry(huint128_t ip) const
+  {
+    if (auto itr = m_ByIP.find(ip); itr != m_ByIP.end())
+      return &*itr->second;
+    return nullptr;
+  }
+
+  bool
+  AddressAllocator::Map(
+      huint128_t ip, const Key_t& key, uint8_t kind, bool pinned, llarp_time_t now)
+  {
+    if (m_ByIP.count(ip) or m_ByKey.count(key))
+      return false;
+    auto& list = pinned ? m_Pinned : m_LRU;
+    auto itr = list.insert(list.end(), Entry{ip, key, now, kind, pinned});
+    m_ByIP.emplace(ip, itr);
+    m_ByKey.emplace(key, itr);
+    return true;
+  }
+
+  std::optional<huint128_t>
+  AddressAllocator::TakeFree()
+  {
+    while (not m_Released.empty())
+    {
+      const auto ip = m_Released.back();
+      m_Released.pop_back();
+      if (m_ByIP.count(ip) == 0)
+        return ip;
+    }
+    while (not m_FreshExhausted)
+    {
+      const auto ip = m_NextFresh;
+      if (m_NextFresh == m_Last)
+        m_FreshExhausted = true;
+      else
+        ++m_NextFresh;
+      // skip over addresses that were explicitly mapped
+      if (m_ByIP.count(ip) == 0)
+        return ip;
+    }
+    return std::nullopt;
+  }
+
+  std::optional<huint128_t>
+  AddressAllocator::Obtain(const Key_t& key, uint8_t kind, llarp_time_t now)
+  {
+    if (auto itr = m_ByKey.find(key); itr != m_ByKey.end())
+    {
+      MarkActive(itr->second->ip, now);
+      return itr->second->ip;
+    }
+
+    if (auto maybe = TakeFree())
+    {
+      Map(*maybe, key, kind, false, now);
+      return maybe;
+    }
+
+    // we are full, reclaim the least recently active address
+    if (m_LRU.empty())
+      return std::nullopt;
+
+    auto itr = m_LRU.begin();
+    if (onEvict)
+      onEvict(*itr);
+    m_ByKey.erase(itr->key);
+    m_ByKey.emplace(key, itr);
+    itr->key = key;
+    itr->kind = kind;
+    itr->lastActive = now;
+    m_LRU.splice(m_LRU.end(), m_LRU, itr);
+    return itr->ip;
+  }
+
+  void
+  AddressAllocator::MarkActive(huint128_t ip, llarp_time_t now)
+  {
+    auto itr = m_ByIP.find(ip);
+    if (itr == m_ByIP.end())
+      return;
+    auto entry = itr->second;
+    entry->lastActive = std::max(entry->lastActive, now);
+    if (not entry->pinned)
+      m_LRU.splice(m_LRU.end(), m_LRU, entry);
+  }
+
+  void
+  AddressAllocator::Pin(huint128_t ip)
+  {
+    auto itr = m_ByIP.find(ip);
+    if (itr == m_ByIP.end() or itr->second->pinned)
+      return;
+    itr->second->pinned = true;
+    m_Pinned.splice(m_Pinned.end(), m_LRU, itr->second);
+  }
+
+  bool
+  AddressAllocator::Release(huint128_t ip)
+  {
+    auto itr = m_ByIP.find(ip);
+    if (itr == m_ByIP.end())
+      return false;
+    auto entry = itr->second;
+    m_ByKey.erase(entry->key);
+    m_ByIP.erase(itr);
+    (entry->pinned ? m_Pinned : m_LRU).erase(entry);
+    if (InRange(ip))
+      m_Released.push_back(ip);
+    return true;
+  }
+
+  using PersistedEntry_t = std::tuple<std::string, std::string, uint64_t, uint64_t>;
+
+  bool
+  AddressAllocator::Save(const fs::path& fpath) const
+  {
+    std::vector<PersistedEntry_t> entries;
+    entries.reserve(m_LRU.size());
+    for (const auto& entry : m_LRU)
+    {
+      entries.emplace_back(
+          entry.ip.ToString(),
+          std::string{reinterpret_cast<const char*>(entry.key.data()), entry.key.size()},
+          entry.kind,
+          entry.lastActive.count());
+    }
+    const auto data = oxenmq::bt_serialize(entries);
+    auto f = util::OpenFileStream<std::ofstream>(fpath, std::ios::binary);
+    if (not f or not f->is_open())
+    {
+      LogWarn("could not open ", fpath, " to save address mappings");
+      return false;
+    }
+    f->write(data.data(), data.size());
+    return true;
+  }
+
+  size_t
+  AddressAllocator::Load(const fs::path& fpath, llarp_time_t now)
+  {
+    std::string data;
+    {
+      std::ifstream f{fpath.string(), std::ios::binary};
+      if (not f.is_open())
+        return 0;
+      data.assign(std::istreambuf_iterator<char>{f}, std::istreambuf_iterator<char>{});
+    }
+    std::vector<PersistedEntry_t> entries;
+    try
+    {
+      oxenmq::bt_deserialize(data, entries);
+    }
+    catch (const oxenmq::bt_deserialize_invalid& err)
+    {
+      LogWarn("invalid address mappings in ", fpath, ": ", err.what());
+      return 0;
+    }
+    size_t loaded = 0;
+    // entries were saved least recently active first, so mapping them in order restores the
+    // eviction order
+    for (const auto& [ipstr, keystr, kind, lastActive] : entries)
+    {
+      huint128_t ip;
+      if (keystr.size() != Key_t::SIZE or not ip.FromString(ipstr) or not InRange(ip))
+        continue;
+      Key_t key{reinterpret_cast<const byte_t*>(keystr.data())};
+      // never claim to have been active in the future
+      const llarp_time_t active =
+          std::min(llarp_time_t{static_cast<llarp_time_t::rep>(lastActive)}, now);
+      if (Map(ip, key, kind, false, active))
+        loaded++;
+    }
+    return loaded;
+  }
+}  // namespace llarp::net
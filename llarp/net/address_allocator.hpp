@@ -0,0 +1,150 @@
+#pragma once
+
+#include "ip_range.hpp"
+#include "net_int.hpp"
+#include <llarp/util/aligned.hpp>
+#include <llarp/util/fs.hpp>
+#include <llarp/util/time.hpp>
+
+#include <functional>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp::net
+{
+  /// hands out ip addresses from a range to 32 byte identities (.loki addresses, router ids,
+  /// exit client keys) and reclaims the least recently active address when the range is full.
+  ///
+  /// addresses that were never handed out are tracked as a single high water mark and released
+  /// addresses go on a free list, so the allocator only uses memory for addresses that are in use
+  /// and allocation never scans the range, which matters for /8 or ipv6 ranges.  mapped addresses
+  /// are kept in an lru list; touching and evicting are both O(1).
+  class AddressAllocator
+  {
+   public:
+    using Key_t = AlignedBuffer<32>;
+
+    struct Entry
+    {
+      huint128_t ip;
+      Key_t key;
+      llarp_time_t lastActive;
+      /// caller defined kind of key, e.g. to tell router ids and .loki addresses apart
+      uint8_t kind;
+      /// pinned entries are never evicted
+      bool pinned;
+    };
+
+    /// called with the entry that is about to be evicted to make room for a new mapping
+    std::function<void(const Entry&)> onEvict;
+
+    /// set the range of allocatable addresses (inclusive); forgets all unpinned mappings
+    void
+    Init(huint128_t first, huint128_t last);
+
+    /// get the address mapped to key, does not mark it active
+    std::optional<huint128_t>
+    FindIP(const Key_t& key) const;
+
+    /// get the entry mapped to ip or nullptr if it is not mapped
+    const Entry*
+    FindEntry(huint128_t ip) const;
+
+    bool
+    HasIP(huint128_t ip) const
+    {
+      return m_ByIP.count(ip) > 0;
+    }
+
+    /// explicitly map ip to key; the ip does not need to be in the allocatable range.
+    /// returns false if the ip or the key is already mapped.
+    bool
+    Map(huint128_t ip, const Key_t& key, uint8_t kind, bool pinned, llarp_time_t now);
+
+    /// get the address for key, allocating a free one or reclaiming the least recently active one
+    /// if key has no address yet.  marks the address active.  returns nullopt if the range is full
+    /// and every address is pinned.
+    std::optional<huint128_t>
+    Obtain(const Key_t& key, uint8_t kind, llarp_time_t now);
+
+    /// mark ip as active now, moving it to the back of the eviction order
+    void
+    MarkActive(huint128_t ip, llarp_time_t now);
+
+    /// pin ip so it is never evicted
+    void
+    Pin(huint128_t ip);
+
+    /// remove the mapping for ip, returning it to the pool if it is in the allocatable range
+    bool
+    Release(huint128_t ip);
+
+    size_t
+    Size() const
+    {
+      return m_ByIP.size();
+    }
+
+    /// visit all entries, least recently active unpinned entries first then pinned entries
+    template <typename Visit_t>
+    void
+    ForEach(Visit_t&& visit) const
+    {
+      for (const auto& entry : m_LRU)
+        visit(entry);
+      for (const auto& entry : m_Pinned)
+        visit(entry);
+    }
+
+    /// the next address that has never been handed out
+    huint128_t
+    NextFresh() const
+    {
+      return m_NextFresh;
+    }
+
+    huint128_t
+    Last() const
+    {
+      return m_Last;
+    }
+
+    /// write all unpinned mappings to a file
+    bool
+    Save(const fs::path& fpath) const;
+
+    /// load mappings written by Save(); entries that are outside our range or that collide with
+    /// existing mappings are skipped.  returns the number of entries loaded.
+    size_t
+    Load(const fs::path& fpath, llarp_time_t now);
+
+   private:
+    using List_t = std::list<Entry>;
+
+    /// take an unused address from the free list or the never used part of the range
+    std::optional<huint128_t>
+    TakeFree();
+
+    bool
+    InRange(huint128_t ip) const
+    {
+      return not(ip < m_First) and not(m_Last < ip);
+    }
+
+    huint128_t m_First{0};
+    huint128_t m_Last{0};
+    /// every address in [m_NextFresh, m_Last] has never been handed out
+    huint128_t m_NextFresh{0};
+    bool m_FreshExhausted = true;
+    /// released addresses in the allocatable range
+    std::vector<huint128_t> m_Released;
+
+    /// unpinned entries, least recently active at the front
+    List_t m_LRU;
+    List_t m_Pinned;
+    std::unordered_map<huint128_t, List_t::iterator> m_ByIP;
+    std::unordered_map<Key_t, List_t::iterator> m_ByKey;
+  };
+}  // namespace llarp::net
@@ -128,6 +128,61 @@ namespace llarp
       }
     }
 
+    std::optional<nuint16_t>
+    IPPacket::SrcPort() const
+    {
+      switch (IPProtocol{Header()->protocol})
+      {
+        case IPProtocol::TCP:
+        case IPProtocol::UDP:
+          return nuint16_t{*reinterpret_cast<const uint16_t*>(buf + (Header()->ihl * 4))};
+        default:
+          return std::nullopt;
+      }
+    }
+
+    size_t
+    IPPacket::FlowHash::operator()(const IPPacket& pkt) const
+    {
+      // fnv-1a over whichever of the 5 tuple fields we can find
+      uint64_t hash = 0xcbf29ce484222325ULL;
+      const auto mix = [&hash](const byte_t* ptr, size_t sz) {
+        for (size_t idx = 0; idx < sz; ++idx)
+          hash = (hash ^ ptr[idx]) * 0x100000001b3ULL;
+      };
+      size_t portsAt = 0;
+      uint8_t proto = 0;
+      if (pkt.IsV4() and pkt.sz >= sizeof(ip_header))
+      {
+        const auto* hdr = pkt.Header();
+        proto = hdr->protocol;
+        mix(reinterpret_cast<const byte_t*>(&hdr->saddr), sizeof(hdr->saddr));
+        mix(reinterpret_cast<const byte_t*>(&hdr->daddr), sizeof(hdr->daddr));
+        portsAt = hdr->ihl * 4;
+      }
+      else if (pkt.IsV6() and pkt.sz >= sizeof(ipv6_header))
+      {
+        const auto* hdr = pkt.HeaderV6();
+        proto = hdr->proto;
+        mix(reinterpret_cast<const byte_t*>(&hdr->srcaddr), sizeof(hdr->srcaddr));
+        mix(reinterpret_cast<const byte_t*>(&hdr->dstaddr), sizeof(hdr->dstaddr));
+        portsAt = sizeof(ipv6_header);
+      }
+      mix(&proto, 1);
+      switch (IPProtocol{proto})
+      {
+        case IPProtocol::TCP:
+        case IPProtocol::UDP:
+          // source and destination port
+          if (portsAt and pkt.sz >= portsAt + 4)
+            mix(pkt.buf + portsAt, 4);
+          break;
+        default:
+          break;
+      }
+      return hash;
+    }
+
     huint32_t
     IPPacket::srcv4() const
     {
@@ -203,6 +203,23 @@ namespace llarp
         }
       };
 
+      struct GetSize
+      {
+        size_t
+        operator()(const IPPacket& pkt) const
+        {
+          return pkt.sz;
+        }
+      };
+
+      /// hash of the protocol, addresses and ports, so every packet of a connection lands in
+      /// the same flow
+      struct FlowHash
+      {
+        size_t
+        operator()(const IPPacket& pkt) const;
+      };
+
       struct CompareOrder
       {
         bool
@@ -293,6 +310,10 @@ namespace llarp
       std::optional<nuint16_t>
       DstPort() const;
 
+      /// get source port if applicable
+      std::optional<nuint16_t>
+      SrcPort() const;
+
       void
       UpdateIPv4Address(nuint32_t src, nuint32_t dst);
 
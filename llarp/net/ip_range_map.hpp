@@ -2,6 +2,13 @@
 
 #include "ip_range.hpp"
 #include <llarp/util/status.hpp>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <set>
 #include <vector>
 
 namespace llarp
@@ -10,8 +17,9 @@ namespace llarp
   {
     /// a container that maps an ip range to a value that allows you to lookup
     /// key by range hit
-    /// TODO: do some kind of magic shit to ensure near constant time for
-    /// lookups
+    ///
+    /// ranges are indexed by a path compressed binary trie keyed on the network prefix, so a lookup
+    /// walks at most 128 bits worth of nodes no matter how many ranges are in the map.
     template <typename Value_t>
     struct IPRangeMap
     {
@@ -37,6 +45,12 @@ namespace llarp
         return m_Entries.empty();
       }
 
+      size_t
+      Size() const
+      {
+        return m_Entries.size();
+      }
+
       bool
       ContainsValue(const Value_t& val) const
       {
@@ -81,24 +95,49 @@ namespace llarp
       std::optional<Value_t>
       GetExact(Range_t range) const
       {
-        for (const auto& [r, value] : m_Entries)
-        {
-          if (r == range)
-            return value;
-        }
-        return std::nullopt;
+        const auto prefix = Masked(range.addr, PrefixLen(range));
+        const auto len = PrefixLen(range);
+        std::optional<Value_t> found;
+        VisitMatches(prefix, [&](const Node& node) {
+          if (node.len == len and not node.entries.empty())
+            found = m_Entries[node.entries.front()].second;
+        });
+        return found;
+      }
+
+      /// call visit with every entry who's range contains this IP, shortest prefix first
+      template <typename Visit_t>
+      void
+      ForEachMatch(const IP_t& addr, Visit_t visit) const
+      {
+        VisitMatches(addr, [&](const Node& node) {
+          for (const auto idx : node.entries)
+            visit(m_Entries[idx].first, m_Entries[idx].second);
+        });
       }
 
-      /// return a set of all entries who's range contains this IP
-      std::set<Entry_t>
+      /// return all entries who's range contains this IP, shortest prefix first so the most
+      /// specific match is at the back
+      std::vector<Entry_t>
       FindAllEntries(const IP_t& addr) const
       {
-        std::set<Entry_t> found;
-        for (const auto& entry : m_Entries)
-        {
-          if (entry.first.Contains(addr))
-            found.insert(entry);
-        }
+        std::vector<Entry_t> found;
+        ForEachMatch(addr, [&found](const auto& range, const auto& value) {
+          found.emplace_back(range, value);
+        });
+        return found;
+      }
+
+      /// return the entry with the most specific range that contains this IP or nullptr if no
+      /// range matches
+      const Entry_t*
+      FindLongestMatch(const IP_t& addr) const
+      {
+        const Entry_t* found = nullptr;
+        VisitMatches(addr, [&](const Node& node) {
+          if (not node.entries.empty())
+            found = &m_Entries[node.entries.back()];
+        });
         return found;
       }
 
@@ -115,6 +154,7 @@ namespace llarp
       Insert(const Range_t& addr, const Value_t& val)
       {
         m_Entries.emplace_back(addr, val);
+        Index(m_Entries.size() - 1);
       }
 
       template <typename Visit_t>
@@ -122,13 +162,20 @@ namespace llarp
       RemoveIf(Visit_t visit)
       {
         auto itr = m_Entries.begin();
+        bool removed = false;
         while (itr != m_Entries.end())
         {
           if (visit(*itr))
+          {
             itr = m_Entries.erase(itr);
+            removed = true;
+          }
           else
             ++itr;
         }
+        // removal is rare, rebuilding keeps the trie free of dead nodes
+        if (removed)
+          Reindex();
       }
 
       util::StatusObject
@@ -143,7 +190,163 @@ namespace llarp
       }
 
      private:
+      static constexpr uint32_t NoChild = std::numeric_limits<uint32_t>::max();
+
+      struct Node
+      {
+        /// network prefix with all bits past len cleared
+        IP_t prefix;
+        uint8_t len;
+        std::array<uint32_t, 2> child{NoChild, NoChild};
+        /// indexes into m_Entries of the ranges with exactly this prefix, in insertion order
+        std::vector<size_t> entries;
+      };
+
+      static uint8_t
+      PrefixLen(const Range_t& range)
+      {
+        return bits::count_bits(range.netmask_bits);
+      }
+
+      /// get the bit at position idx counting from the most significant bit
+      static int
+      Bit(const IP_t& ip, uint8_t idx)
+      {
+        if (idx < 64)
+          return (ip.h.upper >> (63 - idx)) & 1;
+        return (ip.h.lower >> (127 - idx)) & 1;
+      }
+
+      static IP_t
+      Masked(IP_t ip, uint8_t len)
+      {
+        if (len == 0)
+          return IP_t{0};
+        if (len <= 64)
+        {
+          ip.h.upper &= ~uint64_t{0} << (64 - len);
+          ip.h.lower = 0;
+        }
+        else if (len < 128)
+          ip.h.lower &= ~uint64_t{0} << (128 - len);
+        return ip;
+      }
+
+      static uint8_t
+      LeadingZeros(uint64_t x)
+      {
+        if (x == 0)
+          return 64;
+        uint8_t n = 0;
+        for (uint8_t shift = 32; shift > 0; shift >>= 1)
+        {
+          if ((x >> (64 - shift)) == 0)
+          {
+            n += shift;
+            x <<= shift;
+          }
+        }
+        return n;
+      }
+
+      /// number of leading bits a and b have in common
+      static uint8_t
+      CommonPrefixLen(const IP_t& a, const IP_t& b)
+      {
+        if (a.h.upper != b.h.upper)
+          return LeadingZeros(a.h.upper ^ b.h.upper);
+        return 64 + LeadingZeros(a.h.lower ^ b.h.lower);
+      }
+
+      uint32_t
+      NewNode(const IP_t& prefix, uint8_t len)
+      {
+        m_Nodes.emplace_back();
+        m_Nodes.back().prefix = prefix;
+        m_Nodes.back().len = len;
+        return m_Nodes.size() - 1;
+      }
+
+      /// call visit with every node on the path to addr that has a prefix containing addr
+      template <typename Visit_t>
+      void
+      VisitMatches(const IP_t& addr, Visit_t visit) const
+      {
+        if (m_Nodes.empty())
+          return;
+        uint32_t cur = 0;
+        while (true)
+        {
+          const auto& node = m_Nodes[cur];
+          visit(node);
+          if (node.len == 128)
+            return;
+          const auto next = node.child[Bit(addr, node.len)];
+          if (next == NoChild)
+            return;
+          const auto& child = m_Nodes[next];
+          if (CommonPrefixLen(addr, child.prefix) < child.len)
+            return;
+          cur = next;
+        }
+      }
+
+      /// add m_Entries[idx] to the trie
+      void
+      Index(size_t idx)
+      {
+        if (m_Nodes.empty())
+          NewNode(IP_t{0}, 0);
+
+        const auto len = PrefixLen(m_Entries[idx].first);
+        const auto prefix = Masked(m_Entries[idx].first.addr, len);
+        uint32_t cur = 0;
+        while (m_Nodes[cur].len != len)
+        {
+          const auto dir = Bit(prefix, m_Nodes[cur].len);
+          const auto next = m_Nodes[cur].child[dir];
+          if (next == NoChild)
+          {
+            const auto leaf = NewNode(prefix, len);
+            m_Nodes[cur].child[dir] = leaf;
+            cur = leaf;
+            break;
+          }
+          const auto nextLen = m_Nodes[next].len;
+          const auto common =
+              std::min({CommonPrefixLen(prefix, m_Nodes[next].prefix), len, nextLen});
+          if (common == nextLen)
+          {
+            cur = next;
+            continue;
+          }
+          // the child's prefix diverges from ours, split the edge at the common prefix
+          const auto split = NewNode(Masked(prefix, common), common);
+          m_Nodes[split].child[Bit(m_Nodes[next].prefix, common)] = next;
+          m_Nodes[cur].child[dir] = split;
+          cur = split;
+          if (common != len)
+          {
+            const auto leaf = NewNode(prefix, len);
+            m_Nodes[split].child[Bit(prefix, common)] = leaf;
+            cur = leaf;
+          }
+          break;
+        }
+        m_Nodes[cur].entries.push_back(idx);
+      }
+
+      void
+      Reindex()
+      {
+        m_Nodes.clear();
+        for (size_t idx = 0; idx < m_Entries.size(); ++idx)
+          Index(idx);
+      }
+
       Container_t m_Entries;
+      /// trie nodes, the root is always at index 0 and has a zero length prefix
+      std::vector<Node> m_Nodes;
     };
   }  // namespace net
 }  // namespace llarp
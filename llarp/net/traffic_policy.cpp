@@ -70,6 +70,58 @@ namespace llarp::net
     return false;
   }
 
+  CompiledTrafficPolicy::CompiledTrafficPolicy(const TrafficPolicy& policy)
+      : m_AllowAll{policy.protocols.empty() and policy.ranges.empty()}
+  {
+    m_PortsIndex.fill(NoPorts);
+    for (const auto& proto : policy.protocols)
+    {
+      const auto num = static_cast<std::underlying_type_t<IPProtocol>>(proto.protocol);
+      if (not proto.port)
+      {
+        m_AnyPort.set(num);
+        continue;
+      }
+      if (m_PortsIndex[num] == NoPorts)
+      {
+        m_PortsIndex[num] = m_Ports.size();
+        m_Ports.emplace_back();
+      }
+      m_HasPorts.set(num);
+      m_Ports[m_PortsIndex[num]].set(ToHost(*proto.port).h);
+    }
+    for (const auto& range : policy.ranges)
+      m_Ranges.Insert(range, true);
+  }
+
+  bool
+  CompiledTrafficPolicy::AllowsTraffic(const IPPacket& pkt) const
+  {
+    if (m_AllowAll)
+      return true;
+
+    const auto proto = pkt.Header()->protocol;
+    if (m_AnyPort.test(proto))
+      return true;
+    if (m_HasPorts.test(proto))
+    {
+      const auto maybe = pkt.DstPort();
+      if (not maybe or m_Ports[m_PortsIndex[proto]].test(ToHost(*maybe).h))
+        return true;
+    }
+
+    if (m_Ranges.Empty())
+      return false;
+    huint128_t dst;
+    if (pkt.IsV6())
+      dst = pkt.dstv6();
+    else if (pkt.IsV4())
+      dst = pkt.dst4to6();
+    else
+      return false;
+    return m_Ranges.FindLongestMatch(dst) != nullptr;
+  }
+
   bool
   ProtocolInfo::BDecode(llarp_buffer_t* buf)
   {
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "ip_range.hpp"
+#include "ip_range_map.hpp"
 #include "ip_packet.hpp"
 #include "llarp/util/status.hpp"
 
+#include <array>
+#include <bitset>
 #include <set>
+#include <vector>
 
 namespace llarp::net
 {
@@ -67,4 +71,31 @@ namespace llarp::net
     bool
     AllowsTraffic(const IPPacket& pkt) const;
   };
+
+  /// a TrafficPolicy flattened into lookup tables so that checking a packet does not depend on
+  /// the number of rules. build it once when the policy is configured and use it per packet.
+  class CompiledTrafficPolicy
+  {
+   public:
+    explicit CompiledTrafficPolicy(const TrafficPolicy& policy);
+
+    /// same result as TrafficPolicy::AllowsTraffic for the policy we were compiled from
+    bool
+    AllowsTraffic(const IPPacket& pkt) const;
+
+   private:
+    static constexpr uint16_t NoPorts = 0xffff;
+
+    bool m_AllowAll;
+    /// protocols allowed on any port
+    std::bitset<256> m_AnyPort;
+    /// protocols that have port rules, packets we cannot get a port from match on protocol alone
+    std::bitset<256> m_HasPorts;
+    /// index into m_Ports for each protocol with port rules
+    std::array<uint16_t, 256> m_PortsIndex;
+    /// allowed destination ports in host order, one bitset per protocol with port rules
+    std::vector<std::bitset<65536>> m_Ports;
+    /// allowed destination ranges
+    IPRangeMap<bool> m_Ranges;
+  };
 }  // namespace llarp::net
@@ -0,0 +1,85 @@
+#include "key_pool.hpp"
+
+#include <llarp/crypto/crypto.hpp>
+#include <llarp/util/metrics.hpp>
+
+namespace llarp
+{
+  namespace path
+  {
+    static metrics::Counter&
+    KeysTaken(const char* from)
+    {
+      return metrics::Registry::Global().GetCounter(
+          "lokinet_path_ephemeral_keys",
+          "path build keypairs used, by where they came from",
+          {{"from", from}});
+    }
+
+    SecretKey
+    EphemeralKeyPool::Take()
+    {
+      {
+        util::Lock lock{m_Access};
+        if (not m_Keys.empty())
+        {
+          static auto& pooled = KeysTaken("pool");
+          pooled.Add();
+          SecretKey key = m_Keys.back();
+          m_Keys.pop_back();
+          return key;
+        }
+      }
+      static auto& generated = KeysTaken("generated");
+      generated.Add();
+      SecretKey key;
+      CryptoManager::instance()->encryption_keygen(key);
+      return key;
+    }
+
+    bool
+    EphemeralKeyPool::StartRefill()
+    {
+      util::Lock lock{m_Access};
+      if (m_Stopped or m_Refilling or m_Keys.size() >= LowWater)
+        return false;
+      m_Refilling = true;
+      return true;
+    }
+
+    void
+    EphemeralKeyPool::Refill()
+    {
+      auto crypto = CryptoManager::instance();
+      while (true)
+      {
+        {
+          util::Lock lock{m_Access};
+          if (m_Stopped or m_Keys.size() >= Capacity)
+          {
+            m_Refilling = false;
+            return;
+          }
+        }
+        SecretKey key;
+        crypto->encryption_keygen(key);
+        util::Lock lock{m_Access};
+        m_Keys.push_back(key);
+      }
+    }
+
+    void
+    EphemeralKeyPool::Stop()
+    {
+      util::Lock lock{m_Access};
+      m_Stopped = true;
+    }
+
+    size_t
+    EphemeralKeyPool::Size() const
+    {
+      util::Lock lock{m_Access};
+      return m_Keys.size();
+    }
+  }  // namespace path
+}  // namespace llarp
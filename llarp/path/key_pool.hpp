@@ -0,0 +1,50 @@
+#pragma once
+
+#include <llarp/constants/path.hpp>
+#include <llarp/crypto/types.hpp>
+#include <llarp/util/thread/threading.hpp>
+
+#include <vector>
+
+namespace llarp
+{
+  namespace path
+  {
+    /// ephemeral encryption keypairs generated ahead of time, so a path build only has to do
+    /// its dh against each hop instead of also generating two keypairs per hop. builds take
+    /// from here and make their own once it runs dry, the router tick tops it up on a worker.
+    struct EphemeralKeyPool
+    {
+      /// enough for a handful of max length path builds, each hop takes two
+      static constexpr size_t Capacity = max_len * 2 * 8;
+      /// we start topping up once it gets this low
+      static constexpr size_t LowWater = Capacity / 2;
+
+      /// a pregenerated keypair, or a fresh one if there are none left
+      SecretKey
+      Take();
+
+      /// if the pool is low and nobody is refilling it yet, mark it as being refilled and return
+      /// true. the caller must then call Refill.
+      bool
+      StartRefill();
+
+      /// generate keys until the pool is full or it is stopped
+      void
+      Refill();
+
+      /// stop a running refill early and refuse new ones, for shutdown
+      void
+      Stop();
+
+      size_t
+      Size() const;
+
+     private:
+      mutable util::Mutex m_Access;
+      std::vector<SecretKey> m_Keys GUARDED_BY(m_Access);
+      bool m_Refilling GUARDED_BY(m_Access) = false;
+      bool m_Stopped GUARDED_BY(m_Access) = false;
+    };
+  }  // namespace path
+}  // namespace llarp
@@ -14,6 +14,8 @@
 #include <llarp/routing/transfer_traffic_message.hpp>
 #include <llarp/util/buffer.hpp>
 #include <llarp/util/endian.hpp>
+#include <llarp/util/instrument.hpp>
+#include <llarp/util/metrics.hpp>
 #include <llarp/tooling/path_event.hpp>
 
 #include <deque>
@@ -320,6 +322,7 @@ namespace llarp
           {"intro", intro.ExtractStatus()},
           {"lastRecvMsg", to_json(m_LastRecvMessage)},
           {"lastLatencyTest", to_json(m_LastLatencyTestTime)},
+          {"rtt", m_RTT.ExtractStatus()},
           {"buildStarted", to_json(buildStarted)},
           {"expired", Expired(now)},
           {"expiresSoon", ExpiresSoon(now)},
@@ -407,21 +410,19 @@ namespace llarp
       // check to see if this path is dead
       if (_status == ePathEstablished)
       {
-        auto dlt = now - m_LastLatencyTestTime;
-        if (dlt > path::latency_interval && m_LastLatencyTestID == 0)
+        if (const auto lost = m_RTT.ExpireProbes(now))
+          LogDebug(Name(), " lost ", lost, " latency probes, loss=", m_RTT.LossRate());
+        // busy paths are probed more often so their rtt stays fresh, the probe rides along
+        // with the traffic; idle ones are probed to see if they are still alive
+        const bool active = now - m_LastRecvMessage < path::latency_interval;
+        const auto interval = active ? path::busy_latency_interval : path::latency_interval;
+        if (now - m_LastLatencyTestTime > interval)
         {
-          // bail doing test if we are active
-          if (now - m_LastRecvMessage < path::latency_interval)
+          SendLatencyProbe(now, r, not active);
+          if (not active)
             return;
-          routing::PathLatencyMessage latency;
-          latency.T = randint();
-          m_LastLatencyTestID = latency.T;
-          m_LastLatencyTestTime = now;
-          SendRoutingMessage(latency, r);
-          FlushUpstream(r);
-          return;
         }
-        dlt = now - m_LastRecvMessage;
+        const auto dlt = now - m_LastRecvMessage;
         if (dlt >= path::alive_timeout)
         {
           LogWarn(Name(), " waited for ", dlt, " and path looks dead");
@@ -434,6 +435,7 @@ namespace llarp
     void
     Path::HandleAllUpstream(std::vector<RelayUpstreamMessage> msgs, AbstractRouter* r)
     {
+      LLARP_ZONE();
       for (const auto& msg : msgs)
       {
         if (r->SendToOrQueue(Upstream(), msg))
@@ -451,17 +453,23 @@ namespace llarp
     void
     Path::UpstreamWork(TrafficQueue_ptr msgs, AbstractRouter* r)
     {
+      LLARP_ZONE();
+      static auto& cells = metrics::Registry::Global().GetCounter(
+          "lokinet_relay_cells", "relay cells handled", {{"role", "path"}, {"direction", "upstream"}});
+      cells.Add(msgs->size());
       std::vector<RelayUpstreamMessage> sendmsgs(msgs->size());
+      std::vector<onion::Layer> layers(hops.size());
       size_t idx = 0;
       for (auto& ev : *msgs)
       {
         const llarp_buffer_t buf(ev.first);
         TunnelNonce n = ev.second;
-        for (const auto& hop : hops)
+        for (size_t hop = 0; hop < hops.size(); ++hop)
         {
-          CryptoManager::instance()->xchacha20(buf, hop.shared, n);
-          n ^= hop.nonceXOR;
+          layers[hop] = {&hops[hop].shared, n};
+          n ^= hops[hop].nonceXOR;
         }
+        CryptoManager::instance()->xchacha20_onion(buf, layers.data(), hops.size());
         auto& msg = sendmsgs[idx];
         msg.X = buf;
         msg.Y = ev.second;
@@ -522,17 +530,23 @@ namespace llarp
     void
     Path::DownstreamWork(TrafficQueue_ptr msgs, AbstractRouter* r)
     {
+      LLARP_ZONE();
+      static auto& cells = metrics::Registry::Global().GetCounter(
+          "lokinet_relay_cells", "relay cells handled", {{"role", "path"}, {"direction", "downstream"}});
+      cells.Add(msgs->size());
       std::vector<RelayDownstreamMessage> sendMsgs(msgs->size());
+      std::vector<onion::Layer> layers(hops.size());
       size_t idx = 0;
       for (auto& ev : *msgs)
       {
         const llarp_buffer_t buf(ev.first);
         sendMsgs[idx].Y = ev.second;
-        for (const auto& hop : hops)
+        for (size_t hop = 0; hop < hops.size(); ++hop)
         {
-          sendMsgs[idx].Y ^= hop.nonceXOR;
-          CryptoManager::instance()->xchacha20(buf, hop.shared, sendMsgs[idx].Y);
+          sendMsgs[idx].Y ^= hops[hop].nonceXOR;
+          layers[hop] = {&hops[hop].shared, sendMsgs[idx].Y};
         }
+        CryptoManager::instance()->xchacha20_onion(buf, layers.data(), hops.size());
         sendMsgs[idx].X = buf;
         ++idx;
       }
@@ -544,6 +558,7 @@ namespace llarp
     void
     Path::HandleAllDownstream(std::vector<RelayDownstreamMessage> msgs, AbstractRouter* r)
     {
+      LLARP_ZONE();
       for (const auto& msg : msgs)
       {
         const llarp_buffer_t buf{msg.X};
@@ -628,6 +643,8 @@ namespace llarp
     Path::HandleDataDiscardMessage(const routing::DataDiscardMessage& msg, AbstractRouter* r)
     {
       MarkActive(r->Now());
+      // the far end echoes the sequence number of what it could not deliver
+      m_RTT.Discarded();
       if (m_DropHandler)
         return m_DropHandler(shared_from_this(), msg.P, msg.S);
       return true;
@@ -649,20 +666,28 @@ namespace llarp
         r->PersistSessionUntil(Upstream(), intro.expiresAt);
         MarkActive(now);
         // send path latency test
-        routing::PathLatencyMessage latency;
-        latency.T = randint();
-        latency.S = NextSeqNo();
-        m_LastLatencyTestID = latency.T;
-        m_LastLatencyTestTime = now;
-        if (!SendRoutingMessage(latency, r))
-          return false;
-        FlushUpstream(r);
-        return true;
+        return SendLatencyProbe(now, r, true);
       }
       LogWarn("got unwarranted path confirm message on tx=", RXID(), " rx=", RXID());
       return false;
     }
 
+    bool
+    Path::SendLatencyProbe(llarp_time_t now, AbstractRouter* r, bool flush)
+    {
+      routing::PathLatencyMessage latency;
+      latency.T = randint();
+      latency.S = NextSeqNo();
+      if (not m_RTT.Sent(latency.T, now))
+        return true;
+      m_LastLatencyTestTime = now;
+      if (not SendRoutingMessage(latency, r))
+        return false;
+      if (flush)
+        FlushUpstream(r);
+      return true;
+    }
+
     bool
     Path::HandlePathConfirmMessage(const routing::PathConfirmMessage& /*msg*/, AbstractRouter* r)
     {
@@ -681,10 +706,13 @@ namespace llarp
     {
       const auto now = r->Now();
       MarkActive(now);
-      if (msg.L == m_LastLatencyTestID)
+      if (m_RTT.Answered(msg.L, now))
       {
-        intro.latency = now - m_LastLatencyTestTime;
-        m_LastLatencyTestID = 0;
+        // a path that lost a build race stays ignored until it expires
+        if (_status == ePathIgnore)
+          return true;
+        // the smoothed rtt is what we publish in our intros too
+        intro.latency = std::max(m_RTT.SmoothedRTT(), 1ms);
         EnterState(ePathEstablished, now);
         if (m_BuiltHook)
           m_BuiltHook(shared_from_this());
@@ -692,7 +720,8 @@ namespace llarp
         return true;
       }
 
-      LogWarn("unwarranted path latency message via ", Upstream());
+      // replies to probes we already counted as lost end up here too
+      LogDebug("late or unwarranted path latency message via ", Upstream());
       return false;
     }
 
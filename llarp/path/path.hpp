@@ -6,6 +6,7 @@
 #include <llarp/messages/relay.hpp>
 #include "ihophandler.hpp"
 #include "path_types.hpp"
+#include "path_rtt.hpp"
 #include "pathbuilder.hpp"
 #include "pathset.hpp"
 #include <llarp/router_id.hpp>
@@ -92,6 +93,8 @@ namespace llarp
       service::Introduction intro;
 
       llarp_time_t buildStarted = 0s;
+      /// when the path build message was handed to the first hop, 0s until then
+      llarp_time_t lrcmSent = 0s;
 
       Path(
           const std::vector<RouterContact>& routers,
@@ -102,6 +105,13 @@ namespace llarp
       util::StatusObject
       ExtractStatus() const;
 
+      /// passive rtt and loss estimate of this path
+      const RTTEstimator&
+      RTT() const
+      {
+        return m_RTT;
+      }
+
       PathRole
       Role() const
       {
@@ -404,6 +414,10 @@ namespace llarp
       bool
       InformExitResult(llarp_time_t b);
 
+      /// queue a latency probe, flushing it now unless it can go out with the next data
+      bool
+      SendLatencyProbe(llarp_time_t now, AbstractRouter* r, bool flush);
+
       BuildResultHookFunc m_BuiltHook;
       DataHandlerFunc m_DataHandler;
       DropHandlerFunc m_DropHandler;
@@ -414,7 +428,7 @@ namespace llarp
       std::vector<ObtainedExitHandler> m_ObtainedExitHooks;
       llarp_time_t m_LastRecvMessage = 0s;
       llarp_time_t m_LastLatencyTestTime = 0s;
-      uint64_t m_LastLatencyTestID = 0;
+      RTTEstimator m_RTT;
       uint64_t m_UpdateExitTX = 0;
       uint64_t m_CloseExitTX = 0;
       uint64_t m_ExitObtainTX = 0;
@@ -4,6 +4,9 @@
 #include "path.hpp"
 #include <llarp/router/abstractrouter.hpp>
 #include <llarp/router/i_outbound_message_handler.hpp>
+#include <llarp/util/metrics.hpp>
+
+#include <memory>
 
 namespace llarp
 {
@@ -11,10 +14,32 @@ namespace llarp
   {
     static constexpr auto DefaultPathBuildLimit = 500ms;
 
+    static metrics::Gauge&
+    PendingPathBuilds()
+    {
+      static auto& queued = metrics::Registry::Global().GetGauge(
+          "lokinet_queue_depth", "items waiting in a queue", {{"queue", "lrcm"}});
+      return queued;
+    }
+
+    static metrics::Counter&
+    ShedPathBuilds(const char* action)
+    {
+      return metrics::Registry::Global().GetCounter(
+          "lokinet_path_lrcm_shed",
+          "path build requests we turned away because too many were waiting on a worker",
+          {{"action", action}});
+    }
+
     PathContext::PathContext(AbstractRouter* router)
         : m_Router(router), m_AllowTransit(false), m_PathLimits(DefaultPathBuildLimit)
     {}
 
+    PathContext::~PathContext()
+    {
+      m_KeyPool->Stop();
+    }
+
     void
     PathContext::AllowTransit()
     {
@@ -42,6 +67,85 @@ namespace llarp
 #endif
     }
 
+    PathContext::BuildAdmission
+    PathContext::AdmitPathBuild()
+    {
+      const auto pending = m_PendingPathBuilds.load();
+      if (pending >= MaxPendingPathBuilds)
+      {
+        static auto& dropped = ShedPathBuilds("dropped");
+        dropped.Add();
+        return BuildAdmission::Drop;
+      }
+      PendingPathBuilds().Set(++m_PendingPathBuilds);
+      if (pending >= CongestedPathBuilds)
+      {
+        static auto& congested = ShedPathBuilds("congested");
+        congested.Add();
+        return BuildAdmission::Congested;
+      }
+      return BuildAdmission::Accept;
+    }
+
+    void
+    PathContext::QueuePathBuildWork(std::function<void(void)> work)
+    {
+      static auto& decryptTime = metrics::Registry::Global().GetLatency(
+          "lokinet_path_lrcm_decrypt_seconds",
+          "time a worker spends decrypting and checking a path build request");
+      // on the general worker threads so a path build storm does not hold up the event loop
+      RunOnWorker([this, work = std::move(work)]() {
+        const auto started = std::chrono::steady_clock::now();
+        work();
+        decryptTime.Record(std::chrono::steady_clock::now() - started);
+        PendingPathBuilds().Set(--m_PendingPathBuilds);
+      });
+    }
+
+    void
+    PathContext::SetWorker(Worker_t worker)
+    {
+      m_Worker = std::move(worker);
+    }
+
+    void
+    PathContext::RunOnWorker(std::function<void(void)> job)
+    {
+      if (m_Worker)
+        m_Worker(std::move(job));
+      else
+        job();
+    }
+
+    void
+    PathContext::TopUpKeyPool()
+    {
+      if (m_PendingPathBuilds.load() > 0 or not m_KeyPool->StartRefill())
+        return;
+      // a refill still queued when we go away does nothing, a running one stops early
+      RunOnWorker([pool = std::weak_ptr<EphemeralKeyPool>{m_KeyPool}]() {
+        if (const auto ptr = pool.lock())
+          ptr->Refill();
+      });
+    }
+
+    size_t
+    PathContext::TakeHedgeBudget(size_t want)
+    {
+      return m_HedgeBudget.Take(
+          want, m_Router->GetConfig()->paths.m_HedgeBudget, m_Router->Now());
+    }
+
+    void
+    PathContext::SettleHedgeBudget(size_t taken, size_t started)
+    {
+      static auto& hedged = metrics::Registry::Global().GetCounter(
+          "lokinet_path_hedged_builds", "extra path builds started to race each other");
+      started = std::min(started, taken);
+      hedged.Add(started);
+      m_HedgeBudget.Return(taken - started, m_Router->GetConfig()->paths.m_HedgeBudget);
+    }
+
     const EventLoop_ptr&
     PathContext::loop()
     {
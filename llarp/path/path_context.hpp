@@ -3,6 +3,8 @@
 #include <llarp/crypto/encrypted_frame.hpp>
 #include <llarp/net/ip_address.hpp>
 #include "ihophandler.hpp"
+#include "key_pool.hpp"
+#include "path_hedge.hpp"
 #include "path_types.hpp"
 #include "pathset.hpp"
 #include "transit_hop.hpp"
@@ -12,6 +14,8 @@
 #include <llarp/util/decaying_hashset.hpp>
 #include <llarp/util/types.hpp>
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <unordered_map>
 
@@ -34,6 +38,8 @@ namespace llarp
     {
       explicit PathContext(AbstractRouter* router);
 
+      ~PathContext();
+
       /// called from router tick function
       void
       ExpirePaths(llarp_time_t now);
@@ -53,6 +59,59 @@ namespace llarp
       bool
       CheckPathLimitHitByIP(const IpAddress& ip);
 
+      /// path build requests waiting on a worker past which we only decrypt them to say we are
+      /// congested
+      static constexpr size_t CongestedPathBuilds = 256;
+      /// path build requests waiting on a worker past which we drop them without decrypting
+      static constexpr size_t MaxPendingPathBuilds = 1024;
+
+      /// what we do with a path build request given how many are waiting on a worker
+      enum class BuildAdmission
+      {
+        Accept,
+        /// decrypt it only to answer with a congestion status
+        Congested,
+        /// drop it, we cannot answer without decrypting it
+        Drop,
+      };
+
+      /// count a path build request against the backlog, unless it is dropped its work must be
+      /// handed to QueuePathBuildWork
+      BuildAdmission
+      AdmitPathBuild();
+
+      /// run the decryption of an admitted path build request on a worker thread
+      void
+      QueuePathBuildWork(std::function<void(void)> work);
+
+      using Worker_t = std::function<void(std::function<void(void)>)>;
+
+      /// where work we take off the event loop runs. the router hands it to its oxenmq workers, a
+      /// simulation can run it on its own loop instead. without a worker it runs inline.
+      void
+      SetWorker(Worker_t worker);
+
+      /// keypairs for the hops of paths we build
+      EphemeralKeyPool&
+      KeyPool()
+      {
+        return *m_KeyPool;
+      }
+
+      /// top up the key pool on a worker if it is low and the workers are not busy with path
+      /// build requests, called from the router tick
+      void
+      TopUpKeyPool();
+
+      /// take up to want extra path builds from the budget that racing builds share, returns
+      /// how many may be made
+      size_t
+      TakeHedgeBudget(size_t want);
+
+      /// started of the taken extra builds were made, put the rest back in the budget
+      void
+      SettleHedgeBudget(size_t taken, size_t started);
+
       bool
       AllowingTransit() const;
 
@@ -162,11 +221,19 @@ namespace llarp
       CurrentTransitPaths();
 
      private:
+      void
+      RunOnWorker(std::function<void(void)> job);
+
       AbstractRouter* m_Router;
+      Worker_t m_Worker;
       SyncTransitMap_t m_TransitPaths;
       SyncOwnedPathsMap_t m_OurPaths;
       bool m_AllowTransit;
       util::DecayingHashSet<IpAddress> m_PathLimits;
+      std::atomic<size_t> m_PendingPathBuilds{0};
+      /// shared with a refill on a worker so it cannot outlive the pool
+      std::shared_ptr<EphemeralKeyPool> m_KeyPool = std::make_shared<EphemeralKeyPool>();
+      HedgeBudget m_HedgeBudget;
     };
   }  // namespace path
 }  // namespace llarp
@@ -0,0 +1,65 @@
+#include "path_hedge.hpp"
+
+#include "path.hpp"
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace path
+  {
+    size_t
+    HedgeBudget::Take(size_t want, double perMinute, llarp_time_t now)
+    {
+      if (m_Updated == 0s)
+        m_Tokens = perMinute;
+      else if (now > m_Updated)
+      {
+        const std::chrono::duration<double, std::ratio<60>> elapsed = now - m_Updated;
+        m_Tokens = std::min(perMinute, m_Tokens + elapsed.count() * perMinute);
+      }
+      m_Updated = now;
+      const auto take = std::min(want, size_t(m_Tokens));
+      m_Tokens -= take;
+      return take;
+    }
+
+    void
+    HedgeBudget::Return(size_t unused, double perMinute)
+    {
+      m_Tokens = std::min(perMinute, m_Tokens + unused);
+    }
+
+    bool
+    HedgedRace::Built(const Path_ptr& p, llarp_time_t now, std::vector<Path_ptr>& dropped)
+    {
+      const auto itr = std::find_if(
+          paths.begin(), paths.end(), [&p](const auto& weak) { return weak.lock() == p; });
+      if (itr == paths.end())
+        return false;
+      paths.erase(itr);
+      if (keep == 0 or --keep > 0)
+        return true;
+      // the rest lost, their transit hops time out on their own
+      for (const auto& weak : paths)
+      {
+        const auto other = weak.lock();
+        if (not other or other->Status() != ePathBuilding)
+          continue;
+        other->EnterState(ePathIgnore, now);
+        dropped.emplace_back(other);
+      }
+      paths.clear();
+      return true;
+    }
+
+    bool
+    HedgedRace::Running() const
+    {
+      return keep > 0 and std::any_of(paths.begin(), paths.end(), [](const auto& weak) {
+               const auto p = weak.lock();
+               return p and p->Status() == ePathBuilding;
+             });
+    }
+  }  // namespace path
+}  // namespace llarp
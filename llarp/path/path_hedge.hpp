@@ -0,0 +1,55 @@
+#pragma once
+
+#include <llarp/util/time.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace llarp
+{
+  namespace path
+  {
+    struct Path;
+    using Path_ptr = std::shared_ptr<Path>;
+
+    /// token bucket for the extra path builds that racing builds start, shared by every builder
+    /// of a router. it starts full and refills perMinute tokens a minute up to perMinute.
+    struct HedgeBudget
+    {
+      /// take up to want tokens, returns how many were taken
+      size_t
+      Take(size_t want, double perMinute, llarp_time_t now);
+
+      /// put back tokens that were taken but not spent
+      void
+      Return(size_t unused, double perMinute);
+
+      double
+      Tokens() const
+      {
+        return m_Tokens;
+      }
+
+     private:
+      double m_Tokens = 0;
+      llarp_time_t m_Updated = 0s;
+    };
+
+    /// paths started at once to race each other, the first keep of them to build are kept
+    struct HedgedRace
+    {
+      /// how many more of them we keep, the rest are dropped once this many are built
+      size_t keep;
+      std::vector<std::weak_ptr<Path>> paths;
+
+      /// p finished building, returns false if it is not in this race. once keep of them are
+      /// built the rest still building are put in ePathIgnore and added to dropped.
+      bool
+      Built(const Path_ptr& p, llarp_time_t now, std::vector<Path_ptr>& dropped);
+
+      /// true while keep is not reached and one of the paths is still building
+      bool
+      Running() const;
+    };
+  }  // namespace path
+}  // namespace llarp
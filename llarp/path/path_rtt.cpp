@@ -0,0 +1,115 @@
+#include "path_rtt.hpp"
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace path
+  {
+    /// weight of a new sample in the loss average, probes are rare so this reacts quickly
+    static constexpr double LossGain = 1.0 / 8;
+    /// loss we stop scaling cost at, so a bad path still compares as finite
+    static constexpr double MaxLoss = 0.9;
+
+    bool
+    RTTEstimator::Sent(uint64_t id, llarp_time_t now)
+    {
+      if (m_Probes.size() >= MaxOutstanding)
+        return false;
+      m_Probes.push_back(Probe{id, now});
+      return true;
+    }
+
+    bool
+    RTTEstimator::Answered(uint64_t id, llarp_time_t now)
+    {
+      auto itr = std::find_if(
+          m_Probes.begin(), m_Probes.end(), [id](const auto& probe) { return probe.id == id; });
+      if (itr == m_Probes.end())
+        return false;
+      const auto sentAt = itr->sentAt;
+      m_Probes.erase(itr);
+      Sample(now > sentAt ? now - sentAt : 0s);
+      return true;
+    }
+
+    size_t
+    RTTEstimator::ExpireProbes(llarp_time_t now)
+    {
+      const auto timeout = ProbeTimeout();
+      const auto itr = std::remove_if(m_Probes.begin(), m_Probes.end(), [now, timeout](auto& p) {
+        return now > p.sentAt and now - p.sentAt >= timeout;
+      });
+      const size_t expired = std::distance(itr, m_Probes.end());
+      m_Probes.erase(itr, m_Probes.end());
+      for (size_t n = 0; n < expired; ++n)
+        Lost();
+      return expired;
+    }
+
+    void
+    RTTEstimator::Lost()
+    {
+      m_Lost++;
+      AddLoss(1.0);
+    }
+
+    void
+    RTTEstimator::Discarded()
+    {
+      m_Discarded++;
+    }
+
+    void
+    RTTEstimator::Sample(llarp_time_t rtt)
+    {
+      if (m_Samples++ == 0)
+      {
+        m_SRTT = rtt;
+        m_RTTVar = rtt / 2;
+      }
+      else
+      {
+        const auto delta = m_SRTT > rtt ? m_SRTT - rtt : rtt - m_SRTT;
+        m_RTTVar = (m_RTTVar * 3 + delta) / 4;
+        m_SRTT = (m_SRTT * 7 + rtt) / 8;
+      }
+      AddLoss(0.0);
+    }
+
+    void
+    RTTEstimator::AddLoss(double sample)
+    {
+      m_Loss += (sample - m_Loss) * LossGain;
+    }
+
+    llarp_time_t
+    RTTEstimator::ProbeTimeout() const
+    {
+      if (not HasSample())
+        return MaxProbeTimeout;
+      return std::clamp<llarp_time_t>((m_SRTT + m_RTTVar * 4) * 2, MinProbeTimeout, MaxProbeTimeout);
+    }
+
+    llarp_time_t
+    RTTEstimator::Cost() const
+    {
+      const auto base = m_SRTT + m_RTTVar;
+      return std::chrono::duration_cast<llarp_time_t>(
+          base / (1.0 - std::min(m_Loss, MaxLoss)));
+    }
+
+    util::StatusObject
+    RTTEstimator::ExtractStatus() const
+    {
+      return util::StatusObject{
+          {"srtt", to_json(m_SRTT)},
+          {"rttvar", to_json(m_RTTVar)},
+          {"loss", m_Loss},
+          {"samples", m_Samples},
+          {"lost", m_Lost},
+          {"discarded", m_Discarded},
+          {"outstanding", m_Probes.size()}};
+    }
+  }  // namespace path
+}  // namespace llarp
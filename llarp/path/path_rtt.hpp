@@ -0,0 +1,113 @@
+#pragma once
+
+#include <llarp/util/status.hpp>
+#include <llarp/util/time.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace llarp
+{
+  namespace path
+  {
+    /// passive round trip and loss estimate for one path, fed by latency probe replies. rtt is
+    /// smoothed the way tcp does it (rfc 6298), loss is a moving average of answered (0) and
+    /// unanswered (1) probes.
+    struct RTTEstimator
+    {
+      /// a probe we sent and are waiting on
+      struct Probe
+      {
+        uint64_t id;
+        llarp_time_t sentAt;
+      };
+
+      /// most probes we keep in flight at once
+      static constexpr size_t MaxOutstanding = 4;
+      /// bounds on how long a probe may go unanswered before it counts as lost
+      static constexpr llarp_time_t MinProbeTimeout = 2s;
+      static constexpr llarp_time_t MaxProbeTimeout = 20s;
+
+      /// remember a probe we just sent, false if there are too many in flight already
+      bool
+      Sent(uint64_t id, llarp_time_t now);
+
+      /// a probe reply came back, returns false if we were not waiting on it
+      bool
+      Answered(uint64_t id, llarp_time_t now);
+
+      /// count probes that have waited longer than ProbeTimeout() as lost, returns how many
+      size_t
+      ExpireProbes(llarp_time_t now);
+
+      /// count a probe that went unanswered
+      void
+      Lost();
+
+      /// count a message the far end told us it discarded. that says nothing about the path
+      /// itself, the far end had nowhere to send it, so it is not loss.
+      void
+      Discarded();
+
+      /// add one rtt sample and count it as a delivery
+      void
+      Sample(llarp_time_t rtt);
+
+      bool
+      HasSample() const
+      {
+        return m_Samples > 0;
+      }
+
+      size_t
+      Outstanding() const
+      {
+        return m_Probes.size();
+      }
+
+      /// smoothed rtt, zero until the first sample
+      llarp_time_t
+      SmoothedRTT() const
+      {
+        return m_SRTT;
+      }
+
+      llarp_time_t
+      RTTVariance() const
+      {
+        return m_RTTVar;
+      }
+
+      /// fraction of recent probes that were lost, 0 to 1
+      double
+      LossRate() const
+      {
+        return m_Loss;
+      }
+
+      /// how long we wait on a probe before counting it lost
+      llarp_time_t
+      ProbeTimeout() const;
+
+      /// the expected time to get something across this path, the smoothed rtt plus its
+      /// variance, scaled up by the retries loss would cost. lower is better.
+      llarp_time_t
+      Cost() const;
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      void
+      AddLoss(double sample);
+
+      std::vector<Probe> m_Probes;
+      llarp_time_t m_SRTT = 0s;
+      llarp_time_t m_RTTVar = 0s;
+      double m_Loss = 0.0;
+      uint64_t m_Samples = 0;
+      uint64_t m_Lost = 0;
+      uint64_t m_Discarded = 0;
+    };
+  }  // namespace path
+}  // namespace llarp
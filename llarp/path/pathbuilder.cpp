@@ -7,8 +7,10 @@
 #include <llarp/profiling.hpp>
 #include <llarp/router/abstractrouter.hpp>
 #include <llarp/util/buffer.hpp>
+#include <llarp/util/metrics.hpp>
 #include <llarp/tooling/path_event.hpp>
 
+#include <algorithm>
 #include <functional>
 
 namespace llarp
@@ -38,9 +40,10 @@ namespace llarp
       auto& frame = LRCM.frames[idx];
 
       auto crypto = CryptoManager::instance();
+      auto& keys = router->pathContext().KeyPool();
 
-      // generate key
-      crypto->encryption_keygen(hop.commkey);
+      // take a pregenerated key
+      hop.commkey = keys.Take();
       hop.nonce.Randomize();
       // do key exchange
       if (!crypto->dh_client(hop.shared, hop.rc.enckey, hop.commkey, hop.nonce))
@@ -84,8 +87,7 @@ namespace llarp
         return;
       }
       // use ephemeral keypair for frame
-      SecretKey framekey;
-      crypto->encryption_keygen(framekey);
+      const SecretKey framekey = keys.Take();
       if (!frame.EncryptInPlace(framekey, hop.rc.enckey))
       {
         LogError(pathset->Name(), " Failed to encrypt LRCR");
@@ -125,6 +127,9 @@ namespace llarp
   static void
   PathBuilderKeysGenerated(std::shared_ptr<AsyncPathKeyExchangeContext> ctx)
   {
+    // lost a race with another build before it was even sent
+    if (ctx->path->Status() == path::ePathIgnore)
+      return;
     if (!ctx->pathset->IsStopped())
     {
       ctx->router->NotifyRouterEvent<tooling::PathAttemptEvent>(ctx->router->pubkey(), ctx->path);
@@ -133,6 +138,7 @@ namespace llarp
       auto sentHandler = [ctx](auto status) {
         if (status == SendStatus::Success)
         {
+          ctx->path->lrcmSent = ctx->router->Now();
           ctx->router->pathContext().AddOwnPath(ctx->pathset, ctx->path);
           ctx->pathset->PathBuildStarted(std::move(ctx->path));
         }
@@ -160,6 +166,27 @@ namespace llarp
 
   namespace path
   {
+    /// path builds this router started, by how they ended
+    static metrics::Counter&
+    PathBuilds(const char* result)
+    {
+      return metrics::Registry::Global().GetCounter(
+          "lokinet_path_builds", "path builds started by this router", {{"result", result}});
+    }
+
+    /// a latency labeled by the number of hops of the path, indexed by it
+    using HopLatencies = std::array<metrics::LatencyHistogram*, max_len + 1>;
+
+    static HopLatencies
+    LatenciesByHops(std::string_view name, std::string_view help)
+    {
+      HopLatencies latencies{};
+      for (size_t hops = 1; hops < latencies.size(); ++hops)
+        latencies[hops] = &metrics::Registry::Global().GetLatency(
+            name, help, {{"hops", std::to_string(hops)}});
+      return latencies;
+    }
+
     Builder::Builder(AbstractRouter* p_router, size_t pathNum, size_t hops)
         : path::PathSet{pathNum}
         , m_EdgeLimiter{MIN_PATH_BUILD_INTERVAL}
@@ -182,8 +209,21 @@ namespace llarp
       const auto now = llarp::time_now_ms();
       m_EdgeLimiter.Decay(now);
       ExpirePaths(now, m_router);
+      // races that have nothing left building are over
+      m_Hedged.erase(
+          std::remove_if(
+              m_Hedged.begin(),
+              m_Hedged.end(),
+              [](const auto& race) { return not race.Running(); }),
+          m_Hedged.end());
       if (ShouldBuildMore(now))
-        BuildOne();
+      {
+        // with no path to use or wait on, race a few builds instead of waiting on one
+        if (NumInStatus(ePathEstablished) == 0 and NumInStatus(ePathBuilding) == 0)
+          BuildHedged();
+        else
+          BuildOne();
+      }
       TickPaths(m_router);
       if (m_BuildStats.attempts > 50)
       {
@@ -386,6 +426,82 @@ namespace llarp
       return false;
     }
 
+    bool
+    Builder::BuildHedged(PathRole roles, size_t keep)
+    {
+      auto select = [this](const std::set<RouterID>& used) {
+        // our subclasses pick the endpoint and what to avoid, so ask them a few times for hops
+        // that do not share a router with the other candidates
+        for (size_t tries = 0; tries < 3; ++tries)
+        {
+          auto maybe = GetHopsForBuild();
+          if (not maybe)
+            return maybe;
+          if (std::none_of(maybe->begin(), maybe->end(), [&used](const auto& rc) {
+                return used.count(rc.pubkey);
+              }))
+            return maybe;
+        }
+        return std::optional<std::vector<RouterContact>>{};
+      };
+      return BuildHedgedWith(select, roles, keep);
+    }
+
+    bool
+    Builder::BuildHedgedAlignedTo(
+        RouterID endpoint, const std::set<RouterID>& exclude, size_t keep)
+    {
+      auto select = [this, endpoint, &exclude](const std::set<RouterID>& used) {
+        auto avoid = exclude;
+        avoid.insert(used.begin(), used.end());
+        // every candidate ends at endpoint, only the hops before it have to differ
+        avoid.erase(endpoint);
+        return GetHopsAlignedToForBuild(endpoint, avoid);
+      };
+      if (BuildHedgedWith(select, ePathRoleAny, keep))
+      {
+        LogInfo(Name(), " building paths to ", endpoint);
+        return true;
+      }
+      return false;
+    }
+
+    bool
+    Builder::BuildHedgedWith(HopSelector select, PathRole roles, size_t keep)
+    {
+      // a single hop path has no other routers to race over
+      const size_t want = numHops < 2
+          ? keep
+          : std::max(m_router->GetConfig()->paths.m_HedgedBuilds, keep);
+      const size_t extra = want > keep ? m_router->pathContext().TakeHedgeBudget(want - keep) : 0;
+      HedgedRace race{keep, {}};
+      std::set<RouterID> used;
+      for (size_t n = 0; n < keep + extra; ++n)
+      {
+        const auto maybe = select(used);
+        if (not maybe)
+          break;
+        for (const auto& rc : *maybe)
+          used.emplace(rc.pubkey);
+        if (auto path = StartBuild(*maybe, roles))
+          race.paths.emplace_back(path);
+      }
+      // only the extra builds that were started are charged
+      if (extra > 0)
+      {
+        const size_t started = race.paths.size() > keep ? race.paths.size() - keep : 0;
+        m_router->pathContext().SettleHedgeBudget(extra, started);
+      }
+      if (race.paths.empty())
+        return false;
+      if (race.paths.size() > race.keep)
+      {
+        LogInfo(Name(), " racing ", race.paths.size(), " path builds for ", race.keep);
+        m_Hedged.emplace_back(std::move(race));
+      }
+      return true;
+    }
+
     llarp_time_t
     Builder::Now() const
     {
@@ -394,15 +510,21 @@ namespace llarp
 
     void
     Builder::Build(std::vector<RouterContact> hops, PathRole roles)
+    {
+      StartBuild(std::move(hops), roles);
+    }
+
+    Path_ptr
+    Builder::StartBuild(std::vector<RouterContact> hops, PathRole roles)
     {
       if (IsStopped())
-        return;
+        return nullptr;
       lastBuild = Now();
       const RouterID edge{hops[0].pubkey};
       if (not m_EdgeLimiter.Insert(edge))
       {
         LogWarn(Name(), " building too fast to edge router ", edge);
-        return;
+        return nullptr;
       }
       // async generate keys
       auto ctx = std::make_shared<AsyncPathKeyExchangeContext>();
@@ -413,6 +535,8 @@ namespace llarp
       path_shortName = path_shortName + std::to_string(m_router->NextPathBuildNumber()) + "]";
       auto path = std::make_shared<path::Path>(hops, self.get(), roles, std::move(path_shortName));
       LogInfo(Name(), " build ", path->ShortName(), ": ", path->HopsString());
+      static auto& started = PathBuilds("started");
+      started.Add();
 
       path->SetBuildResultHook([self](Path_ptr p) { self->HandlePathBuilt(p); });
       ctx->AsyncGenerateKeys(
@@ -420,22 +544,58 @@ namespace llarp
           m_router->loop(),
           [r = m_router](auto func) { r->QueueWork(std::move(func)); },
           &PathBuilderKeysGenerated);
+      return path;
+    }
+
+    void
+    Builder::HandleHedgedBuilt(const Path_ptr& p)
+    {
+      std::vector<Path_ptr> dropped;
+      for (auto race = m_Hedged.begin(); race != m_Hedged.end(); ++race)
+      {
+        if (not race->Built(p, Now(), dropped))
+          continue;
+        for (const auto& other : dropped)
+        {
+          LogDebug(Name(), " dropping ", other->ShortName(), ", ", p->ShortName(), " was first");
+          static auto& cancelled = PathBuilds("cancelled");
+          cancelled.Add();
+        }
+        if (race->keep == 0)
+          m_Hedged.erase(race);
+        return;
+      }
     }
 
     void
     Builder::HandlePathBuilt(Path_ptr p)
     {
+      HandleHedgedBuilt(p);
       buildIntervalLimit = PATH_BUILD_RATE;
       m_router->routerProfiling().MarkPathSuccess(p.get());
 
       LogInfo(p->Name(), " built latency=", p->intro.latency);
       m_BuildStats.success++;
+      static auto& succeeded = PathBuilds("success");
+      succeeded.Add();
+      static const auto buildLatency = LatenciesByHops(
+          "lokinet_path_build_seconds", "time from starting a path build to it being confirmed");
+      static const auto lrcmLatency = LatenciesByHops(
+          "lokinet_path_lrcm_rtt_seconds",
+          "time from the path build message going out to the path being confirmed");
+      const auto now = Now();
+      const auto hops = std::min(p->hops.size(), max_len);
+      buildLatency[hops]->Record(now - p->buildStarted);
+      if (p->lrcmSent > 0s)
+        lrcmLatency[hops]->Record(now - p->lrcmSent);
     }
 
     void
     Builder::HandlePathBuildFailedAt(Path_ptr p, RouterID edge)
     {
       PathSet::HandlePathBuildFailedAt(p, edge);
+      static auto& failed = PathBuilds("failed");
+      failed.Add();
       DoPathBuildBackoff();
       /// add it to the edge limter even if it's not an edge for simplicity
       m_EdgeLimiter.Insert(edge);
@@ -455,6 +615,8 @@ namespace llarp
     {
       m_router->routerProfiling().MarkPathTimeout(p.get());
       PathSet::HandlePathBuildTimeout(p);
+      static auto& timedOut = PathBuilds("timeout");
+      timedOut.Add();
       DoPathBuildBackoff();
     }
 
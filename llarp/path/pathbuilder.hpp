@@ -1,11 +1,16 @@
 #pragma once
 
+#include "path_hedge.hpp"
 #include "pathset.hpp"
 #include <llarp/util/status.hpp>
 #include <llarp/util/decaying_hashset.hpp>
 
 #include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <set>
+#include <vector>
 
 namespace llarp
 {
@@ -33,9 +38,28 @@ namespace llarp
       BuildCooldownHit(RouterID edge) const;
 
      private:
+      /// paths we started at once to race each other
+      std::vector<HedgedRace> m_Hedged;
+
+      using HopSelector =
+          std::function<std::optional<std::vector<RouterContact>>(const std::set<RouterID>&)>;
+
       void
       DoPathBuildBackoff();
 
+      /// start building a path over hops, returns nullptr if none was started
+      Path_ptr
+      StartBuild(std::vector<RouterContact> hops, PathRole roles);
+
+      /// start keep builds plus as many extra as the hedge budget allows, select is given the
+      /// routers used so far by the other candidates and should avoid them
+      bool
+      BuildHedgedWith(HopSelector select, PathRole roles, size_t keep);
+
+      /// drop the losers of a race once its winners are built
+      void
+      HandleHedgedBuilt(const Path_ptr& p);
+
      public:
       AbstractRouter* m_router;
       SecretKey enckey;
@@ -105,6 +129,16 @@ namespace llarp
       void
       Build(std::vector<RouterContact> hops, PathRole roles = ePathRoleAny) override;
 
+      /// build up to [paths]:hedged-builds paths over different routers at once and keep the
+      /// first keep of them that finish, the rest are dropped. returns false if none started.
+      bool
+      BuildHedged(PathRole roles = ePathRoleAny, size_t keep = 1);
+
+      /// like BuildHedged but every candidate ends at endpoint and avoids the routers in exclude
+      bool
+      BuildHedgedAlignedTo(
+          RouterID endpoint, const std::set<RouterID>& exclude = {}, size_t keep = 1);
+
       /// pick a first hop
       std::optional<RouterContact>
       SelectFirstHop(const std::set<RouterID>& exclude = {}) const;
@@ -5,6 +5,7 @@
 #include <llarp/routing/dht_message.hpp>
 #include <llarp/router/abstractrouter.hpp>
 
+#include <algorithm>
 #include <random>
 
 namespace llarp
@@ -156,7 +157,7 @@ namespace llarp
           {
             if (chosen == nullptr)
               chosen = itr->second;
-            else if (chosen->intro.latency > itr->second->intro.latency)
+            else if (chosen->RTT().Cost() > itr->second->RTT().Cost())
               chosen = itr->second;
           }
         }
@@ -426,15 +427,23 @@ namespace llarp
         ++itr;
       }
       Path_ptr chosen = nullptr;
-      llarp_time_t minLatency = 30s;
+      llarp_time_t minCost = 30s;
       for (const auto& path : established)
       {
-        if (path->intro.latency < minLatency)
+        if (const auto cost = path->RTT().Cost(); cost < minCost)
         {
-          minLatency = path->intro.latency;
+          minCost = cost;
           chosen = path;
         }
       }
+      // every path looks bad, a slow path still beats dropping what we were going to send
+      if (chosen == nullptr and not established.empty())
+      {
+        chosen = *std::min_element(
+            established.begin(), established.end(), [](const auto& lhs, const auto& rhs) {
+              return lhs->RTT().Cost() < rhs->RTT().Cost();
+            });
+      }
       return chosen;
     }
 
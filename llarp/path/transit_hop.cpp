@@ -15,11 +15,24 @@
 #include <llarp/routing/handler.hpp>
 #include <llarp/util/buffer.hpp>
 #include <llarp/util/endian.hpp>
+#include <llarp/util/instrument.hpp>
+#include <llarp/util/metrics.hpp>
 
 namespace llarp
 {
   namespace path
   {
+    /// xchacha20 every relayed message of a work queue with the hop's key in one batch
+    static void
+    CryptTraffic(IHopHandler::TrafficQueue_t& msgs, const SharedSecret& key)
+    {
+      std::vector<XChaCha20Job> jobs;
+      jobs.reserve(msgs.size());
+      for (auto& ev : msgs)
+        jobs.push_back({ev.first.data(), ev.first.size(), &key, ev.second});
+      CryptoManager::instance()->xchacha20_batch(jobs.data(), jobs.size());
+    }
+
     std::ostream&
     TransitHopInfo::print(std::ostream& stream, int level, int spaces) const
     {
@@ -119,6 +132,10 @@ namespace llarp
     void
     TransitHop::DownstreamWork(TrafficQueue_ptr msgs, AbstractRouter* r)
     {
+      LLARP_ZONE();
+      static auto& cells = metrics::Registry::Global().GetCounter(
+          "lokinet_relay_cells", "relay cells handled", {{"role", "transit"}, {"direction", "downstream"}});
+      cells.Add(msgs->size());
       auto flushIt = [self = shared_from_this(), r]() {
         std::vector<RelayDownstreamMessage> msgs;
         while (auto maybe = self->m_DownstreamGather.tryPopFront())
@@ -127,13 +144,13 @@ namespace llarp
         }
         self->HandleAllDownstream(std::move(msgs), r);
       };
+      CryptTraffic(*msgs, pathKey);
       for (auto& ev : *msgs)
       {
         RelayDownstreamMessage msg;
         const llarp_buffer_t buf(ev.first);
         msg.pathid = info.rxID;
         msg.Y = ev.second ^ nonceXOR;
-        CryptoManager::instance()->xchacha20(buf, pathKey, ev.second);
         msg.X = buf;
         llarp::LogDebug(
             "relay ",
@@ -155,6 +172,10 @@ namespace llarp
     void
     TransitHop::UpstreamWork(TrafficQueue_ptr msgs, AbstractRouter* r)
     {
+      LLARP_ZONE();
+      static auto& cells = metrics::Registry::Global().GetCounter(
+          "lokinet_relay_cells", "relay cells handled", {{"role", "transit"}, {"direction", "upstream"}});
+      cells.Add(msgs->size());
       auto flushIt = [self = shared_from_this(), r]() {
         std::vector<RelayUpstreamMessage> msgs;
         while (auto maybe = self->m_UpstreamGather.tryPopFront())
@@ -163,11 +184,11 @@ namespace llarp
         }
         self->HandleAllUpstream(std::move(msgs), r);
       };
+      CryptTraffic(*msgs, pathKey);
       for (auto& ev : *msgs)
       {
         const llarp_buffer_t buf(ev.first);
         RelayUpstreamMessage msg;
-        CryptoManager::instance()->xchacha20(buf, pathKey, ev.second);
         msg.pathid = info.txID;
         msg.Y = ev.second ^ nonceXOR;
         msg.X = buf;
@@ -184,6 +205,7 @@ namespace llarp
     void
     TransitHop::HandleAllUpstream(std::vector<RelayUpstreamMessage> msgs, AbstractRouter* r)
     {
+      LLARP_ZONE();
       if (IsEndpoint(r->pubkey()))
       {
         for (const auto& msg : msgs)
@@ -223,6 +245,7 @@ namespace llarp
     void
     TransitHop::HandleAllDownstream(std::vector<RelayDownstreamMessage> msgs, AbstractRouter* r)
     {
+      LLARP_ZONE();
       for (const auto& msg : msgs)
       {
         llarp::LogDebug(
@@ -91,6 +91,21 @@ namespace llarp::quic
 
     std::string
     to_string() const;
+
+    // Compares the IPv6 address and port; two Addresses are equal if they refer to the same convo
+    // tag and pseudo-port.
+    bool
+    operator==(const Address& other) const
+    {
+      return saddr.sin6_port == other.saddr.sin6_port
+          and std::memcmp(&saddr.sin6_addr, &other.saddr.sin6_addr, sizeof(saddr.sin6_addr)) == 0;
+    }
+
+    bool
+    operator!=(const Address& other) const
+    {
+      return not(*this == other);
+    }
   };
 
   // Wraps an ngtcp2_path (which is basically just and address pair) with remote/local components.
@@ -559,6 +559,10 @@ namespace llarp::quic
 
     send_pkt_info = {};
 
+    // Everything we write in this pass goes to the same remote, so let the endpoint coalesce the
+    // packets into as few lokinet frames as possible.
+    PacketBatch batch{endpoint};
+
     auto add_stream_data =
         [&](StreamID stream_id, const ngtcp2_vec* datav, size_t datalen, uint32_t flags = 0) {
           std::array<ngtcp2_ssize, 2> result;
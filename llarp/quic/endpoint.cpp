@@ -179,21 +179,110 @@ namespace llarp::quic
   {
     assert(service_endpoint.Loop()->inEventLoop());
 
+    if (batch_depth_ == 0 or not coalesce_packets)
+      return send_single_packet(to, data, ecn);
+
+    const size_t record_size = COALESCED_RECORD_HEADER + data.size();
+    if (batch_remote_ and (*batch_remote_ != to or batch_size_ + record_size > buf_.size()))
+    {
+      if (auto sent = flush_batch(); not sent)
+        return sent;
+    }
+
+    if (not batch_remote_)
+    {
+      // The coalesced header is the regular header without the trailing ecn byte
+      batch_size_ = write_packet_header(to.port(), 0) - 1;
+      if (batch_size_ + record_size > buf_.size())
+      {
+        // Too big to ever be coalesced
+        batch_size_ = 0;
+        return send_single_packet(to, data, ecn);
+      }
+      buf_[0] |= COALESCED_FLAG;
+      batch_remote_ = to;
+      batch_count_ = 0;
+    }
+
+    auto len = ToNet(huint16_t{static_cast<uint16_t>(data.size())});
+    buf_[batch_size_] = std::byte{ecn};
+    std::memcpy(&buf_[batch_size_ + 1], &len.n, 2);
+    std::memcpy(&buf_[batch_size_ + COALESCED_RECORD_HEADER], data.data(), data.size());
+    batch_size_ += record_size;
+    batch_count_++;
+    LogTrace("[", to, "]: coalesced ", data.size(), "B packet (", batch_count_, " in frame)");
+    return {};
+  }
+
+  io_result
+  Endpoint::send_single_packet(const Address& to, bstring_view data, uint8_t ecn)
+  {
     size_t header_size = write_packet_header(to.port(), ecn);
     size_t outgoing_len = header_size + data.size();
     assert(outgoing_len <= buf_.size());
     std::memcpy(&buf_[header_size], data.data(), data.size());
     bstring_view outgoing{buf_.data(), outgoing_len};
 
+    if (not service_endpoint.SendToOrQueue(to, outgoing, service::ProtocolType::QUIC))
+    {
+      LogDebug("Failed to send to quic endpoint ", to, "; was sending ", outgoing.size(), "B");
+      return {EHOSTUNREACH};
+    }
+    LogTrace("[", to, "]: sent ", buffer_printer{outgoing});
+    return {};
+  }
+
+  void
+  Endpoint::begin_batch()
+  {
+    batch_depth_++;
+  }
+
+  void
+  Endpoint::end_batch()
+  {
+    assert(batch_depth_ > 0);
+    if (--batch_depth_ == 0)
+      flush_batch();
+  }
+
+  io_result
+  Endpoint::flush_batch()
+  {
+    if (not batch_remote_)
+      return {};
+    const Address to = *batch_remote_;
+    batch_remote_.reset();
+
+    if (batch_count_ == 1)
+    {
+      // Only one packet made it in, so send it as a regular packet: the record's ecn byte already
+      // sits where the regular header wants it, so we just drop the length and the flag.
+      buf_[0] &= ~COALESCED_FLAG;
+      std::memmove(&buf_[4], &buf_[4 + 2], batch_size_ - (4 + 2));
+      batch_size_ -= 2;
+    }
+    bstring_view outgoing{buf_.data(), batch_size_};
+    io_result rv{};
     if (service_endpoint.SendToOrQueue(to, outgoing, service::ProtocolType::QUIC))
     {
-      LogTrace("[", to, "]: sent ", buffer_printer{outgoing});
+      LogTrace("[", to, "]: sent ", batch_count_, " coalesced packets in ", batch_size_, "B");
     }
     else
     {
-      LogDebug("Failed to send to quic endpoint ", to, "; was sending ", outgoing.size(), "B");
+      LogDebug(
+          "Failed to send to quic endpoint ",
+          to,
+          "; was sending ",
+          batch_count_,
+          " coalesced packets (",
+          batch_size_,
+          "B)");
+      rv = {EHOSTUNREACH};
     }
-    return {};
+    batch_size_ = 0;
+    batch_count_ = 0;
+    return rv;
   }
 
   void
@@ -11,6 +11,7 @@
 #include <chrono>
 #include <map>
 #include <memory>
+#include <optional>
 #include <queue>
 #include <unordered_map>
 #include <vector>
@@ -31,6 +32,12 @@ namespace llarp::quic
 
   inline constexpr std::byte CLIENT_TO_SERVER{1};
   inline constexpr std::byte SERVER_TO_CLIENT{2};
+  // Bit set in the packet type byte when the lokinet frame carries several coalesced quic packets
+  // rather than a single one; see Endpoint::begin_batch().
+  inline constexpr std::byte COALESCED_FLAG{0x80};
+  // Size of the per-packet record header inside a coalesced frame: ecn [1 byte] followed by the
+  // packet length [2 bytes, network order].
+  inline constexpr size_t COALESCED_RECORD_HEADER = 3;
 
   /// QUIC Tunnel Endpoint; this is the class that implements either end of a quic tunnel for both
   /// servers and clients.
@@ -49,6 +56,22 @@ namespace llarp::quic
     std::shared_ptr<uvw::Loop>
     get_loop();
 
+    /// Starts a packet batch: while a batch is open (and `coalesce_packets` is enabled) outgoing
+    /// packets are not sent immediately but are packed, with length prefixes, into a single
+    /// lokinet frame which is sent when it fills up, when a packet for a different remote is sent,
+    /// or when the batch is ended.  Batches nest; only the outermost end_batch() flushes.
+    void
+    begin_batch();
+
+    /// Ends a batch started with begin_batch(), sending any pending coalesced frame.
+    void
+    end_batch();
+
+    /// If true then packets sent inside a begin_batch()/end_batch() pair are coalesced into
+    /// shared lokinet frames.  Both sides of the tunnel must understand coalesced frames, so this
+    /// is off by default.
+    bool coalesce_packets = false;
+
    protected:
     /// the service endpoint we are owned by
     EndpointBase& service_endpoint;
@@ -155,6 +178,9 @@ namespace llarp::quic
     // depending on type)
     // - ecn value [1 byte]: provided by ngtcp2.  (Only the lower 2 bits are actually used).
     //
+    // Coalesced frames set COALESCED_FLAG in the type byte and drop the ecn byte from the header;
+    // the header is then followed by one or more [ecn][length][packet] records.
+    //
     // \param psuedo_port - the remote's pseudo-port (will be 0 if the remote is a server, > 0 for
     // a client remote)
     // \param ecn - the ecn value from ngtcp2
@@ -164,10 +190,31 @@ namespace llarp::quic
     write_packet_header(nuint16_t pseudo_port, uint8_t ecn) = 0;
 
     // Sends a packet to `to` containing `data`. Returns a non-error io_result on success,
-    // an io_result with .error_code set to the errno of the failure on failure.
+    // an io_result with .error_code set to the errno of the failure on failure.  If a batch is
+    // open and coalescing is enabled the packet is appended to the pending coalesced frame instead,
+    // and fails only if the pending frame had to be sent first and that failed.
     io_result
     send_packet(const Address& to, bstring_view data, uint8_t ecn);
 
+    // Sends `data` as a single, uncoalesced lokinet frame.  Fails with EHOSTUNREACH if lokinet
+    // could neither send nor queue it.
+    io_result
+    send_single_packet(const Address& to, bstring_view data, uint8_t ecn);
+
+    // Sends the pending coalesced frame in `buf_`, if any.  A frame holding just one packet is
+    // sent as a regular, uncoalesced frame.  Returns the same as send_packet for the frame.
+    io_result
+    flush_batch();
+
+    // Batch nesting depth; coalescing is active while this is > 0.
+    int batch_depth_ = 0;
+    // Remote of the pending coalesced frame, if one is being built.
+    std::optional<Address> batch_remote_;
+    // Bytes of `buf_` used by the pending coalesced frame (including its header).
+    size_t batch_size_ = 0;
+    // Number of quic packets in the pending coalesced frame.
+    size_t batch_count_ = 0;
+
     // Wrapper around the above that takes a regular std::string_view (i.e. of chars) and recasts
     // it to an string_view of std::bytes.
     io_result
@@ -248,4 +295,24 @@ namespace llarp::quic
     Endpoint(Endpoint&&) = delete;
   };
 
+  /// RAII wrapper around Endpoint::begin_batch()/end_batch().
+  class PacketBatch
+  {
+    Endpoint& ep;
+
+   public:
+    explicit PacketBatch(Endpoint& ep_) : ep{ep_}
+    {
+      ep.begin_batch();
+    }
+
+    ~PacketBatch()
+    {
+      ep.end_batch();
+    }
+
+    PacketBatch(const PacketBatch&) = delete;
+    PacketBatch(PacketBatch&&) = delete;
+  };
+
 }  // namespace llarp::quic
@@ -3,9 +3,11 @@
 #include "service/endpoint.hpp"
 #include "service/name.hpp"
 #include "stream.hpp"
+#include <algorithm>
 #include <limits>
 #include <llarp/util/logging/buffer.hpp>
 #include <llarp/util/logging/logger.hpp>
+#include <llarp/util/metrics.hpp>
 #include <llarp/util/str.hpp>
 #include <llarp/ev/ev_libuv.hpp>
 #include <memory>
@@ -202,6 +204,50 @@ namespace llarp::quic
         client.close();
     }
 
+
+    // The open_stream() counterpart of initial_client_data_handler: once the remote confirms the
+    // stream we hand it over to the caller, who replaces these initial callbacks with its own.
+    void
+    initial_stream_data_handler(
+        const TunnelManager::StreamOpenCallback& on_stream, Stream& stream, bstring_view bdata)
+    {
+      if (bdata.empty())
+        return;
+      // We are replacing the callback that is running, so hold on to what we need from it
+      auto cb = on_stream;
+      stream.data_callback = nullptr;
+      stream.close_callback = nullptr;
+      if (bdata[0] != tunnel::CONNECT_INIT)
+      {
+        LogWarn(
+            "Remote connection returned invalid initial byte (0x",
+            oxenmq::to_hex(bdata.begin(), bdata.begin() + 1),
+            "); dropping stream");
+        stream.close(tunnel::ERROR_BAD_INIT);
+        cb(nullptr);
+        return;
+      }
+      cb(stream.shared_from_this());
+      bdata.remove_prefix(1);
+      if (not bdata.empty() and stream.data_callback)
+        stream.data_callback(stream, bdata);
+    }
+
+    void
+    initial_stream_close_handler(
+        const TunnelManager::StreamOpenCallback& on_stream,
+        Stream& stream,
+        std::optional<uint64_t> error_code)
+    {
+      LogDebug(
+          "Stream connection closed ",
+          error_code ? "with error " + std::to_string(*error_code) : "gracefully",
+          " before the remote accepted it");
+      auto cb = on_stream;
+      stream.data_callback = nullptr;
+      stream.close_callback = nullptr;
+      cb(nullptr);
+    }
   }  // namespace
 
   TunnelManager::TunnelManager(EndpointBase& se) : service_endpoint_{se}
@@ -227,9 +273,20 @@ namespace llarp::quic
             ++it;
         }
 
+        ct.streams.erase(
+            std::remove_if(
+                ct.streams.begin(),
+                ct.streams.end(),
+                [](const auto& weak) {
+                  auto stream = weak.lock();
+                  return not stream or stream->closing();
+                }),
+            ct.streams.end());
+
         // If there are not accepted connections left *and* we stopped listening for new ones then
         // destroy the whole thing.
-        if (ct.conns.empty() and (not ct.tcp or not ct.tcp->active()))
+        if (ct.conns.empty() and ct.streams.empty() and ct.pending_streams.empty()
+            and (not ct.tcp or not ct.tcp->active()))
         {
           LogDebug("All sockets closed on quic:", port, ", destroying tunnel data");
           ctit = client_tunnels_.erase(ctit);
@@ -247,6 +304,7 @@ namespace llarp::quic
     // auto loop = get_loop();
 
     server_ = std::make_unique<Server>(service_endpoint_);
+    server_->coalesce_packets = coalesce_packets;
     server_->stream_open_callback = [this](Stream& stream, uint16_t port) -> bool {
       stream.close_callback = close_tcp_pair;
 
@@ -259,7 +317,14 @@ namespace llarp::quic
       }
 
       auto lokinet_addr = var::visit([](auto&& remote) { return remote.ToString(); }, *remote);
-      auto tunnel_to = allow_connection(lokinet_addr, port);
+      bool taken = false;
+      auto tunnel_to = allow_connection(lokinet_addr, port, stream, taken);
+      if (taken)
+      {
+        LogInfo("quic stream from ", lokinet_addr, " to ", port, " taken by a stream handler");
+        stream.append_buffer(new std::byte[1]{tunnel::CONNECT_INIT}, 1);
+        return true;
+      }
       if (not tunnel_to)
         return false;
       LogInfo("quic stream from ", lokinet_addr, " to ", port, " tunnelling to ", *tunnel_to);
@@ -320,6 +385,20 @@ namespace llarp::quic
     return id;
   }
 
+  int
+  TunnelManager::listen_streams(StreamListenHandler handler)
+  {
+    if (!handler)
+      throw std::logic_error{"Cannot call listen_streams() with a null handler"};
+    assert(service_endpoint_.Loop()->inEventLoop());
+    if (not server_)
+      make_server();
+
+    int id = next_handler_id_++;
+    incoming_handlers_.emplace_hint(incoming_handlers_.end(), id, std::move(handler));
+    return id;
+  }
+
   int
   TunnelManager::listen(SockAddr addr)
   {
@@ -338,14 +417,24 @@ namespace llarp::quic
   }
 
   std::optional<SockAddr>
-  TunnelManager::allow_connection(std::string_view lokinet_addr, uint16_t port)
+  TunnelManager::allow_connection(
+      std::string_view lokinet_addr, uint16_t port, Stream& stream, bool& taken)
   {
+    taken = false;
     for (auto& [id, handler] : incoming_handlers_)
     {
       try
       {
-        if (auto addr = handler(lokinet_addr, port))
-          return addr;
+        if (auto* tcp_handler = std::get_if<ListenHandler>(&handler))
+        {
+          if (auto addr = (*tcp_handler)(lokinet_addr, port))
+            return addr;
+        }
+        else if (var::get<StreamListenHandler>(handler)(lokinet_addr, port, stream))
+        {
+          taken = true;
+          return std::nullopt;
+        }
       }
       catch (const std::exception& e)
       {
@@ -419,7 +508,8 @@ namespace llarp::quic
     if (!step_success)
     {
       LogWarn("QUIC tunnel to ", addr, " failed during ", step_name, "; aborting tunnel");
-      it->second.tcp->close();
+      if (it->second.tcp)
+        it->second.tcp->close();
       if (it->second.open_cb)
         it->second.open_cb(false);
       client_tunnels_.erase(it);
@@ -427,6 +517,77 @@ namespace llarp::quic
     return step_success;
   }
 
+  std::optional<EndpointBase::AddressVariant_t>
+  TunnelManager::parse_remote(const std::string& remote_addr)
+  {
+    auto maybe_remote = service::ParseAddress(remote_addr);
+    if (!maybe_remote)
+    {
+      if (not service::NameIsValid(remote_addr))
+        throw std::invalid_argument{"Invalid remote lokinet name/address"};
+      // Otherwise it's a valid ONS name, so we'll initiate an ONS lookup when connecting
+    }
+    return maybe_remote;
+  }
+
+  std::pair<const uint16_t, TunnelManager::ClientTunnel>&
+  TunnelManager::new_client_tunnel()
+  {
+    // Find the first unused psuedo-port value starting from next_pseudo_port_.
+    uint16_t pport;
+    if (auto p = find_unused_key(client_tunnels_, next_pseudo_port_))
+      pport = *p;
+    else
+      throw std::runtime_error{
+          "Unable to open an outgoing quic connection: too many existing connections"};
+    (next_pseudo_port_ = pport)++;
+
+    assert(client_tunnels_.count(pport) == 0);
+    return *client_tunnels_.try_emplace(pport).first;
+  }
+
+  void
+  TunnelManager::connect_tunnel(
+      uint16_t pport,
+      uint16_t port,
+      std::string remote_addr,
+      std::optional<EndpointBase::AddressVariant_t> maybe_remote)
+  {
+    auto after_path = [this, port, pport, remote_addr](auto maybe_convo) {
+      if (not continue_connecting(pport, (bool)maybe_convo, "path build", remote_addr))
+        return;
+      SockAddr dest{maybe_convo->ToV6()};
+      dest.setPort(port);
+      make_client(dest, *client_tunnels_.find(pport));
+    };
+
+    if (!maybe_remote)
+    {
+      // We were given an ONS address, so it's a two-step process: first we resolve the ONS name,
+      // then we have to build a path to that address.
+      service_endpoint_.LookupNameAsync(
+          remote_addr,
+          [this,
+           after_path = std::move(after_path),
+           pport,
+           remote_addr = std::move(remote_addr)](auto maybe_remote) {
+            if (not continue_connecting(
+                    pport, (bool)maybe_remote, "endpoint ONS lookup", remote_addr))
+              return;
+            service_endpoint_.EnsurePathTo(*maybe_remote, after_path, open_timeout);
+          });
+      return;
+    }
+
+    auto& remote = *maybe_remote;
+
+    // See if we have an existing convo tag we can use to start things immediately
+    if (auto maybe_convo = service_endpoint_.GetBestConvoTagFor(remote))
+      after_path(maybe_convo);
+    else
+      service_endpoint_.EnsurePathTo(remote, after_path, open_timeout);
+  }
+
   std::pair<SockAddr, uint16_t>
   TunnelManager::open(
       std::string_view remote_address, uint16_t port, OpenCallback on_open, SockAddr bind_addr)
@@ -436,13 +597,7 @@ namespace llarp::quic
     std::pair<SockAddr, uint16_t> result;
     auto& [saddr, pport] = result;
 
-    auto maybe_remote = service::ParseAddress(remote_addr);
-    if (!maybe_remote)
-    {
-      if (not service::NameIsValid(remote_addr))
-        throw std::invalid_argument{"Invalid remote lokinet name/address"};
-      // Otherwise it's a valid ONS name, so we'll initiate an ONS lookup below
-    }
+    auto maybe_remote = parse_remote(remote_addr);
 
     // Open the TCP tunnel right away; it will just block new incoming connections until the quic
     // connection is established, but this still allows the caller to connect right away and queue
@@ -487,67 +642,45 @@ namespace llarp::quic
     auto bound = tcp_tunnel->sock();
     saddr = SockAddr{bound.ip, static_cast<uint16_t>(bound.port)};
 
-    // Find the first unused psuedo-port value starting from next_pseudo_port_.
-    if (auto p = find_unused_key(client_tunnels_, next_pseudo_port_))
-      pport = *p;
-    else
-      throw std::runtime_error{
-          "Unable to open an outgoing quic connection: too many existing connections"};
-    (next_pseudo_port_ = pport)++;
+    // We are emplacing into client_tunnels_ here: beyond this point we must not throw until we
+    // return (or if we do, make sure we remove this row from client_tunnels_ first).
+    auto& row = new_client_tunnel();
+    pport = row.first;
+    auto& ct = row.second;
 
     LogInfo("Bound TCP tunnel ", saddr, " for quic client :", pport);
 
-    // We are emplacing into client_tunnels_ here: beyond this point we must not throw until we
-    // return (or if we do, make sure we remove this row from client_tunnels_ first).
-    assert(client_tunnels_.count(pport) == 0);
-    auto& ct = client_tunnels_[pport];
     ct.open_cb = std::move(on_open);
     ct.tcp = std::move(tcp_tunnel);
     // We use this pport shared_ptr value on the listening tcp socket both to hand to pport into the
     // accept handler, and to let the accept handler know that `this` is still safe to use.
     ct.tcp->data(std::make_shared<uint16_t>(pport));
 
-    auto after_path = [this, port, pport = pport, remote_addr](auto maybe_convo) {
-      if (not continue_connecting(pport, (bool)maybe_convo, "path build", remote_addr))
-        return;
-      SockAddr dest{maybe_convo->ToV6()};
-      dest.setPort(port);
-      make_client(dest, *client_tunnels_.find(pport));
-    };
-
-    if (!maybe_remote)
-    {
-      // We were given an ONS address, so it's a two-step process: first we resolve the ONS name,
-      // then we have to build a path to that address.
-      service_endpoint_.LookupNameAsync(
-          remote_addr,
-          [this,
-           after_path = std::move(after_path),
-           pport = pport,
-           remote_addr = std::move(remote_addr)](auto maybe_remote) {
-            if (not continue_connecting(
-                    pport, (bool)maybe_remote, "endpoint ONS lookup", remote_addr))
-              return;
-            service_endpoint_.EnsurePathTo(*maybe_remote, after_path, open_timeout);
-          });
-      return result;
-    }
+    connect_tunnel(pport, port, std::move(remote_addr), std::move(maybe_remote));
+    return result;
+  }
 
-    auto& remote = *maybe_remote;
+  uint16_t
+  TunnelManager::open_stream(
+      std::string_view remote_address, uint16_t port, StreamOpenCallback on_stream)
+  {
+    if (!on_stream)
+      throw std::logic_error{"Cannot call open_stream() with a null callback"};
+    std::string remote_addr = lowercase_ascii_string(std::string{remote_address});
+    auto maybe_remote = parse_remote(remote_addr);
 
-    // See if we have an existing convo tag we can use to start things immediately
-    if (auto maybe_convo = service_endpoint_.GetBestConvoTagFor(remote))
-      after_path(maybe_convo);
-    else
-      service_endpoint_.EnsurePathTo(remote, after_path, open_timeout);
+    auto& [pport, ct] = new_client_tunnel();
+    LogInfo("Opening quic stream tunnel to ", remote_addr, ":", port, " as quic client :", pport);
+    ct.pending_streams.push(std::move(on_stream));
 
-    return result;
+    connect_tunnel(pport, port, std::move(remote_addr), std::move(maybe_remote));
+    return pport;
   }
 
   void
   TunnelManager::close(int id)
   {
-    if (auto it = client_tunnels_.find(id); it != client_tunnels_.end())
+    if (auto it = client_tunnels_.find(id); it != client_tunnels_.end() and it->second.tcp)
     {
       it->second.tcp->close();
       it->second.tcp->data(nullptr);
@@ -576,6 +709,13 @@ namespace llarp::quic
       }
       pending_incoming.pop();
     }
+
+    while (not pending_streams.empty())
+    {
+      auto on_stream = std::move(pending_streams.front());
+      pending_streams.pop();
+      on_stream(nullptr);
+    }
   }
 
   void
@@ -585,12 +725,23 @@ namespace llarp::quic
     auto& [pport, tunnel] = row;
     assert(not tunnel.client);
     tunnel.client = std::make_unique<Client>(service_endpoint_, remote, pport);
+    tunnel.client->coalesce_packets = coalesce_packets;
     auto conn = tunnel.client->get_connection();
 
     conn->on_stream_available = [this, id = row.first](Connection&) {
       LogDebug("QUIC connection :", id, " established; streams now available");
       if (auto it = client_tunnels_.find(id); it != client_tunnels_.end())
+      {
+        if (auto& opened = it->second.opened)
+        {
+          static auto& connectTime = metrics::Registry::Global().GetLatency(
+              "lokinet_quic_connect_seconds",
+              "time from opening a quic tunnel to its connection being established");
+          connectTime.Record(std::chrono::steady_clock::now() - *opened);
+          opened.reset();
+        }
         flush_pending_incoming(it->second);
+      }
     };
   }
 
@@ -630,6 +781,30 @@ namespace llarp::quic
       LogTrace("Set up new stream");
       conn.io_ready();
     }
+
+    while (available > 0 and not ct.pending_streams.empty())
+    {
+      auto on_stream = std::move(ct.pending_streams.front());
+      ct.pending_streams.pop();
+      try
+      {
+        auto str = conn.open_stream(
+            [on_stream](auto&&... args) {
+              initial_stream_data_handler(on_stream, std::forward<decltype(args)>(args)...);
+            },
+            [on_stream](auto&&... args) {
+              initial_stream_close_handler(on_stream, std::forward<decltype(args)>(args)...);
+            });
+        ct.streams.push_back(str);
+        available--;
+      }
+      catch (const std::exception& e)
+      {
+        LogWarn("Opening quic stream failed: ", e.what());
+        on_stream(nullptr);
+      }
+      conn.io_ready();
+    }
   }
 
   void
@@ -641,11 +816,11 @@ namespace llarp::quic
       return;
     }
     auto type = static_cast<std::byte>(buf.base[0]);
+    const bool coalesced = (type & COALESCED_FLAG) != std::byte{0};
+    type &= ~COALESCED_FLAG;
     nuint16_t pseudo_port_n;
     std::memcpy(&pseudo_port_n.n, &buf.base[1], 2);
     uint16_t pseudo_port = ToHost(pseudo_port_n).h;
-    auto ecn = static_cast<uint8_t>(buf.base[3]);
-    bstring_view data{reinterpret_cast<const std::byte*>(&buf.base[4]), buf.sz - 4};
 
     SockAddr remote{tag.ToV6()};
     quic::Endpoint* ep = nullptr;
@@ -692,6 +867,36 @@ namespace llarp::quic
       LogWarn("Invalid incoming quic packet type ", type, "; dropping packet");
       return;
     }
-    ep->receive_packet(remote, ecn, data);
+
+    if (not coalesced)
+    {
+      auto ecn = static_cast<uint8_t>(buf.base[3]);
+      bstring_view data{reinterpret_cast<const std::byte*>(&buf.base[4]), buf.sz - 4};
+      ep->receive_packet(remote, ecn, data);
+      return;
+    }
+
+    // Coalesced frame: a sequence of [ecn][length][packet] records following the 3-byte header
+    size_t pos = 3;
+    while (pos < buf.sz)
+    {
+      if (buf.sz - pos < COALESCED_RECORD_HEADER)
+      {
+        LogWarn("truncated coalesced quic record header; dropping rest of frame");
+        return;
+      }
+      auto ecn = static_cast<uint8_t>(buf.base[pos]);
+      nuint16_t len_n;
+      std::memcpy(&len_n.n, &buf.base[pos + 1], 2);
+      const size_t len = ToHost(len_n).h;
+      pos += COALESCED_RECORD_HEADER;
+      if (len == 0 or len > buf.sz - pos)
+      {
+        LogWarn("invalid coalesced quic record length ", len, "; dropping rest of frame");
+        return;
+      }
+      ep->receive_packet(remote, ecn, {reinterpret_cast<const std::byte*>(&buf.base[pos]), len});
+      pos += len;
+    }
   }
 }  // namespace llarp::quic
@@ -7,9 +7,12 @@
 #include "server.hpp"
 
 #include <charconv>
+#include <chrono>
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <variant>
 
 #include <uvw/tcp.h>
 
@@ -49,6 +52,11 @@ namespace llarp::quic
     // includes the resolution time.
     std::chrono::milliseconds open_timeout = 4s;
 
+    // If true then quic packets written together are coalesced into shared lokinet frames (see
+    // quic::Endpoint::begin_batch).  Applies to client and server endpoints created after it is
+    // set.
+    bool coalesce_packets = false;
+
     TunnelManager(EndpointBase& endpoint);
 
     /// Adds an incoming listener callback.  When a new incoming quic connection is initiated to us
@@ -73,7 +81,19 @@ namespace llarp::quic
     int
     listen(SockAddr port);
 
-    /// Removes an incoming connection handler; takes the ID returned by `listen()`.
+    /// Handler for incoming streams that the caller reads and writes itself instead of having them
+    /// forwarded to a local TCP socket.  Returning true takes the stream, in which case the handler
+    /// must have set the stream's `data_callback` and `close_callback`; returning false declines it
+    /// (we try the next handler, in order of registration); throwing refuses it outright.  These
+    /// share the handler ids and ordering of `listen()`.
+    using StreamListenHandler =
+        std::function<bool(std::string_view lokinet_addr, uint16_t port, Stream& stream)>;
+
+    int
+    listen_streams(StreamListenHandler handler);
+
+    /// Removes an incoming connection handler; takes the ID returned by `listen()` or
+    /// `listen_streams()`.
     void
     forget(int id);
 
@@ -117,6 +137,20 @@ namespace llarp::quic
         OpenCallback on_open = {},
         SockAddr bind_addr = {127, 0, 0, 1});
 
+    /// Called with the stream once the remote end has accepted it, or with nullptr if the tunnel or
+    /// the stream could not be established.
+    using StreamOpenCallback = std::function<void(std::shared_ptr<Stream>)>;
+
+    /// Opens a quic tunnel to some remote lokinet address like `open()`, but without the localhost
+    /// TCP socket: a single stream is opened over the connection once it is established and handed
+    /// to `on_stream` after the remote accepts it.  The caller then sets the stream's callbacks and
+    /// writes to it with `append_buffer()`.  (Should only be called from the event loop thread.)
+    ///
+    /// Returns the pseudo-port of the tunnel; the tunnel goes away once the stream has closed.
+    /// Throws the same as `open()` on an invalid remote address or if there are too many tunnels.
+    uint16_t
+    open_stream(std::string_view remote_addr, uint16_t port, StreamOpenCallback on_stream);
+
     /// Start closing an outgoing tunnel; takes the ID returned by `open()`.  Note that an existing
     /// established tunneled connections will not be forcibly closed; this simply stops accepting
     /// new tunnel connections.
@@ -126,7 +160,8 @@ namespace llarp::quic
     /// Called from tun code to deliver a quic packet.
     ///
     /// \param dest - the convotag for which the packet arrived
-    /// \param buf - the raw arriving packet
+    /// \param buf - the raw arriving packet; this may be a coalesced frame holding several quic
+    /// packets, in which case each is delivered in order.
     ///
     void
     receive_packet(const service::ConvoTag& tag, const llarp_buffer_t& buf);
@@ -147,13 +182,21 @@ namespace llarp::quic
       std::unique_ptr<Client> client;
       // Callback to invoke on quic connection established (true argument) or failed (false arg)
       OpenCallback open_cb;
-      // TCP listening socket
+      // TCP listening socket; null for tunnels made by `open_stream()`
       std::shared_ptr<uvw::TCPHandle> tcp;
       // Accepted TCP connections
       std::unordered_set<std::shared_ptr<uvw::TCPHandle>> conns;
       // Queue of incoming connections that are waiting for a stream to become available (either
       // because we are still handshaking, or we reached the stream limit).
       std::queue<std::weak_ptr<uvw::TCPHandle>> pending_incoming;
+      // `open_stream()` callbacks waiting for the connection to be established
+      std::queue<StreamOpenCallback> pending_streams;
+      // Streams opened for `open_stream()`; the tunnel is kept while any of them is open
+      std::vector<std::weak_ptr<Stream>> streams;
+      // When the tunnel was opened; cleared once the quic connection is established and the time
+      // it took has been recorded
+      std::optional<std::chrono::steady_clock::time_point> opened =
+          std::chrono::steady_clock::now();
 
       ~ClientTunnel();
     };
@@ -169,6 +212,23 @@ namespace llarp::quic
     continue_connecting(
         uint16_t pseudo_port, bool step_success, std::string_view step_name, std::string_view addr);
 
+    // Parses a lokinet address, returning nullopt for a valid ONS name; throws on anything else.
+    static std::optional<EndpointBase::AddressVariant_t>
+    parse_remote(const std::string& remote_addr);
+
+    // Allocates a pseudo-port and its (empty) client tunnel; throws if we are out of pseudo-ports.
+    std::pair<const uint16_t, ClientTunnel>&
+    new_client_tunnel();
+
+    // Resolves the remote if needed, builds a path to it and then starts the quic client of the
+    // tunnel on `pport`.
+    void
+    connect_tunnel(
+        uint16_t pseudo_port,
+        uint16_t port,
+        std::string remote_addr,
+        std::optional<EndpointBase::AddressVariant_t> maybe_remote);
+
     void
     make_client(const SockAddr& remote, std::pair<const uint16_t, ClientTunnel>& row);
 
@@ -187,12 +247,12 @@ namespace llarp::quic
     // parameters (which include the port) if this is an incoming connection (and this endpoint is a
     // server).  This checks handlers to see whether the stream is allowed and, if so, returns a
     // SockAddr containing the IP/port the tunnel should map to.  Returns nullopt if the connection
-    // should be rejected.
+    // should be rejected, or if a stream handler took the stream in which case `taken` is set.
     std::optional<SockAddr>
-    allow_connection(std::string_view lokinet_addr, uint16_t port);
+    allow_connection(std::string_view lokinet_addr, uint16_t port, Stream& stream, bool& taken);
 
     // Incoming stream handlers
-    std::map<int, ListenHandler> incoming_handlers_;
+    std::map<int, std::variant<ListenHandler, StreamListenHandler>> incoming_handlers_;
     int next_handler_id_ = 1;
 
     std::shared_ptr<uvw::Loop>
@@ -42,6 +42,7 @@ namespace llarp
   struct IOutboundSessionMaker;
   struct ILinkManager;
   struct I_RCLookupHandler;
+  struct RCSyncer;
   struct RoutePoker;
 
   namespace exit
@@ -173,6 +174,9 @@ namespace llarp
     virtual I_RCLookupHandler&
     rcLookupHandler() = 0;
 
+    virtual RCSyncer&
+    rcSyncer() = 0;
+
     virtual std::shared_ptr<PeerDb>
     peerDb() = 0;
 
@@ -5,7 +5,9 @@
 #include "i_rc_lookup_handler.hpp"
 #include <llarp/link/i_link_manager.hpp>
 #include <llarp/constants/link_layer.hpp>
+#include <llarp/util/instrument.hpp>
 #include <llarp/util/meta/memfn.hpp>
+#include <llarp/util/metrics.hpp>
 #include <llarp/util/status.hpp>
 
 #include <algorithm>
@@ -77,6 +79,12 @@ namespace llarp
   void
   OutboundMessageHandler::Tick()
   {
+    LLARP_ZONE();
+    LLARP_PLOT("outbound message queue", outboundQueue.size());
+    LLARP_PLOT("outbound path queues", roundRobinOrder.size());
+    static auto& queued = metrics::Registry::Global().GetGauge(
+        "lokinet_queue_depth", "items waiting in a queue", {{"queue", "outbound_messages"}});
+    queued.Set(outboundQueue.size());
     m_Killer.TryAccess([self = this]() {
       self->ProcessOutboundQueue();
       self->RemoveEmptyPathQueues();
@@ -247,6 +255,8 @@ namespace llarp
     entry.priority = priority;
     if (outboundQueue.tryPushBack(std::move(entry)) != llarp::thread::QueueReturn::Success)
     {
+      static auto& dropped = metrics::Drops("outbound_queue_full");
+      dropped.Add();
       m_queueStats.dropped++;
       DoCallback(callback_copy, SendStatus::Congestion);
     }
@@ -284,6 +294,8 @@ namespace llarp
       }
       else
       {
+        static auto& dropped = metrics::Drops("path_queue_full");
+        dropped.Add();
         DoCallback(entry.message.second, SendStatus::Congestion);
         m_queueStats.dropped++;
       }
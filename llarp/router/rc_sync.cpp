@@ -0,0 +1,360 @@
+#include "rc_sync.hpp"
+
+#include "abstractrouter.hpp"
+#include "i_rc_lookup_handler.hpp"
+#include <llarp/crypto/crypto.hpp>
+#include <llarp/dht/context.hpp>
+#include <llarp/dht/messages/rcsync.hpp>
+#include <llarp/link/i_link_manager.hpp>
+#include <llarp/nodedb.hpp>
+#include <llarp/util/endian.hpp>
+#include <llarp/util/logging/logger.hpp>
+
+#include <bitset>
+
+namespace llarp
+{
+  static uint64_t
+  Mix(uint64_t x)
+  {
+    // splitmix64 finalizer, every relay must hash the same way so this cannot be seeded
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  uint64_t
+  RCSketch::Hash(const RouterID& id, llarp_time_t updated)
+  {
+    uint64_t h = Mix(updated.count());
+    for (size_t pos = 0; pos < RouterID::SIZE; pos += 8)
+    {
+      h = Mix(h ^ le64toh(buf64toh(id.data() + pos)));
+    }
+    return h;
+  }
+
+  std::vector<uint8_t>
+  RCSketch::Differing(const Digest_t& other) const
+  {
+    std::vector<uint8_t> buckets;
+    for (size_t idx = 0; idx < NumBuckets; ++idx)
+    {
+      if (m_Digest[idx] != other[idx])
+        buckets.push_back(idx);
+    }
+    return buckets;
+  }
+
+  std::string
+  RCSketch::EncodeDigest(const Digest_t& digest)
+  {
+    std::string data(NumBuckets * 8, '\0');
+    for (size_t idx = 0; idx < NumBuckets; ++idx)
+      htobe64buf(data.data() + idx * 8, digest[idx]);
+    return data;
+  }
+
+  std::optional<RCSketch::Digest_t>
+  RCSketch::DecodeDigest(std::string_view data)
+  {
+    if (data.size() != NumBuckets * 8)
+      return std::nullopt;
+    Digest_t digest;
+    for (size_t idx = 0; idx < NumBuckets; ++idx)
+      digest[idx] = bufbe64toh(data.data() + idx * 8);
+    return digest;
+  }
+
+  std::string
+  RCSyncEntry::Pack(const std::vector<RCSyncEntry>& entries)
+  {
+    std::string data(entries.size() * PackedSize, '\0');
+    auto* ptr = data.data();
+    for (const auto& entry : entries)
+    {
+      std::memcpy(ptr, entry.id.data(), RouterID::SIZE);
+      htobe64buf(ptr + RouterID::SIZE, entry.updated.count());
+      ptr += PackedSize;
+    }
+    return data;
+  }
+
+  std::optional<std::vector<RCSyncEntry>>
+  RCSyncEntry::Unpack(std::string_view data)
+  {
+    if (data.size() % PackedSize)
+      return std::nullopt;
+    std::vector<RCSyncEntry> entries;
+    entries.reserve(data.size() / PackedSize);
+    for (auto* ptr = data.data(); ptr < data.data() + data.size(); ptr += PackedSize)
+    {
+      entries.push_back(RCSyncEntry{
+          RouterID{reinterpret_cast<const byte_t*>(ptr)},
+          llarp_time_t{bufbe64toh(ptr + RouterID::SIZE)}});
+    }
+    return entries;
+  }
+
+  RCSyncPlan
+  PlanRCSync(
+      const std::unordered_map<RouterID, llarp_time_t>& ours,
+      const std::vector<uint8_t>& complete,
+      const std::vector<RCSyncEntry>& theirs)
+  {
+    RCSyncPlan plan;
+    std::unordered_map<RouterID, llarp_time_t> listed;
+    for (const auto& entry : theirs)
+    {
+      listed.emplace(entry.id, entry.updated);
+      const auto itr = ours.find(entry.id);
+      if (itr == ours.end() or itr->second < entry.updated)
+        plan.want.push_back(entry.id);
+      else if (entry.updated < itr->second)
+        plan.push.push_back(entry.id);
+    }
+    std::bitset<RCSketch::NumBuckets> full;
+    for (const auto bucket : complete)
+      full.set(bucket);
+    for (const auto& [id, updated] : ours)
+    {
+      if (full.test(RCSketch::Bucket(id)) and listed.count(id) == 0)
+        plan.push.push_back(id);
+    }
+    return plan;
+  }
+
+  void
+  RCSyncer::Init(AbstractRouter* router)
+  {
+    m_Router = router;
+  }
+
+  RCSketch
+  RCSyncer::BuildSketch() const
+  {
+    RCSketch sketch;
+    m_Router->nodedb()->VisitAll(
+        [&sketch](const RouterContact& rc) { sketch.Add(rc.pubkey, rc.last_updated); });
+    return sketch;
+  }
+
+  void
+  RCSyncer::Tick(llarp_time_t now)
+  {
+    if (m_Router == nullptr)
+      return;
+    if (now >= m_NextSyncAt)
+    {
+      std::vector<RouterID> peers;
+      m_Router->linkManager().ForEachPeer([&peers](ILinkSession* session) {
+        if (session and session->IsEstablished() and session->GetRemoteRC().IsPublicRouter())
+          peers.emplace_back(session->GetPubKey());
+      });
+      // try again next tick if we have nobody to sync with yet
+      if (not peers.empty())
+      {
+        m_NextSyncAt = now + SyncInterval;
+        // whatever did not answer by now is not going to
+        m_Pending.clear();
+        for (auto itr = m_Served.begin(); itr != m_Served.end();)
+        {
+          if (now - itr->second.at > SyncInterval)
+            itr = m_Served.erase(itr);
+          else
+            ++itr;
+        }
+        SyncWith(peers[randint() % peers.size()], now);
+      }
+    }
+  }
+
+  void
+  RCSyncer::SyncWith(const RouterID& peer, llarp_time_t)
+  {
+    const uint64_t txid = randint();
+    m_Pending[peer] = txid;
+    LogDebug("starting rc sync with ", peer);
+    m_Router->dht()->impl->DHTSendTo(
+        peer, new dht::RCSyncDigestMessage(txid, BuildSketch().Digest()));
+  }
+
+  void
+  RCSyncer::HandleDigest(const RouterID& from, uint64_t txid, const RCSketch::Digest_t& digest)
+  {
+    // clients hold a partial view, they only ever ask
+    if (not m_Router->IsServiceNode())
+      return;
+    const auto now = m_Router->Now();
+    if (auto itr = m_Served.find(from);
+        itr != m_Served.end() and now - itr->second.at < MinServeInterval)
+    {
+      LogDebug("ignoring rc sync digest from ", from, ": asked too often");
+      return;
+    }
+    auto& served = m_Served[from];
+    served = RCSyncServed{txid, now};
+
+    const auto differing = BuildSketch().Differing(digest);
+    std::bitset<RCSketch::NumBuckets> wanted;
+    for (const auto bucket : differing)
+      wanted.set(bucket);
+    std::array<std::vector<RCSyncEntry>, RCSketch::NumBuckets> byBucket;
+    m_Router->nodedb()->VisitAll([&](const RouterContact& rc) {
+      const auto bucket = RCSketch::Bucket(rc.pubkey);
+      if (wanted.test(bucket))
+        byBucket[bucket].push_back(RCSyncEntry{rc.pubkey, rc.last_updated});
+    });
+
+    std::vector<uint8_t> complete;
+    std::vector<RCSyncEntry> entries;
+    size_t sent = 0;
+    auto flush = [&]() {
+      served.listed += entries.size();
+      m_Router->dht()->impl->DHTSendTo(
+          from, new dht::RCSyncSummaryMessage(txid, std::move(complete), std::move(entries)));
+      complete.clear();
+      entries.clear();
+      ++sent;
+    };
+    for (const auto bucket : differing)
+    {
+      const auto& list = byBucket[bucket];
+      if (entries.size() + list.size() > MaxEntriesPerSummary)
+      {
+        if (not(complete.empty() and entries.empty()))
+          flush();
+      }
+      if (list.size() <= MaxEntriesPerSummary)
+      {
+        complete.push_back(bucket);
+        entries.insert(entries.end(), list.begin(), list.end());
+        continue;
+      }
+      // too big for one message, list it in parts without claiming any of them is complete
+      for (size_t pos = 0; pos < list.size(); pos += MaxEntriesPerSummary)
+      {
+        const auto end = std::min(list.size(), pos + MaxEntriesPerSummary);
+        entries.assign(list.begin() + pos, list.begin() + end);
+        flush();
+      }
+    }
+    // an empty summary tells them we agree
+    if (sent == 0 or not(complete.empty() and entries.empty()))
+      flush();
+    LogDebug("rc sync with ", from, ": ", differing.size(), " buckets differ");
+  }
+
+  void
+  RCSyncer::HandleSummary(
+      const RouterID& from,
+      uint64_t txid,
+      const std::vector<uint8_t>& complete,
+      const std::vector<RCSyncEntry>& entries)
+  {
+    if (auto itr = m_Pending.find(from); itr == m_Pending.end() or itr->second != txid)
+    {
+      LogDebug("unexpected rc sync summary from ", from);
+      return;
+    }
+    if (complete.empty() and entries.empty())
+      return;
+
+    std::bitset<RCSketch::NumBuckets> touched;
+    for (const auto bucket : complete)
+      touched.set(bucket);
+    for (const auto& entry : entries)
+      touched.set(RCSketch::Bucket(entry.id));
+    std::unordered_map<RouterID, llarp_time_t> ours;
+    m_Router->nodedb()->VisitAll([&](const RouterContact& rc) {
+      if (touched.test(RCSketch::Bucket(rc.pubkey)))
+        ours.emplace(rc.pubkey, rc.last_updated);
+    });
+    const auto plan = PlanRCSync(ours, complete, entries);
+    LogDebug(
+        "rc sync with ", from, ": sending ", plan.push.size(), " asking for ", plan.want.size());
+    SendBatches(from, txid, plan.push, plan.want);
+  }
+
+  void
+  RCSyncer::HandleBatch(
+      const RouterID& from,
+      uint64_t txid,
+      const std::vector<RouterContact>& rcs,
+      const std::vector<RouterID>& wanted)
+  {
+    const auto pending = m_Pending.find(from);
+    const auto served = m_Served.find(from);
+    const bool started = pending != m_Pending.end() and pending->second == txid;
+    const bool answered = served != m_Served.end() and served->second.txid == txid;
+    if (not(started or answered) or rcs.size() > MaxRCsPerBatch
+        or wanted.size() > MaxWantedPerBatch)
+    {
+      LogDebug("unexpected rc sync batch from ", from);
+      return;
+    }
+    for (const auto& rc : rcs)
+    {
+      // verifies it and puts it in the nodedb and dht if it is newer
+      if (not m_Router->rcLookupHandler().CheckRC(rc))
+        LogDebug("rc sync from ", from, " gave us a bad rc for ", RouterID{rc.pubkey});
+    }
+    // only the side that answered the digest sends what was asked for, so this ends here
+    if (answered and not wanted.empty())
+    {
+      if (const auto owed = served->second.Take(wanted); not owed.empty())
+        SendBatches(from, txid, owed, {});
+    }
+  }
+
+  std::vector<RouterID>
+  RCSyncServed::Take(const std::vector<RouterID>& wanted)
+  {
+    std::vector<RouterID> owed;
+    for (const auto& id : wanted)
+    {
+      if (sent.size() >= listed)
+        break;
+      if (sent.insert(id).second)
+        owed.push_back(id);
+    }
+    return owed;
+  }
+
+  void
+  RCSyncer::SendBatches(
+      const RouterID& peer,
+      uint64_t txid,
+      const std::vector<RouterID>& push,
+      const std::vector<RouterID>& want)
+  {
+    // rcs and the ids we want go in separate messages so either kind fills one link message
+    const auto nodedb = m_Router->nodedb();
+    auto pushItr = push.begin();
+    while (pushItr != push.end())
+    {
+      std::vector<RouterContact> rcs;
+      for (; rcs.size() < MaxRCsPerBatch and pushItr != push.end(); ++pushItr)
+      {
+        if (auto maybe = nodedb->Get(*pushItr))
+          rcs.push_back(std::move(*maybe));
+      }
+      if (not rcs.empty())
+      {
+        m_Router->dht()->impl->DHTSendTo(
+            peer, new dht::RCSyncBatchMessage(txid, std::move(rcs), {}));
+      }
+    }
+    for (auto wantItr = want.begin(); wantItr != want.end();)
+    {
+      const auto numWanted =
+          std::min<size_t>(MaxWantedPerBatch, std::distance(wantItr, want.end()));
+      std::vector<RouterID> wanted{wantItr, wantItr + numWanted};
+      wantItr += numWanted;
+      m_Router->dht()->impl->DHTSendTo(
+          peer, new dht::RCSyncBatchMessage(txid, {}, std::move(wanted)));
+    }
+  }
+}  // namespace llarp
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <llarp/constants/link_layer.hpp>
+#include <llarp/router_contact.hpp>
+#include <llarp/router_id.hpp>
+#include <llarp/util/time.hpp>
+
+#include <array>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace llarp
+{
+  struct AbstractRouter;
+
+  /// a digest of a set of rcs, keyed by router id and last updated time. entries are split
+  /// into buckets by the first byte of the router id and every bucket holds the xor of its
+  /// entries' hashes, so two relays can tell which buckets they disagree on from one message
+  /// and only list those.
+  struct RCSketch
+  {
+    static constexpr size_t NumBuckets = 256;
+    using Digest_t = std::array<uint64_t, NumBuckets>;
+
+    static uint8_t
+    Bucket(const RouterID& id)
+    {
+      return id[0];
+    }
+
+    static uint64_t
+    Hash(const RouterID& id, llarp_time_t updated);
+
+    void
+    Add(const RouterID& id, llarp_time_t updated)
+    {
+      m_Digest[Bucket(id)] ^= Hash(id, updated);
+    }
+
+    const Digest_t&
+    Digest() const
+    {
+      return m_Digest;
+    }
+
+    /// the buckets where other does not match us
+    std::vector<uint8_t>
+    Differing(const Digest_t& other) const;
+
+    /// pack a digest for the wire, 8 big endian bytes per bucket
+    static std::string
+    EncodeDigest(const Digest_t& digest);
+
+    static std::optional<Digest_t>
+    DecodeDigest(std::string_view data);
+
+   private:
+    Digest_t m_Digest{};
+  };
+
+  /// one router in an rc sync summary
+  struct RCSyncEntry
+  {
+    RouterID id;
+    llarp_time_t updated;
+
+    static constexpr size_t PackedSize = RouterID::SIZE + 8;
+
+    /// pack entries for the wire, the router id then 8 big endian bytes of last updated in ms
+    static std::string
+    Pack(const std::vector<RCSyncEntry>& entries);
+
+    static std::optional<std::vector<RCSyncEntry>>
+    Unpack(std::string_view data);
+  };
+
+  /// what to send and what to ask for after a peer listed its entries for some buckets
+  struct RCSyncPlan
+  {
+    /// rcs we have that they lack or have an older copy of
+    std::vector<RouterID> push;
+    /// rcs they have that we lack or have an older copy of
+    std::vector<RouterID> want;
+  };
+
+  /// compare our entries with the ones a peer sent. we only push what they are missing from
+  /// the buckets in complete, the buckets they listed in full; anything newer they listed we
+  /// want regardless.
+  RCSyncPlan
+  PlanRCSync(
+      const std::unordered_map<RouterID, llarp_time_t>& ours,
+      const std::vector<uint8_t>& complete,
+      const std::vector<RCSyncEntry>& theirs);
+
+  /// a digest we answered and the rcs we sent for it since. a peer can send batches for the same
+  /// txid as often as it likes, so what it asks for is only served once per id and never more
+  /// than the entries our summaries listed.
+  struct RCSyncServed
+  {
+    uint64_t txid = 0;
+    llarp_time_t at = 0s;
+    /// how many entries our summaries listed
+    size_t listed = 0;
+    std::unordered_set<RouterID> sent;
+
+    /// the ids in wanted we still owe them, counted as sent
+    std::vector<RouterID>
+    Take(const std::vector<RouterID>& wanted);
+  };
+
+  /// bulk rc synchronization between connected relays. every SyncInterval we send our digest to
+  /// one peer, it answers with its entries for the buckets that differ, and we then exchange
+  /// only the rcs either side is missing or has an older copy of, a handful per message.
+  struct RCSyncer
+  {
+    /// how often we reconcile with one of our peers
+    static constexpr auto SyncInterval = 5min;
+    /// we answer one digest per peer this often at most
+    static constexpr auto MinServeInterval = 1min;
+    /// entries per summary message, each one is 40 bytes
+    static constexpr size_t MaxEntriesPerSummary = 150;
+    /// rcs per batch message, each one is up to MAX_RC_SIZE
+    static constexpr size_t MaxRCsPerBatch = 6;
+    /// router ids we ask for in one batch message, never sent alongside rcs
+    static constexpr size_t MaxWantedPerBatch = 128;
+    /// what a link message spends on the headers around a summary's entries or a batch's rcs
+    static constexpr size_t MessageOverhead = 256;
+
+    void
+    Init(AbstractRouter* router);
+
+    /// start a sync with a random connected relay if one is due
+    void
+    Tick(llarp_time_t now);
+
+    /// send our digest to peer
+    void
+    SyncWith(const RouterID& peer, llarp_time_t now);
+
+    /// peer sent us their digest, answer with our entries for the buckets that differ
+    void
+    HandleDigest(const RouterID& from, uint64_t txid, const RCSketch::Digest_t& digest);
+
+    /// peer answered our digest
+    void
+    HandleSummary(
+        const RouterID& from,
+        uint64_t txid,
+        const std::vector<uint8_t>& complete,
+        const std::vector<RCSyncEntry>& entries);
+
+    /// peer sent rcs and maybe asked for some of ours
+    void
+    HandleBatch(
+        const RouterID& from,
+        uint64_t txid,
+        const std::vector<RouterContact>& rcs,
+        const std::vector<RouterID>& wanted);
+
+   private:
+    RCSketch
+    BuildSketch() const;
+
+    void
+    SendBatches(
+        const RouterID& peer,
+        uint64_t txid,
+        const std::vector<RouterID>& push,
+        const std::vector<RouterID>& want);
+
+    AbstractRouter* m_Router = nullptr;
+    llarp_time_t m_NextSyncAt = 0s;
+    /// the sync we started with each peer
+    std::unordered_map<RouterID, uint64_t> m_Pending;
+    /// the last digest we answered from each peer
+    std::unordered_map<RouterID, RCSyncServed> m_Served;
+  };
+
+  static_assert(
+      RCSyncer::MaxEntriesPerSummary * RCSyncEntry::PackedSize + RCSketch::NumBuckets
+          + RCSyncer::MessageOverhead
+      <= MAX_LINK_MSG_SIZE);
+  static_assert(
+      RCSyncer::MaxRCsPerBatch * MAX_RC_SIZE + RCSyncer::MessageOverhead <= MAX_LINK_MSG_SIZE);
+  // each router id is bencoded as 32:<id>
+  static_assert(
+      RCSyncer::MaxWantedPerBatch * (RouterID::SIZE + 3) + RCSyncer::MessageOverhead
+      <= MAX_LINK_MSG_SIZE);
+}  // namespace llarp
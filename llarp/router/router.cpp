@@ -15,11 +15,13 @@
 #include <llarp/net/route.hpp>
 #include <stdexcept>
 #include <llarp/util/buffer.hpp>
+#include <llarp/util/instrument.hpp>
 #include <llarp/util/logging/file_logger.hpp>
 #include <llarp/util/logging/json_logger.hpp>
 #include <llarp/util/logging/logger_syslog.hpp>
 #include <llarp/util/logging/logger.hpp>
 #include <llarp/util/meta/memfn.hpp>
+#include <llarp/util/metrics.hpp>
 #include <llarp/util/str.hpp>
 #include <llarp/ev/ev.hpp>
 #include <llarp/tooling/peer_stats_event.hpp>
@@ -66,6 +68,7 @@ namespace llarp
       , m_lokidRpcClient(std::make_shared<rpc::LokidRpcClient>(m_lmq, this))
   {
     m_keyManager = std::make_shared<KeyManager>();
+    paths.SetWorker([lmq = m_lmq](auto job) { lmq->job(std::move(job)); });
     // for lokid, so we don't close the connection when syncing the whitelist
     m_lmq->MAX_MSG_SIZE = -1;
     _stopping.store(false);
@@ -182,6 +185,7 @@ namespace llarp
   void
   Router::PumpLL()
   {
+    LLARP_ZONE();
     llarp::LogTrace("Router::PumpLL() start");
     if (_stopping.load())
       return;
@@ -295,6 +299,8 @@ namespace llarp
     enableRPCServer = conf.api.m_enableRPCServer;
     if (enableRPCServer)
       rpcBindAddr = oxenmq::address(conf.api.m_rpcBindAddr);
+    if (conf.api.m_metricsBindAddr)
+      metricsBindAddr = conf.api.m_metricsBindAddr->createSockAddr();
 
     if (not StartRpcServer())
       throw std::runtime_error("Failed to start rpc server");
@@ -363,6 +369,8 @@ namespace llarp
     if (_onDown)
       _onDown();
     LogInfo("closing router");
+    if (m_MetricsServer)
+      m_MetricsServer->Stop();
     _loop->stop();
     _running.store(false);
   }
@@ -588,6 +596,7 @@ namespace llarp
         bootstrapRCList,
         whitelistRouters,
         m_isServiceNode);
+    _rcSyncer.Init(this);
 
     std::vector<LinksConfig::LinkInfo> inboundLinks = conf.links.m_InboundLinks;
 
@@ -672,8 +681,7 @@ namespace llarp
         conf.logging.m_logLevel,
         conf.logging.m_logType,
         conf.logging.m_logFile,
-        conf.router.m_nickname,
-        util::memFn(&AbstractRouter::QueueDiskIO, this));
+        conf.router.m_nickname);
 
     return true;
   }
@@ -722,6 +730,7 @@ namespace llarp
   void
   Router::Tick()
   {
+    LLARP_ZONE();
     if (_stopping)
       return;
     // LogDebug("tick router");
@@ -761,6 +770,9 @@ namespace llarp
 
     _rcGossiper.Decay(now);
 
+    // rcs a bulk sync brought in count as just inserted, so only the ones it did not update are
+    // looked up one by one here
+    _rcSyncer.Tick(now);
     _rcLookupHandler.PeriodicUpdate(now);
 
     const bool isSvcNode = IsServiceNode();
@@ -899,6 +911,7 @@ namespace llarp
         [&peersWeHave](const dht::Key_t& k) -> bool { return peersWeHave.count(k) == 0; });
     // expire paths
     paths.ExpirePaths(now);
+    paths.TopUpKeyPool();
     // update tick timestamp
     _lastTick = llarp::time_now_ms();
   }
@@ -1010,6 +1023,12 @@ namespace llarp
       m_RPCServer->AsyncServeRPC(rpcBindAddr);
       LogInfo("Bound RPC server to ", rpcBindAddr);
     }
+    if (metricsBindAddr)
+    {
+      m_MetricsServer = std::make_unique<rpc::MetricsServer>(metrics::Registry::Global());
+      if (not m_MetricsServer->Start(*metricsBindAddr))
+        return false;
+    }
 
     return true;
   }
@@ -1177,6 +1196,7 @@ namespace llarp
   {
     StopLinks();
     nodedb()->SaveToDisk();
+    _dht->impl->SaveIntroSets();
     _loop->call_later(200ms, [this] { AfterStopLinks(); });
   }
 
@@ -22,10 +22,12 @@
 #include "outbound_session_maker.hpp"
 #include "rc_gossiper.hpp"
 #include "rc_lookup_handler.hpp"
+#include "rc_sync.hpp"
 #include "route_poker.hpp"
 #include <llarp/routing/handler.hpp>
 #include <llarp/routing/message_parser.hpp>
 #include <llarp/rpc/lokid_rpc_client.hpp>
+#include <llarp/rpc/metrics_server.hpp>
 #include <llarp/rpc/rpc_server.hpp>
 #include <llarp/service/context.hpp>
 #include <stdexcept>
@@ -266,6 +268,8 @@ namespace llarp
     bool enableRPCServer = false;
     oxenmq::address rpcBindAddr = DefaultRPCBindAddr;
     std::unique_ptr<rpc::RpcServer> m_RPCServer;
+    std::optional<SockAddr> metricsBindAddr;
+    std::unique_ptr<rpc::MetricsServer> m_MetricsServer;
 
     const llarp_time_t _randomStartDelay;
 
@@ -279,6 +283,7 @@ namespace llarp
     LinkManager _linkManager;
     RCLookupHandler _rcLookupHandler;
     RCGossiper _rcGossiper;
+    RCSyncer _rcSyncer;
 
     using Clock_t = std::chrono::steady_clock;
     using TimePoint_t = Clock_t::time_point;
@@ -309,6 +314,12 @@ namespace llarp
       return _rcLookupHandler;
     }
 
+    RCSyncer&
+    rcSyncer() override
+    {
+      return _rcSyncer;
+    }
+
     std::shared_ptr<PeerDb>
     peerDb() override
     {
@@ -448,7 +459,7 @@ namespace llarp
     llarp_time_t
     Now() const override
     {
-      return llarp::time_now_ms();
+      return _loop->time_now();
     }
 
     /// parse a routing message in a buffer and handle it with a handler if
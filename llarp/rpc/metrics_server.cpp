@@ -0,0 +1,161 @@
+#include "metrics_server.hpp"
+
+#include <llarp/util/logging/logger.hpp>
+#include <llarp/util/metrics.hpp>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace llarp::rpc
+{
+  /// largest request we read before giving up on finding the end of the headers
+  static constexpr size_t MaxRequestSize = 8192;
+
+#ifdef MSG_NOSIGNAL
+  static constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+  static constexpr int SendFlags = 0;
+#endif
+
+  MetricsServer::MetricsServer(const metrics::Registry& registry) : m_Registry{registry}
+  {}
+
+  MetricsServer::~MetricsServer()
+  {
+    Stop();
+  }
+
+#ifdef _WIN32
+  bool
+  MetricsServer::Start(const SockAddr& addr)
+  {
+    // not being able to serve metrics is not worth failing to start over
+    LogWarn("cannot serve metrics on ", addr, ": the metrics listener is not supported on windows");
+    return true;
+  }
+
+  void
+  MetricsServer::Stop()
+  {}
+
+  void
+  MetricsServer::Run()
+  {}
+
+  void
+  MetricsServer::Serve(int)
+  {}
+#else
+  bool
+  MetricsServer::Start(const SockAddr& addr)
+  {
+    if (m_Running)
+      return false;
+    m_FD = ::socket(addr.isIPv6() ? AF_INET6 : AF_INET, SOCK_STREAM, 0);
+    if (m_FD == -1)
+    {
+      LogError("cannot make metrics listener socket: ", strerror(errno));
+      return false;
+    }
+    int on = 1;
+    ::setsockopt(m_FD, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (::bind(m_FD, addr, addr.sockaddr_len()) == -1 or ::listen(m_FD, 8) == -1)
+    {
+      LogError("cannot bind metrics listener to ", addr, ": ", strerror(errno));
+      ::close(m_FD);
+      m_FD = -1;
+      return false;
+    }
+    m_Running = true;
+    m_Thread = std::thread{[this]() { Run(); }};
+    LogInfo("serving metrics on http://", addr, "/metrics");
+    return true;
+  }
+
+  void
+  MetricsServer::Stop()
+  {
+    if (not m_Running.exchange(false))
+      return;
+    if (m_Thread.joinable())
+      m_Thread.join();
+    ::close(m_FD);
+    m_FD = -1;
+  }
+
+  void
+  MetricsServer::Run()
+  {
+    while (m_Running)
+    {
+      // wake up now and then to notice Stop()
+      pollfd pfd{m_FD, POLLIN, 0};
+      if (::poll(&pfd, 1, 250) <= 0)
+        continue;
+      const int fd = ::accept(m_FD, nullptr, nullptr);
+      if (fd == -1)
+        continue;
+      Serve(fd);
+      ::close(fd);
+    }
+  }
+
+  void
+  MetricsServer::Serve(int fd)
+  {
+    // a slow or idle client must not hold up the next scrape for long
+    timeval timeout{1, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos)
+    {
+      const auto got = ::recv(fd, buf, sizeof(buf), 0);
+      if (got <= 0 or request.size() + got > MaxRequestSize)
+        return;
+      request.append(buf, got);
+    }
+
+    const std::string_view line{request.data(), request.find("\r\n")};
+    std::string status = "200 OK";
+    std::string contentType = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+    std::string body;
+    if (line.substr(0, 4) != "GET ")
+    {
+      status = "405 Method Not Allowed";
+      contentType = "text/plain";
+    }
+    else if (const auto path = line.substr(4, line.find(' ', 4) - 4);
+             path != "/metrics" and path.substr(0, 9) != "/metrics?")
+    {
+      status = "404 Not Found";
+      contentType = "text/plain";
+    }
+    else
+      body = m_Registry.ExportOpenMetrics();
+
+    std::string response = "HTTP/1.1 " + status + "\r\nContent-Type: " + contentType
+        + "\r\nContent-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n"
+        + body;
+    std::string_view remaining{response};
+    while (not remaining.empty())
+    {
+      const auto sent = ::send(fd, remaining.data(), remaining.size(), SendFlags);
+      if (sent <= 0)
+        return;
+      remaining.remove_prefix(sent);
+    }
+  }
+#endif
+}  // namespace llarp::rpc
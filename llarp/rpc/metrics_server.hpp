@@ -0,0 +1,51 @@
+#pragma once
+
+#include <llarp/net/sock_addr.hpp>
+
+#include <atomic>
+#include <thread>
+
+namespace llarp::metrics
+{
+  class Registry;
+}
+
+namespace llarp::rpc
+{
+  /// a minimal http listener that serves GET /metrics in the openmetrics text format so
+  /// prometheus can scrape a router without going through the lmq rpc. it answers one request
+  /// at a time on its own thread and never touches the event loop.
+  class MetricsServer
+  {
+   public:
+    explicit MetricsServer(const metrics::Registry& registry);
+
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer&
+    operator=(const MetricsServer&) = delete;
+
+    /// bind addr and start serving, returns false if we could not bind. on windows, where there is
+    /// no listener, it only warns.
+    bool
+    Start(const SockAddr& addr);
+
+    /// stop serving and wait for the listener thread to exit
+    void
+    Stop();
+
+   private:
+    void
+    Run();
+
+    /// answer one request on an accepted connection
+    void
+    Serve(int fd);
+
+    const metrics::Registry& m_Registry;
+    int m_FD = -1;
+    std::atomic<bool> m_Running{false};
+    std::thread m_Thread;
+  };
+}  // namespace llarp::rpc
@@ -11,6 +11,7 @@
 #include <llarp/service/auth.hpp>
 #include <llarp/service/name.hpp>
 #include <llarp/router/abstractrouter.hpp>
+#include <llarp/util/metrics.hpp>
 
 namespace llarp::rpc
 {
@@ -133,6 +134,18 @@ namespace llarp::rpc
                 defer.reply(data);
               });
             })
+        .add_request_command(
+            "metrics",
+            [](oxenmq::Message& msg) {
+              // replies with openmetrics text rather than json so it can be handed to a scraper
+              // as is; reading the registry is thread safe so this does not touch the loop
+              msg.send_reply(metrics::Registry::Global().ExportOpenMetrics());
+            })
+        .add_request_command(
+            "latency",
+            [](oxenmq::Message& msg) {
+              msg.send_reply(CreateJSONResponse(metrics::Registry::Global().ExtractLatencies()));
+            })
         .add_request_command(
             "quic_connect",
             [&](oxenmq::Message& msg) {
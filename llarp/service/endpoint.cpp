@@ -70,6 +70,9 @@ namespace llarp
       if (conf.m_Hops.has_value())
         numHops = *conf.m_Hops;
 
+      if (m_quic)
+        m_quic->coalesce_packets = conf.m_QUICCoalesce;
+
       conf.m_ExitMap.ForEachEntry(
           [&](const IPRange& range, const service::Address& addr) { MapExitRange(range, addr); });
 
@@ -143,6 +146,8 @@ namespace llarp
         if (quic->hasListeners())
           introSet().supportedProtocols.push_back(ProtocolType::QUIC);
       }
+      if (AcceptsResumedConvos())
+        introSet().supportedProtocols.push_back(ProtocolType::Resume);
 
       introSet().intros.clear();
       for (auto& intro : introset)
@@ -218,13 +223,23 @@ namespace llarp
     {
       auto fail = [resultHandler]() { resultHandler({}); };
 
-      auto lookupByAddress = [service, fail, resultHandler](auto address) {
-        // TODO: remove me after implementing the rest
-        fail();
-        if (auto* ptr = std::get_if<RouterID>(&address))
-        {}
-        else if (auto* ptr = std::get_if<Address>(&address))
-        {}
+      auto lookupByAddress = [this, service, fail, resultHandler](auto address) {
+        // snodes do not publish srv records
+        if (auto* ptr = std::get_if<Address>(&address))
+        {
+          // the records come with the introset, which we have once there is a path to them
+          EnsurePathToService(
+              *ptr,
+              [service, fail, resultHandler](const Address&, OutboundContext* ctx) {
+                if (ctx == nullptr)
+                {
+                  fail();
+                  return;
+                }
+                resultHandler(ctx->GetCurrentIntroSet().GetMatchingSRVRecords(service));
+              },
+              5s);
+        }
         else
         {
           fail();
@@ -284,8 +299,23 @@ namespace llarp
         RegenAndPublishIntroSet();
       }
 
-      // expire name cache
+      // refresh the intro sets and names we use before they go stale so a new session to them
+      // never waits on a lookup
+      for (const auto& remote : m_state->introsetCache.TakeDue(now))
+        PrefetchIntroSet(remote);
+      for (auto& name : m_state->nameCache.TakeDue(now))
+        ResolveName(std::move(name), [](auto) {}, true);
+      // expire name and intro set caches
       m_state->nameCache.Decay(now);
+      m_state->introsetCache.Decay(now);
+      for (auto itr = m_state->m_IntroSetPrefetches.begin();
+           itr != m_state->m_IntroSetPrefetches.end();)
+      {
+        if (now >= itr->second)
+          itr = m_state->m_IntroSetPrefetches.erase(itr);
+        else
+          ++itr;
+      }
       // expire snode sessions
       EndpointUtil::ExpireSNodeSessions(now, m_state->m_SNodeSessions);
       // expire pending tx
@@ -300,6 +330,9 @@ namespace llarp
           now, m_state->m_RemoteSessions, m_state->m_DeadSessions, Sessions());
       // expire convotags
       EndpointUtil::ExpireConvoSessions(now, Sessions());
+      // expire session tickets
+      m_state->m_IssuedTickets.Expire(now);
+      m_state->m_SessionTickets.Expire(now);
 
       if (NumInStatus(path::ePathEstablished) > 1)
       {
@@ -897,14 +930,22 @@ namespace llarp
         handler(std::nullopt);
         return;
       }
-      auto& cache = m_state->nameCache;
-      const auto maybe = cache.Get(name);
-      if (maybe.has_value())
+      // a cached name is served even while it is being refreshed
+      if (const auto maybe = m_state->nameCache.Get(name, Now()))
       {
         handler(maybe);
         return;
       }
-      LogInfo(Name(), " looking up LNS name: ", name);
+      ResolveName(std::move(name), std::move(handler), false);
+    }
+
+    void
+    Endpoint::ResolveName(
+        std::string name,
+        std::function<void(std::optional<std::variant<Address, RouterID>>)> handler,
+        bool refresh)
+    {
+      LogInfo(Name(), refresh ? " refreshing LNS name: " : " looking up LNS name: ", name);
       path::Path::UniqueEndpointSet_t paths;
       ForEachPath([&](auto path) {
         if (path and path->IsReady())
@@ -926,7 +967,7 @@ namespace llarp
         return;
       }
 
-      auto maybeInvalidateCache = [handler, &cache, name](auto result) {
+      auto maybeInvalidateCache = [this, handler, name, refresh](auto result) {
         if (result)
         {
           var::visit(
@@ -938,11 +979,13 @@ namespace llarp
               },
               *result);
         }
+        auto& cache = m_state->nameCache;
+        const auto now = Now();
         if (result)
         {
-          cache.Put(name, *result);
+          cache.Put(name, *result, now + NAME_REFRESH_INTERVAL, now + NAME_CACHE_LIFETIME, now);
         }
-        else
+        else if (not refresh)
         {
           cache.Remove(name);
         }
@@ -1214,6 +1257,67 @@ namespace llarp
           SendEvent_t{std::make_shared<routing::PathTransferMessage>(f, replyPath), path});
     }
 
+    bool
+    Endpoint::AcceptsResumedConvos() const
+    {
+      // auth is done on the full handshake only, so we cannot let it be skipped
+      return m_AuthPolicy == nullptr;
+    }
+
+    /// the ticket for a convo made under an intro set signed at introsetSignedAt, or resumed
+    /// from resumedFrom. nullopt if its chain has run out.
+    static std::optional<SessionTicket>
+    TicketFor(
+        const Session& session, llarp_time_t introsetSignedAt, const SessionTicket* resumedFrom)
+    {
+      if (resumedFrom)
+        return resumedFrom->Next(session.sharedKey);
+      return SessionTicket::Derive(session.sharedKey, session.remote, introsetSignedAt);
+    }
+
+    void
+    Endpoint::IssueSessionTicketFor(const ConvoTag& tag, const SessionTicket* resumedFrom)
+    {
+      if (not AcceptsResumedConvos())
+        return;
+      auto itr = Sessions().find(tag);
+      if (itr == Sessions().end() or not itr->second.inbound)
+        return;
+      auto ticket = TicketFor(itr->second, introSet().timestampSignedAt, resumedFrom);
+      if (ticket and not ticket->IsExpired(Now()))
+        m_state->m_IssuedTickets.Put(std::move(*ticket));
+    }
+
+    void
+    Endpoint::PutSessionTicketFor(
+        const ConvoTag& tag, llarp_time_t introsetSignedAt, const SessionTicket* resumedFrom)
+    {
+      auto itr = Sessions().find(tag);
+      if (itr == Sessions().end() or itr->second.inbound)
+        return;
+      auto ticket = TicketFor(itr->second, introsetSignedAt, resumedFrom);
+      if (ticket and not ticket->IsExpired(Now()))
+        m_state->m_SessionTickets.Put(std::move(*ticket));
+    }
+
+    std::optional<SessionTicket>
+    Endpoint::GetSessionTicket(const ConvoTag& id) const
+    {
+      return m_state->m_IssuedTickets.Get(id, Now());
+    }
+
+    bool
+    Endpoint::UseSessionTicket(const ConvoTag& id)
+    {
+      return m_state->m_IssuedTickets.Remove(id);
+    }
+
+    std::optional<SessionTicket>
+    Endpoint::TakeSessionTicketFor(const Address& remote)
+    {
+      return m_state->m_SessionTickets.TakeFor(remote, Now());
+    }
+
     void
     Endpoint::RemoveConvoTag(const ConvoTag& t)
     {
@@ -1240,7 +1344,8 @@ namespace llarp
       if (not frame.AsyncDecryptAndVerify(Router()->loop(), p, m_Identity, this))
       {
         LogError("Failed to decrypt protocol frame");
-        if (not frame.C.IsZero())
+        // a convo we could not resume gets reset too so the client falls back to a handshake
+        if (not frame.C.IsZero() or not frame.K.IsZero())
         {
           // send reset convo tag message
           ProtocolFrame f;
@@ -1298,6 +1403,7 @@ namespace llarp
         }
         return false;
       }
+      PutCachedIntroSet(*introset);
       // check for established outbound context
 
       if (m_state->m_RemoteSessions.count(addr) > 0)
@@ -1307,6 +1413,77 @@ namespace llarp
       return true;
     }
 
+    void
+    Endpoint::PutCachedIntroSet(const IntroSet& introset)
+    {
+      if (introset.intros.empty())
+        return;
+      const auto now = Now();
+      const Address remote{introset.addressKeys.Addr()};
+      auto& cache = m_state->introsetCache;
+      if (const auto* cached = cache.Peek(remote, now);
+          cached and cached->timestampSignedAt > introset.timestampSignedAt)
+        return;
+      // we stop serving it once its newest intro is about to expire, and refresh it ahead of the
+      // first one going
+      const auto expiresAt = introset.GetNewestIntroExpiration() - 30s;
+      if (expiresAt <= now)
+        return;
+      llarp_time_t oldest = expiresAt;
+      for (const auto& intro : introset.intros)
+        oldest = std::min(oldest, intro.expiresAt);
+      cache.Put(remote, introset, oldest - INTROSET_REFRESH_LEAD, expiresAt, now);
+    }
+
+    void
+    Endpoint::PrefetchIntroSet(const Address& remote)
+    {
+      static constexpr size_t NumParallelLookups = 2;
+      const auto paths = GetManyPathsWithUniqueEndpoints(this, NumParallelLookups);
+      const dht::Key_t location = remote.ToKey();
+      uint64_t order = 0;
+      for (const auto& path : paths)
+      {
+        HiddenServiceAddressLookup* job = new HiddenServiceAddressLookup(
+            this,
+            [this, remote](auto, auto result, auto endpoint, auto timeLeft) {
+              // a failed lookup leaves the other one running
+              if (not result or result->IsExpired(Now()))
+                return true;
+              m_state->m_IntroSetPrefetches.erase(remote);
+              PutCachedIntroSet(*result);
+              // sessions to remote skip their own lookup while we refresh, so hand it to them
+              auto range = m_state->m_RemoteSessions.equal_range(remote);
+              for (auto itr = range.first; itr != range.second; ++itr)
+                itr->second->OnIntroSetUpdate(remote, result, endpoint, timeLeft);
+              return true;
+            },
+            location,
+            PubKey{remote.as_array()},
+            order++,
+            GenTXID(),
+            RESOLVE_CACHE_RETRY_INTERVAL);
+        LogDebug(Name(), " refreshing intro set for ", remote, " via ", path->Endpoint());
+        if (job->SendRequestViaPath(path, Router()))
+          m_state->m_IntroSetPrefetches[remote] = Now() + RESOLVE_CACHE_RETRY_INTERVAL;
+        else
+          LogWarn(Name(), " send via path failed for intro set refresh");
+      }
+    }
+
+    bool
+    Endpoint::IsPrefetchingIntroSet(const Address& remote) const
+    {
+      const auto itr = m_state->m_IntroSetPrefetches.find(remote);
+      return itr != m_state->m_IntroSetPrefetches.end() and Now() < itr->second;
+    }
+
+    void
+    Endpoint::MarkIntroSetUsed(const Address& remote)
+    {
+      m_state->introsetCache.Touch(remote, Now());
+    }
+
     void
     Endpoint::MarkAddressOutbound(const Address& addr)
     {
@@ -1346,8 +1523,17 @@ namespace llarp
       // add response hook to list for address.
       m_state->m_PendingServiceLookups.emplace(remote, hook);
 
-      auto& lookupTimes = m_state->m_LastServiceLookupTimes;
       const auto now = Now();
+      // a cached intro set gets the session going without a lookup, it is refreshed in the
+      // background while we keep using it
+      if (const auto maybe = m_state->introsetCache.Get(remote, now))
+      {
+        LogDebug(Name(), " using cached intro set for ", remote);
+        PutNewOutboundContext(*maybe, timeout);
+        return true;
+      }
+
+      auto& lookupTimes = m_state->m_LastServiceLookupTimes;
 
       // if most recent lookup was within last INTROSET_LOOKUP_RETRY_COOLDOWN
       // just add callback to the list and return
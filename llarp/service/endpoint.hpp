@@ -15,6 +15,7 @@
 #include "sendcontext.hpp"
 #include "service/protocol_type.hpp"
 #include "session.hpp"
+#include "session_ticket.hpp"
 #include "lookup.hpp"
 #include <llarp/hook/ihook.hpp>
 #include <llarp/util/compare_ptr.hpp>
@@ -240,6 +241,18 @@ namespace llarp
           std::function<void(std::optional<std::variant<Address, RouterID>>)> resultHandler)
           override;
 
+      /// remember an intro set we found so sessions to it can start without a lookup
+      void
+      PutCachedIntroSet(const IntroSet& introset);
+
+      /// is a background lookup of remote's intro set running
+      bool
+      IsPrefetchingIntroSet(const Address& remote) const;
+
+      /// keep the cached intro set of remote refreshed while a session to it is alive
+      void
+      MarkIntroSetUsed(const Address& remote);
+
       void
       LookupServiceAsync(
           std::string name,
@@ -407,6 +420,33 @@ namespace llarp
       void
       SendAuthResult(path::Path_ptr path, PathID_t replyPath, ConvoTag tag, AuthResult st);
 
+      /// do we let clients resume convos with us from session tickets
+      bool
+      AcceptsResumedConvos() const;
+
+      /// issue a session ticket for an inbound convo once the client has the session key. it
+      /// expires with our current intro set, or with resumedFrom's chain if the convo was resumed.
+      void
+      IssueSessionTicketFor(const ConvoTag& tag, const SessionTicket* resumedFrom);
+
+      /// keep a session ticket to resume an outbound convo with later, introsetSignedAt is when
+      /// the intro set we made the convo under was signed
+      void
+      PutSessionTicketFor(
+          const ConvoTag& tag, llarp_time_t introsetSignedAt, const SessionTicket* resumedFrom);
+
+      /// a ticket we issued that a client wants to resume from, it stays ours until used
+      std::optional<SessionTicket>
+      GetSessionTicket(const ConvoTag& id) const;
+
+      /// spend a ticket we issued once a resumed convo checked out, false if it was already spent
+      bool
+      UseSessionTicket(const ConvoTag& id);
+
+      /// take our ticket for resuming a convo with remote
+      std::optional<SessionTicket>
+      TakeSessionTicketFor(const Address& remote);
+
       uint64_t
       GenTXID();
 
@@ -468,6 +508,19 @@ namespace llarp
           const RouterID& endpoint,
           llarp_time_t timeLeft);
 
+      /// look up a cached intro set again in the background, the sessions we have to remote get
+      /// what it finds
+      void
+      PrefetchIntroSet(const Address& remote);
+
+      /// look up an lns name on the network. a failed refresh keeps the cached name around until
+      /// it expires.
+      void
+      ResolveName(
+          std::string name,
+          std::function<void(std::optional<std::variant<Address, RouterID>>)> resultHandler,
+          bool refresh);
+
       bool
       DoNetworkIsolation(bool failed);
 
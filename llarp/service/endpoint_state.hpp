@@ -6,9 +6,10 @@
 #include "pendingbuffer.hpp"
 #include "router_lookup_job.hpp"
 #include "session.hpp"
+#include "session_ticket.hpp"
 #include "endpoint_types.hpp"
 #include <llarp/util/compare_ptr.hpp>
-#include <llarp/util/decaying_hashtable.hpp>
+#include <llarp/util/prefetch_cache.hpp>
 #include <llarp/util/status.hpp>
 #include "lns_tracker.hpp"
 
@@ -23,6 +24,18 @@ namespace llarp
 {
   namespace service
   {
+    /// how many remote intro sets and lns names we keep cached
+    static constexpr size_t RESOLVE_CACHE_SIZE = 512;
+    /// a cached intro set or name used within this long is refreshed before it goes stale
+    static constexpr auto RESOLVE_CACHE_HOT_WINDOW = 10min;
+    /// how long a refresh of a cached intro set or name gets before it is tried again
+    static constexpr auto RESOLVE_CACHE_RETRY_INTERVAL = 15s;
+    /// how long before the first of its intros expires we refresh a cached intro set
+    static constexpr auto INTROSET_REFRESH_LEAD = 1min;
+    /// how long we keep an lns name, and how often we refresh it while it is used
+    static constexpr auto NAME_CACHE_LIFETIME = 1h;
+    static constexpr auto NAME_REFRESH_INTERVAL = 10min;
+
     struct EndpointState
     {
       hooks::Backend_ptr m_OnUp;
@@ -65,10 +78,21 @@ namespace llarp
       /// conversations
       ConvoMap m_Sessions;
 
+      /// tickets we issued to clients of ours
+      SessionTickets m_IssuedTickets;
+      /// tickets services we talked to issued us
+      SessionTickets m_SessionTickets;
+
       OutboundSessions_t m_OutboundSessions;
 
-      util::DecayingHashTable<std::string, std::variant<Address, RouterID>, std::hash<std::string>>
-          nameCache;
+      /// intro sets of remotes we looked up
+      util::PrefetchCache<Address, IntroSet> introsetCache{
+          RESOLVE_CACHE_SIZE, RESOLVE_CACHE_HOT_WINDOW, RESOLVE_CACHE_RETRY_INTERVAL};
+      /// remotes we are refreshing the intro set of, until when the refresh may still answer
+      std::unordered_map<Address, llarp_time_t> m_IntroSetPrefetches;
+
+      util::PrefetchCache<std::string, std::variant<Address, RouterID>> nameCache{
+          RESOLVE_CACHE_SIZE, RESOLVE_CACHE_HOT_WINDOW, RESOLVE_CACHE_RETRY_INTERVAL};
 
       LNSLookupTracker lnsTracker;
 
@@ -112,6 +112,7 @@ namespace llarp
           return true;
         }
         currentIntroSet = *foundIntro;
+        m_Endpoint->PutCachedIntroSet(currentIntroSet);
       }
       else
       {
@@ -209,6 +210,15 @@ namespace llarp
           return;
         }
       }
+      // auth is only done on a full handshake
+      if (t != ProtocolType::Auth and RemoteAcceptsResume())
+      {
+        if (const auto ticket = m_Endpoint->TakeSessionTicketFor(remoteIdent.Addr()))
+        {
+          if (ResumeFromTicket(*ticket, path, payload, t))
+            return;
+        }
+      }
       sentIntro = true;
       auto frame = std::make_shared<ProtocolFrame>();
       auto ex = std::make_shared<AsyncKeyExchange>(
@@ -233,6 +243,56 @@ namespace llarp
       LogInfo("send intro frame");
     }
 
+    bool
+    OutboundContext::RemoteAcceptsResume() const
+    {
+      const auto& protos = currentIntroSet.supportedProtocols;
+      return std::find(protos.begin(), protos.end(), ProtocolType::Resume) != protos.end();
+    }
+
+    bool
+    OutboundContext::ResumeFromTicket(
+        const SessionTicket& ticket,
+        path::Path_ptr path,
+        const llarp_buffer_t& payload,
+        ProtocolType t)
+    {
+      auto frame = std::make_shared<ProtocolFrame>();
+      frame->N.Randomize();
+      SharedSecret sessionKey;
+      if (not ticket.SessionKey(frame->N, sessionKey))
+        return false;
+      frame->K = ticket.id;
+      frame->T = currentConvoTag;
+      frame->F = path->intro.pathID;
+      frame->R = 0;
+
+      auto msg = std::make_shared<ProtocolMessage>(currentConvoTag);
+      msg->proto = t;
+      msg->PutBuffer(payload);
+      msg->introReply = path->intro;
+      msg->sender = m_Endpoint->GetIdentity().pub;
+
+      m_DataHandler->PutSenderFor(currentConvoTag, remoteIdent, false);
+      m_DataHandler->PutCachedSessionKeyFor(currentConvoTag, sessionKey);
+      m_DataHandler->PutIntroFor(currentConvoTag, remoteIntro);
+      m_DataHandler->PutReplyIntroFor(currentConvoTag, path->intro);
+      sentIntro = true;
+      m_ResumedFrom = ticket;
+      m_ResumedPayload.assign(payload.base, payload.base + payload.sz);
+      m_ResumedProto = t;
+      m_Endpoint->Router()->QueueWork([self = shared_from_this(), frame, msg, sessionKey, path] {
+        if (not frame->EncryptAndSign(*msg, sessionKey, self->m_Endpoint->GetIdentity()))
+        {
+          LogError(self->Name(), " failed to sign resumed intro frame");
+          return;
+        }
+        self->Send(frame, path);
+      });
+      LogInfo(Name(), " resuming convo from session ticket");
+      return true;
+    }
+
     std::string
     OutboundContext::Name() const
     {
@@ -240,12 +300,24 @@ namespace llarp
           + currentIntroSet.addressKeys.Addr().ToString();
     }
 
+    void
+    OutboundContext::Tick(llarp_time_t now)
+    {
+      path::Builder::Tick(now);
+      // keeps the remote's intro set refreshed ahead of its intros expiring while we use it
+      if (not markedBad)
+        m_Endpoint->MarkIntroSetUsed(currentIntroSet.addressKeys.Addr());
+    }
+
     void
     OutboundContext::UpdateIntroSet()
     {
       if (updatingIntroSet || markedBad)
         return;
       const auto addr = currentIntroSet.addressKeys.Addr();
+      // the parent endpoint is already refreshing it and passes the result on to us
+      if (m_Endpoint->IsPrefetchingIntroSet(addr))
+        return;
       // we want to use the parent endpoint's paths because outbound context
       // does not implement path::PathSet::HandleGotIntroMessage
       const auto paths = GetManyPathsWithUniqueEndpoints(m_Endpoint, 2);
@@ -503,7 +575,14 @@ namespace llarp
       if (shifted)
         lastShift = now;
       if (rebuild && !BuildCooldownHit(Now()))
-        BuildOneAlignedTo(m_NextIntro.router);
+      {
+        // nothing to send over yet, race a few paths so the session is not held up by one slow
+        // build
+        if (NumInStatus(path::ePathEstablished) == 0 and NumInStatus(path::ePathBuilding) == 0)
+          BuildHedgedAlignedTo(m_NextIntro.router, m_Endpoint->SnodeBlacklist());
+        else
+          BuildOneAlignedTo(m_NextIntro.router);
+      }
       return success;
     }
 
@@ -611,6 +690,22 @@ namespace llarp
         }
 
         m_Endpoint->RemoveConvoTag(frame.T);
+        if (m_ResumedFrom and frame.T == currentConvoTag)
+        {
+          // they did not take our ticket, start over with a full handshake on a new convo and
+          // send what was in the resumed frame with it. the ticket is spent so this cannot
+          // try to resume again.
+          LogInfo(Name(), " could not resume convo, doing a full handshake");
+          m_ResumedFrom.reset();
+          sentIntro = false;
+          m_SavedTicket = false;
+          lastGoodSend = 0s;
+          currentConvoTag.Randomize();
+          const auto payload = std::move(m_ResumedPayload);
+          m_ResumedPayload.clear();
+          AsyncGenIntro(llarp_buffer_t{payload}, m_ResumedProto);
+          return true;
+        }
         if (authResultListener)
         {
           authResultListener(result);
@@ -633,6 +728,24 @@ namespace llarp
           handler(result);
         };
       }
+      if (not m_SavedTicket and frame.T == currentConvoTag and RemoteAcceptsResume())
+      {
+        // the first thing they send us on the convo means they have its session key too, so
+        // both ends can derive its ticket now
+        hook = [self = shared_from_this(), inner = std::move(hook)](auto msg) {
+          if (not self->m_SavedTicket and msg->tag == self->currentConvoTag)
+          {
+            self->m_SavedTicket = true;
+            self->m_ResumedPayload.clear();
+            self->m_Endpoint->PutSessionTicketFor(
+                msg->tag,
+                self->currentIntroSet.timestampSignedAt,
+                self->m_ResumedFrom ? &*self->m_ResumedFrom : nullptr);
+          }
+          if (inner)
+            inner(msg);
+        };
+      }
       const auto& ident = m_Endpoint->GetIdentity();
       if (not frame.AsyncDecryptAndVerify(m_Endpoint->Loop(), p, ident, m_Endpoint, hook))
       {
@@ -2,6 +2,7 @@
 
 #include <llarp/path/pathbuilder.hpp>
 #include "sendcontext.hpp"
+#include "session_ticket.hpp"
 #include <llarp/util/status.hpp>
 
 #include <unordered_map>
@@ -85,6 +86,9 @@ namespace llarp
       bool
       Pump(llarp_time_t now);
 
+      void
+      Tick(llarp_time_t now) override;
+
       /// return true if it's safe to remove ourselves
       bool
       IsDone(llarp_time_t now) const;
@@ -129,6 +133,11 @@ namespace llarp
       llarp_time_t
       RTT() const;
 
+      /// take an intro set someone looked up for the remote
+      bool
+      OnIntroSetUpdate(
+          const Address& addr, std::optional<IntroSet> i, const RouterID& endpoint, llarp_time_t);
+
      private:
       /// swap remoteIntro with next intro
       void
@@ -137,9 +146,18 @@ namespace llarp
       void
       OnGeneratedIntroFrame(AsyncKeyExchange* k, PathID_t p);
 
+      /// does the remote take convos resumed from a session ticket
       bool
-      OnIntroSetUpdate(
-          const Address& addr, std::optional<IntroSet> i, const RouterID& endpoint, llarp_time_t);
+      RemoteAcceptsResume() const;
+
+      /// open the convo with a frame resumed from ticket instead of a key exchange, returns false
+      /// if we could not
+      bool
+      ResumeFromTicket(
+          const SessionTicket& ticket,
+          path::Path_ptr path,
+          const llarp_buffer_t& payload,
+          ProtocolType t);
 
       const dht::Key_t location;
       uint64_t m_UpdateIntrosetTX = 0;
@@ -152,6 +170,13 @@ namespace llarp
       llarp_time_t m_LastInboundTraffic = 0s;
       bool m_GotInboundTraffic = false;
       bool sentIntro = false;
+      /// the session ticket we opened the current convo from
+      std::optional<SessionTicket> m_ResumedFrom;
+      /// what we sent in the resumed frame, sent again with a full handshake if they reset it
+      std::vector<byte_t> m_ResumedPayload;
+      ProtocolType m_ResumedProto = ProtocolType::Control;
+      /// we have a session ticket from the current convo
+      bool m_SavedTicket = false;
       std::function<void(OutboundContext*)> m_ReadyHook;
     };
   }  // namespace service
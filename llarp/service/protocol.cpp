@@ -3,6 +3,7 @@
 #include <llarp/routing/handler.hpp>
 #include <llarp/util/buffer.hpp>
 #include <llarp/util/mem.hpp>
+#include <llarp/util/metrics.hpp>
 #include <llarp/util/meta/memfn.hpp>
 #include "endpoint.hpp"
 #include <llarp/router/abstractrouter.hpp>
@@ -142,6 +143,11 @@ namespace llarp
       }
       if (!BEncodeWriteDictEntry("F", F, buf))
         return false;
+      if (!K.IsZero())
+      {
+        if (!BEncodeWriteDictEntry("K", K, buf))
+          return false;
+      }
       if (!N.IsZero())
       {
         if (!BEncodeWriteDictEntry("N", N, buf))
@@ -183,6 +189,8 @@ namespace llarp
         return false;
       if (!BEncodeMaybeReadDictEntry("C", C, read, key, val))
         return false;
+      if (!BEncodeMaybeReadDictEntry("K", K, read, key, val))
+        return false;
       if (!BEncodeMaybeReadDictEntry("N", N, read, key, val))
         return false;
       if (!BEncodeMaybeReadDictInt("S", S, read, key, val))
@@ -267,6 +275,38 @@ namespace llarp
       return true;
     }
 
+    /// convos accepted by how they were opened
+    static metrics::Counter&
+    AcceptedConvos(const char* handshake)
+    {
+      return metrics::Registry::Global().GetCounter(
+          "lokinet_service_convos_accepted",
+          "inbound convos accepted by hidden services",
+          {{"handshake", handshake}});
+    }
+
+    /// set up the inbound convo the remote opened with msg, answer it and hand msg on.
+    /// resumedFrom is the ticket it was resumed from, null for a full handshake.
+    static void
+    AcceptConvo(
+        Endpoint* handler,
+        path::Path_ptr path,
+        PathID_t from,
+        std::shared_ptr<ProtocolMessage> msg,
+        const Introduction& fromIntro,
+        const SharedSecret& sharedKey,
+        AuthResult result,
+        const SessionTicket* resumedFrom)
+    {
+      handler->PutSenderFor(msg->tag, msg->sender, true);
+      handler->PutIntroFor(msg->tag, msg->introReply);
+      handler->PutReplyIntroFor(msg->tag, fromIntro);
+      handler->PutCachedSessionKeyFor(msg->tag, sharedKey);
+      handler->IssueSessionTicketFor(msg->tag, resumedFrom);
+      handler->SendAuthResult(path, from, msg->tag, result);
+      ProtocolMessage::ProcessAsync(path, from, msg);
+    }
+
     struct AsyncFrameDecrypt
     {
       path::Path_ptr path;
@@ -367,13 +407,10 @@ namespace llarp
                 AuthResult result) {
               if (result.code == AuthResultCode::eAuthAccepted)
               {
-                handler->PutSenderFor(msg->tag, msg->sender, true);
-                handler->PutIntroFor(msg->tag, msg->introReply);
-                handler->PutReplyIntroFor(msg->tag, fromIntro);
-                handler->PutCachedSessionKeyFor(msg->tag, sharedKey);
-                handler->SendAuthResult(path, from, msg->tag, result);
+                static auto& accepted = AcceptedConvos("full");
+                accepted.Add();
                 LogInfo("auth okay for T=", msg->tag, " from ", msg->sender.Addr());
-                ProtocolMessage::ProcessAsync(path, from, msg);
+                AcceptConvo(handler, path, from, msg, fromIntro, sharedKey, result, nullptr);
               }
               else
               {
@@ -390,6 +427,7 @@ namespace llarp
       C = other.C;
       D = other.D;
       F = other.F;
+      K = other.K;
       N = other.N;
       Z = other.Z;
       T = other.T;
@@ -406,6 +444,28 @@ namespace llarp
       ProtocolFrame frame;
     };
 
+    bool
+    ProtocolFrame::DecryptResumed(
+        const SessionTicket& ticket, const SharedSecret& sessionKey, ProtocolMessage& msg) const
+    {
+      if (not Verify(ticket.remote))
+      {
+        LogError("Signature failure on resumed convo from ", ticket.remote.Addr());
+        return false;
+      }
+      if (not DecryptPayloadInto(sessionKey, msg))
+      {
+        LogError("failed to decrypt resumed convo T=", T);
+        return false;
+      }
+      if (msg.tag != T or msg.sender != ticket.remote)
+      {
+        LogError("resumed convo T=", T, " does not match its ticket");
+        return false;
+      }
+      return true;
+    }
+
     bool
     ProtocolFrame::AsyncDecryptAndVerify(
         EventLoop_ptr loop,
@@ -416,6 +476,59 @@ namespace llarp
     {
       auto msg = std::make_shared<ProtocolMessage>();
       msg->handler = handler;
+      if (not K.IsZero())
+      {
+        // resumed from a session ticket we issued, there is no pq key exchange to do. the ticket
+        // is only spent once the frame checks out so a forged one cannot burn it.
+        auto ticket = handler->GetSessionTicket(K);
+        if (not ticket)
+        {
+          LogDebug("no session ticket K=", K, " to resume T=", T);
+          return false;
+        }
+        if (T.IsZero() or handler->HasConvoTag(T))
+        {
+          LogError("dropping resumed convo with bad convo tag T=", T);
+          return false;
+        }
+        SharedSecret sessionKey;
+        if (not ticket->SessionKey(N, sessionKey))
+        {
+          LogError("failed to derive session key to resume T=", T);
+          return false;
+        }
+        handler->Router()->QueueWork([frame = *this,
+                                      ticket = std::move(*ticket),
+                                      sessionKey,
+                                      msg = std::move(msg),
+                                      recvPath = std::move(recvPath),
+                                      loop]() {
+          if (not frame.DecryptResumed(ticket, sessionKey, *msg))
+            return;
+          loop->call([from = frame.F, ticket, sessionKey, msg, recvPath]() {
+            auto* handler = msg->handler;
+            if (not handler->UseSessionTicket(ticket.id))
+            {
+              LogWarn("session ticket K=", ticket.id, " was already used");
+              return;
+            }
+            static auto& resumed = AcceptedConvos("resumed");
+            resumed.Add();
+            LogInfo("resumed T=", msg->tag, " from ", msg->sender.Addr());
+            AcceptConvo(
+                handler,
+                recvPath,
+                from,
+                msg,
+                recvPath->intro,
+                sessionKey,
+                {AuthResultCode::eAuthAccepted, "OK"},
+                &ticket);
+            handler->Pump(time_now_ms());
+          });
+        });
+        return true;
+      }
       if (T.IsZero())
       {
         // we need to dh
@@ -483,8 +596,8 @@ namespace llarp
     bool
     ProtocolFrame::operator==(const ProtocolFrame& other) const
     {
-      return C == other.C && D == other.D && N == other.N && Z == other.Z && T == other.T
-          && S == other.S && version == other.version;
+      return C == other.C && D == other.D && N == other.N && Z == other.Z && K == other.K
+          && T == other.T && S == other.S && version == other.version;
     }
 
     bool
@@ -9,6 +9,7 @@
 #include "info.hpp"
 #include "intro.hpp"
 #include "handler.hpp"
+#include "session_ticket.hpp"
 #include <llarp/util/bencode.hpp>
 #include <llarp/util/time.hpp>
 #include <llarp/path/pathset.hpp>
@@ -80,6 +81,8 @@ namespace llarp
       KeyExchangeNonce N;
       Signature Z;
       PathID_t F;
+      /// the session ticket a resumed convo is opened with
+      service::ConvoTag K;
       service::ConvoTag T;
 
       ProtocolFrame(const ProtocolFrame& other)
@@ -90,6 +93,7 @@ namespace llarp
           , N(other.N)
           , Z(other.Z)
           , F(other.F)
+          , K(other.K)
           , T(other.T)
       {
         S = other.S;
@@ -133,6 +137,12 @@ namespace llarp
       bool
       DecryptPayloadInto(const SharedSecret& sharedkey, ProtocolMessage& into) const;
 
+      /// check a frame that resumes a convo from ticket was signed by the ticket's remote, then
+      /// decrypt it with sessionKey into msg. false if it was not or does not match the ticket.
+      bool
+      DecryptResumed(
+          const SessionTicket& ticket, const SharedSecret& sessionKey, ProtocolMessage& msg) const;
+
       bool
       DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val) override;
 
@@ -151,6 +161,7 @@ namespace llarp
         C.Zero();
         D.Clear();
         F.Zero();
+        K.Zero();
         T.Zero();
         N.Zero();
         Z.Zero();
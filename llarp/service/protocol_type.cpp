@@ -12,6 +12,7 @@ namespace llarp::service
                 : t == ProtocolType::Exit      ? "Exit"
                 : t == ProtocolType::Auth      ? "Auth"
                 : t == ProtocolType::QUIC      ? "QUIC"
+                : t == ProtocolType::Resume    ? "Resume"
                                                : "(unknown-protocol-type)");
   }
 
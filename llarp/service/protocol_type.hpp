@@ -16,6 +16,9 @@ namespace llarp::service
     Exit = 3UL,
     Auth = 4UL,
     QUIC = 5UL,
+    /// not a payload type, a service lists it in its intro set when it accepts convos resumed
+    /// from a session ticket
+    Resume = 6UL,
 
   };
 
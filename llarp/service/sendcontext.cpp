@@ -54,7 +54,8 @@ namespace llarp
             lastGoodSend = r->Now();
             flushpaths.emplace(item.second);
             m_Endpoint->ConvoTagTX(item.first->T.T);
-            const auto rtt = (item.second->intro.latency + remoteIntro.latency) * 2;
+            // our side is measured as it goes, the remote side is what they last published
+            const auto rtt = (item.second->RTT().Cost() + remoteIntro.latency) * 2;
             rttRMS += rtt * rtt.count();
           }
         } while (not m_SendQueue.empty());
@@ -0,0 +1,138 @@
+#include "session_ticket.hpp"
+
+#include <llarp/crypto/crypto.hpp>
+
+#include <algorithm>
+#include <string_view>
+
+namespace llarp
+{
+  namespace service
+  {
+    std::optional<SessionTicket>
+    SessionTicket::Derive(
+        const SharedSecret& sessionKey, const ServiceInfo& remote, llarp_time_t introsetSignedAt)
+    {
+      if (sessionKey.IsZero())
+        return std::nullopt;
+      static constexpr std::string_view label = "lokinet-session-ticket";
+      static constexpr std::string_view idLabel = "lokinet-session-ticket-id";
+      auto crypto = CryptoManager::instance();
+      SessionTicket ticket;
+      if (not crypto->hmac(
+              ticket.secret.data(), llarp_buffer_t{label.data(), label.size()}, sessionKey))
+        return std::nullopt;
+      ShortHash id;
+      if (not crypto->hmac(
+              id.data(), llarp_buffer_t{idLabel.data(), idLabel.size()}, ticket.secret))
+        return std::nullopt;
+      std::copy_n(id.begin(), ticket.id.size(), ticket.id.begin());
+      ticket.remote = remote;
+      ticket.expiresAt = introsetSignedAt + SessionTicketLifetime;
+      return ticket;
+    }
+
+    std::optional<SessionTicket>
+    SessionTicket::Next(const SharedSecret& sessionKey) const
+    {
+      if (resumes >= MaxSessionTicketResumes)
+        return std::nullopt;
+      auto ticket = Derive(sessionKey, remote, 0s);
+      if (not ticket)
+        return std::nullopt;
+      // a chain of resumed convos lives no longer than the first one's ticket
+      ticket->expiresAt = expiresAt;
+      ticket->resumes = resumes + 1;
+      return ticket;
+    }
+
+    bool
+    SessionTicket::SessionKey(const KeyExchangeNonce& nonce, SharedSecret& sessionKey) const
+    {
+      return CryptoManager::instance()->hmac(sessionKey.data(), llarp_buffer_t{nonce}, secret);
+    }
+
+    void
+    SessionTickets::Put(SessionTicket ticket)
+    {
+      const auto remote = ticket.remote.Addr();
+      if (auto itr = m_ByRemote.find(remote); itr != m_ByRemote.end())
+        Erase(m_Tickets.find(itr->second));
+      if (m_Tickets.size() >= MaxTickets)
+      {
+        // the one closest to expiring is the least useful
+        Erase(std::min_element(
+            m_Tickets.begin(), m_Tickets.end(), [](const auto& a, const auto& b) {
+              return a.second.expiresAt < b.second.expiresAt;
+            }));
+      }
+      m_ByRemote[remote] = ticket.id;
+      m_Tickets[ticket.id] = std::move(ticket);
+    }
+
+    std::optional<SessionTicket>
+    SessionTickets::Get(const ConvoTag& id, llarp_time_t now) const
+    {
+      auto itr = m_Tickets.find(id);
+      if (itr == m_Tickets.end() or itr->second.IsExpired(now))
+        return std::nullopt;
+      return itr->second;
+    }
+
+    bool
+    SessionTickets::Remove(const ConvoTag& id)
+    {
+      auto itr = m_Tickets.find(id);
+      if (itr == m_Tickets.end())
+        return false;
+      Erase(itr);
+      return true;
+    }
+
+    std::optional<SessionTicket>
+    SessionTickets::Take(const ConvoTag& id, llarp_time_t now)
+    {
+      auto itr = m_Tickets.find(id);
+      if (itr == m_Tickets.end())
+        return std::nullopt;
+      auto ticket = std::move(itr->second);
+      Erase(itr);
+      if (ticket.IsExpired(now))
+        return std::nullopt;
+      return ticket;
+    }
+
+    std::optional<SessionTicket>
+    SessionTickets::TakeFor(const Address& remote, llarp_time_t now)
+    {
+      auto itr = m_ByRemote.find(remote);
+      if (itr == m_ByRemote.end())
+        return std::nullopt;
+      return Take(itr->second, now);
+    }
+
+    void
+    SessionTickets::Expire(llarp_time_t now)
+    {
+      for (auto itr = m_Tickets.begin(); itr != m_Tickets.end();)
+      {
+        if (itr->second.IsExpired(now))
+        {
+          m_ByRemote.erase(itr->second.remote.Addr());
+          itr = m_Tickets.erase(itr);
+        }
+        else
+          ++itr;
+      }
+    }
+
+    void
+    SessionTickets::Erase(Tickets_t::iterator itr)
+    {
+      if (itr == m_Tickets.end())
+        return;
+      m_ByRemote.erase(itr->second.remote.Addr());
+      m_Tickets.erase(itr);
+    }
+  }  // namespace service
+}  // namespace llarp
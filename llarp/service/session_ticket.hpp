@@ -0,0 +1,104 @@
+#pragma once
+
+#include <llarp/crypto/types.hpp>
+#include <llarp/constants/path.hpp>
+#include "address.hpp"
+#include "convotag.hpp"
+#include "info.hpp"
+#include <llarp/util/time.hpp>
+
+#include <optional>
+#include <unordered_map>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// how long after the service's intro set was signed a ticket issued under it is good for.
+    /// intro sets live this long so a ticket does not outlive the one it was issued under.
+    static constexpr auto SessionTicketLifetime = path::default_lifetime;
+    /// how many convos in a row may be resumed before a full handshake is needed again
+    static constexpr uint8_t MaxSessionTicketResumes = 4;
+
+    /// lets a client open its next convo with a service it recently talked to without another pq
+    /// key exchange. both ends derive the same ticket from the session key of a convo the service
+    /// accepted, the client then names the ticket in the first frame of the new convo and both
+    /// derive the new session key from it and the frame's nonce.
+    struct SessionTicket
+    {
+      /// what the client names the ticket by, derived from the secret so it does not tie the
+      /// resumed convo to the tag of the one the ticket came from
+      ConvoTag id;
+      SharedSecret secret;
+      /// the other end of the convo, a resuming client has to sign as it
+      ServiceInfo remote;
+      /// set from when the intro set it was issued under was signed, resumed convos keep it
+      llarp_time_t expiresAt = 0s;
+      /// how many convos were resumed since the last full handshake
+      uint8_t resumes = 0;
+
+      /// derive the ticket for a convo made with a full handshake using its session key,
+      /// introsetSignedAt is when the service signed the intro set the convo was made under
+      static std::optional<SessionTicket>
+      Derive(
+          const SharedSecret& sessionKey, const ServiceInfo& remote, llarp_time_t introsetSignedAt);
+
+      /// derive the ticket for a convo resumed from this one, nullopt once the chain of resumed
+      /// convos is as long as we allow
+      std::optional<SessionTicket>
+      Next(const SharedSecret& sessionKey) const;
+
+      /// the session key of a convo resumed from this ticket with nonce
+      bool
+      SessionKey(const KeyExchangeNonce& nonce, SharedSecret& sessionKey) const;
+
+      bool
+      IsExpired(llarp_time_t now) const
+      {
+        return now >= expiresAt;
+      }
+    };
+
+    /// tickets by id, we keep the newest one per remote. taking or removing a ticket is what
+    /// makes sure each is only resumed from once.
+    struct SessionTickets
+    {
+      static constexpr size_t MaxTickets = 1024;
+
+      void
+      Put(SessionTicket ticket);
+
+      /// a copy of the ticket, left in place
+      std::optional<SessionTicket>
+      Get(const ConvoTag& id, llarp_time_t now) const;
+
+      /// returns false if there was no such ticket
+      bool
+      Remove(const ConvoTag& id);
+
+      std::optional<SessionTicket>
+      Take(const ConvoTag& id, llarp_time_t now);
+
+      std::optional<SessionTicket>
+      TakeFor(const Address& remote, llarp_time_t now);
+
+      void
+      Expire(llarp_time_t now);
+
+      size_t
+      Size() const
+      {
+        return m_Tickets.size();
+      }
+
+     private:
+      using Tickets_t = std::unordered_map<ConvoTag, SessionTicket>;
+
+      void
+      Erase(Tickets_t::iterator itr);
+
+      Tickets_t m_Tickets;
+      std::unordered_map<Address, ConvoTag> m_ByRemote;
+    };
+  }  // namespace service
+}  // namespace llarp
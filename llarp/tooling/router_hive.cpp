@@ -12,6 +12,12 @@ using namespace std::chrono_literals;
 
 namespace tooling
 {
+  void
+  RouterHive::UseSimulatedNetwork(uint64_t seed)
+  {
+    simNetwork = std::make_shared<llarp::sim::Network>(seed);
+  }
+
   void
   RouterHive::AddRouter(const std::shared_ptr<llarp::Config>& config, bool isSNode)
   {
@@ -21,6 +27,8 @@ namespace tooling
     opts.isSNode = isSNode;
 
     Context_ptr context = std::make_shared<HiveContext>(this);
+    if (simNetwork)
+      context->loop = simNetwork->MakeLoop();
     context->Configure(config);
     context->Setup(opts);
 
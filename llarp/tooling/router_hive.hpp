@@ -5,6 +5,7 @@
 #include <llarp.hpp>
 #include <config/config.hpp>
 #include <tooling/hive_context.hpp>
+#include <ev/ev_sim.hpp>
 
 #include <vector>
 #include <deque>
@@ -41,6 +42,11 @@ namespace tooling
    public:
     RouterHive() = default;
 
+    /// run every router added after this on one in memory network with a virtual clock instead of
+    /// real udp sockets, see llarp::sim::Network. routers must bind distinct addresses.
+    void
+    UseSimulatedNetwork(uint64_t seed);
+
     void
     AddRelay(const std::shared_ptr<llarp::Config>& conf);
 
@@ -88,6 +94,8 @@ namespace tooling
 
     std::vector<std::thread> routerMainThreads;
 
+    std::shared_ptr<llarp::sim::Network> simNetwork;
+
     std::mutex eventQueueMutex;
     std::deque<RouterEventPtr> eventQueue;
   };
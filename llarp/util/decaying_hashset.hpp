@@ -1,12 +1,17 @@
 #pragma once
 
 #include "time.hpp"
+#include <deque>
 #include <unordered_map>
+#include <utility>
 
 namespace llarp
 {
   namespace util
   {
+    /// a hash set whose entries expire a fixed interval after they were inserted. entries are
+    /// also queued in insertion order, so a decay only touches the entries that expired instead
+    /// of scanning the whole set.
     template <typename Val_t, typename Hash_t = std::hash<Val_t>>
     struct DecayingHashSet
     {
@@ -35,17 +40,28 @@ namespace llarp
       {
         if (now == 0s)
           now = llarp::time_now_ms();
-        return m_Values.try_emplace(v, now).second;
+        if (not m_Values.try_emplace(v, now).second)
+          return false;
+        m_Expiry.emplace_back(now, v);
+        return true;
       }
 
-      /// decay hashset entries
+      /// decay hashset entries. an entry inserted with an older time than one before it waits
+      /// for that one, so it may outlive the interval but never expires early.
       void
       Decay(Time_t now = 0s)
       {
         if (now == 0s)
           now = llarp::time_now_ms();
-        EraseIf([&](const auto& item) { return (m_CacheInterval + item.second) <= now; });
-        m_Values.rehash(0);
+        while (not m_Expiry.empty() and m_Expiry.front().first + m_CacheInterval <= now)
+        {
+          m_Values.erase(m_Expiry.front().second);
+          m_Expiry.pop_front();
+        }
+        // only give memory back once most of it is unused, rehashing is too costly to do on
+        // every decay
+        if (m_Values.bucket_count() > (m_Values.size() + 16) * 8)
+          m_Values.rehash(0);
       }
 
       Time_t
@@ -67,25 +83,10 @@ namespace llarp
       }
 
      private:
-      template <typename Predicate_t>
-      void
-      EraseIf(Predicate_t pred)
-      {
-        for (auto i = m_Values.begin(), last = m_Values.end(); i != last;)
-        {
-          if (pred(*i))
-          {
-            i = m_Values.erase(i);
-          }
-          else
-          {
-            ++i;
-          }
-        }
-      }
-
       Time_t m_CacheInterval;
       std::unordered_map<Val_t, Time_t, Hash_t> m_Values;
+      /// every entry and when it was inserted, oldest first
+      std::deque<std::pair<Time_t, Val_t>> m_Expiry;
     };
   }  // namespace util
 }  // namespace llarp
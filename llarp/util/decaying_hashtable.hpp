@@ -1,10 +1,15 @@
 #pragma once
 
 #include "time.hpp"
+#include <deque>
+#include <optional>
 #include <unordered_map>
+#include <utility>
 
 namespace llarp::util
 {
+  /// a hash table whose entries expire a fixed interval after they were put. keys are also
+  /// queued in the order they were put, so a decay only touches the entries that expired.
   template <typename Key_t, typename Value_t, typename Hash_t = std::hash<Key_t>>
   struct DecayingHashTable
   {
@@ -14,7 +19,15 @@ namespace llarp::util
     void
     Decay(llarp_time_t now)
     {
-      EraseIf([&](const auto& item) { return item.second.second + m_CacheInterval <= now; });
+      while (not m_Expiry.empty() and m_Expiry.front().first + m_CacheInterval <= now)
+      {
+        const auto& [putAt, key] = m_Expiry.front();
+        // the key may have been removed and put again since
+        const auto itr = m_Values.find(key);
+        if (itr != m_Values.end() and itr->second.second == putAt)
+          m_Values.erase(itr);
+        m_Expiry.pop_front();
+      }
     }
 
     /// return if we have this value by key
@@ -31,7 +44,11 @@ namespace llarp::util
     {
       if (now == 0s)
         now = llarp::time_now_ms();
-      return m_Values.try_emplace(std::move(key), std::make_pair(std::move(value), now)).second;
+      const auto itr = m_Values.try_emplace(key, std::make_pair(std::move(value), now));
+      if (not itr.second)
+        return false;
+      m_Expiry.emplace_back(now, std::move(key));
+      return true;
     }
 
     /// get value by key
@@ -52,24 +69,9 @@ namespace llarp::util
     }
 
    private:
-    template <typename Predicate_t>
-    void
-    EraseIf(Predicate_t pred)
-    {
-      for (auto i = m_Values.begin(), last = m_Values.end(); i != last;)
-      {
-        if (pred(*i))
-        {
-          i = m_Values.erase(i);
-        }
-        else
-        {
-          ++i;
-        }
-      }
-    }
-
     llarp_time_t m_CacheInterval;
     std::unordered_map<Key_t, std::pair<Value_t, llarp_time_t>, Hash_t> m_Values;
+    /// every key and when it was put, oldest first
+    std::deque<std::pair<llarp_time_t, Key_t>> m_Expiry;
   };
 }  // namespace llarp::util
@@ -0,0 +1,335 @@
+#pragma once
+
+#include "codel.hpp"
+#include "status.hpp"
+#include <llarp/util/thread/threading.hpp>
+#include "time.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// flow queueing in front of codel (rfc 8290). items are hashed into flows, the flows take
+    /// turns by deficit round robin and each one runs its own codel, so a bulk flow that builds
+    /// a standing queue has its own items dropped instead of delaying everyone else's. flows
+    /// that just became active are served before ones that have been busy for a while, which is
+    /// what keeps sparse interactive flows quick under load.
+    ///
+    /// items live in a pool of slots that is grown up to the limit on demand and then reused,
+    /// flows only hold slot indices.
+    template <
+        typename T,
+        typename GetTime,
+        typename PutTime,
+        typename GetSize,
+        typename FlowHash,
+        typename GetNow = GetNowSyscall,
+        typename Mutex_t = util::Mutex,
+        typename Lock_t = std::lock_guard<Mutex_t>>
+    struct FQCoDelQueue
+    {
+      static constexpr size_t NumFlows = 1024;
+      /// bytes a flow may send per round
+      static constexpr int64_t Quantum = 1514;
+      /// sojourn time codel aims to keep each flow under
+      static constexpr llarp_time_t Target = 5ms;
+      /// how long a flow may stay above target before codel starts dropping
+      static constexpr llarp_time_t Interval = 100ms;
+
+      FQCoDelQueue(std::string name, PutTime put, GetNow now, size_t limit = 1024)
+          : m_name(std::move(name))
+          , m_Limit(limit)
+          , m_Flows(NumFlows)
+          , _putTime(std::move(put))
+          , _getNow(std::move(now))
+      {}
+
+      size_t
+      Size() const EXCLUDES(m_QueueMutex)
+      {
+        Lock_t lock(m_QueueMutex);
+        return m_Size;
+      }
+
+      /// queue an item, when full the oldest item of the flow with the longest backlog is
+      /// dropped to make room
+      template <typename... Args>
+      void
+      Emplace(Args&&... args) EXCLUDES(m_QueueMutex)
+      {
+        Lock_t lock(m_QueueMutex);
+        if (m_Size == m_Limit)
+        {
+          if (not DropFromFattest())
+            return;
+          ++m_Overflows;
+        }
+        const auto slot = Allocate(std::forward<Args>(args)...);
+        _putTime(m_Slots[slot]);
+        auto& flow = m_Flows[FlowHash{}(m_Slots[slot]) % NumFlows];
+        const uint32_t idx = &flow - m_Flows.data();
+        if (flow.tail == None)
+          flow.head = slot;
+        else
+          m_Next[flow.tail] = slot;
+        flow.tail = slot;
+        ++flow.backlog;
+        ++flow.enqueued;
+        ++m_Size;
+        if (not flow.listed)
+        {
+          flow.listed = true;
+          flow.deficit = Quantum;
+          m_NewFlows.push_back(idx);
+        }
+      }
+
+      /// hand every item that codel lets through to visit, in round robin order between flows
+      template <typename Visit>
+      void
+      Process(Visit visit) EXCLUDES(m_QueueMutex)
+      {
+        Lock_t lock(m_QueueMutex);
+        const auto now = _getNow();
+        while (not(m_NewFlows.empty() and m_OldFlows.empty()))
+        {
+          const bool isNew = not m_NewFlows.empty();
+          auto& list = isNew ? m_NewFlows : m_OldFlows;
+          const auto idx = list.front();
+          auto& flow = m_Flows[idx];
+          if (flow.deficit <= 0)
+          {
+            flow.deficit += Quantum;
+            list.pop_front();
+            m_OldFlows.push_back(idx);
+            continue;
+          }
+          const auto slot = CoDelDequeue(flow, now);
+          if (not slot)
+          {
+            list.pop_front();
+            // a new flow that ran dry goes to the back of the old ones once, so it cannot
+            // starve them by going idle and coming back as new every round
+            if (isNew)
+              m_OldFlows.push_back(idx);
+            else
+              flow.listed = false;
+            continue;
+          }
+          auto& item = m_Slots[*slot];
+          flow.deficit -= GetSize{}(item);
+          ++flow.sent;
+          visit(item);
+          Release(*slot);
+        }
+      }
+
+      /// totals and the counters of every flow that has seen traffic
+      util::StatusObject
+      ExtractStatus() const EXCLUDES(m_QueueMutex)
+      {
+        Lock_t lock(m_QueueMutex);
+        std::vector<util::StatusObject> flows;
+        for (size_t idx = 0; idx < m_Flows.size(); ++idx)
+        {
+          const auto& flow = m_Flows[idx];
+          if (flow.enqueued == 0)
+            continue;
+          flows.push_back(util::StatusObject{
+              {"flow", idx},
+              {"backlog", flow.backlog},
+              {"enqueued", flow.enqueued},
+              {"sent", flow.sent},
+              {"dropped", flow.dropped},
+              {"active", flow.listed},
+              {"dropping", flow.dropping}});
+        }
+        return util::StatusObject{
+            {"name", m_name},
+            {"size", m_Size},
+            {"limit", m_Limit},
+            {"dropped", m_Dropped},
+            {"overflows", m_Overflows},
+            {"flows", flows}};
+      }
+
+     private:
+      static constexpr uint32_t None = ~uint32_t{0};
+
+      struct Flow
+      {
+        uint32_t head = None;
+        uint32_t tail = None;
+        uint32_t backlog = 0;
+        int64_t deficit = 0;
+        /// on the new or old list
+        bool listed = false;
+        // codel state, rfc 8289
+        bool dropping = false;
+        llarp_time_t firstAboveTime = 0s;
+        llarp_time_t dropNext = 0s;
+        uint32_t dropCount = 0;
+        uint32_t lastDropCount = 0;
+        llarp_time_t lastDequeue = 0s;
+        // counters
+        uint64_t enqueued = 0;
+        uint64_t sent = 0;
+        uint64_t dropped = 0;
+      };
+
+      template <typename... Args>
+      uint32_t
+      Allocate(Args&&... args) REQUIRES(m_QueueMutex)
+      {
+        if (not m_Free.empty())
+        {
+          const auto slot = m_Free.back();
+          m_Free.pop_back();
+          m_Slots[slot] = T(std::forward<Args>(args)...);
+          m_Next[slot] = None;
+          return slot;
+        }
+        m_Slots.emplace_back(std::forward<Args>(args)...);
+        m_Next.push_back(None);
+        return m_Slots.size() - 1;
+      }
+
+      void
+      Release(uint32_t slot) REQUIRES(m_QueueMutex)
+      {
+        m_Free.push_back(slot);
+        --m_Size;
+      }
+
+      std::optional<uint32_t>
+      Pop(Flow& flow) REQUIRES(m_QueueMutex)
+      {
+        if (flow.head == None)
+          return std::nullopt;
+        const auto slot = flow.head;
+        flow.head = m_Next[slot];
+        if (flow.head == None)
+          flow.tail = None;
+        --flow.backlog;
+        return slot;
+      }
+
+      void
+      Drop(Flow& flow, uint32_t slot) REQUIRES(m_QueueMutex)
+      {
+        ++flow.dropped;
+        ++m_Dropped;
+        Release(slot);
+      }
+
+      bool
+      DropFromFattest() REQUIRES(m_QueueMutex)
+      {
+        Flow* fattest = nullptr;
+        for (auto& flow : m_Flows)
+        {
+          if (fattest == nullptr or flow.backlog > fattest->backlog)
+            fattest = &flow;
+        }
+        if (fattest == nullptr or fattest->backlog == 0)
+          return false;
+        Drop(*fattest, *Pop(*fattest));
+        return true;
+      }
+
+      /// pop the head of flow and tell if codel considers it ok to drop
+      std::optional<uint32_t>
+      DoDequeue(Flow& flow, llarp_time_t now, bool& okToDrop) REQUIRES(m_QueueMutex)
+      {
+        okToDrop = false;
+        auto slot = Pop(flow);
+        if (not slot)
+          return std::nullopt;
+        // every flow is emptied on each pass, so an empty flow only means it was idle when it
+        // went quiet for a whole interval
+        if (now - flow.lastDequeue > Interval)
+          flow.firstAboveTime = 0s;
+        flow.lastDequeue = now;
+        const auto put = GetTime{}(m_Slots[*slot]);
+        const auto sojourn = now > put ? now - put : 0s;
+        if (sojourn < Target)
+          flow.firstAboveTime = 0s;
+        else if (flow.firstAboveTime == 0s)
+          flow.firstAboveTime = now + Interval;
+        // never drop the last item of a flow, there is nothing behind it to speed up
+        else if (now >= flow.firstAboveTime and flow.backlog > 0)
+          okToDrop = true;
+        return slot;
+      }
+
+      static llarp_time_t
+      ControlLaw(llarp_time_t t, uint32_t count)
+      {
+        return t
+            + std::chrono::duration_cast<llarp_time_t>(
+                   Interval / std::sqrt(static_cast<double>(count)));
+      }
+
+      std::optional<uint32_t>
+      CoDelDequeue(Flow& flow, llarp_time_t now) REQUIRES(m_QueueMutex)
+      {
+        bool okToDrop;
+        auto slot = DoDequeue(flow, now, okToDrop);
+        if (flow.dropping)
+        {
+          if (not okToDrop)
+            flow.dropping = false;
+          while (slot and flow.dropping and now >= flow.dropNext)
+          {
+            Drop(flow, *slot);
+            ++flow.dropCount;
+            slot = DoDequeue(flow, now, okToDrop);
+            if (not okToDrop)
+              flow.dropping = false;
+            else
+              flow.dropNext = ControlLaw(flow.dropNext, flow.dropCount);
+          }
+        }
+        else if (slot and okToDrop)
+        {
+          Drop(flow, *slot);
+          slot = DoDequeue(flow, now, okToDrop);
+          flow.dropping = true;
+          // start from where we left off if we were dropping not long ago
+          const auto delta = flow.dropCount - flow.lastDropCount;
+          if (delta > 1 and now - flow.dropNext < Interval * 16)
+            flow.dropCount = delta;
+          else
+            flow.dropCount = 1;
+          flow.dropNext = ControlLaw(now, flow.dropCount);
+          flow.lastDropCount = flow.dropCount;
+        }
+        return slot;
+      }
+
+      const std::string m_name;
+      const size_t m_Limit;
+      mutable Mutex_t m_QueueMutex;
+      size_t m_Size GUARDED_BY(m_QueueMutex) = 0;
+      uint64_t m_Dropped GUARDED_BY(m_QueueMutex) = 0;
+      uint64_t m_Overflows GUARDED_BY(m_QueueMutex) = 0;
+      std::vector<T> m_Slots GUARDED_BY(m_QueueMutex);
+      /// next slot in the same flow, None at the tail
+      std::vector<uint32_t> m_Next GUARDED_BY(m_QueueMutex);
+      std::vector<uint32_t> m_Free GUARDED_BY(m_QueueMutex);
+      std::vector<Flow> m_Flows GUARDED_BY(m_QueueMutex);
+      std::deque<uint32_t> m_NewFlows GUARDED_BY(m_QueueMutex);
+      std::deque<uint32_t> m_OldFlows GUARDED_BY(m_QueueMutex);
+      PutTime _putTime;
+      GetNow _getNow;
+    };
+  }  // namespace util
+}  // namespace llarp
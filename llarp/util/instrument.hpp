@@ -0,0 +1,33 @@
+#pragma once
+
+/// instrumentation for the tracy profiler. every macro here expands to nothing unless lokinet is
+/// built with TRACY_ROOT set, so they are free to put on hot paths; arguments to the macros are
+/// not evaluated when tracy is off, so do not give them expressions with side effects.
+
+#ifdef TRACY_ENABLE
+#include <Tracy.hpp>
+
+#include <cstdint>
+
+/// time the rest of the enclosing scope as a zone named after the function
+#define LLARP_ZONE() ZoneScoped
+/// time the rest of the enclosing scope as a zone called name, name must be a string literal
+#define LLARP_ZONE_NAMED(name) ZoneScopedN(name)
+/// mark the end of one iteration of the main event loop
+#define LLARP_FRAME() FrameMark
+/// mark the end of one iteration of a secondary loop called name, name must be a string literal
+#define LLARP_FRAME_NAMED(name) FrameMarkNamed(name)
+/// record value on the plot called name, name must be a string literal
+#define LLARP_PLOT(name, value) TracyPlot(name, static_cast<int64_t>(value))
+/// record an allocation or a free of ptr for tracy's memory view
+#define LLARP_TRACE_ALLOC(ptr, sz) TracyAlloc(ptr, sz)
+#define LLARP_TRACE_FREE(ptr) TracyFree(ptr)
+#else
+#define LLARP_ZONE()
+#define LLARP_ZONE_NAMED(name)
+#define LLARP_FRAME()
+#define LLARP_FRAME_NAMED(name)
+#define LLARP_PLOT(name, value)
+#define LLARP_TRACE_ALLOC(ptr, sz)
+#define LLARP_TRACE_FREE(ptr)
+#endif
@@ -8,7 +8,12 @@ namespace llarp
 {
   void
   AndroidLogStream::PreLog(
-      std::stringstream& ss, LogLevel lvl, const char* fname, int lineno, const std::string&) const
+      std::stringstream& ss,
+      LogLevel lvl,
+      const char* fname,
+      int lineno,
+      const std::string&,
+      const LogStamp& stamp) const
   {
     switch (lvl)
     {
@@ -31,7 +36,7 @@ namespace llarp
         break;
     }
 
-    ss << "(" << thread_id_string() << ") " << log_timestamp() << " " << fname << ":" << lineno
+    ss << "(" << stamp.thread << ") " << log_timestamp{stamp} << " " << fname << ":" << lineno
        << "\t";
   }
 
@@ -39,9 +44,6 @@ namespace llarp
   AndroidLogStream::PostLog(std::stringstream&) const
   {}
 
-  void AndroidLogStream::Tick(llarp_time_t)
-  {}
-
   void
   AndroidLogStream::Print(LogLevel lvl, const char* tag, const std::string& msg)
   {
@@ -14,7 +14,8 @@ namespace llarp
         LogLevel lvl,
         const char* fname,
         int lineno,
-        const std::string& nodename) const override;
+        const std::string& nodename,
+        const LogStamp& stamp) const override;
 
     void
     Print(LogLevel lvl, const char* filename, const std::string& msg) override;
@@ -22,8 +23,6 @@ namespace llarp
     void
     PostLog(std::stringstream&) const override;
 
-    void Tick(llarp_time_t) override;
-
     void
     ImmediateFlush() override{};
   };
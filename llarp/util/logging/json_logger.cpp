@@ -9,16 +9,17 @@ namespace llarp
       const char* fname,
       int lineno,
       const std::string& nodename,
-      const std::string msg)
+      const std::string& msg,
+      const LogStamp& stamp)
   {
     json::Object obj;
-    obj["time"] = to_json(llarp::time_now_ms());
+    obj["time"] = to_json(stamp.when);
     obj["nickname"] = nodename;
     obj["file"] = std::string(fname);
     obj["line"] = lineno;
     obj["level"] = LogLevelToString(lvl);
     obj["message"] = msg;
-    m_Lines.pushBack(obj.dump());
+    Print(lvl, fname, obj.dump());
   }
 
 }  // namespace llarp
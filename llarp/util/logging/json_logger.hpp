@@ -7,12 +7,7 @@ namespace llarp
 {
   struct JSONLogStream : public FileLogStream
   {
-    JSONLogStream(
-        std::function<void(FileLogStream::Work_t)> disk,
-        FILE* f,
-        llarp_time_t flushInterval,
-        bool closeFile)
-        : FileLogStream(std::move(disk), f, flushInterval, closeFile)
+    JSONLogStream(FILE* f, bool closeFile) : FileLogStream(f, closeFile)
     {}
 
     void
@@ -21,7 +16,8 @@ namespace llarp
         const char* fname,
         int lineno,
         const std::string& nodename,
-        const std::string msg) override;
+        const std::string& msg,
+        const LogStamp& stamp) override;
   };
 }  // namespace llarp
 
@@ -0,0 +1,305 @@
+#include "log_ring.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <sstream>
+
+namespace llarp::log_ring
+{
+  /// how long the writer sleeps between batches when no ring asks for an early drain
+  static constexpr auto FlushInterval = 100ms;
+
+  Ring::Ring() : m_Buf{new std::byte[Capacity]}
+  {}
+
+  bool
+  Ring::TryPush(const std::byte* data, size_t sz)
+  {
+    const auto head = m_Head.load(std::memory_order_relaxed);
+    const auto tail = m_Tail.load(std::memory_order_acquire);
+    if (Capacity - (head - tail) < sz)
+      return false;
+    const auto pos = head % Capacity;
+    const auto first = std::min(sz, Capacity - pos);
+    std::memcpy(m_Buf.get() + pos, data, first);
+    std::memcpy(m_Buf.get(), data + first, sz - first);
+    m_Head.store(head + sz, std::memory_order_release);
+    return true;
+  }
+
+  size_t
+  Ring::Used() const
+  {
+    const auto tail = m_Tail.load(std::memory_order_acquire);
+    return m_Head.load(std::memory_order_acquire) - tail;
+  }
+
+  void
+  Ring::CopyOut(size_t pos, std::byte* dst, size_t sz) const
+  {
+    pos %= Capacity;
+    const auto first = std::min(sz, Capacity - pos);
+    std::memcpy(dst, m_Buf.get() + pos, first);
+    std::memcpy(dst + first, m_Buf.get(), sz - first);
+  }
+
+  template <typename T>
+  static T
+  Get(const std::vector<std::byte>& record, size_t& pos)
+  {
+    T val;
+    std::memcpy(&val, record.data() + pos, sizeof(val));
+    pos += sizeof(val);
+    return val;
+  }
+
+  void
+  Decode(const std::vector<std::byte>& record, Line& line)
+  {
+    size_t pos = 0;
+    const auto hdr = Get<RecordHeader>(record, pos);
+    line.lvl = hdr.lvl;
+    line.fname = hdr.fname;
+    line.lineno = hdr.lineno;
+    line.stamp = hdr.stamp;
+    line.msg.clear();
+    while (pos < hdr.size)
+    {
+      switch (Get<ArgType>(record, pos))
+      {
+        case ArgType::Int:
+          line.msg += std::to_string(Get<int64_t>(record, pos));
+          break;
+        case ArgType::UInt:
+          line.msg += std::to_string(Get<uint64_t>(record, pos));
+          break;
+        case ArgType::Double: {
+          // doubles keep the default ostream format the synchronous path used
+          std::ostringstream ss;
+          ss << Get<double>(record, pos);
+          line.msg += ss.str();
+          break;
+        }
+        case ArgType::Str: {
+          const auto sz = Get<uint32_t>(record, pos);
+          line.msg.append(reinterpret_cast<const char*>(record.data() + pos), sz);
+          pos += sz;
+          break;
+        }
+      }
+    }
+  }
+
+  namespace
+  {
+    /// a streambuf that appends to a record
+    struct AppendBuf : public std::streambuf
+    {
+      std::vector<std::byte>* buf = nullptr;
+
+      int_type
+      overflow(int_type ch) override
+      {
+        if (not traits_type::eq_int_type(ch, traits_type::eof()))
+          buf->push_back(static_cast<std::byte>(ch));
+        return traits_type::not_eof(ch);
+      }
+
+      std::streamsize
+      xsputn(const char* str, std::streamsize sz) override
+      {
+        Put(*buf, str, sz);
+        return sz;
+      }
+    };
+
+    /// the calling thread's rings, one per writer it logged to. a ring is marked orphaned when
+    /// the thread exits so the writer can let go of it.
+    struct ThreadRings
+    {
+      std::vector<std::pair<uint64_t, std::shared_ptr<Ring>>> rings;
+
+      ~ThreadRings()
+      {
+        for (auto& [id, ring] : rings)
+          ring->orphaned = true;
+      }
+    };
+  }  // namespace
+
+  std::ostream&
+  Appender(std::vector<std::byte>& buf)
+  {
+    thread_local AppendBuf appendBuf;
+    thread_local std::ostream out{&appendBuf};
+    appendBuf.buf = &buf;
+    // every argument gets a freshly formatted stream like the synchronous path had
+    out.clear();
+    out.flags(std::ios_base::dec | std::ios_base::skipws);
+    out.precision(6);
+    out.width(0);
+    out.fill(' ');
+    return out;
+  }
+
+  std::vector<std::byte>&
+  Begin(LogLevel lvl, const char* fname, int lineno)
+  {
+    thread_local std::vector<std::byte> staging;
+    staging.clear();
+    const RecordHeader hdr{0, lvl, lineno, fname, {time_now_ms(), uptime(), log_thread_id()}};
+    Put(staging, &hdr, sizeof(hdr));
+    return staging;
+  }
+
+  void
+  Commit(Writer& writer, LogLevel lvl, std::vector<std::byte>& record)
+  {
+    const uint32_t sz = record.size();
+    std::memcpy(record.data() + offsetof(RecordHeader, size), &sz, sizeof(sz));
+    auto& ring = writer.ThisThread();
+    // a record bigger than the ring never fits however far the writer is, so it is not shed
+    if (lvl < eLogError and sz <= Ring::Capacity)
+    {
+      const auto used = ring.Used();
+      if (ring.TryPush(record.data(), sz))
+      {
+        if (used < Ring::Capacity / 2 and used + sz >= Ring::Capacity / 2)
+          writer.Wake();
+        return;
+      }
+      if (lvl < eLogWarn)
+      {
+        // the writer is not keeping up, shed debug and info rather than stall the caller
+        ring.Dropped();
+        writer.Wake();
+        return;
+      }
+    }
+    // errors, warnings that did not fit and records too big for the ring are written out before
+    // we return, errors so they are not lost if we are about to crash
+    writer.Deliver(record);
+  }
+
+  static uint64_t
+  NextWriterID()
+  {
+    static std::atomic<uint64_t> next{0};
+    return next++;
+  }
+
+  Writer::Writer(Sink_t sink)
+      : m_ID{NextWriterID()}, m_Sink{std::move(sink)}, m_Thread{[this]() { Run(); }}
+  {}
+
+  Writer::~Writer()
+  {
+    {
+      std::unique_lock lock{m_Access};
+      m_Running = false;
+    }
+    m_Cond.notify_one();
+    m_Thread.join();
+    std::unique_lock lock{m_Drain};
+    DrainLocked();
+  }
+
+  Ring&
+  Writer::ThisThread()
+  {
+    thread_local ThreadRings mine;
+    for (const auto& [id, ring] : mine.rings)
+    {
+      if (id == m_ID)
+        return *ring;
+    }
+    auto ring = std::make_shared<Ring>();
+    {
+      std::unique_lock lock{m_Access};
+      m_Rings.push_back(ring);
+    }
+    mine.rings.emplace_back(m_ID, ring);
+    return *ring;
+  }
+
+  void
+  Writer::Wake()
+  {
+    m_Cond.notify_one();
+  }
+
+  void
+  Writer::Flush()
+  {
+    std::unique_lock lock{m_Drain};
+    DrainLocked();
+  }
+
+  void
+  Writer::Deliver(const std::vector<std::byte>& record)
+  {
+    std::unique_lock lock{m_Drain};
+    // everything already in the rings is older than this record
+    DrainLocked();
+    m_Lines.resize(1);
+    Decode(record, m_Lines.front());
+    m_Sink(m_Lines);
+    m_Lines.clear();
+  }
+
+  void
+  Writer::Run()
+  {
+    std::unique_lock lock{m_Access};
+    while (m_Running)
+    {
+      m_Cond.wait_for(lock, FlushInterval);
+      lock.unlock();
+      {
+        std::unique_lock drain{m_Drain};
+        DrainLocked();
+      }
+      lock.lock();
+    }
+  }
+
+  void
+  Writer::DrainLocked()
+  {
+    m_Lines.clear();
+    std::unique_lock lock{m_Access};
+    auto itr = m_Rings.begin();
+    while (itr != m_Rings.end())
+    {
+      auto& ring = **itr;
+      // read before popping, so an orphaned ring is known to be empty once popped
+      const bool orphaned = ring.orphaned;
+      ring.PopAll(m_Scratch, [this](const auto& record) {
+        Decode(record, m_Lines.emplace_back());
+      });
+      if (const auto dropped = ring.TakeDropped())
+      {
+        m_Lines.push_back(Line{
+            eLogWarn,
+            "log_ring",
+            0,
+            {time_now_ms(), uptime(), log_thread_id()},
+            std::to_string(dropped) + " log lines dropped because the log writer fell behind"});
+      }
+      if (orphaned)
+        itr = m_Rings.erase(itr);
+      else
+        ++itr;
+    }
+    // the sink does io, do not keep threads registering their rings waiting on it
+    lock.unlock();
+    if (m_Lines.empty())
+      return;
+    // each ring is in order already, this interleaves the threads
+    std::stable_sort(m_Lines.begin(), m_Lines.end(), [](const auto& lhs, const auto& rhs) {
+      return lhs.stamp.when < rhs.stamp.when;
+    });
+    m_Sink(m_Lines);
+    m_Lines.clear();
+  }
+}  // namespace llarp::log_ring
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "logstream.hpp"
+#include "logger_internal.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace llarp::log_ring
+{
+  /// how a raw log argument was stored
+  enum class ArgType : uint8_t
+  {
+    Int,
+    UInt,
+    Double,
+    Str,
+  };
+
+  /// what is stored in front of the arguments of every record. fname is the static string of
+  /// the call site, so together with lineno it identifies the format without copying it.
+  struct RecordHeader
+  {
+    uint32_t size;
+    LogLevel lvl;
+    int lineno;
+    const char* fname;
+    LogStamp stamp;
+  };
+
+  /// a single producer single consumer ring of encoded records. the owning thread pushes, the
+  /// writer pops while holding the writer lock.
+  class Ring
+  {
+   public:
+    static constexpr size_t Capacity = 1 << 18;
+
+    Ring();
+
+    /// copy a whole record in, false if there is no room for it
+    bool
+    TryPush(const std::byte* data, size_t sz);
+
+    /// bytes waiting to be popped
+    size_t
+    Used() const;
+
+    /// pop every record pushed so far, calling visit on each
+    template <typename Visit_t>
+    void
+    PopAll(std::vector<std::byte>& scratch, Visit_t&& visit)
+    {
+      const auto head = m_Head.load(std::memory_order_acquire);
+      auto tail = m_Tail.load(std::memory_order_relaxed);
+      while (tail != head)
+      {
+        RecordHeader hdr;
+        CopyOut(tail, reinterpret_cast<std::byte*>(&hdr), sizeof(hdr));
+        scratch.resize(hdr.size);
+        CopyOut(tail, scratch.data(), hdr.size);
+        visit(std::as_const(scratch));
+        tail += hdr.size;
+      }
+      m_Tail.store(tail, std::memory_order_release);
+    }
+
+    /// records the owner could not push and dropped, reset on read
+    uint64_t
+    TakeDropped()
+    {
+      return m_Dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    void
+    Dropped()
+    {
+      m_Dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// set when the owning thread exits, the writer frees the ring once it is drained
+    std::atomic<bool> orphaned{false};
+
+   private:
+    void
+    CopyOut(size_t pos, std::byte* dst, size_t sz) const;
+
+    std::unique_ptr<std::byte[]> m_Buf;
+    alignas(64) std::atomic<size_t> m_Head{0};
+    alignas(64) std::atomic<size_t> m_Tail{0};
+    std::atomic<uint64_t> m_Dropped{0};
+  };
+
+  /// a decoded log record, ready to be formatted by a log stream
+  struct Line
+  {
+    LogLevel lvl;
+    const char* fname;
+    int lineno;
+    LogStamp stamp;
+    std::string msg;
+  };
+
+  /// turn an encoded record back into a line, formatting its arguments into msg
+  void
+  Decode(const std::vector<std::byte>& record, Line& line);
+
+  /// drains every thread's ring on a background thread and hands the lines, oldest first, to
+  /// the sink in batches
+  class Writer
+  {
+   public:
+    using Sink_t = std::function<void(std::vector<Line>&)>;
+
+    explicit Writer(Sink_t sink);
+
+    ~Writer();
+
+    /// the ring the calling thread records into
+    Ring&
+    ThisThread();
+
+    /// wake the background thread early, called when a ring passes half full
+    void
+    Wake();
+
+    /// drain every ring on the calling thread, returns once everything recorded so far has been
+    /// handed to the sink
+    void
+    Flush();
+
+    /// hand one encoded record straight to the sink, for records that do not fit in a ring
+    void
+    Deliver(const std::vector<std::byte>& record);
+
+   private:
+    void
+    Run();
+
+    /// pop every ring under m_Access then hand the lines to the sink without it, must hold
+    /// m_Drain
+    void
+    DrainLocked();
+
+    /// tells writers apart in the per thread ring lists
+    const uint64_t m_ID;
+    const Sink_t m_Sink;
+    /// guards m_Running and m_Rings, never held while the sink runs
+    std::mutex m_Access;
+    /// serializes draining so lines reach the sink in order, taken before m_Access
+    std::mutex m_Drain;
+    std::condition_variable m_Cond;
+    bool m_Running = true;
+    std::vector<std::shared_ptr<Ring>> m_Rings;
+    /// guarded by m_Drain
+    std::vector<Line> m_Lines;
+    std::vector<std::byte> m_Scratch;
+    std::thread m_Thread;
+  };
+
+  /// an ostream that appends to buf, reset to the default format. arguments that cannot be
+  /// stored raw are formatted through it straight into the staging buffer.
+  std::ostream&
+  Appender(std::vector<std::byte>& buf);
+
+  inline void
+  Put(std::vector<std::byte>& buf, const void* data, size_t sz)
+  {
+    const auto* ptr = static_cast<const std::byte*>(data);
+    buf.insert(buf.end(), ptr, ptr + sz);
+  }
+
+  inline void
+  PutStr(std::vector<std::byte>& buf, std::string_view str)
+  {
+    const ArgType type = ArgType::Str;
+    const uint32_t sz = str.size();
+    Put(buf, &type, sizeof(type));
+    Put(buf, &sz, sizeof(sz));
+    Put(buf, str.data(), str.size());
+  }
+
+  /// format arg into a string argument through its operator<<
+  template <typename TArg>
+  inline void
+  PutFormatted(std::vector<std::byte>& buf, TArg&& arg)
+  {
+    const ArgType type = ArgType::Str;
+    Put(buf, &type, sizeof(type));
+    const auto lenAt = buf.size();
+    buf.resize(lenAt + sizeof(uint32_t));
+    Appender(buf) << std::forward<TArg>(arg);
+    const uint32_t sz = buf.size() - lenAt - sizeof(uint32_t);
+    std::memcpy(buf.data() + lenAt, &sz, sizeof(sz));
+  }
+
+  template <typename T>
+  inline void
+  PutValue(std::vector<std::byte>& buf, ArgType type, T val)
+  {
+    Put(buf, &type, sizeof(type));
+    Put(buf, &val, sizeof(val));
+  }
+
+  /// store one argument, formatting it the same way the ostream in the old synchronous path did
+  template <typename TArg>
+  void
+  Encode(std::vector<std::byte>& buf, TArg&& arg)
+  {
+    using PlainT = std::remove_reference_t<TArg>;
+    using DecayT = std::decay_t<TArg>;
+    // char types are logged as their numeric value rather than the raw char, unless const
+    if constexpr (is_same_any_v<PlainT, char, unsigned char, signed char, uint8_t>)
+      PutValue<int64_t>(buf, ArgType::Int, +arg);
+    else if constexpr (std::is_same_v<PlainT, std::byte>)
+      PutValue<int64_t>(buf, ArgType::Int, std::to_integer<int>(arg));
+    else if constexpr (is_same_any_v<DecayT, char, signed char, unsigned char, wchar_t, char16_t>)
+      PutFormatted(buf, std::forward<TArg>(arg));
+    else if constexpr (std::is_integral_v<DecayT> and std::is_signed_v<DecayT>)
+      PutValue<int64_t>(buf, ArgType::Int, arg);
+    else if constexpr (std::is_integral_v<DecayT>)
+      PutValue<uint64_t>(buf, ArgType::UInt, arg);
+    else if constexpr (is_same_any_v<DecayT, float, double>)
+      PutValue<double>(buf, ArgType::Double, arg);
+    else if constexpr (std::is_array_v<PlainT> and is_same_any_v<DecayT, char*, const char*>)
+      PutStr(buf, std::string_view{arg});
+    else if constexpr (is_same_any_v<DecayT, char*, const char*>)
+      PutStr(buf, arg ? std::string_view{arg} : std::string_view{});
+    else if constexpr (std::is_convertible_v<const DecayT&, std::string_view>)
+      PutStr(buf, std::string_view{arg});
+    else
+      PutFormatted(buf, std::forward<TArg>(arg));
+  }
+
+  /// start a record in the staging buffer
+  std::vector<std::byte>&
+  Begin(LogLevel lvl, const char* fname, int lineno);
+
+  /// finish the record in the staging buffer and push it into this thread's ring of writer
+  void
+  Commit(Writer& writer, LogLevel lvl, std::vector<std::byte>& record);
+
+  template <typename... TArgs>
+  void
+  Record(Writer& writer, LogLevel lvl, const char* fname, int lineno, TArgs&&... args)
+  {
+    auto& record = Begin(lvl, fname, lineno);
+    (Encode(record, std::forward<TArgs>(args)), ...);
+    Commit(writer, lvl, record);
+  }
+}  // namespace llarp::log_ring
@@ -44,7 +44,9 @@ namespace llarp
     return LogType::Unknown;
   }
 
-  LogContext::LogContext() : logStream{std::make_unique<Stream_t>(_LOGSTREAM_INIT)}
+  LogContext::LogContext()
+      : logStream{std::make_unique<Stream_t>(_LOGSTREAM_INIT)}
+      , writer{[this](auto& lines) { WriteLines(lines); }}
   {}
 
   LogContext&
@@ -73,6 +75,10 @@ namespace llarp
       : format{fmt}, now{llarp::time_now_ms()}, delta{llarp::uptime()}
   {}
 
+  log_timestamp::log_timestamp(const LogStamp& stamp)
+      : format{"%c %Z"}, now{stamp.when}, delta{stamp.uptime}
+  {}
+
   void
   SetLogLevel(LogLevel lvl)
   {
@@ -89,6 +95,27 @@ namespace llarp
   void
   LogContext::ImmediateFlush()
   {
+    writer.Flush();
+  }
+
+  ILogStream_ptr
+  LogContext::SwapLogStream(ILogStream_ptr stream)
+  {
+    writer.Flush();
+    std::unique_lock lock{streamAccess};
+    std::swap(stream, logStream);
+    hasStream.store(logStream != nullptr, std::memory_order_relaxed);
+    return stream;
+  }
+
+  void
+  LogContext::WriteLines(std::vector<log_ring::Line>& lines)
+  {
+    std::unique_lock lock{streamAccess};
+    if (not logStream)
+      return;
+    for (const auto& line : lines)
+      logStream->AppendLog(line.lvl, line.fname, line.lineno, nodeName, line.msg, line.stamp);
     logStream->ImmediateFlush();
   }
 
@@ -97,14 +124,18 @@ namespace llarp
       LogLevel level,
       LogType type,
       const std::string& file,
-      const std::string& nickname,
-      std::function<void(IOFunc_t)> io)
+      const std::string& nickname)
   {
     SetLogLevel(level);
     if (level == eLogTrace)
       LogTrace("Set log level to trace.");
 
-    nodeName = nickname;
+    // lines logged so far keep the old name
+    writer.Flush();
+    {
+      std::unique_lock lock{streamAccess};
+      nodeName = nickname;
+    }
 
     FILE* logfile = nullptr;
     if (file == "stdout" or file == "-" or file.empty())
@@ -132,8 +163,7 @@ namespace llarp
           LogInfo("Switching logger to file ", file);
           std::cout << std::flush;
 
-          LogContext::Instance().logStream =
-              std::make_unique<FileLogStream>(io, logfile, 100ms, true);
+          SwapLogStream(std::make_unique<FileLogStream>(logfile, true));
         }
         else
         {
@@ -145,8 +175,7 @@ namespace llarp
         LogInfo("Switching logger to JSON with file: ", file);
         std::cout << std::flush;
 
-        LogContext::Instance().logStream =
-            std::make_unique<JSONLogStream>(io, logfile, 100ms, logfile != stdout);
+        SwapLogStream(std::make_unique<JSONLogStream>(logfile, logfile != stdout));
         break;
       case LogType::Syslog:
         if (logfile)
@@ -161,7 +190,7 @@ namespace llarp
 #else
         LogInfo("Switching logger to syslog");
         std::cout << std::flush;
-        LogContext::Instance().logStream = std::make_unique<SysLogStream>();
+        SwapLogStream(std::make_unique<SysLogStream>());
 #endif
         break;
     }
@@ -170,12 +199,12 @@ namespace llarp
   LogSilencer::LogSilencer() : LogSilencer(LogContext::Instance())
   {}
 
-  LogSilencer::LogSilencer(LogContext& ctx) : parent(ctx), stream(std::move(ctx.logStream))
+  LogSilencer::LogSilencer(LogContext& ctx) : parent(ctx), stream(ctx.SwapLogStream(nullptr))
   {}
 
   LogSilencer::~LogSilencer()
   {
-    parent.logStream = std::move(stream);
+    parent.SwapLogStream(std::move(stream));
   }
 
 }  // namespace llarp
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <llarp/util/time.hpp>
 #include "logstream.hpp"
 #include "logger_internal.hpp"
+#include "log_ring.hpp"
 
 namespace llarp
 {
@@ -19,14 +22,19 @@ namespace llarp
 
   struct LogContext
   {
-    using IOFunc_t = std::function<void(void)>;
-
     LogContext();
     LogLevel curLevel = eLogInfo;
     LogLevel startupLevel = eLogInfo;
     LogLevel runtimeLevel = eLogInfo;
+    /// only read this from the logging thread, replace it with SwapLogStream
     ILogStream_ptr logStream;
+    /// whether logStream is set, what other threads check to see if logging is on
+    std::atomic<bool> hasStream{true};
     std::string nodeName = "lokinet";
+    /// held while logStream or nodeName is used or replaced, must outlive writer
+    std::mutex streamAccess;
+    /// what every thread logs is recorded here and written to logStream in batches
+    log_ring::Writer writer;
 
     static LogContext&
     Instance();
@@ -42,20 +50,24 @@ namespace llarp
     void
     ImmediateFlush();
 
+    /// write out everything logged so far to the current stream, then replace it with stream
+    /// and return the old one
+    ILogStream_ptr
+    SwapLogStream(ILogStream_ptr stream);
+
     /// Initialize the logging system.
     ///
     /// @param level is the new log level (below which log statements will be ignored)
     /// @param type is the type of logger to set up
     /// @param file is the file to log to (relevant for types File and Json)
     /// @param nickname is a tag to add to each log statement
-    /// @param io is a callable that queues work that does io, async
     void
-    Initialize(
-        LogLevel level,
-        LogType type,
-        const std::string& file,
-        const std::string& nickname,
-        std::function<void(IOFunc_t)> io);
+    Initialize(LogLevel level, LogType type, const std::string& file, const std::string& nickname);
+
+   private:
+    /// the sink of writer, runs on its thread
+    void
+    WriteLines(std::vector<log_ring::Line>& lines);
   };
 
   /// RAII type to turn logging off
@@ -83,12 +95,9 @@ namespace llarp
   _log(LogLevel lvl, const char* fname, int lineno, TArgs&&... args) noexcept
   {
     auto& log = LogContext::Instance();
-    if (log.curLevel > lvl || log.logStream == nullptr)
+    if (log.curLevel > lvl || not log.hasStream.load(std::memory_order_relaxed))
       return;
-    std::ostringstream ss;
-    if constexpr (sizeof...(args) > 0)
-      LogAppend(ss, std::forward<TArgs>(args)...);
-    log.logStream->AppendLog(lvl, fname, lineno, log.nodeName, ss.str());
+    log_ring::Record(log.writer, lvl, fname, lineno, std::forward<TArgs>(args)...);
   }
 
   inline void
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "logstream.hpp"
 #include <llarp/util/time.hpp>
 
 #include <ctime>
@@ -15,36 +16,13 @@ namespace llarp
   template <typename T, typename... V>
   constexpr bool is_same_any_v = (std::is_same_v<T, V> || ...);
 
-  template <typename TArg, typename... TArgs>
-  void
-  LogAppend(std::ostringstream& ss, TArg&& arg, TArgs&&... args) noexcept
+  /// short id of the calling thread that log lines are tagged with
+  inline uint16_t
+  log_thread_id()
   {
-    // If you are logging a char/unsigned char/uint8_t then promote it to an integer so that we
-    // print numeric values rather than std::ostream's default of printing it as a raw char.
-    using PlainT = std::remove_reference_t<TArg>;
-    if constexpr (is_same_any_v<PlainT, char, unsigned char, signed char, uint8_t>)
-      ss << +std::forward<TArg>(arg);  // Promote to int
-    else if constexpr (std::is_same_v<PlainT, std::byte>)
-      ss << std::to_integer<int>(arg);
-    else
-      ss << std::forward<TArg>(arg);
-    if constexpr (sizeof...(TArgs) > 0)
-      LogAppend(ss, std::forward<TArgs>(args)...);
-  }
-
-  inline std::string
-  thread_id_string()
-  {
-    auto tid = std::this_thread::get_id();
-    std::hash<std::thread::id> h;
-    uint16_t id = h(tid) % 1000;
-#if defined(ANDROID)
-    char buff[8] = {0};
-    snprintf(buff, sizeof(buff), "%u", id);
-    return buff;
-#else
-    return std::to_string(id);
-#endif
+    static thread_local const uint16_t id =
+        std::hash<std::thread::id>{}(std::this_thread::get_id()) % 1000;
+    return id;
   }
 
   struct log_timestamp
@@ -56,6 +34,9 @@ namespace llarp
     log_timestamp();
 
     explicit log_timestamp(const char* fmt);
+
+    /// the time a line was recorded at
+    explicit log_timestamp(const LogStamp& stamp);
   };
 
   std::ostream&
@@ -13,7 +13,8 @@ namespace llarp
         LogLevel lvl,
         const char* fname,
         int lineno,
-        const std::string& nodename) const override;
+        const std::string& nodename,
+        const LogStamp& stamp) const override;
 
     void
     Print(LogLevel lvl, const char* tag, const std::string& msg) override;
@@ -24,8 +25,5 @@ namespace llarp
     virtual void
     ImmediateFlush() override
     {}
-
-    void Tick(llarp_time_t) override
-    {}
   };
 }  // namespace llarp
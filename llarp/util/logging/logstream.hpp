@@ -9,6 +9,15 @@
 
 namespace llarp
 {
+  /// when and on which thread a log line was recorded. lines are formatted later on the log
+  /// writer thread, so this is captured by the thread that logged.
+  struct LogStamp
+  {
+    llarp_time_t when;
+    llarp_time_t uptime;
+    uint16_t thread;
+  };
+
   /// logger stream interface
   struct ILogStream
   {
@@ -20,7 +29,8 @@ namespace llarp
         LogLevel lvl,
         const char* fname,
         int lineno,
-        const std::string& nodename) const = 0;
+        const std::string& nodename,
+        const LogStamp& stamp) const = 0;
 
     virtual void
     Print(LogLevel lvl, const char* filename, const std::string& msg) = 0;
@@ -34,22 +44,19 @@ namespace llarp
         const char* fname,
         int lineno,
         const std::string& nodename,
-        const std::string msg)
+        const std::string& msg,
+        const LogStamp& stamp)
     {
       std::stringstream ss;
-      PreLog(ss, lvl, fname, lineno, nodename);
+      PreLog(ss, lvl, fname, lineno, nodename, stamp);
       ss << msg;
       PostLog(ss);
       Print(lvl, fname, ss.str());
     }
 
-    /// A blocking call to flush to disk. Should only be called in rare circumstances.
+    /// Flush what was printed. Called by the log writer after every batch of lines.
     virtual void
     ImmediateFlush() = 0;
-
-    /// called every end of event loop tick
-    virtual void
-    Tick(llarp_time_t now) = 0;
   };
 
   using ILogStream_ptr = std::unique_ptr<ILogStream>;
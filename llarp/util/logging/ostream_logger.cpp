@@ -13,7 +13,8 @@ namespace llarp
       LogLevel lvl,
       const char* fname,
       int lineno,
-      const std::string& nodename) const
+      const std::string& nodename,
+      const LogStamp& stamp) const
   {
     if (m_withColours)
     {
@@ -38,7 +39,7 @@ namespace llarp
     }
     ss << "[" << LogLevelToString(lvl) << "] ";
     ss << "[" << nodename << "]"
-       << "(" << thread_id_string() << ") " << log_timestamp() << " " << fname << ":" << lineno
+       << "(" << stamp.thread << ") " << log_timestamp{stamp} << " " << fname << ":" << lineno
        << "\t";
   }
 
@@ -53,7 +54,7 @@ namespace llarp
   void
   OStreamLogStream::Print(LogLevel, const char*, const std::string& msg)
   {
-    m_Out << msg << std::flush;
+    m_Out << msg;
   }
 
   void
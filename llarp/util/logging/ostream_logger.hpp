@@ -17,7 +17,8 @@ namespace llarp
         LogLevel lvl,
         const char* fname,
         int lineno,
-        const std::string& nodename) const override;
+        const std::string& nodename,
+        const LogStamp& stamp) const override;
 
     virtual void
     Print(LogLevel lvl, const char* tag, const std::string& msg) override;
@@ -28,9 +29,6 @@ namespace llarp
     virtual void
     ImmediateFlush() override;
 
-    void Tick(llarp_time_t) override
-    {}
-
    private:
     bool m_withColours;
     std::ostream& m_Out;
@@ -12,11 +12,12 @@ namespace llarp
       LogLevel lvl,
       const char* fname,
       int lineno,
-      const std::string& nodename) const
+      const std::string& nodename,
+      const LogStamp& stamp) const
   {
     ss << "[" << LogLevelToString(lvl) << "] ";
     ss << "[" << nodename << "]"
-       << "(" << thread_id_string() << ") " << log_timestamp() << " " << fname << ":" << lineno
+       << "(" << stamp.thread << ") " << log_timestamp{stamp} << " " << fname << ":" << lineno
        << "\t";
   }
 
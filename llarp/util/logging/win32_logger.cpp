@@ -29,7 +29,8 @@ namespace llarp
       LogLevel lvl,
       const char* fname,
       int lineno,
-      const std::string& nodename) const
+      const std::string& nodename,
+      const LogStamp& stamp) const
   {
     if (!isConsoleModern)
     {
@@ -54,11 +55,11 @@ namespace llarp
           break;
       }
       ss << "[" << nodename << "]"
-         << "(" << thread_id_string() << ") " << log_timestamp() << " " << fname << ":" << lineno
+         << "(" << stamp.thread << ") " << log_timestamp{stamp} << " " << fname << ":" << lineno
          << "\t";
     }
     else
-      OStreamLogStream::PreLog(ss, lvl, fname, lineno, nodename);
+      OStreamLogStream::PreLog(ss, lvl, fname, lineno, nodename, stamp);
   }
 
   void
@@ -16,13 +16,12 @@ namespace llarp
         LogLevel lvl,
         const char* fname,
         int lineno,
-        const std::string& nodename) const override;
+        const std::string& nodename,
+        const LogStamp& stamp) const override;
 
     void
     PostLog(std::stringstream& s) const override;
 
-    void Tick(llarp_time_t) override{};
-
     void
     Print(LogLevel lvl, const char*, const std::string& msg) override;
 
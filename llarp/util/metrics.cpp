@@ -0,0 +1,388 @@
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace llarp::metrics
+{
+  size_t
+  ThisShard()
+  {
+    static std::atomic<size_t> next{0};
+    thread_local const size_t shard = next.fetch_add(1, std::memory_order_relaxed) % NumShards;
+    return shard;
+  }
+
+  uint64_t
+  Counter::Value() const
+  {
+    uint64_t total = 0;
+    for (const auto& shard : m_Shards)
+      total += shard.value.load(std::memory_order_relaxed);
+    return total;
+  }
+
+  static uint64_t
+  DoubleBits(double val)
+  {
+    uint64_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    return bits;
+  }
+
+  static double
+  BitsDouble(uint64_t bits)
+  {
+    double val;
+    std::memcpy(&val, &bits, sizeof(val));
+    return val;
+  }
+
+  Histogram::Histogram(std::vector<double> bounds) : m_Bounds{std::move(bounds)}
+  {
+    for (auto& shard : m_Shards)
+    {
+      shard.buckets.reset(new std::atomic<uint64_t>[m_Bounds.size() + 1]);
+      for (size_t idx = 0; idx <= m_Bounds.size(); ++idx)
+        shard.buckets[idx].store(0, std::memory_order_relaxed);
+      shard.sum.store(DoubleBits(0), std::memory_order_relaxed);
+    }
+  }
+
+  void
+  Histogram::Observe(double val)
+  {
+    size_t idx = 0;
+    while (idx < m_Bounds.size() and val > m_Bounds[idx])
+      ++idx;
+    auto& shard = m_Shards[ThisShard()];
+    shard.buckets[idx].fetch_add(1, std::memory_order_relaxed);
+    // shards are per thread but more than NumShards threads wrap around, so this must still be
+    // an atomic update
+    auto old = shard.sum.load(std::memory_order_relaxed);
+    while (not shard.sum.compare_exchange_weak(
+        old, DoubleBits(BitsDouble(old) + val), std::memory_order_relaxed))
+    {}
+  }
+
+  Histogram::Snapshot
+  Histogram::Read() const
+  {
+    Snapshot snap;
+    snap.bounds = m_Bounds;
+    snap.buckets.resize(m_Bounds.size() + 1);
+    for (const auto& shard : m_Shards)
+    {
+      for (size_t idx = 0; idx <= m_Bounds.size(); ++idx)
+        snap.buckets[idx] += shard.buckets[idx].load(std::memory_order_relaxed);
+      snap.sum += BitsDouble(shard.sum.load(std::memory_order_relaxed));
+    }
+    for (size_t idx = 1; idx < snap.buckets.size(); ++idx)
+      snap.buckets[idx] += snap.buckets[idx - 1];
+    snap.count = snap.buckets.back();
+    return snap;
+  }
+
+  LatencyHistogram::LatencyHistogram() : m_Buckets{new std::atomic<uint64_t>[NumBuckets]}
+  {
+    for (size_t idx = 0; idx < NumBuckets; ++idx)
+      m_Buckets[idx].store(0, std::memory_order_relaxed);
+  }
+
+  size_t
+  LatencyHistogram::BucketFor(uint64_t usec)
+  {
+    if (usec < SubBuckets)
+      return usec;
+    usec = std::min(usec, (uint64_t{1} << MaxBits) - 1);
+    // index of the top bit, at least SubBucketBits here
+    const unsigned top = 63 - __builtin_clzll(usec);
+    const auto shift = top - SubBucketBits;
+    return (shift + 1) * SubBuckets + ((usec >> shift) & (SubBuckets - 1));
+  }
+
+  uint64_t
+  LatencyHistogram::BucketMax(size_t idx)
+  {
+    if (idx < SubBuckets)
+      return idx;
+    const auto shift = idx / SubBuckets - 1;
+    const auto lower = (SubBuckets + idx % SubBuckets) << shift;
+    return lower + (uint64_t{1} << shift) - 1;
+  }
+
+  void
+  LatencyHistogram::RecordMicros(uint64_t usec)
+  {
+    m_Buckets[BucketFor(usec)].fetch_add(1, std::memory_order_relaxed);
+    m_Sum.fetch_add(usec, std::memory_order_relaxed);
+    auto old = m_Max.load(std::memory_order_relaxed);
+    while (old < usec and not m_Max.compare_exchange_weak(old, usec, std::memory_order_relaxed))
+    {}
+  }
+
+  LatencyHistogram::Snapshot
+  LatencyHistogram::Read() const
+  {
+    Snapshot snap;
+    for (size_t idx = 0; idx < NumBuckets; ++idx)
+    {
+      snap.buckets[idx] = m_Buckets[idx].load(std::memory_order_relaxed);
+      // count from the buckets so percentiles stay consistent with a concurrent Record
+      snap.count += snap.buckets[idx];
+    }
+    snap.sumMicros = m_Sum.load(std::memory_order_relaxed);
+    snap.maxMicros = m_Max.load(std::memory_order_relaxed);
+    return snap;
+  }
+
+  std::chrono::microseconds
+  LatencyHistogram::Snapshot::Percentile(double q) const
+  {
+    if (count == 0)
+      return std::chrono::microseconds{0};
+    const auto rank = std::max<uint64_t>(1, std::ceil(std::clamp(q, 0.0, 1.0) * count));
+    uint64_t seen = 0;
+    for (size_t idx = 0; idx < NumBuckets; ++idx)
+    {
+      seen += buckets[idx];
+      if (seen >= rank)
+        return std::chrono::microseconds{std::min(BucketMax(idx), maxMicros)};
+    }
+    return std::chrono::microseconds{maxMicros};
+  }
+
+  std::vector<double>
+  ExponentialBuckets(double start, double factor, size_t count)
+  {
+    std::vector<double> bounds;
+    bounds.reserve(count);
+    for (size_t idx = 0; idx < count; ++idx)
+    {
+      bounds.push_back(start);
+      start *= factor;
+    }
+    return bounds;
+  }
+
+  Registry&
+  Registry::Global()
+  {
+    static Registry registry;
+    return registry;
+  }
+
+  Registry::Family&
+  Registry::GetFamily(std::string_view name, std::string_view help, Type type)
+  {
+    auto itr = m_Families.find(name);
+    if (itr == m_Families.end())
+    {
+      itr = m_Families.emplace(std::string{name}, Family{}).first;
+      itr->second.type = type;
+      itr->second.help = help;
+    }
+    else if (itr->second.type != type)
+      throw std::invalid_argument{"metric " + std::string{name} + " registered with another type"};
+    return itr->second;
+  }
+
+  Counter&
+  Registry::GetCounter(std::string_view name, std::string_view help, Labels labels)
+  {
+    std::unique_lock lock{m_Access};
+    auto& metric = GetFamily(name, help, Type::Counter).counters[std::move(labels)];
+    if (not metric)
+      metric = std::make_unique<Counter>();
+    return *metric;
+  }
+
+  Gauge&
+  Registry::GetGauge(std::string_view name, std::string_view help, Labels labels)
+  {
+    std::unique_lock lock{m_Access};
+    auto& metric = GetFamily(name, help, Type::Gauge).gauges[std::move(labels)];
+    if (not metric)
+      metric = std::make_unique<Gauge>();
+    return *metric;
+  }
+
+  Histogram&
+  Registry::GetHistogram(
+      std::string_view name, std::string_view help, std::vector<double> bounds, Labels labels)
+  {
+    std::unique_lock lock{m_Access};
+    auto& metric = GetFamily(name, help, Type::Histogram).histograms[std::move(labels)];
+    if (not metric)
+      metric = std::make_unique<Histogram>(std::move(bounds));
+    return *metric;
+  }
+
+  LatencyHistogram&
+  Registry::GetLatency(std::string_view name, std::string_view help, Labels labels)
+  {
+    std::unique_lock lock{m_Access};
+    auto& metric = GetFamily(name, help, Type::Summary).latencies[std::move(labels)];
+    if (not metric)
+      metric = std::make_unique<LatencyHistogram>();
+    return *metric;
+  }
+
+  Counter&
+  Drops(std::string_view reason)
+  {
+    return Registry::Global().GetCounter(
+        "lokinet_drops", "packets or messages dropped", {{"reason", std::string{reason}}});
+  }
+
+  /// write label values and help text escaped the way openmetrics wants
+  static void
+  WriteEscaped(std::ostream& out, std::string_view str)
+  {
+    for (const auto ch : str)
+    {
+      if (ch == '\\')
+        out << "\\\\";
+      else if (ch == '"')
+        out << "\\\"";
+      else if (ch == '\n')
+        out << "\\n";
+      else
+        out << ch;
+    }
+  }
+
+  /// the quantiles latency histograms export and report over rpc
+  static constexpr std::pair<const char*, double> Quantiles[] = {
+      {"0.5", 0.5}, {"0.9", 0.9}, {"0.99", 0.99}, {"0.999", 0.999}};
+
+  /// extra is the name of one more label after labels, such as le or quantile
+  static void
+  WriteLabels(
+      std::ostream& out,
+      const Labels& labels,
+      const char* extra = nullptr,
+      const char* extraValue = nullptr)
+  {
+    if (labels.empty() and extra == nullptr)
+      return;
+    out << '{';
+    bool first = true;
+    for (const auto& [key, val] : labels)
+    {
+      if (not first)
+        out << ',';
+      first = false;
+      out << key << "=\"";
+      WriteEscaped(out, val);
+      out << '"';
+    }
+    if (extra)
+      out << (first ? "" : ",") << extra << "=\"" << extraValue << '"';
+    out << '}';
+  }
+
+  std::string
+  Registry::ExportOpenMetrics() const
+  {
+    std::ostringstream out;
+    out.precision(17);
+    std::unique_lock lock{m_Access};
+    for (const auto& [name, family] : m_Families)
+    {
+      static constexpr const char* TypeNames[] = {"counter", "gauge", "histogram", "summary"};
+      out << "# TYPE " << name << ' ' << TypeNames[static_cast<int>(family.type)] << '\n';
+      out << "# HELP " << name << ' ';
+      WriteEscaped(out, family.help);
+      out << '\n';
+      for (const auto& [labels, counter] : family.counters)
+      {
+        out << name << "_total";
+        WriteLabels(out, labels);
+        out << ' ' << counter->Value() << '\n';
+      }
+      for (const auto& [labels, gauge] : family.gauges)
+      {
+        out << name;
+        WriteLabels(out, labels);
+        out << ' ' << gauge->Value() << '\n';
+      }
+      for (const auto& [labels, histogram] : family.histograms)
+      {
+        const auto snap = histogram->Read();
+        for (size_t idx = 0; idx < snap.buckets.size(); ++idx)
+        {
+          std::ostringstream le;
+          le.precision(17);
+          if (idx < snap.bounds.size())
+            le << snap.bounds[idx];
+          else
+            le << "+Inf";
+          out << name << "_bucket";
+          WriteLabels(out, labels, "le", le.str().c_str());
+          out << ' ' << snap.buckets[idx] << '\n';
+        }
+        out << name << "_sum";
+        WriteLabels(out, labels);
+        out << ' ' << snap.sum << '\n';
+        out << name << "_count";
+        WriteLabels(out, labels);
+        out << ' ' << snap.count << '\n';
+      }
+      for (const auto& [labels, latency] : family.latencies)
+      {
+        const auto snap = latency->Read();
+        for (const auto& [quantile, q] : Quantiles)
+        {
+          out << name;
+          WriteLabels(out, labels, "quantile", quantile);
+          out << ' ' << std::chrono::duration<double>(snap.Percentile(q)).count() << '\n';
+        }
+        out << name << "_sum";
+        WriteLabels(out, labels);
+        out << ' ' << snap.sumMicros / 1e6 << '\n';
+        out << name << "_count";
+        WriteLabels(out, labels);
+        out << ' ' << snap.count << '\n';
+      }
+    }
+    out << "# EOF\n";
+    return out.str();
+  }
+
+  util::StatusObject
+  Registry::ExtractLatencies() const
+  {
+    const auto millis = [](auto dlt) {
+      return std::chrono::duration<double, std::milli>(dlt).count();
+    };
+    util::StatusObject obj;
+    std::unique_lock lock{m_Access};
+    for (const auto& [name, family] : m_Families)
+    {
+      if (family.type != Type::Summary)
+        continue;
+      std::vector<util::StatusObject> series;
+      for (const auto& [labels, latency] : family.latencies)
+      {
+        const auto snap = latency->Read();
+        util::StatusObject labelsObj = util::StatusObject::object();
+        for (const auto& [key, val] : labels)
+          labelsObj[key] = val;
+        series.push_back(util::StatusObject{
+            {"labels", labelsObj},
+            {"count", snap.count},
+            {"p50", millis(snap.Percentile(0.5))},
+            {"p90", millis(snap.Percentile(0.9))},
+            {"p99", millis(snap.Percentile(0.99))},
+            {"p999", millis(snap.Percentile(0.999))},
+            {"max", millis(std::chrono::microseconds{snap.maxMicros})}});
+      }
+      obj[name] = series;
+    }
+    return obj;
+  }
+}  // namespace llarp::metrics
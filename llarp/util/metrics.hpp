@@ -0,0 +1,238 @@
+#pragma once
+
+#include <llarp/util/status.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace llarp::metrics
+{
+  /// label name and value pairs that tell apart the series of one metric family
+  using Labels = std::vector<std::pair<std::string, std::string>>;
+
+  /// number of per thread slots each counter and histogram is split over. updates from different
+  /// threads land on different cache lines, reads add up every slot.
+  constexpr size_t NumShards = 16;
+
+  /// the slot the calling thread updates
+  size_t
+  ThisShard();
+
+  /// a monotonically increasing count, e.g. packets sent
+  class Counter
+  {
+   public:
+    void
+    Add(uint64_t n = 1)
+    {
+      m_Shards[ThisShard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t
+    Value() const;
+
+   private:
+    struct alignas(64) Shard
+    {
+      std::atomic<uint64_t> value{0};
+    };
+    std::array<Shard, NumShards> m_Shards;
+  };
+
+  /// a value that goes up and down, e.g. a queue depth
+  class Gauge
+  {
+   public:
+    void
+    Set(int64_t val)
+    {
+      m_Value.store(val, std::memory_order_relaxed);
+    }
+
+    void
+    Add(int64_t n)
+    {
+      m_Value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    int64_t
+    Value() const
+    {
+      return m_Value.load(std::memory_order_relaxed);
+    }
+
+   private:
+    alignas(64) std::atomic<int64_t> m_Value{0};
+  };
+
+  /// counts observations into buckets with fixed upper bounds, e.g. path build times in seconds
+  class Histogram
+  {
+   public:
+    /// bounds must be sorted ascending, an implicit +Inf bucket follows the last one
+    explicit Histogram(std::vector<double> bounds);
+
+    void
+    Observe(double val);
+
+    struct Snapshot
+    {
+      std::vector<double> bounds;
+      /// cumulative counts, one per bound and a last one for +Inf that equals count
+      std::vector<uint64_t> buckets;
+      double sum = 0;
+      uint64_t count = 0;
+    };
+
+    Snapshot
+    Read() const;
+
+   private:
+    struct alignas(64) Shard
+    {
+      std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+      /// bits of the double sum of this shard's observations
+      std::atomic<uint64_t> sum{0};
+    };
+    const std::vector<double> m_Bounds;
+    std::array<Shard, NumShards> m_Shards;
+  };
+
+  /// records durations into log-linear buckets of microseconds (16 per power of two, so any
+  /// percentile is off by at most 1/16) covering up to about 19 hours in fixed memory. unlike
+  /// Histogram it needs no bounds picked up front, which suits latencies we want percentiles of.
+  class LatencyHistogram
+  {
+   public:
+    static constexpr unsigned SubBucketBits = 4;
+    static constexpr uint64_t SubBuckets = 1 << SubBucketBits;
+    /// values at or above 2^MaxBits microseconds land in the last bucket
+    static constexpr unsigned MaxBits = 36;
+    static constexpr size_t NumBuckets = (MaxBits - SubBucketBits + 1) * SubBuckets;
+
+    LatencyHistogram();
+
+    void
+    RecordMicros(uint64_t usec);
+
+    template <typename Rep, typename Period>
+    void
+    Record(std::chrono::duration<Rep, Period> dlt)
+    {
+      const auto usec = std::chrono::duration_cast<std::chrono::microseconds>(dlt).count();
+      RecordMicros(usec > 0 ? usec : 0);
+    }
+
+    struct Snapshot
+    {
+      std::array<uint64_t, NumBuckets> buckets{};
+      uint64_t count = 0;
+      uint64_t sumMicros = 0;
+      uint64_t maxMicros = 0;
+
+      /// the value at or below which fraction q of the recorded values lie, 0 when empty
+      std::chrono::microseconds
+      Percentile(double q) const;
+    };
+
+    Snapshot
+    Read() const;
+
+    /// the bucket usec falls in
+    static size_t
+    BucketFor(uint64_t usec);
+
+    /// the largest value that falls in bucket idx
+    static uint64_t
+    BucketMax(size_t idx);
+
+   private:
+    std::unique_ptr<std::atomic<uint64_t>[]> m_Buckets;
+    std::atomic<uint64_t> m_Sum{0};
+    std::atomic<uint64_t> m_Max{0};
+  };
+
+  /// bucket bounds growing by factor from start, count of them
+  std::vector<double>
+  ExponentialBuckets(double start, double factor, size_t count);
+
+  /// holds every metric of a process. getting a metric takes a lock and is meant to be done once
+  /// per call site; updating one is lock free. metrics live as long as the registry, so keep the
+  /// returned reference.
+  class Registry
+  {
+   public:
+    /// the registry lokinet reports its own metrics to
+    static Registry&
+    Global();
+
+    /// get the counter called name with labels, making it if it does not exist yet. name should
+    /// not end in _total, it is added on export.
+    Counter&
+    GetCounter(std::string_view name, std::string_view help, Labels labels = {});
+
+    Gauge&
+    GetGauge(std::string_view name, std::string_view help, Labels labels = {});
+
+    /// bounds are only used when the histogram is made
+    Histogram&
+    GetHistogram(
+        std::string_view name,
+        std::string_view help,
+        std::vector<double> bounds,
+        Labels labels = {});
+
+    /// get the latency histogram called name with labels, making it if it does not exist yet.
+    /// it exports as an openmetrics summary in seconds.
+    LatencyHistogram&
+    GetLatency(std::string_view name, std::string_view help, Labels labels = {});
+
+    /// every metric in the openmetrics text exposition format
+    std::string
+    ExportOpenMetrics() const;
+
+    /// count, percentiles and max in milliseconds of every latency histogram, for rpc
+    util::StatusObject
+    ExtractLatencies() const;
+
+   private:
+    enum class Type
+    {
+      Counter,
+      Gauge,
+      Histogram,
+      Summary,
+    };
+
+    struct Family
+    {
+      Type type;
+      std::string help;
+      std::map<Labels, std::unique_ptr<Counter>> counters;
+      std::map<Labels, std::unique_ptr<Gauge>> gauges;
+      std::map<Labels, std::unique_ptr<Histogram>> histograms;
+      std::map<Labels, std::unique_ptr<LatencyHistogram>> latencies;
+    };
+
+    /// get or make the family called name, throws if it exists with a different type
+    Family&
+    GetFamily(std::string_view name, std::string_view help, Type type);
+
+    mutable std::mutex m_Access;
+    std::map<std::string, Family, std::less<>> m_Families;
+  };
+
+  /// the global counter of packets or messages dropped for reason, shared by every place that
+  /// drops something so they export as one family
+  Counter&
+  Drops(std::string_view reason);
+}  // namespace llarp::metrics
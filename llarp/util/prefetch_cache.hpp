@@ -0,0 +1,132 @@
+#pragma once
+
+#include "time.hpp"
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace llarp::util
+{
+  /// a cache of things we resolved that keeps serving a value until it expires while a refresh
+  /// for it runs in the background. values used recently are handed out for refreshing once they
+  /// are due so whoever uses them next does not have to wait on a lookup.
+  template <typename Key_t, typename Value_t, typename Hash_t = std::hash<Key_t>>
+  struct PrefetchCache
+  {
+    /// maxEntries: how many values we keep, the least recently used goes when full
+    /// hotWindow: a value used within this long is refreshed when due
+    /// retryInterval: how long a value handed out for refreshing waits before it is due again
+    PrefetchCache(size_t maxEntries, llarp_time_t hotWindow, llarp_time_t retryInterval)
+        : m_MaxEntries(maxEntries), m_HotWindow(hotWindow), m_RetryInterval(retryInterval)
+    {}
+
+    /// store a value we resolved, it is served until expiresAt and refreshed from refreshAt on
+    void
+    Put(Key_t key, Value_t value, llarp_time_t refreshAt, llarp_time_t expiresAt, llarp_time_t now)
+    {
+      auto itr = m_Values.find(key);
+      if (itr == m_Values.end())
+      {
+        if (m_Values.size() >= m_MaxEntries)
+        {
+          m_Values.erase(std::min_element(
+              m_Values.begin(), m_Values.end(), [](const auto& a, const auto& b) {
+                return a.second.lastUsed < b.second.lastUsed;
+              }));
+        }
+        // we resolved it because something wanted it
+        itr = m_Values.emplace(std::move(key), Entry{std::move(value), now}).first;
+      }
+      else
+        itr->second.value = std::move(value);
+      itr->second.refreshAt = refreshAt;
+      itr->second.expiresAt = expiresAt;
+    }
+
+    /// get an unexpired value by key and count it as used
+    std::optional<Value_t>
+    Get(const Key_t& key, llarp_time_t now)
+    {
+      auto itr = m_Values.find(key);
+      if (itr == m_Values.end() or now >= itr->second.expiresAt)
+        return std::nullopt;
+      itr->second.lastUsed = now;
+      return itr->second.value;
+    }
+
+    /// count a value as used without getting it, for keeping what a live session uses hot
+    void
+    Touch(const Key_t& key, llarp_time_t now)
+    {
+      if (auto itr = m_Values.find(key); itr != m_Values.end())
+        itr->second.lastUsed = now;
+    }
+
+    /// get an unexpired value by key without counting it as used
+    const Value_t*
+    Peek(const Key_t& key, llarp_time_t now) const
+    {
+      auto itr = m_Values.find(key);
+      if (itr == m_Values.end() or now >= itr->second.expiresAt)
+        return nullptr;
+      return &itr->second.value;
+    }
+
+    /// the keys of hot values that are due a refresh, they are not due again until the retry
+    /// interval passes or a new value is put for them
+    std::vector<Key_t>
+    TakeDue(llarp_time_t now)
+    {
+      std::vector<Key_t> due;
+      for (auto& [key, entry] : m_Values)
+      {
+        if (now < entry.refreshAt or now >= entry.expiresAt or now - entry.lastUsed > m_HotWindow)
+          continue;
+        entry.refreshAt = now + m_RetryInterval;
+        due.push_back(key);
+      }
+      return due;
+    }
+
+    void
+    Remove(const Key_t& key)
+    {
+      m_Values.erase(key);
+    }
+
+    /// drop expired values
+    void
+    Decay(llarp_time_t now)
+    {
+      for (auto itr = m_Values.begin(); itr != m_Values.end();)
+      {
+        if (now >= itr->second.expiresAt)
+          itr = m_Values.erase(itr);
+        else
+          ++itr;
+      }
+    }
+
+    size_t
+    Size() const
+    {
+      return m_Values.size();
+    }
+
+   private:
+    struct Entry
+    {
+      Value_t value;
+      llarp_time_t lastUsed;
+      llarp_time_t refreshAt = 0s;
+      llarp_time_t expiresAt = 0s;
+    };
+
+    const size_t m_MaxEntries;
+    const llarp_time_t m_HotWindow;
+    const llarp_time_t m_RetryInterval;
+    std::unordered_map<Key_t, Entry, Hash_t> m_Values;
+  };
+}  // namespace llarp::util
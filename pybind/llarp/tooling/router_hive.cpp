@@ -17,6 +17,7 @@ namespace tooling
 
     py::class_<RouterHive, RouterHive_ptr>(mod, "RouterHive")
         .def(py::init<>())
+        .def("UseSimulatedNetwork", &RouterHive::UseSimulatedNetwork, py::arg("seed") = 0)
         .def("AddRelay", &RouterHive::AddRelay)
         .def("AddClient", &RouterHive::AddClient)
         .def("StartRelays", &RouterHive::StartRelays)
@@ -0,0 +1,114 @@
+#include <crypto/crypto_libsodium.hpp>
+#include <messages/relay.hpp>
+#include <messages/relay_commit.hpp>
+#include <router_contact.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+using namespace llarp;
+
+namespace
+{
+  /// the bencoded form of msg, empty if it did not fit in sz bytes
+  template <typename Msg_t>
+  std::vector<byte_t>
+  Encode(const Msg_t& msg, size_t sz)
+  {
+    std::vector<byte_t> storage(sz);
+    llarp_buffer_t buf{storage};
+    if (not msg.BEncode(&buf))
+      return {};
+    storage.resize(buf.cur - buf.base);
+    return storage;
+  }
+}  // namespace
+
+TEST_CASE("RouterContact bencode", "[bench][bencode]")
+{
+  sodium::CryptoLibSodium crypto;
+  CryptoManager manager{&crypto};
+
+  SecretKey identity, encryption;
+  crypto.identity_keygen(identity);
+  crypto.encryption_keygen(encryption);
+  RouterContact rc;
+  rc.pubkey = identity.toPublic();
+  rc.enckey = encryption.toPublic();
+  auto& addr = rc.addrs.emplace_back();
+  addr.rank = 1;
+  addr.dialect = "iwp";
+  addr.pubkey = encryption.toPublic();
+  addr.port = 1090;
+  REQUIRE(rc.Sign(identity));
+
+  std::vector<byte_t> storage(MAX_RC_SIZE);
+  const auto encoded = Encode(rc, storage.size());
+  REQUIRE(not encoded.empty());
+
+  BENCHMARK("RouterContact encode")
+  {
+    llarp_buffer_t out{storage};
+    return rc.BEncode(&out);
+  };
+  BENCHMARK("RouterContact decode")
+  {
+    RouterContact decoded;
+    llarp_buffer_t in{encoded};
+    return decoded.BDecode(&in);
+  };
+}
+
+TEST_CASE("LR_CommitMessage bencode", "[bench][bencode]")
+{
+  sodium::CryptoLibSodium crypto;
+  CryptoManager manager{&crypto};
+
+  LR_CommitMessage msg;
+  for (auto& frame : msg.frames)
+    frame.Randomize();
+  std::vector<byte_t> storage(MAX_LINK_MSG_SIZE);
+  const auto encoded = Encode(msg, storage.size());
+  REQUIRE(not encoded.empty());
+
+  BENCHMARK("LR_CommitMessage encode")
+  {
+    llarp_buffer_t out{storage};
+    return msg.BEncode(&out);
+  };
+  BENCHMARK("LR_CommitMessage decode")
+  {
+    LR_CommitMessage decoded;
+    llarp_buffer_t in{encoded};
+    return decoded.BDecode(&in);
+  };
+}
+
+TEST_CASE("RelayUpstreamMessage bencode", "[bench][bencode]")
+{
+  sodium::CryptoLibSodium crypto;
+  CryptoManager manager{&crypto};
+
+  RelayUpstreamMessage msg;
+  msg.pathid.Randomize();
+  msg.Y.Randomize();
+  std::vector<byte_t> payload(1024);
+  msg.X = llarp_buffer_t{payload};
+  msg.X.Randomize();
+  std::vector<byte_t> storage(MAX_LINK_MSG_SIZE);
+  const auto encoded = Encode(msg, storage.size());
+  REQUIRE(not encoded.empty());
+
+  BENCHMARK("RelayUpstreamMessage encode 1KB")
+  {
+    llarp_buffer_t out{storage};
+    return msg.BEncode(&out);
+  };
+  BENCHMARK("RelayUpstreamMessage decode 1KB")
+  {
+    RelayUpstreamMessage decoded;
+    llarp_buffer_t in{encoded};
+    return decoded.BDecode(&in);
+  };
+}
@@ -0,0 +1,185 @@
+#include <crypto/crypto_libsodium.hpp>
+#include <crypto/onion.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace llarp;
+using namespace std::literals;
+
+namespace
+{
+  /// run f, which handles cells relay cells, for a while and report how many cells a second
+  /// that comes to
+  template <typename Func_t>
+  void
+  ReportCellRate(const std::string& name, size_t cells, Func_t&& f)
+  {
+    using Clock_t = std::chrono::steady_clock;
+    size_t runs = 0;
+    const auto started = Clock_t::now();
+    std::chrono::duration<double> elapsed{0};
+    do
+    {
+      f();
+      ++runs;
+      elapsed = Clock_t::now() - started;
+    } while (elapsed < 500ms);
+    WARN(name << ": " << static_cast<uint64_t>(runs * cells / elapsed.count()) << " cells/s");
+  }
+}  // namespace
+
+TEST_CASE("CryptoLibSodium primitives", "[bench][crypto]")
+{
+  sodium::CryptoLibSodium crypto;
+  CryptoManager manager{&crypto};
+
+  std::vector<byte_t> data(1024);
+  crypto.randbytes(data.data(), data.size());
+  SharedSecret key;
+  key.Randomize();
+  TunnelNonce nonce;
+  nonce.Randomize();
+  ShortHash hash;
+
+  SecretKey identity;
+  crypto.identity_keygen(identity);
+  const PubKey identityPub = identity.toPublic();
+  Signature sig;
+  REQUIRE(crypto.sign(sig, identity, llarp_buffer_t{data}));
+
+  SecretKey alice, bob;
+  crypto.encryption_keygen(alice);
+  crypto.encryption_keygen(bob);
+  const PubKey alicePub = alice.toPublic();
+  const PubKey bobPub = bob.toPublic();
+  SharedSecret shared;
+
+  BENCHMARK("xchacha20 1KB")
+  {
+    return crypto.xchacha20(llarp_buffer_t{data}, key, nonce);
+  };
+  BENCHMARK("hmac 1KB")
+  {
+    return crypto.hmac(hash.data(), llarp_buffer_t{data}, key);
+  };
+  BENCHMARK("sign 1KB")
+  {
+    return crypto.sign(sig, identity, llarp_buffer_t{data});
+  };
+  BENCHMARK("verify 1KB")
+  {
+    return crypto.verify(identityPub, llarp_buffer_t{data}, sig);
+  };
+  BENCHMARK("dh client")
+  {
+    return crypto.dh_client(shared, bobPub, alice, nonce);
+  };
+  BENCHMARK("dh server")
+  {
+    return crypto.dh_server(shared, alicePub, bob, nonce);
+  };
+}
+
+TEST_CASE("Onion kernels", "[bench][crypto][onion]")
+{
+  sodium::CryptoLibSodium crypto;
+  CryptoManager manager{&crypto};
+  std::vector<SharedSecret> keys(4);
+  std::vector<onion::Layer> layers(4);
+  for (size_t idx = 0; idx < keys.size(); ++idx)
+  {
+    keys[idx].Randomize();
+    layers[idx] = {&keys[idx], {}};
+    layers[idx].nonce.Randomize();
+  }
+  std::vector<byte_t> cell(1024);
+
+  const auto layered = [&] {
+    for (const auto& layer : layers)
+      crypto.xchacha20(llarp_buffer_t{cell}, *layer.key, layer.nonce);
+    return cell[0];
+  };
+  BENCHMARK("layered xchacha20 4 hops 1KB")
+  {
+    return layered();
+  };
+  ReportCellRate("layered xchacha20 4 hops 1KB", 1, layered);
+  for (const auto kernel : {simd::Kernel::Scalar, simd::Kernel::AVX2, simd::Kernel::AVX512})
+  {
+    if (not simd::Supported(kernel))
+      continue;
+    const auto name = "onion kernel " + std::to_string(static_cast<int>(kernel)) + " 4 hops 1KB";
+    const auto fused = [&] {
+      onion::XChaCha20(llarp_buffer_t{cell}, layers.data(), layers.size(), kernel);
+      return cell[0];
+    };
+    BENCHMARK(name)
+    {
+      return fused();
+    };
+    ReportCellRate(name, 1, fused);
+  }
+}
+
+TEST_CASE("Batched relay cell crypto", "[bench][crypto][batch]")
+{
+  sodium::CryptoLibSodium crypto;
+  CryptoManager manager{&crypto};
+  constexpr size_t NumCells = 64;
+  std::vector<std::vector<byte_t>> cells(NumCells, std::vector<byte_t>(1024));
+  std::vector<SharedSecret> keys(NumCells);
+  std::vector<XChaCha20Job> ciphers;
+  std::vector<ShortHash> hashes(NumCells);
+  std::vector<HMACJob> macs;
+  for (size_t idx = 0; idx < NumCells; ++idx)
+  {
+    keys[idx].Randomize();
+    ciphers.push_back({cells[idx].data(), cells[idx].size(), &keys[idx], {}});
+    ciphers.back().nonce.Randomize();
+    macs.push_back({hashes[idx].data(), cells[idx].data(), cells[idx].size(), &keys[idx]});
+  }
+
+  const auto cipherOneAtATime = [&] {
+    for (const auto& job : ciphers)
+      crypto.xchacha20(llarp_buffer_t{job.buf, job.sz}, *job.key, job.nonce);
+    return cells[0][0];
+  };
+  const auto cipherBatched = [&] {
+    crypto.xchacha20_batch(ciphers.data(), ciphers.size());
+    return cells[0][0];
+  };
+  const auto hmacOneAtATime = [&] {
+    for (const auto& job : macs)
+      crypto.hmac(job.result, llarp_buffer_t{job.buf, job.sz}, *job.key);
+    return hashes[0][0];
+  };
+  const auto hmacBatched = [&] {
+    crypto.hmac_batch(macs.data(), macs.size());
+    return hashes[0][0];
+  };
+
+  BENCHMARK("xchacha20 64 cells one at a time")
+  {
+    return cipherOneAtATime();
+  };
+  BENCHMARK("xchacha20 64 cells batched")
+  {
+    return cipherBatched();
+  };
+  BENCHMARK("hmac 64 cells one at a time")
+  {
+    return hmacOneAtATime();
+  };
+  BENCHMARK("hmac 64 cells batched")
+  {
+    return hmacBatched();
+  };
+  ReportCellRate("xchacha20 1KB cells one at a time", NumCells, cipherOneAtATime);
+  ReportCellRate("xchacha20 1KB cells batched", NumCells, cipherBatched);
+  ReportCellRate("hmac 1KB cells one at a time", NumCells, hmacOneAtATime);
+  ReportCellRate("hmac 1KB cells batched", NumCells, hmacBatched);
+}
@@ -0,0 +1,139 @@
+#include <crypto/crypto.hpp>
+#include <crypto/crypto_libsodium.hpp>
+#include <ev/ev_sim.hpp>
+#include <iwp/iwp.hpp>
+#include <messages/discard.hpp>
+#include <messages/link_message_parser.hpp>
+#include <net/net_if.hpp>
+#include <router_contact.hpp>
+#include <util/meta/memfn.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <memory>
+#include <string_view>
+
+namespace
+{
+  /// one end of an iwp link on a simulated network
+  struct LinkEnd
+  {
+    llarp::RouterContact rc;
+    llarp::IpAddress localAddr;
+    llarp::LinkLayer_ptr link;
+    std::shared_ptr<llarp::KeyManager> keyManager;
+    llarp::LinkMessageParser m_Parser;
+    llarp::EventLoop_ptr m_Loop;
+    llarp::ILinkSession* session = nullptr;
+
+    LinkEnd(std::string_view addr, llarp::EventLoop_ptr loop)
+        : localAddr{std::move(addr)}
+        , keyManager{std::make_shared<llarp::KeyManager>()}
+        , m_Parser{nullptr}
+        , m_Loop{std::move(loop)}
+    {
+      llarp::CryptoManager::instance()->identity_keygen(keyManager->identityKey);
+      llarp::CryptoManager::instance()->encryption_keygen(keyManager->encryptionKey);
+      llarp::CryptoManager::instance()->encryption_keygen(keyManager->transportKey);
+      rc.pubkey = keyManager->identityKey.toPublic();
+      rc.enckey = keyManager->encryptionKey.toPublic();
+    }
+
+    bool
+    HandleMessage(llarp::ILinkSession* from, const llarp_buffer_t& buf)
+    {
+      return m_Parser.ProcessFrom(from, buf);
+    }
+
+    void
+    Init(bool inbound)
+    {
+      auto args = std::make_tuple(
+          keyManager,
+          m_Loop,
+          [&]() -> const llarp::RouterContact& { return rc; },
+          llarp::util::memFn(&LinkEnd::HandleMessage, this),
+          [&](llarp::Signature& sig, const llarp_buffer_t& buf) {
+            return llarp::CryptoManager::instance()->sign(sig, keyManager->identityKey, buf);
+          },
+          nullptr,
+          [this](llarp::ILinkSession* s, bool) {
+            session = s;
+            return true;
+          },
+          [](llarp::RouterContact, llarp::RouterContact) { return true; },
+          [](llarp::ILinkSession*) {},
+          [](llarp::RouterID) {},
+          []() {},
+          [l = m_Loop](llarp::Work_t work) { l->call_soon(work); });
+      link = std::apply(inbound ? llarp::iwp::NewInboundLink : llarp::iwp::NewOutboundLink, args);
+      REQUIRE(link->Configure(
+          m_Loop, llarp::net::LoopbackInterfaceName(), AF_INET, *localAddr.getPort()));
+      if (inbound)
+      {
+        rc.addrs.emplace_back();
+        REQUIRE(link->GetOurAddressInfo(rc.addrs.back()));
+      }
+      REQUIRE(rc.Sign(keyManager->identityKey));
+    }
+  };
+}  // namespace
+
+TEST_CASE("IWP loopback throughput", "[bench][macro][iwp]")
+{
+  llarp::LogSilencer shutup;
+  auto oldBlockBogons = llarp::RouterContact::BlockBogons;
+  llarp::RouterContact::BlockBogons = false;
+
+  llarp::sodium::CryptoLibSodium crypto{};
+  llarp::CryptoManager manager{&crypto};
+
+  // a lossless link with no delay so only the cost of iwp itself is measured
+  auto net = std::make_shared<llarp::sim::Network>(1);
+  net->SetDefaultLink({0ms, 0ms, 0.0, 0, 1s});
+  auto aliceLoop = net->MakeLoop();
+  auto bobLoop = net->MakeLoop();
+
+  LinkEnd alice{"127.0.0.1:3001", aliceLoop};
+  LinkEnd bob{"127.0.0.1:3002", bobLoop};
+  alice.Init(false);
+  bob.Init(true);
+  REQUIRE(alice.link->Start());
+  REQUIRE(bob.link->Start());
+
+  aliceLoop->call_soon([&] { REQUIRE(alice.link->TryEstablishTo(bob.rc)); });
+  for (int step = 0; step < 100 and not(alice.session and bob.session); ++step)
+    net->RunFor(10ms);
+  REQUIRE(alice.session);
+  REQUIRE(bob.session);
+
+  constexpr size_t NumMessages = 256;
+  std::vector<byte_t> msgBuff(1024);
+  {
+    llarp::DiscardMessage msg;
+    llarp_buffer_t buf{msgBuff};
+    crypto.randomize(buf);
+    REQUIRE(msg.BEncode(&buf));
+  }
+
+  BENCHMARK("IWP send 256 x 1KB")
+  {
+    // completions can outlive this iteration, e.g. ones that time out later on
+    auto acked = std::make_shared<size_t>(0);
+    aliceLoop->call_soon([&, acked] {
+      for (size_t idx = 0; idx < NumMessages; ++idx)
+        alice.session->SendMessageBuffer(msgBuff, [acked](auto status) {
+          if (status == llarp::ILinkSession::DeliveryStatus::eDeliverySuccess)
+            ++*acked;
+        });
+    });
+    for (int step = 0; step < 10000 and *acked < NumMessages; ++step)
+      net->RunFor(1ms);
+    return *acked;
+  };
+
+  alice.link->Stop();
+  bob.link->Stop();
+  net->RunFor(1s);
+  llarp::RouterContact::BlockBogons = oldBlockBogons;
+}
@@ -0,0 +1,136 @@
+#include <net/ip_range_map.hpp>
+#include <net/traffic_policy.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace llarp;
+
+namespace
+{
+  /// the linear scan IPRangeMap used to do, to compare lookup speed with
+  struct LinearRangeMap
+  {
+    std::vector<std::pair<IPRange, size_t>> entries;
+
+    size_t
+    CountMatches(const huint128_t& ip) const
+    {
+      size_t found = 0;
+      for (const auto& entry : entries)
+      {
+        if (entry.first.Contains(ip))
+          ++found;
+      }
+      return found;
+    }
+  };
+
+  huint128_t
+  RandomIP(std::mt19937_64& rng)
+  {
+    huint128_t ip{0};
+    if (rng() % 2)
+    {
+      // ipv4 mapped
+      ip.h.upper = 0;
+      ip.h.lower = 0x0000'ffff'0000'0000UL | (rng() & 0xffff'ffffUL);
+    }
+    else
+    {
+      ip.h.upper = rng();
+      ip.h.lower = rng();
+    }
+    return ip;
+  }
+
+  IPRange
+  RandomRange(std::mt19937_64& rng)
+  {
+    auto ip = RandomIP(rng);
+    const bool v4 = ip.h.upper == 0 and (ip.h.lower >> 32) == 0xffff;
+    const auto bits = v4 ? 96 + 8 + rng() % 25 : 16 + rng() % 113;
+    const auto mask = netmask_ipv6_bits(bits);
+    return IPRange{ip & mask, mask};
+  }
+
+  net::IPPacket
+  MakePacket(net::IPProtocol proto, byte_t a, byte_t b, byte_t c, byte_t d, uint16_t port)
+  {
+    std::array<byte_t, 8> data{};
+    auto pkt = net::IPPacket::UDP(
+        nuint32_t{0},
+        nuint16_t{0},
+        ToNet(ipaddr_ipv4_bits(a, b, c, d)),
+        ToNet(huint16_t{port}),
+        llarp_buffer_t{data});
+    pkt.Header()->protocol = static_cast<uint8_t>(proto);
+    return pkt;
+  }
+}  // namespace
+
+TEST_CASE("Traffic policy", "[bench][net]")
+{
+  std::mt19937 rng{42};
+  net::TrafficPolicy policy;
+  for (uint16_t port = 1; port <= 200; ++port)
+    policy.protocols.emplace("tcp/" + std::to_string(port * 7));
+  for (int n = 0; n < 200; ++n)
+    policy.ranges.emplace(IPRange::FromIPv4(rng() % 224, rng() % 256, 0, 0, 16));
+  const net::CompiledTrafficPolicy compiled{policy};
+
+  std::vector<net::IPPacket> packets;
+  for (int n = 0; n < 64; ++n)
+  {
+    packets.emplace_back(MakePacket(
+        n % 2 ? net::IPProtocol::TCP : net::IPProtocol::UDP,
+        rng() % 224,
+        rng() % 256,
+        rng() % 256,
+        rng() % 256,
+        rng() % 2000));
+  }
+
+  size_t idx = 0;
+  BENCHMARK("TrafficPolicy::AllowsTraffic")
+  {
+    return policy.AllowsTraffic(packets[idx++ % packets.size()]);
+  };
+  BENCHMARK("CompiledTrafficPolicy::AllowsTraffic")
+  {
+    return compiled.AllowsTraffic(packets[idx++ % packets.size()]);
+  };
+}
+
+TEST_CASE("IPRangeMap lookup", "[bench][net]")
+{
+  for (const size_t numRanges : {size_t{10}, size_t{1'000}, size_t{100'000}})
+  {
+    std::mt19937_64 rng{numRanges};
+    net::IPRangeMap<size_t> map;
+    LinearRangeMap linear;
+    for (size_t n = 0; n < numRanges; ++n)
+    {
+      const auto range = RandomRange(rng);
+      map.Insert(range, n);
+      linear.entries.emplace_back(range, n);
+    }
+    std::vector<huint128_t> ips;
+    for (size_t n = 0; n < 256; ++n)
+      ips.push_back(linear.entries[n % numRanges].first.addr + huint128_t{n});
+
+    size_t idx = 0;
+    const auto suffix = " " + std::to_string(numRanges) + " ranges";
+    BENCHMARK("trie" + suffix)
+    {
+      return map.FindLongestMatch(ips[idx++ % ips.size()]);
+    };
+    BENCHMARK("linear" + suffix)
+    {
+      return linear.CountMatches(ips[idx++ % ips.size()]);
+    };
+  }
+}
@@ -0,0 +1,28 @@
+#include <nodedb.hpp>
+#include <router_contact.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+TEST_CASE("NodeDB FindManyClosestTo", "[bench][nodedb]")
+{
+  for (const size_t numRCs : {1000, 10000})
+  {
+    NodeDB nodeDB{fs::current_path(), nullptr};
+    for (size_t idx = 0; idx < numRCs; ++idx)
+    {
+      RouterContact rc;
+      rc.pubkey.Randomize();
+      nodeDB.Put(rc);
+    }
+    REQUIRE(nodeDB.NumLoaded() == numRCs);
+
+    dht::Key_t location;
+    location.Randomize();
+    BENCHMARK("FindManyClosestTo 4 of " + std::to_string(numRCs))
+    {
+      return nodeDB.FindManyClosestTo(location, 4);
+    };
+  }
+}
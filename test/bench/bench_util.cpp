@@ -0,0 +1,66 @@
+#include <router_id.hpp>
+#include <util/decaying_hashset.hpp>
+#include <util/thread/queue.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <thread>
+#include <vector>
+
+using namespace llarp;
+
+TEST_CASE("thread::Queue", "[bench][util]")
+{
+  constexpr size_t NumItems = 1024;
+  thread::Queue<size_t> queue{NumItems};
+
+  BENCHMARK("Queue push then pop 1024 items one thread")
+  {
+    for (size_t idx = 0; idx < NumItems; ++idx)
+      queue.pushBack(idx);
+    size_t sum = 0;
+    for (size_t idx = 0; idx < NumItems; ++idx)
+      sum += queue.popFront();
+    return sum;
+  };
+  BENCHMARK("Queue 1024 items producer to consumer thread")
+  {
+    std::thread producer{[&] {
+      for (size_t idx = 0; idx < NumItems; ++idx)
+        queue.pushBack(idx);
+    }};
+    size_t sum = 0;
+    for (size_t idx = 0; idx < NumItems; ++idx)
+      sum += queue.popFront();
+    producer.join();
+    return sum;
+  };
+}
+
+TEST_CASE("DecayingHashSet", "[bench][util]")
+{
+  constexpr size_t NumItems = 4096;
+  std::vector<RouterID> ids(NumItems);
+  for (auto& id : ids)
+    id.Randomize();
+
+  BENCHMARK("DecayingHashSet insert 4096 then decay half")
+  {
+    util::DecayingHashSet<RouterID> set{10s};
+    for (size_t idx = 0; idx < NumItems; ++idx)
+      set.Insert(ids[idx], idx % 2 ? 11s : 1s);
+    set.Decay(15s);
+    return set.Size();
+  };
+
+  util::DecayingHashSet<RouterID> set{10s};
+  for (size_t idx = 0; idx < NumItems; idx += 2)
+    set.Insert(ids[idx], 1s);
+  BENCHMARK("DecayingHashSet contains 4096 half hits")
+  {
+    size_t hits = 0;
+    for (const auto& id : ids)
+      hits += set.Contains(id);
+    return hits;
+  };
+}
@@ -0,0 +1,65 @@
+#include <crypto/crypto_libsodium.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+using namespace llarp;
+
+namespace
+{
+  const std::vector<size_t> sizes{0, 1, 63, 64, 65, 127, 128, 129, 511, 1024, 1500};
+
+  std::vector<std::vector<byte_t>>
+  RandomMessages(Crypto& crypto, size_t num)
+  {
+    std::vector<std::vector<byte_t>> msgs(num);
+    for (size_t idx = 0; idx < num; ++idx)
+    {
+      msgs[idx].resize(sizes[idx % sizes.size()]);
+      crypto.randbytes(msgs[idx].data(), msgs[idx].size());
+    }
+    return msgs;
+  }
+}  // namespace
+
+TEST_CASE("Batched xchacha20 matches one call per buffer", "[crypto][batch]")
+{
+  sodium::CryptoLibSodium crypto;
+  for (const size_t num : {1, 2, 7, 8, 9, 17, 33})
+  {
+    auto batched = RandomMessages(crypto, num);
+    auto single = batched;
+    std::vector<SharedSecret> keys(num);
+    std::vector<XChaCha20Job> jobs;
+    for (size_t idx = 0; idx < num; ++idx)
+    {
+      keys[idx].Randomize();
+      jobs.push_back({batched[idx].data(), batched[idx].size(), &keys[idx], {}});
+      jobs.back().nonce.Randomize();
+      crypto.xchacha20(llarp_buffer_t{single[idx]}, keys[idx], jobs.back().nonce);
+    }
+    REQUIRE(crypto.xchacha20_batch(jobs.data(), jobs.size()));
+    REQUIRE(batched == single);
+  }
+}
+
+TEST_CASE("Batched hmac matches one call per message", "[crypto][batch]")
+{
+  sodium::CryptoLibSodium crypto;
+  for (const size_t num : {1, 2, 3, 4, 5, 11, 33})
+  {
+    auto msgs = RandomMessages(crypto, num);
+    std::vector<SharedSecret> keys(num);
+    std::vector<ShortHash> batched(num), single(num);
+    std::vector<HMACJob> jobs;
+    for (size_t idx = 0; idx < num; ++idx)
+    {
+      keys[idx].Randomize();
+      jobs.push_back({batched[idx].data(), msgs[idx].data(), msgs[idx].size(), &keys[idx]});
+      crypto.hmac(single[idx].data(), llarp_buffer_t{msgs[idx]}, keys[idx]);
+    }
+    REQUIRE(crypto.hmac_batch(jobs.data(), jobs.size()));
+    REQUIRE(batched == single);
+  }
+}
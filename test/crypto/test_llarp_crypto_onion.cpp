@@ -0,0 +1,69 @@
+#include <crypto/crypto_libsodium.hpp>
+#include <crypto/onion.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+using namespace llarp;
+
+TEST_CASE("Onion kernels match layered xchacha20", "[crypto][onion]")
+{
+  sodium::CryptoLibSodium crypto;
+
+  std::vector<SharedSecret> keys(10);
+  for (auto& key : keys)
+    key.Randomize();
+
+  for (const auto kernel : {simd::Kernel::Scalar, simd::Kernel::AVX2, simd::Kernel::AVX512})
+  {
+    if (not simd::Supported(kernel))
+      continue;
+    for (const size_t numLayers : {1, 2, 4, 8, 10})
+    {
+      for (const size_t sz : {0, 1, 63, 64, 65, 511, 512, 513, 1024, 1500, 4000})
+      {
+        std::vector<byte_t> layered(sz);
+        crypto.randbytes(layered.data(), layered.size());
+        auto fused = layered;
+
+        std::vector<onion::Layer> layers(numLayers);
+        for (size_t idx = 0; idx < numLayers; ++idx)
+        {
+          layers[idx].key = &keys[idx];
+          layers[idx].nonce.Randomize();
+          crypto.xchacha20(llarp_buffer_t{layered}, keys[idx], layers[idx].nonce);
+        }
+        onion::XChaCha20(llarp_buffer_t{fused}, layers.data(), layers.size(), kernel);
+        REQUIRE(fused == layered);
+      }
+    }
+  }
+}
+
+TEST_CASE("xchacha20_onion matches layered xchacha20 with and without simd", "[crypto][onion]")
+{
+  for (const bool forceScalar : {false, true})
+  {
+    if (forceScalar)
+      setenv("AVX2_FORCE_DISABLE", "1", 1);
+    sodium::CryptoLibSodium crypto;
+    unsetenv("AVX2_FORCE_DISABLE");
+
+    std::vector<SharedSecret> keys(4);
+    std::vector<onion::Layer> layers(keys.size());
+    std::vector<byte_t> layered(1500);
+    crypto.randbytes(layered.data(), layered.size());
+    auto onion = layered;
+    for (size_t idx = 0; idx < keys.size(); ++idx)
+    {
+      keys[idx].Randomize();
+      layers[idx].key = &keys[idx];
+      layers[idx].nonce.Randomize();
+      crypto.xchacha20(llarp_buffer_t{layered}, keys[idx], layers[idx].nonce);
+    }
+    REQUIRE(crypto.xchacha20_onion(llarp_buffer_t{onion}, layers.data(), layers.size()));
+    REQUIRE(onion == layered);
+  }
+}
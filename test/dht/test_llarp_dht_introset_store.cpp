@@ -0,0 +1,129 @@
+#include <dht/introset_store.hpp>
+#include <constants/path.hpp>
+#include <util/bencode.hpp>
+#include <catch2/catch.hpp>
+
+#include <fstream>
+#include <iterator>
+
+using namespace std::literals;
+using llarp::dht::IntroSetStore;
+using llarp::dht::Key_t;
+using llarp::service::EncryptedIntroSet;
+
+namespace
+{
+  Key_t
+  MakeKey(uint8_t first)
+  {
+    Key_t k;
+    k.Zero();
+    k[0] = first;
+    return k;
+  }
+
+  EncryptedIntroSet
+  MakeIntroSet(uint8_t first, llarp_time_t signedAt, size_t payload = 100)
+  {
+    EncryptedIntroSet introset;
+    introset.derivedSigningKey.Zero();
+    introset.derivedSigningKey[0] = first;
+    introset.signedAt = signedAt;
+    introset.introsetPayload.resize(payload);
+    return introset;
+  }
+
+  constexpr size_t EntrySize = 100 + IntroSetStore::EntryOverhead;
+}  // namespace
+
+TEST_CASE("introset store keeps the newest copy and expires it", "[dht]")
+{
+  IntroSetStore store{MakeKey(0)};
+  const auto source = MakeKey(0xff);
+  REQUIRE(store.Put(MakeIntroSet(1, 10s), source, 10s));
+  REQUIRE(store.Put(MakeIntroSet(1, 20s), source, 20s));
+  // an older copy is accepted but does not replace what we have
+  REQUIRE(store.Put(MakeIntroSet(1, 15s), source, 21s));
+  REQUIRE(store.Size() == 1);
+  CHECK(store.Bytes() == EntrySize);
+  REQUIRE(store.Get(MakeKey(1)));
+  CHECK(store.Get(MakeKey(1))->signedAt == 20s);
+  CHECK_FALSE(store.Get(MakeKey(2)));
+
+  // the replaced copy's expiry does not take the newer one with it
+  CHECK(store.Expire(10s + llarp::path::default_lifetime) == 0);
+  CHECK(store.Size() == 1);
+  CHECK(store.Expire(20s + llarp::path::default_lifetime) == 1);
+  CHECK(store.Size() == 0);
+  CHECK(store.Bytes() == 0);
+}
+
+TEST_CASE("introset store evicts the entries farthest from us", "[dht]")
+{
+  IntroSetStore store{MakeKey(0), EntrySize * 3};
+  const auto source = MakeKey(0xff);
+  REQUIRE(store.Put(MakeIntroSet(0x10, 1s), source, 1s));
+  REQUIRE(store.Put(MakeIntroSet(0x80, 1s), source, 1s));
+  REQUIRE(store.Put(MakeIntroSet(0x40, 1s), source, 1s));
+  REQUIRE(store.Size() == 3);
+
+  // closer than what we have, the farthest goes
+  REQUIRE(store.Put(MakeIntroSet(0x20, 1s), source, 1s));
+  CHECK(store.Size() == 3);
+  CHECK_FALSE(store.Get(MakeKey(0x80)));
+  CHECK(store.Get(MakeKey(0x40)));
+
+  // farther than everything we have, refused
+  CHECK_FALSE(store.Put(MakeIntroSet(0xf0, 1s), source, 1s));
+  CHECK_FALSE(store.Get(MakeKey(0xf0)));
+  CHECK(store.Size() == 3);
+  CHECK(store.Bytes() <= store.MaxBytes());
+}
+
+TEST_CASE("introset store rate limits each source", "[dht]")
+{
+  IntroSetStore store{MakeKey(0)};
+  const auto flooder = MakeKey(0xfe);
+  const auto other = MakeKey(0xfd);
+  size_t accepted = 0;
+  for (size_t n = 0; n < IntroSetStore::SourceBurst * 2; ++n)
+  {
+    if (store.Put(MakeIntroSet(n + 1, 1s), flooder, 1s))
+      ++accepted;
+  }
+  CHECK(accepted == IntroSetStore::SourceBurst);
+  // someone else is not held back by it
+  CHECK(store.Put(MakeIntroSet(0xf0, 1s), other, 1s));
+  // and the flooder earns tokens back over time
+  CHECK_FALSE(store.Put(MakeIntroSet(0xf1, 1s), flooder, 1s));
+  CHECK(store.Put(MakeIntroSet(0xf1, 1s), flooder, 1s + IntroSetStore::SourceRefill));
+}
+
+TEST_CASE("introset store saves every entry and replaces the old file", "[dht]")
+{
+  const auto fpath = fs::temp_directory_path() / "lokinet-test-introsets.dat";
+  fs::remove(fpath);
+  REQUIRE(IntroSetStore::Save(fpath, {MakeIntroSet(1, 10s)}));
+  const std::vector<EncryptedIntroSet> introsets{
+      MakeIntroSet(1, 20s), MakeIntroSet(2, 30s, 4000), MakeIntroSet(3, 40s)};
+  REQUIRE(IntroSetStore::Save(fpath, introsets));
+  CHECK_FALSE(fs::exists(fs::path{fpath.string() + ".tmp"}));
+
+  std::vector<byte_t> data;
+  {
+    std::ifstream f{fpath.string(), std::ios::binary};
+    REQUIRE(f.is_open());
+    data.assign(std::istreambuf_iterator<char>{f}, std::istreambuf_iterator<char>{});
+  }
+  fs::remove(fpath);
+  llarp_buffer_t buf(data);
+  std::vector<EncryptedIntroSet> loaded;
+  REQUIRE(llarp::BEncodeReadList(loaded, &buf));
+  REQUIRE(loaded.size() == introsets.size());
+  for (size_t idx = 0; idx < loaded.size(); ++idx)
+  {
+    CHECK(loaded[idx].derivedSigningKey == introsets[idx].derivedSigningKey);
+    CHECK(loaded[idx].signedAt == introsets[idx].signedAt);
+    CHECK(loaded[idx].introsetPayload.size() == introsets[idx].introsetPayload.size());
+  }
+}
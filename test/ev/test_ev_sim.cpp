@@ -0,0 +1,166 @@
+#include <ev/ev_sim.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <thread>
+#include <vector>
+
+using namespace llarp;
+
+namespace
+{
+  struct Host
+  {
+    EventLoop_ptr loop;
+    std::shared_ptr<UDPHandle> udp;
+    std::vector<std::pair<llarp_time_t, size_t>> received;
+
+    Host(sim::Network& net, const SockAddr& addr) : loop{net.MakeLoop()}
+    {
+      udp = loop->make_udp([this](UDPHandle&, SockAddr, OwnedBuffer buf) {
+        received.emplace_back(loop->time_now(), buf.sz);
+      });
+      REQUIRE(udp->listen(addr));
+    }
+  };
+
+  void
+  SendMany(Host& from, const SockAddr& to, size_t num, size_t sz)
+  {
+    std::vector<byte_t> data(sz);
+    for (size_t idx = 0; idx < num; ++idx)
+      REQUIRE(from.udp->send(to, llarp_buffer_t{data}));
+  }
+
+  const SockAddr addrA{10, 0, 0, 1, huint16_t{1090}};
+  const SockAddr addrB{10, 0, 0, 2, huint16_t{1090}};
+}  // namespace
+
+TEST_CASE("Simulated network delivers after the link latency", "[ev][sim]")
+{
+  auto net = std::make_shared<sim::Network>(1, 0s);
+  sim::LinkModel model;
+  model.latency = 25ms;
+  net->SetDefaultLink(model);
+  Host a{*net, addrA}, b{*net, addrB};
+
+  SendMany(a, addrB, 1, 100);
+  net->RunFor(24ms);
+  REQUIRE(b.received.empty());
+  net->RunFor(1ms);
+  REQUIRE(b.received.size() == 1);
+  CHECK(b.received[0] == std::make_pair(llarp_time_t{25ms}, size_t{100}));
+  CHECK(net->Now() == 25ms);
+
+  SECTION("closed sockets are unreachable")
+  {
+    b.udp->close();
+    SendMany(a, addrB, 1, 100);
+    net->RunFor(1s);
+    CHECK(b.received.size() == 1);
+    CHECK(net->Stats().unreachable == 1);
+  }
+}
+
+TEST_CASE("Simulated network serializes datagrams on a limited link", "[ev][sim]")
+{
+  auto net = std::make_shared<sim::Network>(1, 0s);
+  sim::LinkModel model;
+  model.latency = 5ms;
+  model.bandwidth = 100'000;
+  model.maxQueue = 50ms;
+  net->SetLink(addrA, addrB, model);
+  Host a{*net, addrA}, b{*net, addrB};
+
+  // 1000 bytes takes 10ms at 100KB/s, anything waiting over 50ms is dropped
+  SendMany(a, addrB, 10, 1000);
+  net->RunFor(1s);
+  REQUIRE(b.received.size() == 6);
+  for (size_t idx = 0; idx < b.received.size(); ++idx)
+    CHECK(b.received[idx].first == llarp_time_t{5ms + 10ms * (idx + 1)});
+  CHECK(net->Stats().queueDropped == 4);
+
+  // the other direction still uses the unlimited default link
+  SendMany(b, addrA, 10, 1000);
+  net->RunFor(1s);
+  CHECK(a.received.size() == 10);
+}
+
+TEST_CASE("Simulated loss is reproducible for a seed", "[ev][sim]")
+{
+  const auto run = [](uint64_t seed) {
+    auto net = std::make_shared<sim::Network>(seed, 0s);
+    sim::LinkModel model;
+    model.loss = 0.25;
+    model.jitter = 5ms;
+    net->SetDefaultLink(model);
+    Host a{*net, addrA}, b{*net, addrB};
+    SendMany(a, addrB, 1000, 10);
+    net->RunFor(1s);
+    return b.received;
+  };
+  const auto first = run(7);
+  CHECK(first == run(7));
+  CHECK(first.size() > 650);
+  CHECK(first.size() < 850);
+}
+
+TEST_CASE("Simulated loops run timers in virtual time", "[ev][sim]")
+{
+  auto net = std::make_shared<sim::Network>(1, 0s);
+  auto loop = net->MakeLoop();
+  std::vector<llarp_time_t> fired;
+  loop->call_later(30ms, [&] { fired.push_back(loop->time_now()); });
+  loop->call_later(10ms, [&] { fired.push_back(loop->time_now()); });
+  auto owner = std::make_shared<int>(0);
+  loop->call_every(100ms, owner, [&] { fired.push_back(loop->time_now()); });
+  size_t ticks = 0;
+  loop->add_ticker([&] { ++ticks; });
+
+  net->RunFor(250ms);
+  const std::vector<llarp_time_t> expected{10ms, 30ms, 100ms, 200ms};
+  CHECK(fired == expected);
+  CHECK(ticks == fired.size());
+  owner.reset();
+  net->RunFor(1s);
+  CHECK(fired.size() == 4);
+
+  SECTION("run drives the network until every loop stopped")
+  {
+    loop->call_later(1h, [&] { loop->stop(); });
+    std::thread runner{[&] { loop->run(); }};
+    runner.join();
+    CHECK(not loop->running());
+    CHECK(net->Now() == 1s + 250ms + 1h);
+  }
+}
+
+TEST_CASE("Simulated loops read and write in memory interfaces", "[ev][sim]")
+{
+  auto net = std::make_shared<sim::Network>(1, 0s);
+  auto loop = net->MakeLoop();
+  sim::MemoryPlatform platform{loop};
+  auto netif = platform.ObtainInterface(vpn::InterfaceInfo{"sim0", {}, {}});
+  REQUIRE(platform.interfaces.size() == 1);
+  auto& memif = *platform.interfaces[0];
+  CHECK(netif->IfName() == "sim0");
+
+  std::vector<byte_t> payload(100);
+  const auto pkt = net::IPPacket::UDP(
+      nuint32_t{1}, nuint16_t{2}, nuint32_t{3}, nuint16_t{4}, llarp_buffer_t{payload});
+  std::vector<size_t> read, written;
+  memif.onWrite = [&written](net::IPPacket pkt) { written.push_back(pkt.sz); };
+  REQUIRE(loop->add_network_interface(netif, [&](net::IPPacket pkt) {
+    read.push_back(pkt.sz);
+    // echo it back out like a tun device would
+    netif->WritePacket(std::move(pkt));
+  }));
+
+  memif.Inject(pkt);
+  memif.Inject(pkt);
+  net->RunPending();
+  const std::vector<size_t> expected{pkt.sz, pkt.sz};
+  CHECK(read == expected);
+  CHECK(written == read);
+  CHECK(netif->ReadNextPacket().sz == 0);
+}
@@ -151,9 +151,7 @@ RunIWPTest(Func_t test, Duration_t timeout = 10s)
   auto loop = llarp::EventLoop::create();
 
   llarp::LogContext::Instance().Initialize(
-      llarp::eLogDebug, llarp::LogType::File, "stdout", "unit test", [loop](auto work) {
-        loop->call_soon(work);
-      });
+      llarp::eLogDebug, llarp::LogType::File, "stdout", "unit test");
 
   // turn off bogon blocking
   auto oldBlockBogons = llarp::RouterContact::BlockBogons;
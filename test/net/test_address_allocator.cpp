@@ -0,0 +1,114 @@
+#include <net/address_allocator.hpp>
+#include <net/ip_range.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::huint128_t;
+using llarp::net::AddressAllocator;
+
+static AddressAllocator::Key_t
+MakeKey(uint8_t n)
+{
+  AddressAllocator::Key_t key{};
+  key[0] = n;
+  return key;
+}
+
+TEST_CASE("AddressAllocator hands out addresses in order", "[address-allocator]")
+{
+  const auto range = llarp::IPRange::FromIPv4(10, 0, 0, 1, 29);
+  AddressAllocator alloc;
+  alloc.Init(range.addr + huint128_t{1}, range.HighestAddr() - huint128_t{1});
+
+  const auto first = alloc.Obtain(MakeKey(1), 0, 1s);
+  REQUIRE(first);
+  REQUIRE(*first == range.addr + huint128_t{1});
+  // same key gets the same address
+  REQUIRE(alloc.Obtain(MakeKey(1), 0, 2s) == first);
+  const auto second = alloc.Obtain(MakeKey(2), 0, 2s);
+  REQUIRE(second);
+  REQUIRE(*second == range.addr + huint128_t{2});
+  REQUIRE(alloc.Size() == 2);
+}
+
+TEST_CASE("AddressAllocator skips explicit mappings", "[address-allocator]")
+{
+  AddressAllocator alloc;
+  alloc.Init(huint128_t{10}, huint128_t{12});
+  REQUIRE(alloc.Map(huint128_t{10}, MakeKey(1), 0, true, 0s));
+  REQUIRE_FALSE(alloc.Map(huint128_t{10}, MakeKey(2), 0, true, 0s));
+  REQUIRE(alloc.Obtain(MakeKey(2), 0, 1s) == huint128_t{11});
+}
+
+TEST_CASE("AddressAllocator evicts the least recently active address", "[address-allocator]")
+{
+  AddressAllocator alloc;
+  alloc.Init(huint128_t{10}, huint128_t{12});
+  std::vector<AddressAllocator::Key_t> evicted;
+  alloc.onEvict = [&evicted](const auto& entry) { evicted.push_back(entry.key); };
+
+  REQUIRE(alloc.Obtain(MakeKey(1), 0, 1s) == huint128_t{10});
+  REQUIRE(alloc.Obtain(MakeKey(2), 0, 2s) == huint128_t{11});
+  REQUIRE(alloc.Obtain(MakeKey(3), 0, 3s) == huint128_t{12});
+  // touch the oldest so the second one becomes the eviction candidate
+  alloc.MarkActive(huint128_t{10}, 4s);
+
+  REQUIRE(alloc.Obtain(MakeKey(4), 0, 5s) == huint128_t{11});
+  REQUIRE(evicted.size() == 1);
+  REQUIRE(evicted[0] == MakeKey(2));
+  REQUIRE_FALSE(alloc.FindIP(MakeKey(2)));
+  REQUIRE(alloc.FindIP(MakeKey(4)) == huint128_t{11});
+  REQUIRE(alloc.Size() == 3);
+}
+
+TEST_CASE("AddressAllocator never evicts pinned addresses", "[address-allocator]")
+{
+  AddressAllocator alloc;
+  alloc.Init(huint128_t{10}, huint128_t{11});
+  REQUIRE(alloc.Obtain(MakeKey(1), 0, 1s) == huint128_t{10});
+  REQUIRE(alloc.Obtain(MakeKey(2), 0, 2s) == huint128_t{11});
+  alloc.Pin(huint128_t{10});
+  REQUIRE(alloc.Obtain(MakeKey(3), 0, 3s) == huint128_t{11});
+  alloc.Pin(huint128_t{11});
+  REQUIRE_FALSE(alloc.Obtain(MakeKey(4), 0, 4s));
+}
+
+TEST_CASE("AddressAllocator reuses released addresses", "[address-allocator]")
+{
+  AddressAllocator alloc;
+  alloc.Init(huint128_t{10}, huint128_t{11});
+  REQUIRE(alloc.Obtain(MakeKey(1), 0, 1s) == huint128_t{10});
+  REQUIRE(alloc.Obtain(MakeKey(2), 0, 1s) == huint128_t{11});
+  REQUIRE(alloc.Release(huint128_t{10}));
+  REQUIRE_FALSE(alloc.HasIP(huint128_t{10}));
+  REQUIRE(alloc.Obtain(MakeKey(3), 0, 2s) == huint128_t{10});
+}
+
+TEST_CASE("AddressAllocator handles huge ranges", "[address-allocator]")
+{
+  llarp::IPRange range;
+  REQUIRE(range.FromString("fd00::/16"));
+  AddressAllocator alloc;
+  alloc.Init(range.addr + huint128_t{1}, range.HighestAddr());
+  for (uint8_t n = 1; n < 100; n++)
+    REQUIRE(alloc.Obtain(MakeKey(n), 0, 1s) == range.addr + huint128_t{n});
+  REQUIRE(alloc.NextFresh() == range.addr + huint128_t{100});
+}
+
+TEST_CASE("AddressAllocator keeps pinned mappings across Init", "[address-allocator]")
+{
+  // TunEndpoint::Configure pins [network]:mapaddr entries before SetupTun sets the range
+  const auto range = llarp::IPRange::FromIPv4(10, 0, 0, 1, 24);
+  const auto mapped = range.addr + huint128_t{5};
+  AddressAllocator alloc;
+  REQUIRE(alloc.Map(mapped, MakeKey(1), 0, true, llarp_time_t::max()));
+  REQUIRE(alloc.Map(huint128_t{1}, MakeKey(2), 0, false, 1s));
+
+  alloc.Init(range.addr + huint128_t{1}, range.HighestAddr() - huint128_t{1});
+  REQUIRE(alloc.Size() == 1);
+  REQUIRE(alloc.FindIP(MakeKey(1)) == mapped);
+  REQUIRE_FALSE(alloc.FindIP(MakeKey(2)));
+  // the pinned address is never handed out to anyone else
+  for (uint8_t n = 3; n < 10; n++)
+    REQUIRE(alloc.Obtain(MakeKey(n), 0, 1s) != mapped);
+}
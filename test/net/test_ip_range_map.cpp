@@ -0,0 +1,127 @@
+#include <net/ip_range_map.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+
+using llarp::huint128_t;
+using llarp::IPRange;
+using llarp::net::IPRangeMap;
+
+namespace
+{
+  /// the linear scan IPRangeMap used to do, kept as a reference to check against
+  struct LinearRangeMap
+  {
+    std::vector<std::pair<IPRange, int>> entries;
+
+    void
+    Insert(const IPRange& range, int val)
+    {
+      entries.emplace_back(range, val);
+    }
+
+    std::vector<std::pair<IPRange, int>>
+    FindAllEntries(const huint128_t& ip) const
+    {
+      std::vector<std::pair<IPRange, int>> found;
+      for (const auto& entry : entries)
+      {
+        if (entry.first.Contains(ip))
+          found.push_back(entry);
+      }
+      return found;
+    }
+  };
+
+  huint128_t
+  RandomIP(std::mt19937_64& rng)
+  {
+    huint128_t ip{0};
+    if (rng() % 2)
+    {
+      // ipv4 mapped
+      ip.h.upper = 0;
+      ip.h.lower = 0x0000'ffff'0000'0000UL | (rng() & 0xffff'ffffUL);
+    }
+    else
+    {
+      ip.h.upper = rng();
+      ip.h.lower = rng();
+    }
+    return ip;
+  }
+
+  IPRange
+  RandomRange(std::mt19937_64& rng)
+  {
+    auto ip = RandomIP(rng);
+    const bool v4 = ip.h.upper == 0 and (ip.h.lower >> 32) == 0xffff;
+    const auto bits = v4 ? 96 + 8 + rng() % 25 : 16 + rng() % 113;
+    const auto mask = llarp::netmask_ipv6_bits(bits);
+    return IPRange{ip & mask, mask};
+  }
+
+  std::vector<int>
+  Values(std::vector<std::pair<IPRange, int>> entries)
+  {
+    std::vector<int> vals;
+    for (const auto& entry : entries)
+      vals.push_back(entry.second);
+    std::sort(vals.begin(), vals.end());
+    return vals;
+  }
+}  // namespace
+
+TEST_CASE("IPRangeMap longest prefix match", "[iprangemap]")
+{
+  IPRangeMap<int> map;
+  REQUIRE(map.Empty());
+  REQUIRE(map.FindLongestMatch(huint128_t{1}) == nullptr);
+
+  map.Insert(IPRange::FromIPv4(0, 0, 0, 0, 0), 1);
+  map.Insert(IPRange::FromIPv4(10, 0, 0, 0, 8), 2);
+  map.Insert(IPRange::FromIPv4(10, 1, 0, 0, 16), 3);
+  map.Insert(IPRange::FromIPv4(192, 168, 0, 0, 16), 4);
+
+  const auto ip = llarp::net::ExpandV4(llarp::ipaddr_ipv4_bits(10, 1, 2, 3));
+  const auto* best = map.FindLongestMatch(ip);
+  REQUIRE(best);
+  REQUIRE(best->second == 3);
+
+  const auto all = map.FindAllEntries(ip);
+  REQUIRE(all.size() == 3);
+  REQUIRE(all[0].second == 1);
+  REQUIRE(all[1].second == 2);
+  REQUIRE(all[2].second == 3);
+
+  const auto other = llarp::net::ExpandV4(llarp::ipaddr_ipv4_bits(10, 2, 0, 1));
+  REQUIRE(map.FindLongestMatch(other)->second == 2);
+
+  REQUIRE(map.GetExact(IPRange::FromIPv4(10, 1, 0, 0, 16)) == 3);
+  REQUIRE_FALSE(map.GetExact(IPRange::FromIPv4(10, 1, 0, 0, 24)));
+
+  map.RemoveIf([](const auto& entry) { return entry.second == 3; });
+  REQUIRE(map.Size() == 3);
+  REQUIRE(map.FindLongestMatch(ip)->second == 2);
+}
+
+TEST_CASE("IPRangeMap matches the linear scan", "[iprangemap]")
+{
+  std::mt19937_64 rng{1337};
+  IPRangeMap<int> map;
+  LinearRangeMap linear;
+  for (int n = 0; n < 2000; ++n)
+  {
+    const auto range = RandomRange(rng);
+    map.Insert(range, n);
+    linear.Insert(range, n);
+  }
+  for (int n = 0; n < 2000; ++n)
+  {
+    // look up both random ips and ips inside known ranges
+    const auto ip = n % 2 ? RandomIP(rng) : linear.entries[n].first.addr + huint128_t{1};
+    REQUIRE(Values(map.FindAllEntries(ip)) == Values(linear.FindAllEntries(ip)));
+  }
+}
@@ -0,0 +1,58 @@
+#include <net/traffic_policy.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+namespace
+{
+  net::IPPacket
+  MakePacket(net::IPProtocol proto, byte_t a, byte_t b, byte_t c, byte_t d, uint16_t port)
+  {
+    std::array<byte_t, 8> data{};
+    auto pkt = net::IPPacket::UDP(
+        nuint32_t{0},
+        nuint16_t{0},
+        ToNet(ipaddr_ipv4_bits(a, b, c, d)),
+        ToNet(huint16_t{port}),
+        llarp_buffer_t{data});
+    pkt.Header()->protocol = static_cast<uint8_t>(proto);
+    return pkt;
+  }
+
+  net::TrafficPolicy
+  MakePolicy()
+  {
+    net::TrafficPolicy policy;
+    policy.protocols.emplace("icmp");
+    policy.protocols.emplace("tcp/80");
+    policy.protocols.emplace("tcp/443");
+    policy.ranges.emplace(IPRange::FromIPv4(10, 0, 0, 0, 8));
+    return policy;
+  }
+}  // namespace
+
+TEST_CASE("Compiled traffic policy", "[traffic-policy]")
+{
+  const auto policy = MakePolicy();
+  const net::CompiledTrafficPolicy compiled{policy};
+
+  const std::vector<std::pair<net::IPPacket, bool>> cases{
+      {MakePacket(net::IPProtocol::ICMP, 1, 1, 1, 1, 0), true},
+      {MakePacket(net::IPProtocol::TCP, 1, 1, 1, 1, 80), true},
+      {MakePacket(net::IPProtocol::TCP, 1, 1, 1, 1, 443), true},
+      {MakePacket(net::IPProtocol::TCP, 1, 1, 1, 1, 22), false},
+      {MakePacket(net::IPProtocol::UDP, 1, 1, 1, 1, 80), false},
+      {MakePacket(net::IPProtocol::UDP, 10, 2, 3, 4, 53), true},
+      {MakePacket(net::IPProtocol::TCP, 10, 2, 3, 4, 22), true},
+  };
+  for (const auto& [pkt, allowed] : cases)
+  {
+    REQUIRE(policy.AllowsTraffic(pkt) == allowed);
+    REQUIRE(compiled.AllowsTraffic(pkt) == allowed);
+  }
+
+  // an empty policy allows everything
+  const net::CompiledTrafficPolicy empty{net::TrafficPolicy{}};
+  REQUIRE(empty.AllowsTraffic(MakePacket(net::IPProtocol::UDP, 1, 1, 1, 1, 1)));
+}
@@ -0,0 +1,54 @@
+#include <path/path_context.hpp>
+#include <catch2/catch.hpp>
+
+using llarp::path::PathContext;
+using BuildAdmission = PathContext::BuildAdmission;
+
+TEST_CASE("path build requests are shed as the backlog grows", "[path]")
+{
+  PathContext ctx{nullptr};
+  std::vector<std::function<void(void)>> jobs;
+  ctx.SetWorker([&jobs](auto job) { jobs.push_back(std::move(job)); });
+
+  for (size_t n = 0; n < PathContext::CongestedPathBuilds; ++n)
+  {
+    REQUIRE(ctx.AdmitPathBuild() == BuildAdmission::Accept);
+    ctx.QueuePathBuildWork([] {});
+  }
+  for (size_t n = PathContext::CongestedPathBuilds; n < PathContext::MaxPendingPathBuilds; ++n)
+  {
+    REQUIRE(ctx.AdmitPathBuild() == BuildAdmission::Congested);
+    ctx.QueuePathBuildWork([] {});
+  }
+  // a dropped request is not counted
+  CHECK(ctx.AdmitPathBuild() == BuildAdmission::Drop);
+  CHECK(ctx.AdmitPathBuild() == BuildAdmission::Drop);
+  REQUIRE(jobs.size() == PathContext::MaxPendingPathBuilds);
+
+  // the backlog drains as the worker gets through it
+  for (size_t n = 0; n <= PathContext::MaxPendingPathBuilds - PathContext::CongestedPathBuilds;
+       ++n)
+    jobs[n]();
+  CHECK(ctx.AdmitPathBuild() == BuildAdmission::Accept);
+}
+
+TEST_CASE("path build work runs inline without a worker", "[path]")
+{
+  PathContext ctx{nullptr};
+  REQUIRE(ctx.AdmitPathBuild() == BuildAdmission::Accept);
+  bool ran = false;
+  ctx.QueuePathBuildWork([&ran] { ran = true; });
+  CHECK(ran);
+}
+
+TEST_CASE("a key pool refill queued at shutdown does nothing", "[path]")
+{
+  std::function<void(void)> refill;
+  {
+    PathContext ctx{nullptr};
+    ctx.SetWorker([&refill](auto job) { refill = std::move(job); });
+    ctx.TopUpKeyPool();
+    REQUIRE(refill);
+  }
+  refill();
+}
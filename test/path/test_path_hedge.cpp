@@ -0,0 +1,66 @@
+#include <path/path.hpp>
+#include <path/path_hedge.hpp>
+#include <catch2/catch.hpp>
+
+using namespace std::literals;
+using llarp::path::HedgeBudget;
+using llarp::path::HedgedRace;
+using llarp::path::Path_ptr;
+
+namespace
+{
+  Path_ptr
+  MakeBuildingPath(char name)
+  {
+    std::vector<llarp::RouterContact> hops(3);
+    for (auto& hop : hops)
+      hop.pubkey.Fill(name++);
+    auto path = std::make_shared<llarp::path::Path>(hops, nullptr, 0, "test");
+    path->EnterState(llarp::path::ePathBuilding, 0s);
+    return path;
+  }
+}  // namespace
+
+TEST_CASE("hedge budget caps extra builds", "[path]")
+{
+  HedgeBudget budget;
+  // starts full
+  CHECK(budget.Take(5, 2, 1s) == 2);
+  CHECK(budget.Take(1, 2, 1s) == 0);
+  // what was taken but not started goes back
+  budget.Return(1, 2);
+  CHECK(budget.Take(3, 2, 1s) == 1);
+  // two a minute is one every 30s
+  CHECK(budget.Take(3, 2, 31s) == 1);
+  CHECK(budget.Take(3, 2, 31s) == 0);
+  // never refills past the cap
+  budget.Return(10, 2);
+  CHECK(budget.Tokens() == 2);
+  CHECK(budget.Take(3, 2, 10min) == 2);
+}
+
+TEST_CASE("hedged race drops the losers once enough are built", "[path]")
+{
+  const auto first = MakeBuildingPath('a');
+  const auto second = MakeBuildingPath('d');
+  const auto third = MakeBuildingPath('g');
+  const auto stranger = MakeBuildingPath('j');
+  HedgedRace race{2, {first, second, third}};
+  REQUIRE(race.Running());
+
+  std::vector<Path_ptr> dropped;
+  CHECK_FALSE(race.Built(stranger, 1s, dropped));
+  REQUIRE(race.Built(first, 1s, dropped));
+  CHECK(dropped.empty());
+  CHECK(race.Running());
+
+  // the second winner ends the race, the last one still building loses
+  REQUIRE(race.Built(second, 2s, dropped));
+  REQUIRE(dropped.size() == 1);
+  CHECK(dropped[0] == third);
+  CHECK(third->Status() == llarp::path::ePathIgnore);
+  CHECK(first->Status() == llarp::path::ePathBuilding);
+  CHECK(stranger->Status() == llarp::path::ePathBuilding);
+  CHECK_FALSE(race.Running());
+  CHECK_FALSE(race.Built(third, 3s, dropped));
+}
@@ -0,0 +1,52 @@
+#include <path/key_pool.hpp>
+#include <crypto/crypto.hpp>
+#include <crypto/crypto_libsodium.hpp>
+#include <catch2/catch.hpp>
+
+using llarp::path::EphemeralKeyPool;
+
+TEST_CASE("ephemeral key pool refills and falls back to generating", "[path]")
+{
+  llarp::sodium::CryptoLibSodium crypto;
+  llarp::CryptoManager manager{&crypto};
+  EphemeralKeyPool pool;
+  REQUIRE(pool.Size() == 0);
+  REQUIRE(pool.StartRefill());
+  // only one refill at a time
+  REQUIRE_FALSE(pool.StartRefill());
+  pool.Refill();
+  REQUIRE(pool.Size() == EphemeralKeyPool::Capacity);
+  REQUIRE_FALSE(pool.StartRefill());
+
+  std::vector<llarp::SecretKey> taken;
+  while (pool.Size() >= EphemeralKeyPool::LowWater)
+    taken.push_back(pool.Take());
+  REQUIRE(pool.StartRefill());
+  pool.Refill();
+  REQUIRE(pool.Size() == EphemeralKeyPool::Capacity);
+
+  // an empty pool still hands out working keys
+  while (pool.Size() > 0)
+    taken.push_back(pool.Take());
+  taken.push_back(pool.Take());
+  for (size_t n = 0; n < taken.size(); ++n)
+  {
+    REQUIRE_FALSE(taken[n].IsZero());
+    REQUIRE_FALSE(llarp::PubKey{llarp::seckey_topublic(taken[n])}.IsZero());
+    if (n > 0)
+      REQUIRE(taken[n] != taken[n - 1]);
+  }
+}
+
+TEST_CASE("a stopped ephemeral key pool is not refilled", "[path]")
+{
+  llarp::sodium::CryptoLibSodium crypto;
+  llarp::CryptoManager manager{&crypto};
+  EphemeralKeyPool pool;
+  REQUIRE(pool.StartRefill());
+  pool.Stop();
+  // a refill that was already handed to a worker returns without generating anything
+  pool.Refill();
+  CHECK(pool.Size() == 0);
+  CHECK_FALSE(pool.StartRefill());
+}
@@ -0,0 +1,79 @@
+#include <path/path_rtt.hpp>
+#include <catch2/catch.hpp>
+
+using namespace std::literals;
+using llarp::path::RTTEstimator;
+
+TEST_CASE("rtt estimator smooths samples", "[path]")
+{
+  RTTEstimator rtt;
+  REQUIRE_FALSE(rtt.HasSample());
+  rtt.Sample(100ms);
+  CHECK(rtt.SmoothedRTT() == 100ms);
+  CHECK(rtt.RTTVariance() == 50ms);
+  for (int n = 0; n < 100; ++n)
+    rtt.Sample(200ms);
+  CHECK(rtt.SmoothedRTT() > 190ms);
+  CHECK(rtt.SmoothedRTT() <= 200ms);
+  CHECK(rtt.RTTVariance() < 10ms);
+  CHECK(rtt.LossRate() == 0.0);
+}
+
+TEST_CASE("rtt estimator matches probe replies", "[path]")
+{
+  RTTEstimator rtt;
+  REQUIRE(rtt.Sent(1, 1000ms));
+  REQUIRE(rtt.Sent(2, 1500ms));
+  CHECK_FALSE(rtt.Answered(3, 1600ms));
+  REQUIRE(rtt.Answered(2, 1600ms));
+  CHECK(rtt.SmoothedRTT() == 100ms);
+  CHECK(rtt.Outstanding() == 1);
+  // a second reply to the same probe is not a sample
+  CHECK_FALSE(rtt.Answered(2, 1700ms));
+  for (uint64_t id = 10; id < 10 + RTTEstimator::MaxOutstanding; ++id)
+    rtt.Sent(id, 2000ms);
+  CHECK(rtt.Outstanding() == RTTEstimator::MaxOutstanding);
+  CHECK_FALSE(rtt.Sent(99, 2000ms));
+}
+
+TEST_CASE("rtt estimator counts unanswered probes as lost", "[path]")
+{
+  RTTEstimator rtt;
+  rtt.Sent(1, 0ms);
+  rtt.Answered(1, 50ms);
+  const auto timeout = rtt.ProbeTimeout();
+  CHECK(timeout >= RTTEstimator::MinProbeTimeout);
+  CHECK(timeout <= RTTEstimator::MaxProbeTimeout);
+  rtt.Sent(2, 1s);
+  CHECK(rtt.ExpireProbes(1s + timeout - 1ms) == 0);
+  CHECK(rtt.ExpireProbes(1s + timeout) == 1);
+  CHECK(rtt.Outstanding() == 0);
+  CHECK(rtt.LossRate() > 0.0);
+  CHECK_FALSE(rtt.Answered(2, 1s + timeout + 1ms));
+}
+
+TEST_CASE("rtt estimator cost prefers fast clean paths", "[path]")
+{
+  RTTEstimator fast, slow, lossy;
+  for (int n = 0; n < 20; ++n)
+  {
+    fast.Sample(100ms);
+    slow.Sample(300ms);
+    lossy.Sample(100ms);
+    lossy.Lost();
+  }
+  CHECK(fast.Cost() < slow.Cost());
+  CHECK(fast.Cost() < lossy.Cost());
+  CHECK(lossy.LossRate() > 0.3);
+}
+
+TEST_CASE("rtt estimator does not count discards as loss", "[path]")
+{
+  RTTEstimator rtt;
+  rtt.Sample(100ms);
+  const auto cost = rtt.Cost();
+  for (int n = 0; n < 100; ++n)
+    rtt.Discarded();
+  CHECK(rtt.LossRate() == 0.0);
+  CHECK(rtt.Cost() == cost);
+}
@@ -0,0 +1,109 @@
+#include <router/rc_sync.hpp>
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+
+using namespace llarp;
+
+namespace
+{
+  RouterID
+  MakeID(uint8_t bucket, uint8_t n)
+  {
+    RouterID id;
+    id.Fill(n);
+    id[0] = bucket;
+    return id;
+  }
+
+  bool
+  Contains(const std::vector<RouterID>& ids, const RouterID& id)
+  {
+    return std::find(ids.begin(), ids.end(), id) != ids.end();
+  }
+}  // namespace
+
+TEST_CASE("rc sketch finds the buckets that differ", "[rcsync]")
+{
+  RCSketch ours, theirs;
+  for (uint8_t n = 0; n < 100; ++n)
+  {
+    ours.Add(MakeID(n, n), 1000ms);
+    theirs.Add(MakeID(n, n), 1000ms);
+  }
+  // order of insertion does not matter
+  ours.Add(MakeID(7, 200), 5ms);
+  ours.Add(MakeID(7, 201), 6ms);
+  theirs.Add(MakeID(7, 201), 6ms);
+  theirs.Add(MakeID(7, 200), 5ms);
+  CHECK(ours.Differing(theirs.Digest()).empty());
+
+  // a newer copy of one rc and one rc only we have
+  theirs.Add(MakeID(20, 250), 1ms);
+  ours.Add(MakeID(42, 42), 1001ms);
+  const auto differ = ours.Differing(theirs.Digest());
+  CHECK((differ == std::vector<uint8_t>{20, 42}));
+
+  const auto decoded = RCSketch::DecodeDigest(RCSketch::EncodeDigest(ours.Digest()));
+  REQUIRE(decoded);
+  CHECK(*decoded == ours.Digest());
+  CHECK_FALSE(RCSketch::DecodeDigest("short"));
+}
+
+TEST_CASE("rc sync entries pack and unpack", "[rcsync]")
+{
+  std::vector<RCSyncEntry> entries{{MakeID(1, 2), 1234567ms}, {MakeID(200, 9), 0ms}};
+  const auto packed = RCSyncEntry::Pack(entries);
+  CHECK(packed.size() == entries.size() * RCSyncEntry::PackedSize);
+  const auto unpacked = RCSyncEntry::Unpack(packed);
+  REQUIRE(unpacked);
+  REQUIRE(unpacked->size() == 2);
+  CHECK((*unpacked)[0].id == entries[0].id);
+  CHECK((*unpacked)[0].updated == entries[0].updated);
+  CHECK((*unpacked)[1].id == entries[1].id);
+  CHECK_FALSE(RCSyncEntry::Unpack(packed.substr(1)));
+}
+
+TEST_CASE("rc sync plan pushes older and missing, wants newer", "[rcsync]")
+{
+  const auto same = MakeID(1, 1);
+  const auto theyAreNewer = MakeID(1, 2);
+  const auto weAreNewer = MakeID(1, 3);
+  const auto onlyOurs = MakeID(1, 4);
+  const auto onlyTheirs = MakeID(1, 5);
+  const auto onlyOursPartial = MakeID(2, 6);
+
+  std::unordered_map<RouterID, llarp_time_t> ours{
+      {same, 10ms},
+      {theyAreNewer, 10ms},
+      {weAreNewer, 20ms},
+      {onlyOurs, 10ms},
+      {onlyOursPartial, 10ms}};
+  std::vector<RCSyncEntry> theirs{
+      {same, 10ms}, {theyAreNewer, 20ms}, {weAreNewer, 10ms}, {onlyTheirs, 10ms}};
+  // bucket 2 was only partly listed, so we cannot tell if they lack what we have there
+  const auto plan = PlanRCSync(ours, {1}, theirs);
+
+  CHECK(plan.want.size() == 2);
+  CHECK(Contains(plan.want, theyAreNewer));
+  CHECK(Contains(plan.want, onlyTheirs));
+  CHECK(plan.push.size() == 2);
+  CHECK(Contains(plan.push, weAreNewer));
+  CHECK(Contains(plan.push, onlyOurs));
+}
+
+TEST_CASE("rc sync serves each wanted rc once and no more than it listed", "[rcsync]")
+{
+  RCSyncServed served{1, 0s, 3};
+  const auto first = served.Take({MakeID(1, 1), MakeID(1, 2), MakeID(1, 1)});
+  REQUIRE(first.size() == 2);
+  CHECK(Contains(first, MakeID(1, 1)));
+  CHECK(Contains(first, MakeID(1, 2)));
+  // asking again for the same ones gets nothing
+  CHECK(served.Take({MakeID(1, 1), MakeID(1, 2)}).empty());
+  // only one more fits in what we listed
+  const auto second = served.Take({MakeID(2, 3), MakeID(2, 4)});
+  REQUIRE(second.size() == 1);
+  CHECK(second[0] == MakeID(2, 3));
+  CHECK(served.Take({MakeID(2, 4)}).empty());
+}
@@ -0,0 +1,198 @@
+#include <crypto/crypto_libsodium.hpp>
+#include <service/identity.hpp>
+#include <service/protocol.hpp>
+#include <service/session_ticket.hpp>
+#include <util/logging/logger.hpp>
+#include <catch2/catch.hpp>
+
+#include <cstring>
+
+using namespace std::literals;
+using llarp::service::ConvoTag;
+using llarp::service::Identity;
+using llarp::service::ProtocolFrame;
+using llarp::service::ProtocolMessage;
+using llarp::service::SessionTicket;
+using llarp::service::SessionTickets;
+
+namespace
+{
+  SessionTicket
+  MakeTicket(uint8_t id, uint8_t remote, llarp_time_t expiresAt)
+  {
+    SessionTicket ticket;
+    ticket.id.Zero();
+    ticket.id[0] = id;
+    std::array<byte_t, 32> signkey{};
+    signkey[0] = remote;
+    const std::array<byte_t, 32> enckey{};
+    ticket.remote.Update(signkey.data(), enckey.data());
+    ticket.secret.Fill(id);
+    ticket.expiresAt = expiresAt;
+    return ticket;
+  }
+
+  ConvoTag
+  MakeTag(uint8_t id)
+  {
+    ConvoTag tag;
+    tag.Zero();
+    tag[0] = id;
+    return tag;
+  }
+}  // namespace
+
+TEST_CASE("session tickets are taken once", "[service]")
+{
+  SessionTickets tickets;
+  tickets.Put(MakeTicket(1, 1, 10s));
+  REQUIRE(tickets.Size() == 1);
+  const auto ticket = tickets.Take(MakeTag(1), 1s);
+  REQUIRE(ticket);
+  CHECK(ticket->secret == MakeTicket(1, 1, 10s).secret);
+  CHECK_FALSE(tickets.Take(MakeTag(1), 1s));
+  CHECK(tickets.Size() == 0);
+}
+
+TEST_CASE("session tickets keep the newest per remote", "[service]")
+{
+  SessionTickets tickets;
+  tickets.Put(MakeTicket(1, 1, 10s));
+  tickets.Put(MakeTicket(2, 1, 20s));
+  tickets.Put(MakeTicket(3, 2, 20s));
+  CHECK(tickets.Size() == 2);
+  CHECK_FALSE(tickets.Take(MakeTag(1), 1s));
+  const auto remote = MakeTicket(2, 1, 20s).remote.Addr();
+  const auto ticket = tickets.TakeFor(remote, 1s);
+  REQUIRE(ticket);
+  CHECK(ticket->id == MakeTag(2));
+  CHECK_FALSE(tickets.TakeFor(remote, 1s));
+}
+
+TEST_CASE("session tickets expire", "[service]")
+{
+  SessionTickets tickets;
+  tickets.Put(MakeTicket(1, 1, 10s));
+  tickets.Put(MakeTicket(2, 2, 20s));
+  CHECK_FALSE(tickets.Take(MakeTag(1), 10s));
+  tickets.Expire(20s);
+  CHECK(tickets.Size() == 0);
+}
+
+TEST_CASE("session tickets are left in place until removed", "[service]")
+{
+  SessionTickets tickets;
+  tickets.Put(MakeTicket(1, 1, 10s));
+  REQUIRE(tickets.Get(MakeTag(1), 1s));
+  REQUIRE(tickets.Get(MakeTag(1), 1s));
+  CHECK_FALSE(tickets.Get(MakeTag(1), 10s));
+  CHECK(tickets.Remove(MakeTag(1)));
+  CHECK_FALSE(tickets.Remove(MakeTag(1)));
+  CHECK_FALSE(tickets.Get(MakeTag(1), 1s));
+  CHECK(tickets.Size() == 0);
+}
+
+TEST_CASE("resumed session tickets keep their expiry and end the chain", "[service]")
+{
+  llarp::sodium::CryptoLibSodium crypto{};
+  llarp::CryptoManager manager{&crypto};
+  auto ticket = MakeTicket(1, 1, 10s);
+  llarp::SharedSecret key;
+  key.Fill(7);
+  for (uint8_t n = 0; n < llarp::service::MaxSessionTicketResumes; ++n)
+  {
+    auto next = ticket.Next(key);
+    REQUIRE(next);
+    CHECK(next->expiresAt == 10s);
+    CHECK(next->resumes == n + 1);
+    CHECK(next->remote == ticket.remote);
+    ticket = *next;
+  }
+  CHECK_FALSE(ticket.Next(key));
+}
+
+TEST_CASE("both ends derive the same session ticket", "[service]")
+{
+  llarp::sodium::CryptoLibSodium crypto{};
+  llarp::CryptoManager manager{&crypto};
+  llarp::SharedSecret key;
+  key.Fill(7);
+  // the client's ticket names the service as remote and the service's names the client
+  const auto client = SessionTicket::Derive(key, MakeTicket(1, 1, 0s).remote, 0s);
+  const auto service = SessionTicket::Derive(key, MakeTicket(1, 2, 0s).remote, 0s);
+  REQUIRE(client);
+  REQUIRE(service);
+  CHECK(client->id == service->id);
+  CHECK(client->secret == service->secret);
+  // the id is not the secret so naming the ticket does not give it away
+  CHECK(std::memcmp(client->id.data(), client->secret.data(), client->id.size()) != 0);
+
+  llarp::KeyExchangeNonce nonce;
+  nonce.Randomize();
+  llarp::SharedSecret clientKey, serviceKey;
+  REQUIRE(client->SessionKey(nonce, clientKey));
+  REQUIRE(service->SessionKey(nonce, serviceKey));
+  CHECK(clientKey == serviceKey);
+
+  const auto clientNext = client->Next(clientKey);
+  const auto serviceNext = service->Next(serviceKey);
+  REQUIRE(clientNext);
+  REQUIRE(serviceNext);
+  CHECK(clientNext->id == serviceNext->id);
+  CHECK(clientNext->secret == serviceNext->secret);
+  CHECK(clientNext->id != client->id);
+}
+
+TEST_CASE("protocol frames keep the session ticket they resume from", "[service]")
+{
+  ProtocolFrame frame;
+  frame.K = MakeTag(1);
+  frame.T = MakeTag(2);
+  frame.N.Randomize();
+  std::array<byte_t, 1024> tmp;
+  llarp_buffer_t buf{tmp};
+  REQUIRE(frame.BEncode(&buf));
+  buf.sz = buf.cur - buf.base;
+  buf.cur = buf.base;
+  ProtocolFrame decoded;
+  REQUIRE(decoded.BDecode(&buf));
+  CHECK(decoded.K == frame.K);
+  CHECK(decoded == frame);
+}
+
+TEST_CASE("resumed frames must be signed by the ticket's remote", "[service]")
+{
+  llarp::LogSilencer shutup;
+  llarp::sodium::CryptoLibSodium crypto{};
+  llarp::CryptoManager manager{&crypto};
+  Identity client, stranger;
+  client.RegenerateKeys();
+  stranger.RegenerateKeys();
+  llarp::SharedSecret key;
+  key.Fill(7);
+  const auto ticket = SessionTicket::Derive(key, client.pub, 1s);
+  REQUIRE(ticket);
+  SessionTickets tickets;
+  tickets.Put(*ticket);
+
+  ProtocolFrame frame;
+  frame.N.Randomize();
+  frame.K = ticket->id;
+  frame.T = MakeTag(2);
+  llarp::SharedSecret sessionKey;
+  REQUIRE(ticket->SessionKey(frame.N, sessionKey));
+
+  ProtocolMessage msg{frame.T};
+  msg.sender = stranger.pub;
+  REQUIRE(frame.EncryptAndSign(msg, sessionKey, stranger));
+  ProtocolMessage decrypted;
+  CHECK_FALSE(frame.DecryptResumed(*ticket, sessionKey, decrypted));
+  // a rejected frame leaves the ticket for the real client
+  CHECK(tickets.Get(ticket->id, 1s));
+
+  msg.sender = client.pub;
+  REQUIRE(frame.EncryptAndSign(msg, sessionKey, client));
+  CHECK(frame.DecryptResumed(*ticket, sessionKey, decrypted));
+  CHECK(decrypted.tag == frame.T);
+  CHECK(tickets.Take(ticket->id, 1s));
+}
@@ -1,4 +1,5 @@
 #include <util/decaying_hashset.hpp>
+#include <util/decaying_hashtable.hpp>
 #include <router_id.hpp>
 #include <catch2/catch.hpp>
 
@@ -37,3 +38,38 @@ TEST_CASE("DecayingHashSet test decay dynamic time", "[decaying-hashset]")
   hashset.Decay(now + timeout + 1s);
   REQUIRE(not hashset.Contains(zero));
 }
+
+TEST_CASE("DecayingHashSet decays only what expired", "[decaying-hashset]")
+{
+  static constexpr auto timeout = 5s;
+  llarp::util::DecayingHashSet<int> hashset{timeout};
+  for (int n = 0; n < 10; ++n)
+    REQUIRE(hashset.Insert(n, 1s * (n + 1)));
+  REQUIRE_FALSE(hashset.Insert(3, 20s));
+  hashset.Decay(timeout + 3s);
+  CHECK(hashset.Size() == 7);
+  CHECK_FALSE(hashset.Contains(2));
+  CHECK(hashset.Contains(3));
+  // inserted out of order, it waits behind the newer entry instead of expiring early
+  REQUIRE(hashset.Insert(0, 2s));
+  hashset.Decay(timeout + 9s);
+  CHECK(hashset.Contains(9));
+  CHECK(hashset.Contains(0));
+  hashset.Decay(timeout + 10s);
+  CHECK(hashset.Empty());
+}
+
+TEST_CASE("DecayingHashTable keeps a key put again after removal", "[decaying-hashset]")
+{
+  static constexpr auto timeout = 5s;
+  llarp::util::DecayingHashTable<int, int> table{timeout};
+  REQUIRE(table.Put(1, 10, 1s));
+  REQUIRE(table.Put(2, 20, 2s));
+  table.Remove(1);
+  REQUIRE(table.Put(1, 11, 3s));
+  table.Decay(timeout + 2s);
+  CHECK_FALSE(table.Has(2));
+  REQUIRE(table.Get(1) == 11);
+  table.Decay(timeout + 3s);
+  CHECK_FALSE(table.Has(1));
+}
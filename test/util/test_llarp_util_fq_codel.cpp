@@ -0,0 +1,151 @@
+#include <util/fq_codel.hpp>
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+
+using namespace llarp;
+
+namespace
+{
+  llarp_time_t fakeNow = 0s;
+
+  struct Item
+  {
+    size_t flow = 0;
+    size_t size = 1500;
+    int seq = 0;
+    llarp_time_t timestamp = 0s;
+
+    Item() = default;
+
+    Item(size_t f, int s, size_t sz = 1500) : flow{f}, size{sz}, seq{s}
+    {}
+  };
+
+  struct GetTime
+  {
+    llarp_time_t
+    operator()(const Item& item) const
+    {
+      return item.timestamp;
+    }
+  };
+
+  struct PutTime
+  {
+    void
+    operator()(Item& item) const
+    {
+      item.timestamp = fakeNow;
+    }
+  };
+
+  struct GetNow
+  {
+    llarp_time_t
+    operator()() const
+    {
+      return fakeNow;
+    }
+  };
+
+  struct GetSize
+  {
+    size_t
+    operator()(const Item& item) const
+    {
+      return item.size;
+    }
+  };
+
+  struct FlowHash
+  {
+    size_t
+    operator()(const Item& item) const
+    {
+      return item.flow;
+    }
+  };
+
+  using Queue_t = util::FQCoDelQueue<Item, GetTime, PutTime, GetSize, FlowHash, GetNow>;
+
+  std::vector<Item>
+  Drain(Queue_t& queue)
+  {
+    std::vector<Item> out;
+    queue.Process([&out](Item& item) { out.push_back(item); });
+    return out;
+  }
+}  // namespace
+
+TEST_CASE("fq codel serves a sparse flow ahead of a bulk one", "[codel]")
+{
+  fakeNow = 0s;
+  Queue_t queue{"test", {}, {}};
+  for (int seq = 0; seq < 100; ++seq)
+    queue.Emplace(1, seq);
+  queue.Emplace(2, 0);
+  REQUIRE(queue.Size() == 101);
+
+  const auto out = Drain(queue);
+  REQUIRE(out.size() == 101);
+  CHECK(queue.Size() == 0);
+  const auto sparse =
+      std::find_if(out.begin(), out.end(), [](const auto& item) { return item.flow == 2; });
+  // behind one quantum of the bulk flow rather than all 100 of its items
+  CHECK(std::distance(out.begin(), sparse) <= 2);
+  // each flow keeps its own order
+  int next = 0;
+  for (const auto& item : out)
+  {
+    if (item.flow == 1)
+      CHECK(item.seq == next++);
+  }
+}
+
+TEST_CASE("fq codel drops from a flow with a standing queue only", "[codel]")
+{
+  fakeNow = 0s;
+  Queue_t queue{"test", {}, {}};
+  size_t bulkSent = 0, sparseSent = 0;
+  constexpr int Ticks = 100;
+  for (int tick = 0; tick < Ticks; ++tick)
+  {
+    // the bulk flow always has a backlog waiting longer than target, the sparse one never
+    // has more than one item waiting
+    for (int seq = 0; seq < 10; ++seq)
+      queue.Emplace(1, seq);
+    queue.Emplace(2, tick, 100);
+    fakeNow += 10ms;
+    for (const auto& item : Drain(queue))
+      ++(item.flow == 1 ? bulkSent : sparseSent);
+  }
+  CHECK(sparseSent == Ticks);
+  CHECK(bulkSent < Ticks * 10);
+  CHECK(bulkSent > 0);
+  CHECK(queue.Size() == 0);
+  const auto status = queue.ExtractStatus();
+  CHECK(status["dropped"] == Ticks * 10 - bulkSent);
+}
+
+TEST_CASE("fq codel makes room by dropping from the longest flow", "[codel]")
+{
+  fakeNow = 0s;
+  Queue_t queue{"test", {}, {}, 8};
+  for (int seq = 0; seq < 8; ++seq)
+    queue.Emplace(1, seq);
+  queue.Emplace(2, 0);
+  CHECK(queue.Size() == 8);
+  const auto out = Drain(queue);
+  REQUIRE(out.size() == 8);
+  CHECK(std::count_if(out.begin(), out.end(), [](const auto& item) { return item.flow == 2; })
+        == 1);
+  // the oldest bulk item went
+  CHECK(std::none_of(
+      out.begin(), out.end(), [](const auto& item) { return item.flow == 1 and item.seq == 0; }));
+
+  // slots are reused once drained
+  for (int seq = 0; seq < 8; ++seq)
+    queue.Emplace(3, seq);
+  CHECK(Drain(queue).size() == 8);
+}
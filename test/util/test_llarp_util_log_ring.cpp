@@ -0,0 +1,165 @@
+#include <util/logging/log_ring.hpp>
+#include <catch2/catch.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace llarp;
+using namespace llarp::log_ring;
+
+namespace
+{
+  struct Printable
+  {
+    int val;
+  };
+
+  std::ostream&
+  operator<<(std::ostream& out, const Printable& p)
+  {
+    return out << std::hex << "printable(" << p.val << ")";
+  }
+
+  struct Collector
+  {
+    std::vector<Line> lines;
+    Writer writer{[this](auto& batch) {
+      for (auto& line : batch)
+        lines.push_back(std::move(line));
+    }};
+  };
+}  // namespace
+
+TEST_CASE("log ring formats arguments like an ostream", "[log]")
+{
+  Collector collect;
+  const char* nothing = nullptr;
+  const std::string str{"string"};
+  const char constChar = 'c';
+  uint8_t byte = 7;
+  Record(
+      collect.writer,
+      eLogInfo,
+      "file.cpp",
+      42,
+      "literal ",
+      str,
+      ' ',
+      std::string_view{"view"},
+      constChar,
+      byte,
+      -12345678901LL,
+      uint64_t{18446744073709551615ULL},
+      1.5,
+      0.1f,
+      true,
+      Printable{255},
+      // formatting set by an argument does not leak into the next one
+      255,
+      nothing,
+      std::byte{3});
+  collect.writer.Flush();
+  REQUIRE(collect.lines.size() == 1);
+  const auto& line = collect.lines[0];
+  CHECK(line.lvl == eLogInfo);
+  CHECK(std::string{line.fname} == "file.cpp");
+  CHECK(line.lineno == 42);
+  const std::string expected =
+      "literal string32viewc7-1234567890118446744073709551615"
+      "1.50.11printable(ff)2553";
+  CHECK(line.msg == expected);
+}
+
+TEST_CASE("log ring keeps each thread's lines in order", "[log]")
+{
+  Collector collect;
+  constexpr int numThreads = 4;
+  constexpr int perThread = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; ++t)
+    threads.emplace_back([&collect, t]() {
+      for (int n = 0; n < perThread; ++n)
+        Record(collect.writer, eLogDebug, "thread", t, n);
+    });
+  for (auto& thread : threads)
+    thread.join();
+  collect.writer.Flush();
+  REQUIRE(collect.lines.size() == numThreads * perThread);
+  std::vector<int> next(numThreads, 0);
+  for (const auto& line : collect.lines)
+  {
+    REQUIRE(line.msg == std::to_string(next[line.lineno]));
+    ++next[line.lineno];
+  }
+}
+
+TEST_CASE("log ring wraps around", "[log]")
+{
+  Collector collect;
+  const std::string big(1000, 'x');
+  size_t expected = 0;
+  // several times the ring's capacity, flushing before it fills
+  for (int round = 0; round < 20; ++round)
+  {
+    for (size_t n = 0; n < Ring::Capacity / 4 / big.size(); ++n, ++expected)
+      Record(collect.writer, eLogInfo, "wrap", 0, expected, big);
+    collect.writer.Flush();
+  }
+  REQUIRE(collect.lines.size() == expected);
+  for (size_t n = 0; n < expected; ++n)
+    REQUIRE(collect.lines[n].msg == std::to_string(n) + big);
+}
+
+TEST_CASE("log ring writes out records too big for it", "[log]")
+{
+  Collector collect;
+  const std::string huge(Ring::Capacity, 'x');
+  Record(collect.writer, eLogDebug, "huge", 0, huge);
+  // written before Record returned
+  REQUIRE(collect.lines.size() == 1);
+  CHECK(collect.lines[0].msg == huge);
+  collect.writer.Flush();
+  CHECK(collect.lines.size() == 1);
+}
+
+TEST_CASE("log ring sheds info when full but never errors", "[log]")
+{
+  std::mutex access;
+  std::vector<Line> lines;
+  bool blocked = true;
+  bool stalled = false;
+  std::condition_variable cond;
+  // a sink that stalls until we let it go, so the ring fills up
+  Writer writer{[&](auto& batch) {
+    std::unique_lock lock{access};
+    stalled = true;
+    cond.notify_all();
+    cond.wait(lock, [&]() { return not blocked; });
+    for (auto& line : batch)
+      lines.push_back(std::move(line));
+  }};
+  const std::string big(1000, 'x');
+  const size_t fits = Ring::Capacity / (big.size() + sizeof(RecordHeader) + 16);
+  // wait for the background thread to be stuck in the sink, so it cannot drain while we fill
+  Record(writer, eLogInfo, "full", 0, big);
+  {
+    std::unique_lock lock{access};
+    cond.wait(lock, [&]() { return stalled; });
+  }
+  for (size_t n = 1; n < fits * 2; ++n)
+    Record(writer, eLogInfo, "full", 0, big);
+  {
+    std::unique_lock lock{access};
+    blocked = false;
+  }
+  cond.notify_all();
+  Record(writer, eLogError, "full", 1, "error");
+  // the error was written before Record returned, after everything logged before it and the
+  // count of what was dropped
+  std::unique_lock lock{access};
+  REQUIRE(lines.size() >= 2);
+  CHECK(lines.size() < fits * 2 + 2);
+  CHECK(lines.back().msg == "error");
+  CHECK(lines[lines.size() - 2].msg.find("log lines dropped") != std::string::npos);
+}
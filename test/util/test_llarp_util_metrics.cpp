@@ -0,0 +1,139 @@
+#include <util/metrics.hpp>
+#include <catch2/catch.hpp>
+
+#include <limits>
+#include <thread>
+#include <vector>
+
+using namespace llarp::metrics;
+
+TEST_CASE("metrics counter sums every thread", "[metrics]")
+{
+  Registry registry;
+  auto& counter = registry.GetCounter("test_packets", "packets");
+  constexpr size_t numThreads = 32;
+  constexpr uint64_t perThread = 10000;
+  std::vector<std::thread> threads;
+  for (size_t idx = 0; idx < numThreads; ++idx)
+    threads.emplace_back([&counter]() {
+      for (uint64_t n = 0; n < perThread; ++n)
+        counter.Add();
+    });
+  for (auto& thread : threads)
+    thread.join();
+  REQUIRE(counter.Value() == numThreads * perThread);
+}
+
+TEST_CASE("metrics registry returns one series per name and labels", "[metrics]")
+{
+  Registry registry;
+  auto& tx = registry.GetCounter("test_bytes", "bytes", {{"direction", "tx"}});
+  auto& rx = registry.GetCounter("test_bytes", "bytes", {{"direction", "rx"}});
+  REQUIRE(&tx != &rx);
+  REQUIRE(&tx == &registry.GetCounter("test_bytes", "bytes", {{"direction", "tx"}}));
+  REQUIRE_THROWS(registry.GetGauge("test_bytes", "bytes"));
+}
+
+TEST_CASE("metrics histogram buckets are cumulative", "[metrics]")
+{
+  Histogram histogram{{1, 2, 4}};
+  for (const auto val : {0.5, 1.0, 1.5, 3.0, 10.0})
+    histogram.Observe(val);
+  const auto snap = histogram.Read();
+  const std::vector<uint64_t> expected{2, 3, 4, 5};
+  REQUIRE(snap.buckets == expected);
+  REQUIRE(snap.count == 5);
+  REQUIRE(snap.sum == 16.0);
+}
+
+TEST_CASE("metrics openmetrics export", "[metrics]")
+{
+  Registry registry;
+  registry.GetCounter("lokinet_drops", "dropped \"packets\"", {{"reason", "full"}}).Add(3);
+  registry.GetGauge("lokinet_queue", "queue depth").Set(-2);
+  registry.GetHistogram("lokinet_build_seconds", "build time", {0.5, 1}).Observe(0.75);
+
+  const std::string expected =
+      "# TYPE lokinet_build_seconds histogram\n"
+      "# HELP lokinet_build_seconds build time\n"
+      "lokinet_build_seconds_bucket{le=\"0.5\"} 0\n"
+      "lokinet_build_seconds_bucket{le=\"1\"} 1\n"
+      "lokinet_build_seconds_bucket{le=\"+Inf\"} 1\n"
+      "lokinet_build_seconds_sum 0.75\n"
+      "lokinet_build_seconds_count 1\n"
+      "# TYPE lokinet_drops counter\n"
+      "# HELP lokinet_drops dropped \\\"packets\\\"\n"
+      "lokinet_drops_total{reason=\"full\"} 3\n"
+      "# TYPE lokinet_queue gauge\n"
+      "# HELP lokinet_queue queue depth\n"
+      "lokinet_queue -2\n"
+      "# EOF\n";
+  REQUIRE(registry.ExportOpenMetrics() == expected);
+}
+
+TEST_CASE("metrics latency histogram buckets", "[metrics]")
+{
+  // every value lands in a bucket whose range holds it, and neighbouring buckets touch
+  uint64_t prev = 0;
+  for (size_t idx = 0; idx < LatencyHistogram::NumBuckets; ++idx)
+  {
+    const auto max = LatencyHistogram::BucketMax(idx);
+    REQUIRE(LatencyHistogram::BucketFor(max) == idx);
+    if (idx > 0)
+    {
+      REQUIRE(LatencyHistogram::BucketFor(prev + 1) == idx);
+      // at most 1/16 wide relative to the values in it
+      REQUIRE((max - prev - 1) * LatencyHistogram::SubBuckets <= prev + 1);
+    }
+    prev = max;
+  }
+  REQUIRE(
+      LatencyHistogram::BucketFor(std::numeric_limits<uint64_t>::max())
+      == LatencyHistogram::NumBuckets - 1);
+}
+
+TEST_CASE("metrics latency histogram percentiles", "[metrics]")
+{
+  LatencyHistogram latency;
+  REQUIRE(latency.Read().Percentile(0.5).count() == 0);
+  // 1ms to 1000ms in 1ms steps
+  for (int ms = 1; ms <= 1000; ++ms)
+    latency.Record(std::chrono::milliseconds{ms});
+  const auto snap = latency.Read();
+  REQUIRE(snap.count == 1000);
+  REQUIRE(snap.maxMicros == 1'000'000);
+  REQUIRE(snap.sumMicros == 500'500'000);
+  for (const auto& [q, exact] : {std::pair{0.5, 500'000}, {0.9, 900'000}, {0.99, 990'000}})
+  {
+    const auto got = snap.Percentile(q).count();
+    REQUIRE(got >= exact);
+    REQUIRE(got <= exact + exact / 16);
+  }
+  REQUIRE(snap.Percentile(1.0).count() == 1'000'000);
+  latency.Record(std::chrono::milliseconds{-5});
+  REQUIRE(latency.Read().Percentile(0).count() == 0);
+}
+
+TEST_CASE("metrics latency export", "[metrics]")
+{
+  Registry registry;
+  auto& latency = registry.GetLatency("lokinet_lookup_seconds", "lookup time", {{"kind", "rc"}});
+  latency.Record(std::chrono::milliseconds{8});
+  const std::string expected =
+      "# TYPE lokinet_lookup_seconds summary\n"
+      "# HELP lokinet_lookup_seconds lookup time\n"
+      "lokinet_lookup_seconds{kind=\"rc\",quantile=\"0.5\"} 0.0080000000000000002\n"
+      "lokinet_lookup_seconds{kind=\"rc\",quantile=\"0.9\"} 0.0080000000000000002\n"
+      "lokinet_lookup_seconds{kind=\"rc\",quantile=\"0.99\"} 0.0080000000000000002\n"
+      "lokinet_lookup_seconds{kind=\"rc\",quantile=\"0.999\"} 0.0080000000000000002\n"
+      "lokinet_lookup_seconds_sum{kind=\"rc\"} 0.0080000000000000002\n"
+      "lokinet_lookup_seconds_count{kind=\"rc\"} 1\n"
+      "# EOF\n";
+  REQUIRE(registry.ExportOpenMetrics() == expected);
+
+  const auto obj = registry.ExtractLatencies();
+  const auto& series = obj.at("lokinet_lookup_seconds").at(0);
+  REQUIRE(series.at("labels").at("kind") == "rc");
+  REQUIRE(series.at("count") == 1);
+  REQUIRE(series.at("p99") == 8.0);
+}
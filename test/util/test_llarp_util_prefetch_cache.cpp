@@ -0,0 +1,72 @@
+#include <util/prefetch_cache.hpp>
+#include <catch2/catch.hpp>
+
+#include <string>
+
+using namespace std::literals;
+
+using Cache_t = llarp::util::PrefetchCache<std::string, int>;
+
+TEST_CASE("PrefetchCache serves a value until it expires", "[util]")
+{
+  Cache_t cache{8, 1min, 5s};
+  cache.Put("a", 1, 10s, 20s, 0s);
+  REQUIRE(cache.Get("a", 15s) == 1);
+  CHECK_FALSE(cache.Get("b", 15s));
+  // past its refresh time but not expired, still served
+  CHECK(cache.Get("a", 19s) == 1);
+  CHECK_FALSE(cache.Get("a", 20s));
+  CHECK_FALSE(cache.Peek("a", 20s));
+  cache.Decay(20s);
+  CHECK(cache.Size() == 0);
+}
+
+TEST_CASE("PrefetchCache hands out hot values for refreshing", "[util]")
+{
+  Cache_t cache{8, 1min, 5s};
+  cache.Put("hot", 1, 10s, 100s, 0s);
+  cache.Put("cold", 2, 10s, 200s, 0s);
+  CHECK(cache.TakeDue(5s).empty());
+
+  REQUIRE(cache.Get("hot", 70s));
+  const auto due = cache.TakeDue(70s);
+  REQUIRE(due.size() == 1);
+  CHECK(due[0] == "hot");
+  // being refreshed, not due again until the retry interval passes
+  CHECK(cache.TakeDue(71s).empty());
+  CHECK(cache.TakeDue(75s).size() == 1);
+
+  // a refreshed value keeps its heat but is not due until its new refresh time
+  cache.Put("hot", 3, 150s, 200s, 76s);
+  CHECK(cache.TakeDue(100s).empty());
+  CHECK(cache.Peek("hot", 100s));
+  CHECK(*cache.Peek("hot", 100s) == 3);
+  // peeking does not make it hot
+  CHECK(cache.TakeDue(160s).empty());
+}
+
+TEST_CASE("PrefetchCache evicts the least recently used", "[util]")
+{
+  Cache_t cache{2, 1min, 5s};
+  cache.Put("a", 1, 10s, 100s, 0s);
+  cache.Put("b", 2, 10s, 100s, 1s);
+  REQUIRE(cache.Get("a", 2s));
+  cache.Put("c", 3, 10s, 100s, 3s);
+  CHECK(cache.Size() == 2);
+  CHECK(cache.Get("a", 4s));
+  CHECK_FALSE(cache.Get("b", 4s));
+  CHECK(cache.Get("c", 4s));
+}
+
+TEST_CASE("PrefetchCache keeps touched values hot", "[util]")
+{
+  Cache_t cache{8, 1min, 5s};
+  cache.Put("a", 1, 100s, 200s, 0s);
+  // used within the hot window by someone who never gets it
+  cache.Touch("a", 90s);
+  cache.Touch("b", 90s);
+  CHECK(cache.Size() == 1);
+  const auto due = cache.TakeDue(120s);
+  REQUIRE(due.size() == 1);
+  CHECK(due[0] == "a");
+}